@@ -61,6 +61,10 @@ namespace DSPConfig {
   constexpr float humPitchMinCents = 0.0f;
   constexpr float humPitchMaxCents = 15.0f;
 
+  // Harmony preset morph time in milliseconds (0 = switch at once)
+  constexpr float harmonyMorphMinMs = 0.0f;
+  constexpr float harmonyMorphMaxMs = 2000.0f;
+
   //==========================================================================
   // PITCH DETECTION CONFIGURATION
   // These control the YIN algorithm behavior
@@ -86,6 +90,9 @@ namespace DSPConfig {
    */
   constexpr int pitchDetectionHopSize = 256;
 
+  /** Analyses per frame length (hop = frame / divisor) */
+  constexpr int pitchDetectionHopDivisor = 8;
+
   //==========================================================================
   // PITCH RANGE CONFIGURATION BY VOICE TYPE
   // Frequencies in Hz - used to limit pitch search range
@@ -146,6 +153,31 @@ namespace DSPConfig {
    */
   constexpr int mixModeLatencySamples = 512;
 
+  //==========================================================================
+  // RENDER (OFFLINE) CONFIGURATION
+  // Used when the host renders non-realtime (bounce, freeze). Heavier, but
+  // the reported latency is the same as the real-time configuration's.
+  //==========================================================================
+
+  /** Detector hop divisor when rendering: twice the real-time analysis rate */
+  constexpr int renderHopDivisor = 16;
+
+  /**
+   * Soft clipper oversampling when rendering, as a power of 2 (2 = 4x).
+   * Polyphase IIR, so its delay is a few samples, taken out of the shifters.
+   */
+  constexpr int renderClipOversamplingOrder = 2;
+
+  /** Samples per pitch-ratio update when the smoothed track is applied */
+  constexpr int renderRatioUpdateSamples = 32;
+
+  /**
+   * Version of the rendered sound. Bump it with any change that alters the
+   * engine's output: the render cache (RenderCache.h) keys on it, so a new
+   * version never serves blocks rendered by an old one.
+   */
+  constexpr int engineVersion = 3;
+
   //==========================================================================
   // SMOOTHING CONFIGURATION
   //==========================================================================
@@ -0,0 +1,182 @@
+#include "KeyBus.h"
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+#else
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
+
+/**
+ * KeyBus.cpp
+ *
+ * The shared segment, and the seqlock on each change.
+ */
+
+namespace {
+
+  // Versioned: a layout change gets a new segment instead of misreading an old one.
+  // Short, for macOS's 31-character limit on shared memory names.
+#if JUCE_WINDOWS
+  const wchar_t *segmentName = L"Local\\NovaTuneKeyBus1";
+#else
+  const char *segmentName = "/NovaTuneKeyBus1";
+#endif
+
+} // namespace
+
+//==============================================================================
+// SEGMENT
+//==============================================================================
+
+/** The machine-wide segment, mapped */
+struct KeyBus::Mapping {
+#if JUCE_WINDOWS
+  HANDLE handle = nullptr;
+#endif
+  void *address = nullptr;
+
+  ~Mapping() {
+#if JUCE_WINDOWS
+    UnmapViewOfFile(address);
+    CloseHandle(handle);
+#else
+    munmap(address, sizeof(Segment));
+#endif
+  }
+
+  static std::unique_ptr<Mapping> open() {
+    auto mapping = std::make_unique<Mapping>();
+
+#if JUCE_WINDOWS
+    // Created zero-filled, or opened if another instance got there first
+    mapping->handle = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                         static_cast<DWORD>(sizeof(Segment)), segmentName);
+
+    if (mapping->handle == nullptr)
+      return {};
+
+    mapping->address = MapViewOfFile(mapping->handle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(Segment));
+
+    if (mapping->address == nullptr) {
+      CloseHandle(mapping->handle);
+      mapping->handle = nullptr;
+      return {};
+    }
+#else
+    const int fd = shm_open(segmentName, O_RDWR | O_CREAT, 0600);
+
+    if (fd < 0)
+      return {};
+
+    // Whoever finds it short extends it: extending is idempotent and zero-fills
+    struct stat status {};
+    const bool sized = fstat(fd, &status) == 0 &&
+                       (status.st_size >= static_cast<off_t>(sizeof(Segment)) ||
+                        ftruncate(fd, static_cast<off_t>(sizeof(Segment))) == 0);
+
+    void *address = sized ? mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    if (address == MAP_FAILED)
+      return {};
+
+    mapping->address = address;
+#endif
+
+    return mapping;
+  }
+};
+
+KeyBus::KeyBus() {
+  // The segment outlives every instance: the next session starts from its last key
+  if (auto shared = Mapping::open()) {
+    auto *candidate = static_cast<Segment *>(shared->address);
+    uint32_t magic = 0;
+
+    if (candidate->magic.compare_exchange_strong(magic, segmentMagic) || magic == segmentMagic) {
+      segment = candidate;
+      mapping = std::move(shared);
+    }
+  }
+
+  if (segment == nullptr)
+    segment = &localSegment;
+}
+
+KeyBus::~KeyBus() = default;
+
+//==============================================================================
+// PUBLISHING
+//==============================================================================
+
+void KeyBus::publish(NovaTuneEnums::Key key, NovaTuneEnums::Scale scale, juce::int64 timelineSample) noexcept {
+  const uint64_t number = segment->published.fetch_add(1, std::memory_order_acq_rel) + 1;
+  auto &slot = segment->slots[number % capacity];
+
+  // Odd: readers drop whatever they copy until the even tag lands
+  slot.tag.store(2 * number - 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.key.store(static_cast<int32_t>(key), std::memory_order_relaxed);
+  slot.scale.store(static_cast<int32_t>(scale), std::memory_order_relaxed);
+  slot.timelineSample.store(timelineSample, std::memory_order_relaxed);
+
+  slot.tag.store(2 * number, std::memory_order_release);
+}
+
+//==============================================================================
+// FOLLOWING
+//==============================================================================
+
+uint64_t KeyBus::getNumPublished() const noexcept { return segment->published.load(std::memory_order_acquire); }
+
+bool KeyBus::read(uint64_t number, Change &change) const noexcept {
+  const auto &slot = segment->slots[number % capacity];
+
+  // Not written yet, or already reused for a later change
+  if (slot.tag.load(std::memory_order_acquire) != 2 * number)
+    return false;
+
+  const int key = slot.key.load(std::memory_order_relaxed);
+  const int scale = slot.scale.load(std::memory_order_relaxed);
+  const juce::int64 timelineSample = slot.timelineSample.load(std::memory_order_relaxed);
+
+  // Torn by a writer reusing the slot meanwhile
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  if (slot.tag.load(std::memory_order_relaxed) != 2 * number)
+    return false;
+
+  // Another process's memory: never trust it to hold a valid enum
+  if (key < 0 || key >= static_cast<int>(NovaTuneEnums::Key::numKeys) || scale < 0 ||
+      scale >= static_cast<int>(NovaTuneEnums::Scale::numScales))
+    return false;
+
+  change.key = static_cast<NovaTuneEnums::Key>(key);
+  change.scale = static_cast<NovaTuneEnums::Scale>(scale);
+  change.timelineSample = timelineSample;
+  change.number = number;
+  return true;
+}
+
+bool KeyBus::getChangeAt(juce::int64 timelineSample, Change &change) const noexcept {
+  const uint64_t newest = getNumPublished();
+  const uint64_t oldest = newest > capacity ? newest - capacity + 1 : 1;
+
+  for (uint64_t number = newest; number >= oldest && number > 0; --number) {
+    Change candidate;
+
+    if (!read(number, candidate))
+      continue;
+
+    if (timelineSample == now || candidate.timelineSample == now || candidate.timelineSample <= timelineSample) {
+      change = candidate;
+      return true;
+    }
+  }
+
+  return false;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <memory>
+#include "ParameterIDs.h"
+
+/**
+ * KeyBus.h
+ *
+ * Key and scale shared by every NovaTune instance on the machine: one
+ * instance publishes, the others follow.
+ *
+ * WHY?
+ * A session with a lead, doubles and backing vocals runs an instance per
+ * track, and each one's key and scale have to be set - and changed at a
+ * modulation - by hand. With the bus, one instance (or, later, a key
+ * detector) publishes its key and scale and every instance set to follow
+ * sings in it, at the same point of the timeline. Hosts that run plugins
+ * sandboxed in separate processes still share it.
+ *
+ * HOW IT WORKS:
+ *
+ *   Publisher (audio thread)              Followers (audio thread, any process)
+ *   ────────────────────────              ─────────────────────────────────────
+ *   publish(key, scale, timeline) ──► [ shared segment: the last 32 changes ]
+ *                                         ──► getChangeAt(block end): the
+ *                                             newest change that is due
+ *
+ * - The segment is POSIX shared memory (a named file mapping on Windows),
+ *   created zero-filled by whichever instance opens it first. If it can't
+ *   be opened, instances in the same process share a private one.
+ * - Each change is a slot guarded by a seqlock: the writer marks the slot
+ *   odd, writes it and marks it even, tagged with the change's number. A
+ *   reader that sees the tag change mid-read drops the copy. Nobody ever
+ *   waits, so both ends run on the audio thread.
+ * - A change carries the host timeline sample it takes effect at.
+ *   Followers apply it at block granularity, not at that sample: a block
+ *   takes the newest change due by its last sample, so the change starts
+ *   with the block containing it - up to one block early, and in the same
+ *   block in every follower of a session. Splitting the block at the
+ *   change would run the engine on a shorter block, and TunerEngine
+ *   re-prepares its shifters on any block-size change: a click, where one
+ *   block of the new key early is inaudible. A publisher stamps changes
+ *   with its own block start, so its changes are block-aligned anyway. A
+ *   change published without a timeline position applies at once.
+ *
+ * THREADING:
+ * publish() and getChangeAt() are wait-free and allocation-free, callable
+ * from any thread of any process. Opening the segment (the constructor) is
+ * not: share one bus per process through juce::SharedResourcePointer.
+ *
+ * ANALOGY: Like a conductor's score on a shared screen - everyone reads
+ * the current key off the same page instead of being told one by one.
+ */
+
+class KeyBus {
+public:
+  /** Changes kept; a follower only needs the ones still due */
+  static constexpr int capacity = 32;
+
+  /** A timeline position for "at once" (no host timeline) */
+  static constexpr juce::int64 now = -1;
+
+  /** One published key/scale change */
+  struct Change {
+    NovaTuneEnums::Key key = NovaTuneEnums::Key::C;
+    NovaTuneEnums::Scale scale = NovaTuneEnums::Scale::Major;
+    juce::int64 timelineSample = now;
+    uint64_t number = 0; // 1 for the first change published on the bus
+  };
+
+  /** Opens (or creates) the machine-wide bus, falling back to a process-local one */
+  KeyBus();
+  ~KeyBus();
+
+  /** True if instances in other processes share this bus */
+  bool isMachineWide() const noexcept { return mapping != nullptr; }
+
+  /** Publish a change, taking effect at `timelineSample` (or `now`) */
+  void publish(NovaTuneEnums::Key key, NovaTuneEnums::Scale scale, juce::int64 timelineSample) noexcept;
+
+  /**
+   * The newest change due by `timelineSample` (every change, for `now`).
+   * False if none is - nothing published yet, or only for later.
+   */
+  bool getChangeAt(juce::int64 timelineSample, Change &change) const noexcept;
+
+  /** Changes published so far, by anyone */
+  uint64_t getNumPublished() const noexcept;
+
+private:
+  //==========================================================================
+  // SHARED LAYOUT
+  // Zero bytes are a valid empty bus, which is how a new segment starts
+  //==========================================================================
+
+  struct Slot {
+    std::atomic<uint64_t> tag{0}; // 2n while holding change n, 2n - 1 while it's written
+    std::atomic<int32_t> key{0};
+    std::atomic<int32_t> scale{0};
+    std::atomic<int64_t> timelineSample{0};
+  };
+
+  struct Segment {
+    std::atomic<uint32_t> magic{0}; // Set by the first instance to attach
+    uint32_t reserved = 0;
+    std::atomic<uint64_t> published{0};
+    Slot slots[capacity];
+  };
+
+  static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<int64_t>::is_always_lock_free &&
+                    std::atomic<int32_t>::is_always_lock_free,
+                "The segment is shared between processes, so its atomics can't use locks");
+
+  static constexpr uint32_t segmentMagic = 0x4e544b42; // "NTKB"; the version is in the segment's name
+
+  bool read(uint64_t number, Change &change) const noexcept;
+
+  Segment *segment = nullptr;
+  Segment localSegment; // When the machine-wide segment can't be opened
+
+  struct Mapping;
+  std::unique_ptr<Mapping> mapping;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(KeyBus)
+};
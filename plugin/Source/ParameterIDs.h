@@ -1,6 +1,6 @@
 #pragma once
 
-#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_core/juce_core.h>
 
 /**
  * ParameterIDs.h
@@ -69,12 +69,38 @@ namespace ParamIDs {
    */
   static constexpr const char *qualityMode = "qualityMode";
 
+  /**
+   * CPU Guard (Off / Studio / Live)
+   * How eagerly the engine sheds work when its block time nears the
+   * deadline (see dsp/CpuGuard.h)
+   */
+  static constexpr const char *cpuGuard = "cpuGuard";
+
+  /**
+   * Deterministic Render (on/off)
+   * Humanization from a seed saved with the session, and offline renders
+   * served from / stored in the render cache (see RenderCache.h)
+   */
+  static constexpr const char *deterministic = "deterministic";
+
+  /**
+   * Key Bus (Off / Publish / Follow)
+   * Share key and scale with the other instances on the machine (see KeyBus.h)
+   */
+  static constexpr const char *keyBus = "keyBus";
+
   /**
    * Harmony Preset dropdown
    * Quick way to set up common harmony configurations
    */
   static constexpr const char *harmonyPreset = "harmonyPreset";
 
+  /**
+   * Harmony Morph Time (ms)
+   * How long the voices take to move to a newly chosen harmony preset
+   */
+  static constexpr const char *harmonyMorphTime = "harmonyMorphTime";
+
   //==========================================================================
   // HARMONY VOICE A PARAMETERS
   //==========================================================================
@@ -279,6 +305,52 @@ namespace NovaTuneEnums {
     return {"Live", "Mix"};
   }
 
+  //==========================================================================
+  // CPU GUARD MODE ENUM
+  //==========================================================================
+
+  /**
+   * Off: never degrade
+   * Studio: degrade only when blocks are missing their deadline
+   * Live: degrade early, keeping headroom for the rest of the rig
+   */
+  enum class CpuGuardMode
+  {
+    Off,
+    Studio,
+    Live,
+    numCpuGuardModes
+  };
+
+  inline const juce::StringArray getCpuGuardModeNames()
+  {
+    return {"Off", "Studio", "Live"};
+  }
+
+  //==========================================================================
+  // KEY BUS MODE ENUM
+  //==========================================================================
+
+  /**
+   * What an instance does with the shared key bus.
+   *
+   * Off: Uses its own key and scale
+   * Publish: Sends its key and scale to the bus
+   * Follow: Sings in the bus's key and scale instead of its own
+   */
+  enum class KeyBusMode
+  {
+    Off,
+    Publish,
+    Follow,
+    numKeyBusModes
+  };
+
+  inline const juce::StringArray getKeyBusModeNames()
+  {
+    return {"Off", "Publish", "Follow"};
+  }
+
   //==========================================================================
   // HARMONY MODE ENUM
   //==========================================================================
@@ -0,0 +1,232 @@
+#include "PitchAnalysisCache.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+/**
+ * PitchAnalysisCache.cpp
+ *
+ * Content hashing, key derivation and the on-disk track directory.
+ */
+
+namespace {
+
+  constexpr uint64_t prime1 = 0x9e3779b185ebca87ull;
+  constexpr uint64_t prime2 = 0xc2b2ae3d27d4eb4full;
+  constexpr uint64_t prime3 = 0x165667b19e3779f9ull;
+
+  uint64_t rotl(uint64_t value, int bits) noexcept { return (value << bits) | (value >> (64 - bits)); }
+
+  /** One input word into an accumulator (the xxHash64 round) */
+  uint64_t accumulate(uint64_t acc, uint64_t input) noexcept { return rotl(acc + input * prime2, 31) * prime1; }
+
+  /** Final avalanche, so every input bit reaches every output bit */
+  uint64_t avalanche(uint64_t h) noexcept {
+    h ^= h >> 33;
+    h *= prime2;
+    h ^= h >> 29;
+    h *= prime3;
+    h ^= h >> 32;
+    return h;
+  }
+
+  uint32_t bitsOf(float value) noexcept {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  uint64_t bitsOf(double value) noexcept {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  void toKey(uint64_t a, uint64_t b, PitchTrack::Key &key) noexcept {
+    for (size_t i = 0; i < 8; ++i) {
+      key[i] = static_cast<uint8_t>(a >> (8 * i));
+      key[i + 8] = static_cast<uint8_t>(b >> (8 * i));
+    }
+  }
+
+  void fromKey(const PitchTrack::Key &key, uint64_t &a, uint64_t &b) noexcept {
+    a = b = 0;
+
+    for (size_t i = 0; i < 8; ++i) {
+      a |= static_cast<uint64_t>(key[i]) << (8 * i);
+      b |= static_cast<uint64_t>(key[i + 8]) << (8 * i);
+    }
+  }
+
+  const char *trackWildcard = "*.ntpt";
+
+} // namespace
+
+//==============================================================================
+// CONTENT HASH
+//==============================================================================
+
+void PitchAnalysisCache::ContentHash::addBlock(const juce::AudioBuffer<float> &buffer, int numSamples) {
+  if (channels.size() < static_cast<size_t>(buffer.getNumChannels()))
+    channels.resize(static_cast<size_t>(buffer.getNumChannels()));
+
+  for (int ch = 0; ch < buffer.getNumChannels(); ++ch) {
+    auto &state = channels[static_cast<size_t>(ch)];
+    const float *samples = buffer.getReadPointer(ch);
+
+    // Sample n always goes to lane n % 4, whatever the block boundaries
+    auto add = [&state](float sample) {
+      auto &lane = state.lanes[state.count & 3u];
+      lane = accumulate(lane, bitsOf(sample));
+      ++state.count;
+    };
+
+    int i = 0;
+
+    for (; i < numSamples && (state.count & 3u) != 0; ++i)
+      add(samples[i]);
+
+    // Aligned: four independent lanes, so the multiplies overlap
+    for (; i + 4 <= numSamples; i += 4) {
+      state.lanes[0] = accumulate(state.lanes[0], bitsOf(samples[i]));
+      state.lanes[1] = accumulate(state.lanes[1], bitsOf(samples[i + 1]));
+      state.lanes[2] = accumulate(state.lanes[2], bitsOf(samples[i + 2]));
+      state.lanes[3] = accumulate(state.lanes[3], bitsOf(samples[i + 3]));
+      state.count += 4;
+    }
+
+    for (; i < numSamples; ++i)
+      add(samples[i]);
+  }
+}
+
+PitchTrack::Key PitchAnalysisCache::ContentHash::finish() const {
+  uint64_t a = prime3 ^ channels.size();
+  uint64_t b = prime1 ^ channels.size();
+
+  for (const auto &state : channels) {
+    const auto &l = state.lanes;
+    const uint64_t first = rotl(l[0], 1) + rotl(l[1], 7) + rotl(l[2], 12) + rotl(l[3], 18);
+    const uint64_t second = rotl(l[0], 41) ^ rotl(l[1], 29) ^ rotl(l[2], 17) ^ rotl(l[3], 5);
+
+    a = avalanche(accumulate(a, first) ^ state.count);
+    b = avalanche(accumulate(b, second) + state.count * prime3);
+  }
+
+  PitchTrack::Key key;
+  toKey(a, b, key);
+  return key;
+}
+
+//==============================================================================
+// KEYS
+//==============================================================================
+
+PitchTrack::Key PitchAnalysisCache::makeKey(const ContentHash &audio, const PitchDetector &detector,
+                                            NovaTuneEnums::InputType inputType) {
+  const PitchTrack::FileHeader format;
+
+  // Everything that changes which hops come out of the same audio
+  const uint64_t settings[] = {format.version,
+                               bitsOf(detector.getSampleRate()),
+                               static_cast<uint64_t>(detector.getFrameSize()),
+                               static_cast<uint64_t>(detector.getHopSize()),
+                               bitsOf(detector.getThreshold()),
+                               static_cast<uint64_t>(inputType),
+                               detector.isFullLag() ? 1u : 0u};
+
+  return combine(audio.finish(), settings, std::size(settings));
+}
+
+PitchTrack::Key PitchAnalysisCache::combine(const PitchTrack::Key &key, const uint64_t *words, size_t numWords) {
+  uint64_t a, b;
+  fromKey(key, a, b);
+
+  for (size_t i = 0; i < numWords; ++i) {
+    a = accumulate(a, words[i]);
+    b = accumulate(b, words[i] ^ prime3);
+  }
+
+  PitchTrack::Key result;
+  toKey(avalanche(a), avalanche(b), result);
+  return result;
+}
+
+//==============================================================================
+// DIRECTORY
+//==============================================================================
+
+juce::File PitchAnalysisCache::getDefaultDirectory() {
+  return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+      .getChildFile("NovaTune")
+      .getChildFile("PitchCache");
+}
+
+PitchAnalysisCache::PitchAnalysisCache(const juce::File &directoryToUse) : directory(directoryToUse) {}
+
+juce::File PitchAnalysisCache::getFileFor(const PitchTrack::Key &key) const {
+  return directory.getChildFile(juce::String::toHexString(key.data(), static_cast<int>(key.size()), 0) + ".ntpt");
+}
+
+std::unique_ptr<MappedPitchTrack> PitchAnalysisCache::find(const PitchTrack::Key &key) const {
+  const auto file = getFileFor(key);
+
+  if (!file.existsAsFile())
+    return nullptr;
+
+  juce::String error;
+  auto track = MappedPitchTrack::open(file, &key, error);
+
+  if (track == nullptr) {
+    // Damaged (or from another version): analyse again and replace it
+    file.deleteFile();
+    return nullptr;
+  }
+
+  file.setLastModificationTime(juce::Time::getCurrentTime());
+  return track;
+}
+
+bool PitchAnalysisCache::store(const PitchTrack::Key &key, const PitchTrack &track) const {
+  if (!track.isValid() || !directory.createDirectory())
+    return false;
+
+  // Written beside the target and renamed over it, so find() never maps half a file
+  juce::TemporaryFile temporary(getFileFor(key));
+
+  {
+    juce::FileOutputStream stream(temporary.getFile());
+
+    if (!stream.openedOk() || !track.write(stream, key))
+      return false;
+
+    stream.flush();
+
+    if (stream.getStatus().failed())
+      return false;
+  }
+
+  return temporary.overwriteTargetFileWithTemporary();
+}
+
+void PitchAnalysisCache::trim(juce::int64 maxBytes) const {
+  auto files = directory.findChildFiles(juce::File::findFiles, false, trackWildcard);
+
+  juce::int64 total = 0;
+  for (const auto &file : files)
+    total += file.getSize();
+
+  std::sort(files.begin(), files.end(), [](const juce::File &x, const juce::File &y) {
+    return x.getLastModificationTime() < y.getLastModificationTime();
+  });
+
+  for (const auto &file : files) {
+    if (total <= maxBytes)
+      break;
+
+    const auto size = file.getSize();
+
+    if (file.deleteFile())
+      total -= size;
+  }
+}
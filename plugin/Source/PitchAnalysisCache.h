@@ -0,0 +1,95 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <memory>
+#include <vector>
+#include "dsp/PitchTrack.h"
+
+/**
+ * PitchAnalysisCache.h
+ *
+ * Pitch tracks on disk, addressed by what they were computed from.
+ *
+ * WHY?
+ * A track is only valid for the exact audio and detector settings it was
+ * analysed with. Naming the file after a hash of both means a lookup
+ * needs no bookkeeping: the same take rendered again, under any file name
+ * and with any other parameters changed, finds its track; different audio
+ * or a different detector configuration can never be served a stale one.
+ *
+ * HOW IT WORKS:
+ * 1. ContentHash runs over the audio the engine will see (every channel,
+ *    block by block - the result doesn't depend on the block size)
+ * 2. makeKey() folds in the detector's configuration: sample rate, frame,
+ *    hop, threshold, input type and full-lag
+ * 3. find() maps <key>.ntpt if present; store() writes one via a
+ *    temporary file, so readers never see a partial track
+ *
+ * Hashing reads each sample once (~1 ns/sample) and a hit maps the file
+ * without decoding it, so a four-minute take costs tens of milliseconds
+ * instead of a YIN pass. trim() keeps the directory within a size budget,
+ * least recently used first.
+ *
+ * THREADING:
+ * No shared state; several renders can look up and store concurrently.
+ *
+ * ANALOGY: Like a build cache (ccache) - outputs filed under a hash of
+ * their inputs, so a rebuild of unchanged sources is a lookup.
+ */
+
+class PitchAnalysisCache {
+public:
+  /**
+   * Streaming hash of multichannel audio. Each channel has its own state,
+   * so feeding the same audio in different block sizes gives the same hash.
+   */
+  class ContentHash {
+  public:
+    void addBlock(const juce::AudioBuffer<float> &buffer, int numSamples);
+
+    /** Channel count and length are part of the hash */
+    PitchTrack::Key finish() const;
+
+    /** Start over (keeps the channel storage, so hashing block by block doesn't allocate) */
+    void reset() noexcept { channels.clear(); }
+
+  private:
+    struct ChannelState {
+      uint64_t lanes[4] = {0x243f6a8885a308d3ull, 0x13198a2e03707344ull, 0xa4093822299f31d0ull, 0x082efa98ec4e6c89ull};
+      uint64_t count = 0;
+    };
+
+    std::vector<ChannelState> channels;
+  };
+
+  /**
+   * Key for audio hashed by `audio`, analysed by a detector prepared like
+   * `detector` with `inputType` (a parameter, so the detector only picks it
+   * up once processing starts)
+   */
+  static PitchTrack::Key makeKey(const ContentHash &audio, const PitchDetector &detector,
+                                 NovaTuneEnums::InputType inputType);
+
+  /** Fold `numWords` values into `key` - settings, a chain's previous key (see RenderCache) */
+  static PitchTrack::Key combine(const PitchTrack::Key &key, const uint64_t *words, size_t numWords);
+
+  /** <user application data>/NovaTune/PitchCache */
+  static juce::File getDefaultDirectory();
+
+  explicit PitchAnalysisCache(const juce::File &directory = getDefaultDirectory());
+
+  /** The cached track for `key`, or nullptr. A hit counts as a use for trim(). */
+  std::unique_ptr<MappedPitchTrack> find(const PitchTrack::Key &key) const;
+
+  /** File a recorded track under `key` (replacing any existing one) */
+  bool store(const PitchTrack::Key &key, const PitchTrack &track) const;
+
+  /** Delete least recently used tracks until the directory is within maxBytes */
+  void trim(juce::int64 maxBytes) const;
+
+  juce::File getFileFor(const PitchTrack::Key &key) const;
+  const juce::File &getDirectory() const noexcept { return directory; }
+
+private:
+  juce::File directory;
+};
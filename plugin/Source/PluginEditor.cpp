@@ -1,4 +1,5 @@
 #include "PluginEditor.h"
+#include <cstring>
 
 /**
  * PluginEditor.cpp
@@ -139,16 +140,66 @@ void NovaTuneLookAndFeel::drawToggleButton(juce::Graphics &g,
              juce::Justification::centredLeft, true);
 }
 
+//==============================================================================
+// VISIBILITY
+//==============================================================================
+
+namespace {
+/**
+ * Is the component on screen? Hidden and minimised editors are caught by
+ * isShowing(). A component not on any desktop (rendered to an image by
+ * EditorPaintBench) can only be hidden by its own or a parent's flag.
+ */
+bool isDisplayed(const juce::Component &component) {
+  if (component.getPeer() != nullptr)
+    return component.isShowing();
+
+  for (auto *c = &component; c != nullptr; c = c->getParentComponent()) {
+    if (!c->isVisible())
+      return false;
+  }
+
+  return true;
+}
+} // namespace
+
 //==============================================================================
 // PITCH DISPLAY COMPONENT
 //==============================================================================
 
 PitchDisplayComponent::PitchDisplayComponent(NovaTuneAudioProcessor &p)
-    : processor(p) {
-  startTimerHz(30); // Update 30 times per second
+    : pitchHistory(p.getPitchHistory()),
+      drainedFrames(static_cast<size_t>(PitchHistory::capacity)) {
+  // Whatever queued up while no editor was open is stale
+  pitchHistory.discardAll();
+
+  setRefreshRate(activeHz);
+}
+
+void PitchDisplayComponent::setRefreshRate(int hz) {
+  if (hz == refreshHz)
+    return;
+
+  refreshHz = hz;
+  startTimerHz(hz);
+}
+
+PitchDisplayComponent::DisplayState PitchDisplayComponent::getDisplayState() const noexcept {
+  DisplayState state;
+  state.voiced = isVoiced;
+
+  if (isVoiced) {
+    state.pitchNote = static_cast<int>(std::round(displayedPitch));
+    state.targetNote = static_cast<int>(std::round(displayedTarget));
+    state.cents = static_cast<int>(displayedCents);
+  }
+
+  return state;
 }
 
 void PitchDisplayComponent::paint(juce::Graphics &g) {
+  paintedState = getDisplayState();
+
   auto bounds = getLocalBounds().toFloat();
 
   // Background
@@ -211,22 +262,459 @@ void PitchDisplayComponent::paint(juce::Graphics &g) {
 }
 
 void PitchDisplayComponent::timerCallback() {
-  const auto &detector = processor.getTunerEngine().getPitchDetector();
-  const auto &mapper = processor.getTunerEngine().getPitchMapper();
+  // Hidden or minimised - nothing to draw, just keep the queue from filling
+  if (!isDisplayed(*this)) {
+    pitchHistory.discardAll();
+    setRefreshRate(hiddenHz);
+    return;
+  }
 
-  isVoiced = detector.isVoiced();
+  const int numFrames = pitchHistory.pop(drainedFrames.data(), static_cast<int>(drainedFrames.size()));
+
+  // No new hops (transport stopped) - keep showing the last one
+  if (numFrames == 0) {
+    setRefreshRate(idleHz);
+    return;
+  }
+
+  if (onFramesDrained)
+    onFramesDrained(drainedFrames.data(), numFrames);
+
+  const bool anyVoiced = std::any_of(drainedFrames.begin(), drainedFrames.begin() + numFrames,
+                                     [](const PitchFrame &frame) { return frame.voiced; });
+  setRefreshRate(anyVoiced ? activeHz : unvoicedHz);
+
+  const auto &latest = drainedFrames[static_cast<size_t>(numFrames - 1)];
+  isVoiced = latest.voiced;
 
   if (isVoiced) {
-    displayedPitch = detector.getMidiNote();
+    displayedPitch = latest.detectedMidiNote;
+    displayedTarget = latest.targetMidiNote;
+    displayedCents = (latest.detectedMidiNote - latest.targetMidiNote) * 100.0f;
+  }
+
+  if (!(getDisplayState() == paintedState))
+    repaint();
+}
+
+//==============================================================================
+// PITCH GRAPH
+//==============================================================================
+
+PitchGraphComponent::PitchGraphComponent() {
+  // Every pixel is painted, so JUCE never repaints the editor behind it
+  setOpaque(true);
+  setInterceptsMouseClicks(false, false);
+}
+
+void PitchGraphComponent::resized() {
+  plotArea = getLocalBounds().reduced(6);
+  plotArea.removeFromLeft(28); // Octave labels
+
+  // A software image, so scrolling is a plain memmove on every platform
+  strip = juce::Image(juce::Image::RGB, juce::jmax(1, plotArea.getWidth()), juce::jmax(1, plotArea.getHeight()),
+                      false, juce::SoftwareImageType());
+
+  juce::Graphics g(strip);
+  clearColumns(g, 0, strip.getWidth());
+  hasPrevious = false;
+}
+
+void PitchGraphComponent::addFrames(const PitchFrame *frames, int numFrames) {
+  if (strip.isNull() || numFrames <= 0)
+    return;
+
+  const int width = strip.getWidth();
+  bool changed = false;
+
+  for (int i = 0; i < numFrames; ++i) {
+    const auto &frame = frames[i];
+    const auto column = static_cast<int64_t>(frame.timeSeconds * columnsPerSecond);
+
+    if (column < newestColumn) {
+      // The engine was reset and its clock restarted - start a fresh graph
+      juce::Graphics g(strip);
+      clearColumns(g, 0, width);
+      newestColumn = column;
+      hasPrevious = false;
+    } else if (column > newestColumn) {
+      scrollBy(static_cast<int>(std::min<int64_t>(column - newestColumn, width)));
+      newestColumn = column;
+    }
+
+    changed = true;
+
+    if (!frame.voiced) {
+      hasPrevious = false;
+      continue;
+    }
+
+    const float x = static_cast<float>(width - 1 - (newestColumn - column)) + 0.5f;
+    const float pitchY = noteToY(frame.detectedMidiNote);
+    const float targetY = noteToY(frame.targetMidiNote);
+
+    // Join to the previous hop unless there was a gap (unvoiced, or dropped frames)
+    const bool joined = hasPrevious && column - previousColumn <= 5;
+    const float fromX = joined ? static_cast<float>(width - 1 - (newestColumn - previousColumn)) + 0.5f : x;
+
+    juce::Graphics g(strip);
+    g.setColour(NovaTuneLookAndFeel::textColour);
+    g.drawLine(fromX, joined ? previousTargetY : targetY, x, targetY, 2.0f);
+    g.setColour(juce::Colours::white);
+    g.drawLine(fromX, joined ? previousPitchY : pitchY, x, pitchY, 1.5f);
+
+    hasPrevious = true;
+    previousColumn = column;
+    previousPitchY = pitchY;
+    previousTargetY = targetY;
+  }
+
+  if (changed)
+    repaint(plotArea);
+}
+
+void PitchGraphComponent::scrollBy(int numColumns) {
+  const int width = strip.getWidth();
+
+  if (numColumns < width)
+    strip.moveImageSection(0, 0, numColumns, 0, width - numColumns, strip.getHeight());
+
+  juce::Graphics g(strip);
+  clearColumns(g, width - numColumns, numColumns);
+}
+
+void PitchGraphComponent::clearColumns(juce::Graphics &g, int x, int width) const {
+  g.setColour(NovaTuneLookAndFeel::accentColour.darker(0.6f));
+  g.fillRect(x, 0, width, strip.getHeight());
+
+  // A line at every C
+  g.setColour(NovaTuneLookAndFeel::dimTextColour.withAlpha(0.35f));
+
+  for (float note = lowestMidiNote; note <= highestMidiNote; note += 12.0f)
+    g.fillRect(static_cast<float>(x), std::floor(noteToY(note)), static_cast<float>(width), 1.0f);
+}
+
+float PitchGraphComponent::noteToY(float midiNote) const {
+  const float height = static_cast<float>(strip.getHeight() - 1);
+  const float normalized = (juce::jlimit(lowestMidiNote, highestMidiNote, midiNote) - lowestMidiNote) /
+                           (highestMidiNote - lowestMidiNote);
+  return height * (1.0f - normalized);
+}
+
+void PitchGraphComponent::paint(juce::Graphics &g) {
+  g.fillAll(NovaTuneLookAndFeel::backgroundColour);
+  g.setColour(NovaTuneLookAndFeel::panelColour);
+  g.fillRoundedRectangle(getLocalBounds().toFloat(), 8.0f);
+
+  g.drawImageAt(strip, plotArea.getX(), plotArea.getY());
+
+  g.setColour(NovaTuneLookAndFeel::dimTextColour);
+  g.setFont(10.0f);
+
+  for (float note = lowestMidiNote; note <= highestMidiNote; note += 12.0f) {
+    const float y = static_cast<float>(plotArea.getY()) + noteToY(note);
+    g.drawText(NovaTuneUtils::getMidiNoteName(static_cast<int>(note)),
+               juce::Rectangle<float>(0.0f, y - 6.0f, static_cast<float>(plotArea.getX() - 4), 12.0f),
+               juce::Justification::centredRight);
+  }
+}
+
+//==============================================================================
+// LEVEL METERS
+//==============================================================================
+
+namespace {
+constexpr int meterRefreshHz = 30;
+constexpr float peakFallDbPerSecond = 20.0f;
+constexpr int peakHoldTicks = meterRefreshHz * 3 / 2; // 1.5s
+} // namespace
+
+LevelMeterComponent::LevelMeterComponent(NovaTuneAudioProcessor &p)
+    : meters{&p.getInputMeter(), &p.getOutputMeter()} {
+  // Discard whatever peaked while no editor was open
+  for (auto *meter : meters) {
+    for (int ch = 0; ch < LevelMeter::maxChannels; ++ch)
+      meter->takePeak(ch);
+  }
+
+  for (size_t m = 0; m < meters.size(); ++m) {
+    for (int ch = 0; ch < LevelMeter::maxChannels; ++ch)
+      bars[m][static_cast<size_t>(ch)].previousTotals = meters[m]->getTotals(ch);
+  }
+
+  startTimerHz(meterRefreshHz);
+}
+
+bool LevelMeterComponent::updateBar(LevelMeter &meter, int channel, Bar &bar) {
+  const float peak = meter.takePeak(channel);
+  const auto totals = meter.getTotals(channel);
+  const float rms = LevelMeter::getRms(bar.previousTotals, totals);
+  bar.previousTotals = totals;
+
+  const float peakDb = juce::Decibels::gainToDecibels(peak, minDb);
+  const float rmsDb = juce::Decibels::gainToDecibels(rms, minDb);
+
+  // Peaks jump up and fall back at a fixed rate; the hold line waits first
+  const float fallenPeakDb = juce::jmax(peakDb, bar.peakDb - peakFallDbPerSecond / meterRefreshHz);
+  float holdDb = bar.holdDb;
+
+  if (peakDb >= bar.holdDb) {
+    holdDb = peakDb;
+    bar.holdTicksLeft = peakHoldTicks;
+  } else if (bar.holdTicksLeft > 0) {
+    --bar.holdTicksLeft;
+  } else {
+    holdDb = juce::jmax(minDb, bar.holdDb - peakFallDbPerSecond / meterRefreshHz);
+  }
+
+  const bool clipped = bar.clipped || peak >= 1.0f;
+
+  const bool changed = std::abs(fallenPeakDb - bar.peakDb) > 0.1f || std::abs(rmsDb - bar.rmsDb) > 0.1f ||
+                       std::abs(holdDb - bar.holdDb) > 0.1f || clipped != bar.clipped;
+
+  bar.peakDb = fallenPeakDb;
+  bar.rmsDb = rmsDb;
+  bar.holdDb = holdDb;
+  bar.clipped = clipped;
+  return changed;
+}
+
+void LevelMeterComponent::timerCallback() {
+  // Poll slowly while hidden; the first tick after showing again picks up
+  // the peak and RMS of the whole hidden stretch
+  const bool displayed = isDisplayed(*this);
+  const int hz = displayed ? meterRefreshHz : PitchDisplayComponent::hiddenHz;
+
+  if (getTimerInterval() != 1000 / hz)
+    startTimerHz(hz);
+
+  if (!displayed)
+    return;
+
+  bool changed = false;
+
+  for (size_t m = 0; m < meters.size(); ++m) {
+    for (int ch = 0; ch < LevelMeter::maxChannels; ++ch)
+      changed |= updateBar(*meters[m], ch, bars[m][static_cast<size_t>(ch)]);
+  }
+
+  if (changed)
+    repaint();
+}
+
+void LevelMeterComponent::mouseDown(const juce::MouseEvent &) {
+  for (auto &group : bars) {
+    for (auto &bar : group)
+      bar.clipped = false;
+  }
+
+  repaint();
+}
+
+void LevelMeterComponent::paint(juce::Graphics &g) {
+  auto bounds = getLocalBounds().toFloat();
+
+  g.setColour(NovaTuneLookAndFeel::panelColour);
+  g.fillRoundedRectangle(bounds, 8.0f);
+
+  bounds.reduce(6.0f, 6.0f);
+  auto labels = bounds.removeFromBottom(14.0f);
+
+  auto toProportion = [](float db) { return juce::jlimit(0.0f, 1.0f, (db - minDb) / -minDb); };
+  const float groupWidth = bounds.getWidth() / static_cast<float>(meters.size());
+
+  g.setFont(10.0f);
+
+  for (size_t m = 0; m < meters.size(); ++m) {
+    auto group = bounds.removeFromLeft(groupWidth).reduced(3.0f, 0.0f);
+
+    g.setColour(NovaTuneLookAndFeel::dimTextColour);
+    g.drawText(m == 0 ? "IN" : "OUT", labels.removeFromLeft(groupWidth), juce::Justification::centred);
+
+    const int numChannels = meters[m]->getNumChannels();
+    const float barWidth = group.getWidth() / static_cast<float>(numChannels);
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+      const auto &bar = bars[m][static_cast<size_t>(ch)];
+      auto column = group.removeFromLeft(barWidth).reduced(1.0f, 0.0f);
 
-    const auto &result = mapper.getLastResult();
-    displayedTarget = result.leadTargetMidiNote;
-    displayedCents = result.centsOffTarget;
+      // Clip light
+      auto light = column.removeFromTop(6.0f);
+      g.setColour(bar.clipped ? juce::Colours::red : NovaTuneLookAndFeel::accentColour);
+      g.fillRect(light);
+      column.removeFromTop(2.0f);
+
+      g.setColour(NovaTuneLookAndFeel::accentColour);
+      g.fillRect(column);
+
+      // Peak behind, RMS in front, held peak as a line
+      g.setColour(juce::Colours::white.withAlpha(0.35f));
+      g.fillRect(column.withTop(column.getBottom() - column.getHeight() * toProportion(bar.peakDb)));
+
+      g.setColour(NovaTuneLookAndFeel::textColour);
+      g.fillRect(column.withTop(column.getBottom() - column.getHeight() * toProportion(bar.rmsDb)));
+
+      if (bar.holdDb > minDb) {
+        g.setColour(juce::Colours::white);
+        g.fillRect(column.withTop(column.getBottom() - column.getHeight() * toProportion(bar.holdDb)).withHeight(1.0f));
+      }
+    }
+  }
+}
+
+//==============================================================================
+// PERFORMANCE OVERLAY
+//==============================================================================
+
+PerformanceOverlay::PerformanceOverlay(NovaTuneAudioProcessor &p)
+    : profiler(p.getStageProfiler()),
+      blockTimes(p.getBlockTimeHistogram()),
+      cpuGuard(p.getCpuGuard()) {
+  setInterceptsMouseClicks(false, false);
+}
+
+PerformanceOverlay::~PerformanceOverlay() {
+  if (isProfiling)
+    profiler.removeClient();
+}
+
+void PerformanceOverlay::visibilityChanged() {
+  if (isVisible() == isProfiling)
+    return;
+
+  isProfiling = isVisible();
+
+  if (isProfiling) {
+    profiler.resetPeak();
+    previousTotals = profiler.getTotals();
+    profiler.addClient();
+    startTimerHz(10);
+  } else {
+    stopTimer();
+    profiler.removeClient();
+  }
+}
+
+void PerformanceOverlay::timerCallback() {
+  blockTimeSnapshot = blockTimes.getSnapshot();
+
+  const auto totals = profiler.getTotals();
+  const auto budget = totals.budgetNanos - previousTotals.budgetNanos;
+
+  // No audio since the last tick (transport stopped) - keep the last values
+  if (budget <= 0)
+    return;
+
+  auto percentOf = [budget](int64_t nanos) {
+    return static_cast<float>(100.0 * static_cast<double>(nanos) / static_cast<double>(budget));
+  };
+
+  for (size_t i = 0; i < stagePercent.size(); ++i)
+    stagePercent[i] = percentOf(totals.stageNanos[i] - previousTotals.stageNanos[i]);
+
+  totalPercent = percentOf(totals.processNanos - previousTotals.processNanos);
+  peakPercent = static_cast<float>(totals.peakBlockPermille) / 10.0f;
+
+  previousTotals = totals;
+  repaint();
+}
+
+void PerformanceOverlay::paint(juce::Graphics &g) {
+  auto bounds = getLocalBounds().toFloat();
+
+  g.setColour(NovaTuneLookAndFeel::panelColour.withAlpha(0.92f));
+  g.fillRoundedRectangle(bounds, 8.0f);
+
+  bounds.reduce(10.0f, 6.0f);
+
+  g.setColour(juce::Colours::white);
+  g.setFont(14.0f);
+  g.drawText("CPU - % of block budget", bounds.removeFromTop(22.0f), juce::Justification::centredLeft);
+
+  g.setFont(12.0f);
+  const float rowHeight = juce::jmin(18.0f, bounds.getHeight() / static_cast<float>(StageProfiler::numStages + 3));
+
+  for (int i = 0; i < StageProfiler::numStages; ++i) {
+    auto row = bounds.removeFromTop(rowHeight);
+    const float percent = stagePercent[static_cast<size_t>(i)];
+
+    g.setColour(NovaTuneLookAndFeel::dimTextColour);
+    g.drawText(StageProfiler::getStageName(static_cast<StageProfiler::Stage>(i)),
+               row.removeFromLeft(80.0f), juce::Justification::centredLeft);
+
+    g.setColour(juce::Colours::white);
+    g.drawText(juce::String(percent, 1) + "%", row.removeFromRight(50.0f), juce::Justification::centredRight);
+
+    // Bars are scaled so a full row is the whole budget
+    auto bar = row.reduced(4.0f, 4.0f);
+    g.setColour(NovaTuneLookAndFeel::accentColour);
+    g.fillRect(bar);
+    g.setColour(NovaTuneLookAndFeel::textColour);
+    g.fillRect(bar.withWidth(bar.getWidth() * juce::jlimit(0.0f, 1.0f, percent / 100.0f)));
   }
 
+  g.setColour(totalPercent > 80.0f || peakPercent > 100.0f ? NovaTuneLookAndFeel::textColour
+                                                           : juce::Colours::white);
+  g.drawText("Total " + juce::String(totalPercent, 1) + "%   Peak " + juce::String(peakPercent, 1) + "%",
+             bounds.removeFromTop(rowHeight), juce::Justification::centredLeft);
+
+  // Tail latency - any block over 100% is a potential dropout
+  auto asPercent = [](double ratio) { return juce::String(100.0 * ratio, 0) + "%"; };
+  const auto &blocks = blockTimeSnapshot;
+
+  g.setColour(blocks.maxRatio > 1.0 ? NovaTuneLookAndFeel::textColour : NovaTuneLookAndFeel::dimTextColour);
+  g.drawText("Blocks p50 " + asPercent(blocks.percentile(0.5)) +
+                 "  p99 " + asPercent(blocks.percentile(0.99)) +
+                 "  p99.9 " + asPercent(blocks.percentile(0.999)) +
+                 "  max " + asPercent(blocks.maxRatio),
+             bounds.removeFromTop(rowHeight), juce::Justification::centredLeft);
+
+  // Degradation policy and what it is currently shedding
+  const auto guardLevel = cpuGuard.getPublishedLevel();
+  const auto guardMode = NovaTuneEnums::getCpuGuardModeNames()[static_cast<int>(cpuGuard.getMode())];
+
+  g.setColour(guardLevel != CpuGuard::full ? NovaTuneLookAndFeel::textColour : NovaTuneLookAndFeel::dimTextColour);
+  g.drawText("Guard " + guardMode + "  level " + juce::String(static_cast<int>(guardLevel)) + "/" +
+                 juce::String(CpuGuard::numLevels - 1) + " (" + CpuGuard::getLevelName(guardLevel) + ")" +
+                 "  load " + asPercent(cpuGuard.getPublishedLoad()),
+             bounds.removeFromTop(rowHeight), juce::Justification::centredLeft);
+}
+
+//==============================================================================
+// CPU GUARD INDICATOR
+//==============================================================================
+
+CpuGuardIndicator::CpuGuardIndicator(NovaTuneAudioProcessor &p)
+    : cpuGuard(p.getCpuGuard()) {
+  setInterceptsMouseClicks(false, false);
+  startTimerHz(4);
+}
+
+void CpuGuardIndicator::timerCallback() {
+  const auto level = cpuGuard.getPublishedLevel();
+  const int loadPercent = juce::roundToInt(100.0f * cpuGuard.getPublishedLoad());
+  const bool off = cpuGuard.getMode() == NovaTuneEnums::CpuGuardMode::Off;
+
+  if (level == displayedLevel && loadPercent == displayedLoadPercent && off == isOff)
+    return;
+
+  displayedLevel = level;
+  displayedLoadPercent = loadPercent;
+  isOff = off;
   repaint();
 }
 
+void CpuGuardIndicator::paint(juce::Graphics &g) {
+  const bool degraded = displayedLevel != CpuGuard::full;
+
+  juce::String text = isOff ? juce::String("Guard off") : juce::String(CpuGuard::getLevelName(displayedLevel));
+  text << "  -  load " << displayedLoadPercent << "%";
+
+  g.setColour(degraded ? NovaTuneLookAndFeel::textColour : NovaTuneLookAndFeel::dimTextColour);
+  g.setFont(12.0f);
+  g.drawText(text, getLocalBounds(), juce::Justification::centredLeft);
+}
+
 //==============================================================================
 // HARMONY VOICE PANEL
 //==============================================================================
@@ -349,10 +837,23 @@ HarmonyVoicePanel::HarmonyVoicePanel(NovaTuneAudioProcessor &p, int index)
   formantLabel.setText("Formant", juce::dontSendNotification);
   formantLabel.setJustificationType(juce::Justification::centred);
   addAndMakeVisible(formantLabel);
+
+  // Following the Harmony Preset
+  followLabel.setText("Preset", juce::dontSendNotification);
+  followLabel.setJustificationType(juce::Justification::centredRight);
+  followLabel.setColour(juce::Label::textColourId, NovaTuneLookAndFeel::dimTextColour);
+  addChildComponent(followLabel);
+
+  timerCallback();
+  startTimerHz(4);
 }
 
 HarmonyVoicePanel::~HarmonyVoicePanel() = default;
 
+void HarmonyVoicePanel::timerCallback() {
+  followLabel.setVisible(processor.isVoiceFollowingHarmonyPreset(voiceIndex));
+}
+
 void HarmonyVoicePanel::paint(juce::Graphics &g) {
   auto bounds = getLocalBounds().toFloat();
 
@@ -367,7 +868,9 @@ void HarmonyVoicePanel::resized() {
   auto bounds = getLocalBounds().reduced(10);
 
   // Enabled button at top
-  enabledButton.setBounds(bounds.removeFromTop(25));
+  auto topRow = bounds.removeFromTop(25);
+  followLabel.setBounds(topRow.removeFromRight(60));
+  enabledButton.setBounds(topRow);
   bounds.removeFromTop(5);
 
   // Mode and interval
@@ -407,7 +910,10 @@ void HarmonyVoicePanel::resized() {
 NovaTuneAudioProcessorEditor::NovaTuneAudioProcessorEditor(NovaTuneAudioProcessor &p)
     : AudioProcessorEditor(&p),
       processor(p),
-      pitchDisplay(p) {
+      pitchDisplay(p),
+      levelMeters(p),
+      performanceOverlay(p),
+      cpuGuardIndicator(p) {
   setLookAndFeel(&lookAndFeel);
 
   auto &apvts = processor.getValueTreeState();
@@ -495,6 +1001,16 @@ NovaTuneAudioProcessorEditor::NovaTuneAudioProcessorEditor(NovaTuneAudioProcesso
   harmonyPresetLabel.setJustificationType(juce::Justification::centredLeft);
   addAndMakeVisible(harmonyPresetLabel);
 
+  harmonyMorphSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+  harmonyMorphSlider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 60, 20);
+  harmonyMorphSlider.setTextValueSuffix(" ms");
+  addAndMakeVisible(harmonyMorphSlider);
+  harmonyMorphAttachment = std::make_unique<SliderAttachment>(apvts, ParamIDs::harmonyMorphTime, harmonyMorphSlider);
+
+  harmonyMorphLabel.setText("Morph", juce::dontSendNotification);
+  harmonyMorphLabel.setJustificationType(juce::Justification::centredRight);
+  addAndMakeVisible(harmonyMorphLabel);
+
   voicePanelA = std::make_unique<HarmonyVoicePanel>(processor, 0);
   voicePanelB = std::make_unique<HarmonyVoicePanel>(processor, 1);
   voicePanelC = std::make_unique<HarmonyVoicePanel>(processor, 2);
@@ -509,6 +1025,18 @@ NovaTuneAudioProcessorEditor::NovaTuneAudioProcessorEditor(NovaTuneAudioProcesso
 
   addAndMakeVisible(pitchDisplay);
 
+  // The display owns the PitchHistory reader and hands each batch on
+  pitchDisplay.onFramesDrained = [this](const PitchFrame *frames, int numFrames) {
+    pitchGraph.addFrames(frames, numFrames);
+  };
+  addAndMakeVisible(pitchGraph);
+
+  //==========================================================================
+  // LEVEL METERS
+  //==========================================================================
+
+  addAndMakeVisible(levelMeters);
+
   //==========================================================================
   // BYPASS
   //==========================================================================
@@ -517,17 +1045,122 @@ NovaTuneAudioProcessorEditor::NovaTuneAudioProcessorEditor(NovaTuneAudioProcesso
   addAndMakeVisible(bypassButton);
   bypassAttachment = std::make_unique<ButtonAttachment>(apvts, ParamIDs::bypass, bypassButton);
 
+  //==========================================================================
+  // DETERMINISTIC RENDER (seeded humanization, cached offline renders)
+  //==========================================================================
+
+  deterministicButton.setButtonText("Deterministic");
+  addAndMakeVisible(deterministicButton);
+  deterministicAttachment = std::make_unique<ButtonAttachment>(apvts, ParamIDs::deterministic, deterministicButton);
+
+  //==========================================================================
+  // CPU OVERLAY (not a parameter - a diagnostic view)
+  //==========================================================================
+
+  cpuButton.setButtonText("CPU");
+  cpuButton.onClick = [this] { performanceOverlay.setVisible(cpuButton.getToggleState()); };
+  addAndMakeVisible(cpuButton);
+
+  //==========================================================================
+  // CPU GUARD (policy is a parameter; the indicator shows what it is doing)
+  //==========================================================================
+
+  cpuGuardBox.addItemList(NovaTuneEnums::getCpuGuardModeNames(), 1);
+  addAndMakeVisible(cpuGuardBox);
+  cpuGuardAttachment = std::make_unique<ComboBoxAttachment>(apvts, ParamIDs::cpuGuard, cpuGuardBox);
+
+  cpuGuardLabel.setText("CPU Guard", juce::dontSendNotification);
+  addAndMakeVisible(cpuGuardLabel);
+
+  keyBusBox.addItemList(NovaTuneEnums::getKeyBusModeNames(), 1);
+  addAndMakeVisible(keyBusBox);
+  keyBusAttachment = std::make_unique<ComboBoxAttachment>(apvts, ParamIDs::keyBus, keyBusBox);
+
+  keyBusLabel.setText("Key Bus", juce::dontSendNotification);
+  addAndMakeVisible(keyBusLabel);
+
+  addAndMakeVisible(cpuGuardIndicator);
+
+  // Added last so it draws over the harmony section
+  addChildComponent(performanceOverlay);
+
+  //==========================================================================
+  // TELEMETRY LOG (keeps recording when the editor is closed)
+  //==========================================================================
+
+  logButton.setButtonText("Log");
+  logButton.setToggleState(processor.isRecordingTelemetry(), juce::dontSendNotification);
+  logButton.onClick = [this] {
+    if (!logButton.getToggleState()) {
+      processor.stopTelemetry();
+      return;
+    }
+
+    const auto file = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                          .getChildFile("NovaTune")
+                          .getChildFile("Telemetry")
+                          .getChildFile("NovaTune-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".nttl");
+
+    if (!processor.startTelemetry(file))
+      logButton.setToggleState(false, juce::dontSendNotification);
+  };
+  addAndMakeVisible(logButton);
+
+  //==========================================================================
+  // PRESETS (listed from the library's index, checked again in the background)
+  //==========================================================================
+
+  presetBox.setTextWhenNothingSelected("Preset: None");
+  presetBox.onChange = [this] {
+    const int position = presetBox.getSelectedId() - 1;
+
+    if (presetIndex != nullptr && juce::isPositiveAndBelow(position, presetIndex->size()))
+      processor.loadPreset(presetIndex->getPreset(position).getFile());
+  };
+  addAndMakeVisible(presetBox);
+
+  refreshPresetBox();
+  processor.getPresetLibrary().addChangeListener(this);
+  processor.getPresetLibrary().rescan();
+
   //==========================================================================
   // WINDOW SIZE
   //==========================================================================
 
-  setSize(700, 550);
+  setSize(700, 650);
 }
 
 NovaTuneAudioProcessorEditor::~NovaTuneAudioProcessorEditor() {
+  processor.getPresetLibrary().removeChangeListener(this);
   setLookAndFeel(nullptr);
 }
 
+void NovaTuneAudioProcessorEditor::refreshPresetBox() {
+  presetIndex = processor.getPresetLibrary().getIndex();
+  presetBox.clear(juce::dontSendNotification);
+
+  // Sorted by category: a heading where each one starts
+  const char *category = nullptr;
+
+  for (int i = 0; i < presetIndex->size(); ++i) {
+    const auto preset = presetIndex->getPreset(i);
+
+    if (category == nullptr || std::strcmp(category, preset.category) != 0) {
+      category = preset.category;
+      presetBox.addSectionHeading(preset.getCategory());
+    }
+
+    presetBox.addItem(preset.getName(), i + 1);
+  }
+
+  const int current = presetIndex->find(processor.getCurrentPreset());
+  presetBox.setSelectedId(current + 1, juce::dontSendNotification);
+}
+
+void NovaTuneAudioProcessorEditor::changeListenerCallback(juce::ChangeBroadcaster * /*source*/) {
+  refreshPresetBox();
+}
+
 void NovaTuneAudioProcessorEditor::paint(juce::Graphics &g) {
   g.fillAll(NovaTuneLookAndFeel::backgroundColour);
 
@@ -546,6 +1179,10 @@ void NovaTuneAudioProcessorEditor::paint(juce::Graphics &g) {
 
 void NovaTuneAudioProcessorEditor::resized() {
   auto bounds = getLocalBounds().reduced(10);
+
+  // Preset selector left of the title
+  presetBox.setBounds(bounds.getX(), bounds.getY() + 5, 170, 26);
+
   bounds.removeFromTop(50); // Space for title
 
   //==========================================================================
@@ -600,6 +1237,16 @@ void NovaTuneAudioProcessorEditor::resized() {
 
   bounds.removeFromTop(10);
 
+  //==========================================================================
+  // PITCH GRAPH
+  //==========================================================================
+
+  auto graphRow = bounds.removeFromTop(110);
+  levelMeters.setBounds(graphRow.removeFromRight(90).reduced(5, 0));
+  pitchGraph.setBounds(graphRow.reduced(5, 0));
+
+  bounds.removeFromTop(10);
+
   //==========================================================================
   // HARMONY SECTION
   //==========================================================================
@@ -610,6 +1257,8 @@ void NovaTuneAudioProcessorEditor::resized() {
   auto presetRow = harmonySection.removeFromTop(30);
   harmonyPresetLabel.setBounds(presetRow.removeFromLeft(100));
   harmonyPresetBox.setBounds(presetRow.removeFromLeft(150));
+  harmonyMorphLabel.setBounds(presetRow.removeFromLeft(60));
+  harmonyMorphSlider.setBounds(presetRow.removeFromLeft(200));
 
   harmonySection.removeFromTop(5);
 
@@ -627,4 +1276,16 @@ void NovaTuneAudioProcessorEditor::resized() {
 
   auto bottomRow = bounds.removeFromBottom(30);
   bypassButton.setBounds(bottomRow.removeFromRight(100).reduced(5));
+  cpuButton.setBounds(bottomRow.removeFromRight(80).reduced(5));
+  logButton.setBounds(bottomRow.removeFromRight(80).reduced(5));
+  deterministicButton.setBounds(bottomRow.removeFromRight(115).reduced(5));
+
+  cpuGuardLabel.setBounds(bottomRow.removeFromLeft(75));
+  cpuGuardBox.setBounds(bottomRow.removeFromLeft(95).reduced(2));
+  keyBusLabel.setBounds(bottomRow.removeFromLeft(60));
+  keyBusBox.setBounds(bottomRow.removeFromLeft(90).reduced(2));
+  cpuGuardIndicator.setBounds(bottomRow.reduced(8, 0));
+
+  // The overlay covers the harmony voices when shown
+  performanceOverlay.setBounds(voicePanelA->getBounds().getUnion(voicePanelC->getBounds()));
 }
@@ -37,6 +37,11 @@
  * │                   └──────────────────────────────────────────┘  │
  * │                                                                  │
  * │  ┌────────────────────────────────────────────────────────────┐ │
+ * │  │ C5 ─────────────────────────────── PITCH GRAPH ──────────── │ │
+ * │  │ C4 ──────────────────────────────────────────~~~───~~~~──── │ │
+ * │  └────────────────────────────────────────────────────────────┘ │
+ * │                                                                  │
+ * │  ┌────────────────────────────────────────────────────────────┐ │
  * │  │                    HARMONY VOICES                          │ │
  * │  │  ┌─────────────┐  ┌─────────────┐  ┌─────────────┐        │ │
  * │  │  │   VOICE A   │  │   VOICE B   │  │   VOICE C   │        │ │
@@ -99,6 +104,21 @@ public:
 
 /**
  * Displays the detected pitch and correction status.
+ *
+ * Fed by the engine's PitchHistory channel: each tick drains every hop
+ * since the last one and shows the newest. It never reads the DSP objects
+ * directly. As the channel's only reader, it passes each tick's frames on
+ * through onFramesDrained (the pitch graph listens there).
+ *
+ * IDLE THROTTLING:
+ * Dozens of open editors in a big session all tick on the message thread,
+ * so the timer runs only as fast as there is something to show:
+ * - 30 Hz while voiced frames arrive, 10 Hz while they are all unvoiced,
+ *   4 Hz while none arrive (transport stopped)
+ * - 2 Hz while the editor is hidden or minimised, discarding the queue
+ *   instead of drawing
+ * - repaint() only when the note names, cents or voicing differ from
+ *   what was last painted
  */
 class PitchDisplayComponent : public juce::Component,
                               public juce::Timer {
@@ -108,13 +128,196 @@ public:
   void paint(juce::Graphics &g) override;
   void timerCallback() override;
 
+  /** Called on the message thread with every batch of drained frames, oldest first */
+  std::function<void(const PitchFrame *frames, int numFrames)> onFramesDrained;
+
+  /** Timer rates for each activity level */
+  static constexpr int activeHz = 30;
+  static constexpr int unvoicedHz = 10;
+  static constexpr int idleHz = 4;
+  static constexpr int hiddenHz = 2;
+
 private:
-  NovaTuneAudioProcessor &processor;
+  /** What the text and the cents indicator show */
+  struct DisplayState {
+    bool voiced = false;
+    int pitchNote = 0;
+    int targetNote = 0;
+    int cents = 0;
+
+    bool operator==(const DisplayState &other) const noexcept {
+      return voiced == other.voiced && pitchNote == other.pitchNote && targetNote == other.targetNote &&
+             cents == other.cents;
+    }
+  };
+
+  DisplayState getDisplayState() const noexcept;
+
+  /** Restart the timer only when the rate actually changes */
+  void setRefreshRate(int hz);
+
+  PitchHistory &pitchHistory;
+  std::vector<PitchFrame> drainedFrames; // Reused every tick
 
   float displayedPitch = 0.0f;
   float displayedTarget = 0.0f;
   float displayedCents = 0.0f;
   bool isVoiced = false;
+
+  DisplayState paintedState; // As of the last paint()
+  int refreshHz = 0;
+};
+
+//==============================================================================
+// PITCH GRAPH
+//==============================================================================
+
+/**
+ * Auto-Tune style scrolling graph of detected pitch (white) against the
+ * scale target (accent), newest on the right.
+ *
+ * The plot is a cached software image, one column per 10ms of stream time.
+ * New frames scroll the image left in place and draw only the columns they
+ * add, then repaint just the plot area - so a tick costs the same however
+ * much history is on screen, and the full path is never re-stroked. The
+ * graph freezes while no audio is processed, and starts over when the
+ * engine's clock resets.
+ */
+class PitchGraphComponent : public juce::Component {
+public:
+  PitchGraphComponent();
+
+  /** Draw newly drained frames (oldest first) into the strip */
+  void addFrames(const PitchFrame *frames, int numFrames);
+
+  void paint(juce::Graphics &g) override;
+  void resized() override;
+
+  static constexpr double columnsPerSecond = 100.0;
+  static constexpr float lowestMidiNote = 36.0f;  // C2
+  static constexpr float highestMidiNote = 84.0f; // C6
+
+private:
+  /** Shift the strip left by numColumns and clear what scrolls in */
+  void scrollBy(int numColumns);
+
+  /** Fill a column range with the background and the note grid */
+  void clearColumns(juce::Graphics &g, int x, int width) const;
+
+  float noteToY(float midiNote) const;
+
+  juce::Rectangle<int> plotArea;
+  juce::Image strip; // Same size as plotArea
+
+  int64_t newestColumn = 0;   // Stream column at the strip's right edge
+  bool hasPrevious = false;   // Is there a voiced point to join the next one to?
+  int64_t previousColumn = 0;
+  float previousPitchY = 0.0f;
+  float previousTargetY = 0.0f;
+};
+
+//==============================================================================
+// LEVEL METERS
+//==============================================================================
+
+/**
+ * Input and output peak/RMS meters with peak hold and clip lights.
+ *
+ * The engine only publishes raw levels (see LevelMeter.h); ballistics -
+ * peak fall-off, the held peak line - are done here. A clip light latches
+ * when a channel reaches 0 dBFS and clears on click. Like the pitch
+ * display, it drops to a slow poll while the editor is hidden.
+ */
+class LevelMeterComponent : public juce::Component,
+                            public juce::Timer {
+public:
+  LevelMeterComponent(NovaTuneAudioProcessor &processor);
+
+  void paint(juce::Graphics &g) override;
+  void timerCallback() override;
+  void mouseDown(const juce::MouseEvent &event) override;
+
+  static constexpr float minDb = -60.0f;
+
+private:
+  struct Bar {
+    LevelMeter::Totals previousTotals;
+    float peakDb = minDb;
+    float rmsDb = minDb;
+    float holdDb = minDb;
+    int holdTicksLeft = 0;
+    bool clipped = false;
+  };
+
+  std::array<LevelMeter *, 2> meters; // Input, output
+  std::array<std::array<Bar, LevelMeter::maxChannels>, 2> bars;
+
+  /** Update one bar from its meter; true if it needs repainting */
+  bool updateBar(LevelMeter &meter, int channel, Bar &bar);
+};
+
+//==============================================================================
+// PERFORMANCE OVERLAY
+//==============================================================================
+
+/**
+ * Optional overlay showing each DSP stage's share of the block budget.
+ *
+ * The engine's StageProfiler is only enabled while this is visible, so the
+ * timers cost nothing the rest of the time. Values are averaged over the
+ * last refresh interval (10 Hz); "Peak" is the worst single block since
+ * the overlay was opened. Below that are the processBlock tail-latency
+ * histogram (p50/p99/p99.9/max of block time vs deadline) since playback
+ * was last prepared, and the CPU guard's policy and level.
+ */
+class PerformanceOverlay : public juce::Component,
+                           public juce::Timer {
+public:
+  PerformanceOverlay(NovaTuneAudioProcessor &processor);
+  ~PerformanceOverlay() override;
+
+  void paint(juce::Graphics &g) override;
+  void timerCallback() override;
+  void visibilityChanged() override;
+
+private:
+  StageProfiler &profiler;
+  StageProfiler::Totals previousTotals;
+  bool isProfiling = false;
+
+  BlockTimeHistogram &blockTimes;
+  BlockTimeHistogram::Snapshot blockTimeSnapshot;
+
+  const CpuGuard &cpuGuard;
+
+  std::array<float, StageProfiler::numStages> stagePercent{};
+  float totalPercent = 0.0f;
+  float peakPercent = 0.0f;
+};
+
+//==============================================================================
+// CPU GUARD INDICATOR
+//==============================================================================
+
+/**
+ * One-line status of the CPU guard: the level in effect and what it is
+ * shedding, plus the engine's smoothed load. Highlighted while degraded,
+ * so a performer can see why the harmonies went quiet.
+ */
+class CpuGuardIndicator : public juce::Component,
+                          public juce::Timer {
+public:
+  CpuGuardIndicator(NovaTuneAudioProcessor &processor);
+
+  void paint(juce::Graphics &g) override;
+  void timerCallback() override;
+
+private:
+  const CpuGuard &cpuGuard;
+
+  CpuGuard::Level displayedLevel = CpuGuard::full;
+  int displayedLoadPercent = 0;
+  bool isOff = false;
 };
 
 //==============================================================================
@@ -122,9 +325,11 @@ private:
 //==============================================================================
 
 /**
- * Panel for controlling a single harmony voice.
+ * Panel for controlling a single harmony voice. While the voice follows the
+ * Harmony Preset its controls keep showing its own settings, so the panel
+ * says so; editing one takes the voice back (see NovaTuneAudioProcessor).
  */
-class HarmonyVoicePanel : public juce::Component {
+class HarmonyVoicePanel : public juce::Component, private juce::Timer {
 public:
   HarmonyVoicePanel(NovaTuneAudioProcessor &processor, int voiceIndex);
   ~HarmonyVoicePanel() override;
@@ -133,6 +338,8 @@ public:
   void resized() override;
 
 private:
+  void timerCallback() override;
+
   using APVTS = juce::AudioProcessorValueTreeState;
   using ButtonAttachment = APVTS::ButtonAttachment;
   using ComboBoxAttachment = APVTS::ComboBoxAttachment;
@@ -157,6 +364,7 @@ private:
   juce::Label levelLabel;
   juce::Label panLabel;
   juce::Label formantLabel;
+  juce::Label followLabel; // Shown while the voice follows the Harmony Preset
 
   // Attachments
   std::unique_ptr<ButtonAttachment> enabledAttachment;
@@ -172,7 +380,7 @@ private:
 // MAIN EDITOR
 //==============================================================================
 
-class NovaTuneAudioProcessorEditor : public juce::AudioProcessorEditor {
+class NovaTuneAudioProcessorEditor : public juce::AudioProcessorEditor, private juce::ChangeListener {
 public:
   explicit NovaTuneAudioProcessorEditor(NovaTuneAudioProcessor &processor);
   ~NovaTuneAudioProcessorEditor() override;
@@ -219,6 +427,8 @@ private:
 
   juce::ComboBox harmonyPresetBox;
   juce::Label harmonyPresetLabel;
+  juce::Slider harmonyMorphSlider; // Harmony Morph Time
+  juce::Label harmonyMorphLabel;
 
   std::unique_ptr<HarmonyVoicePanel> voicePanelA;
   std::unique_ptr<HarmonyVoicePanel> voicePanelB;
@@ -229,12 +439,40 @@ private:
   //==========================================================================
 
   PitchDisplayComponent pitchDisplay;
+  PitchGraphComponent pitchGraph;
+  LevelMeterComponent levelMeters;
+  PerformanceOverlay performanceOverlay;
 
   //==========================================================================
   // GLOBAL CONTROLS
   //==========================================================================
 
   juce::ToggleButton bypassButton;
+  juce::ToggleButton cpuButton; // Shows/hides the performance overlay
+  juce::ToggleButton logButton; // Starts/stops telemetry recording
+  juce::ToggleButton deterministicButton;
+
+  juce::ComboBox cpuGuardBox;
+  juce::Label cpuGuardLabel;
+  CpuGuardIndicator cpuGuardIndicator;
+
+  juce::ComboBox keyBusBox; // Off / Publish / Follow (see KeyBus.h)
+  juce::Label keyBusLabel;
+
+  //==========================================================================
+  // PRESETS
+  //==========================================================================
+
+  /**
+   * Lists the library's index snapshot (see PresetLibrary.h): opening the
+   * editor reads no preset files. Refilled when a scan publishes a new
+   * snapshot.
+   */
+  juce::ComboBox presetBox;
+  std::shared_ptr<const PresetLibrary::Index> presetIndex; // What presetBox lists (item ID = position + 1)
+
+  void refreshPresetBox();
+  void changeListenerCallback(juce::ChangeBroadcaster *source) override;
 
   //==========================================================================
   // ATTACHMENTS (connect UI to parameters)
@@ -245,12 +483,16 @@ private:
   std::unique_ptr<ComboBoxAttachment> inputTypeAttachment;
   std::unique_ptr<ComboBoxAttachment> qualityModeAttachment;
   std::unique_ptr<ComboBoxAttachment> harmonyPresetAttachment;
+  std::unique_ptr<ComboBoxAttachment> cpuGuardAttachment;
+  std::unique_ptr<ComboBoxAttachment> keyBusAttachment;
 
   std::unique_ptr<SliderAttachment> retuneSpeedAttachment;
   std::unique_ptr<SliderAttachment> humanizeAttachment;
   std::unique_ptr<SliderAttachment> mixAttachment;
+  std::unique_ptr<SliderAttachment> harmonyMorphAttachment;
 
   std::unique_ptr<ButtonAttachment> bypassAttachment;
+  std::unique_ptr<ButtonAttachment> deterministicAttachment;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NovaTuneAudioProcessorEditor)
 };
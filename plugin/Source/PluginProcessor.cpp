@@ -2,6 +2,7 @@
 #include "PluginEditor.h"
 #include "ParameterIDs.h"
 #include "DSPConfig.h"
+#include "StateFormat.h"
 
 /**
  * PluginProcessor.cpp
@@ -9,6 +10,36 @@
  * Implementation of the main audio plugin processor.
  */
 
+namespace {
+
+  // State property (not a parameter) holding the Deterministic Render seed
+  constexpr const char *renderSeedProperty = "renderSeed";
+
+  // State property holding which harmony voices follow the Harmony Preset (bit v for voice v)
+  constexpr const char *harmonyFollowProperty = "harmonyFollow";
+
+  // harmonyPresetState: the preset above the voice bits
+  constexpr int harmonyPresetShift = 8;
+  constexpr uint32_t allHarmonyVoices = (1u << DSPConfig::maxHarmonyVoices) - 1;
+
+  uint32_t packHarmonyPresetState(int preset, uint32_t following) noexcept {
+    return (static_cast<uint32_t>(preset) << harmonyPresetShift) | (following & allHarmonyVoices);
+  }
+
+  int harmonyPresetOf(uint32_t state) noexcept {
+    return static_cast<int>(state >> harmonyPresetShift);
+  }
+
+  /** The voice settings a harmony preset sets */
+  template <typename Value>
+  std::array<Value, 7> getPresetSettings(const Value &enabled, const Value &mode, const Value &diatonic,
+                                         const Value &semitones, const Value &level, const Value &pan,
+                                         const Value &formant) {
+    return {enabled, mode, diatonic, semitones, level, pan, formant};
+  }
+
+} // namespace
+
 //==============================================================================
 // PARAMETER LAYOUT CREATION
 //==============================================================================
@@ -97,6 +128,28 @@ juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout() {
       0 // Default: Live
       ));
 
+  // CPU Guard
+  params.push_back(std::make_unique<juce::AudioParameterChoice>(
+      juce::ParameterID(cpuGuard, 1),
+      "CPU Guard",
+      getCpuGuardModeNames(),
+      1 // Default: Studio
+      ));
+
+  // Deterministic Render
+  params.push_back(std::make_unique<juce::AudioParameterBool>(
+      juce::ParameterID(deterministic, 1),
+      "Deterministic Render",
+      false));
+
+  // Key Bus
+  params.push_back(std::make_unique<juce::AudioParameterChoice>(
+      juce::ParameterID(keyBus, 1),
+      "Key Bus",
+      getKeyBusModeNames(),
+      0 // Default: Off
+      ));
+
   // Harmony Preset
   params.push_back(std::make_unique<juce::AudioParameterChoice>(
       juce::ParameterID(harmonyPreset, 1),
@@ -105,6 +158,14 @@ juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout() {
       0 // Default: None
       ));
 
+  // Harmony Morph Time
+  params.push_back(std::make_unique<juce::AudioParameterFloat>(
+      juce::ParameterID(harmonyMorphTime, 1),
+      "Harmony Morph Time",
+      juce::NormalisableRange<float>(DSPConfig::harmonyMorphMinMs, DSPConfig::harmonyMorphMaxMs, 1.0f),
+      250.0f // Default: 250 ms
+      ));
+
   //==========================================================================
   // HARMONY VOICE PARAMETERS
   //==========================================================================
@@ -221,10 +282,26 @@ NovaTuneAudioProcessor::NovaTuneAudioProcessor()
       apvts(*this, nullptr, "PARAMETERS", createParameterLayout()) {
   // Plugin is constructed but not yet ready for audio processing
   // Audio setup happens in prepareToPlay()
+  parameterValues = lookUpParameterValues<std::atomic<float> *>(
+      [this](const char *id) { return apvts.getRawParameterValue(id); });
+
+  // A new instance gets its own seed; a restored one keeps its session's
+  apvts.state.setProperty(renderSeedProperty, juce::Random::getSystemRandom().nextInt64(), nullptr);
+
+  // Edits to a voice that follows the Harmony Preset let it go
+  parameterIds = lookUpParameterValues<const char *>([](const char *id) { return id; });
+
+  for (const auto &ids : parameterIds.voices)
+    for (const char *id : getPresetSettings(ids.enabled, ids.mode, ids.diatonic, ids.semitones, ids.level, ids.pan,
+                                            ids.formant))
+      apvts.addParameterListener(id, this);
 }
 
 NovaTuneAudioProcessor::~NovaTuneAudioProcessor() {
-  // Destructor - clean up any resources
+  for (const auto &ids : parameterIds.voices)
+    for (const char *id : getPresetSettings(ids.enabled, ids.mode, ids.diatonic, ids.semitones, ids.level, ids.pan,
+                                            ids.formant))
+      apvts.removeParameterListener(id, this);
 }
 
 //==============================================================================
@@ -255,24 +332,35 @@ double NovaTuneAudioProcessor::getTailLengthSeconds() const {
 // PRESET / PROGRAM MANAGEMENT
 //==============================================================================
 
+// Programs are the preset library's presets, in browse order. Hosts that
+// list them see the index snapshot as it is when they ask.
+
 int NovaTuneAudioProcessor::getNumPrograms() {
-  return 1; // At least 1 program required by some hosts
+  return juce::jmax(1, presetLibrary->getIndex()->size()); // At least 1 program required by some hosts
 }
 
 int NovaTuneAudioProcessor::getCurrentProgram() {
-  return 0;
+  return juce::jmax(0, presetLibrary->getIndex()->find(currentPreset));
 }
 
-void NovaTuneAudioProcessor::setCurrentProgram(int /*index*/) {
-  // Not implemented - presets handled through state management
+void NovaTuneAudioProcessor::setCurrentProgram(int index) {
+  const auto presets = presetLibrary->getIndex();
+
+  if (juce::isPositiveAndBelow(index, presets->size()))
+    loadPreset(presets->getPreset(index).getFile());
 }
 
-const juce::String NovaTuneAudioProcessor::getProgramName(int /*index*/) {
-  return "Default";
+const juce::String NovaTuneAudioProcessor::getProgramName(int index) {
+  const auto presets = presetLibrary->getIndex();
+  return juce::isPositiveAndBelow(index, presets->size()) ? presets->getPreset(index).getName() : "Default";
 }
 
-void NovaTuneAudioProcessor::changeProgramName(int /*index*/, const juce::String & /*newName*/) {
-  // Not implemented
+void NovaTuneAudioProcessor::changeProgramName(int index, const juce::String &newName) {
+  const auto presets = presetLibrary->getIndex();
+
+  // Factory presets keep their names (PresetLibrary::rename refuses them)
+  if (juce::isPositiveAndBelow(index, presets->size()))
+    presetLibrary->rename(presets->getPreset(index).getFile(), newName);
 }
 
 //==============================================================================
@@ -300,27 +388,179 @@ bool NovaTuneAudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts)
 }
 
 void NovaTuneAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
-  // Prepare the DSP engine
+  currentSampleRate = sampleRate;
+
+  // Block times from a previous configuration aren't comparable
+  blockTimeHistogram.requestReset();
+
+  // The previous render, if there was one, is stored before this one starts
+  renderSession.reset();
+
+  const bool deterministic = apvts.getRawParameterValue(ParamIDs::deterministic)->load() > 0.5f;
+
+  if (deterministic)
+    tunerEngine.setRandomSeed(getRenderSeed());
+
+  // Prepare the DSP engine. Hosts flag an offline bounce before preparing
+  // for it, so the render-quality path follows isNonRealtime() here.
+  tunerEngine.setRenderQuality(isNonRealtime());
   tunerEngine.prepare(sampleRate, samplesPerBlock, getTotalNumInputChannels());
 
+  // A deterministic offline render is served from / stored in the render cache
+  if (deterministic && isNonRealtime()) {
+    RenderCache::Configuration configuration;
+    configuration.sampleRate = sampleRate;
+    configuration.numChannels = getTotalNumInputChannels();
+    configuration.maxBlockSize = samplesPerBlock;
+    configuration.seed = getRenderSeed();
+    configuration.timelineStart = tunerEngine.getTimelineStart();
+    configuration.renderQuality = tunerEngine.isRenderQuality();
+
+    tunerEngine.setNonRealtime(true);
+    renderSession = std::make_unique<RenderCache::Session>(renderCache, tunerEngine, configuration);
+  }
+
   // Report latency to the host
   setLatencySamples(tunerEngine.getLatencySamples());
 }
 
 void NovaTuneAudioProcessor::releaseResources() {
+  renderSession.reset();
+
   // Reset the DSP engine
   tunerEngine.reset();
 }
 
+juce::int64 NovaTuneAudioProcessor::getRenderSeed() const {
+  return static_cast<juce::int64>(apvts.state.getProperty(renderSeedProperty));
+}
+
 //==============================================================================
 // AUDIO PROCESSING
 //==============================================================================
 
+template <typename Value, typename Lookup>
+NovaTuneAudioProcessor::ParameterValues<Value> NovaTuneAudioProcessor::lookUpParameterValues(Lookup &&lookup) {
+  using namespace ParamIDs;
+
+  ParameterValues<Value> values;
+  values.key = lookup(key);
+  values.scale = lookup(scale);
+  values.inputType = lookup(inputType);
+  values.cpuGuard = lookup(cpuGuard);
+  values.retuneSpeed = lookup(retuneSpeed);
+  values.humanize = lookup(humanize);
+  values.vibratoAmount = lookup(vibratoAmount);
+  values.mix = lookup(mix);
+  values.harmonyPreset = lookup(harmonyPreset);
+  values.harmonyMorphTime = lookup(harmonyMorphTime);
+
+  values.voices = {{
+      {lookup(A_enabled), lookup(A_mode), lookup(A_intervalDiatonic), lookup(A_intervalSemi), lookup(A_level),
+       lookup(A_pan), lookup(A_formantShift), lookup(A_humTiming), lookup(A_humPitch)},
+      {lookup(B_enabled), lookup(B_mode), lookup(B_intervalDiatonic), lookup(B_intervalSemi), lookup(B_level),
+       lookup(B_pan), lookup(B_formantShift), lookup(B_humTiming), lookup(B_humPitch)},
+      {lookup(C_enabled), lookup(C_mode), lookup(C_intervalDiatonic), lookup(C_intervalSemi), lookup(C_level),
+       lookup(C_pan), lookup(C_formantShift), lookup(C_humTiming), lookup(C_humPitch)},
+  }};
+
+  return values;
+}
+
+template <typename Value, typename Load>
+EngineParameters NovaTuneAudioProcessor::toEngineParameters(const ParameterValues<Value> &values, Load &&load) noexcept {
+  auto index = [&load](const Value &value) { return static_cast<int>(load(value)); };
+
+  EngineParameters params;
+  params.key = static_cast<NovaTuneEnums::Key>(index(values.key));
+  params.scale = static_cast<NovaTuneEnums::Scale>(index(values.scale));
+  params.inputType = static_cast<NovaTuneEnums::InputType>(index(values.inputType));
+  params.cpuGuard = static_cast<NovaTuneEnums::CpuGuardMode>(index(values.cpuGuard));
+  params.retuneSpeed = load(values.retuneSpeed);
+  params.humanize = load(values.humanize);
+  params.vibratoAmount = load(values.vibratoAmount);
+  params.mixPercent = load(values.mix);
+  params.harmonyPreset = static_cast<NovaTuneEnums::HarmonyPreset>(index(values.harmonyPreset));
+  params.harmonyMorphMs = load(values.harmonyMorphTime);
+
+  for (size_t v = 0; v < params.voices.size(); ++v) {
+    const auto &voiceValues = values.voices[v];
+    auto &voice = params.voices[v];
+
+    voice.enabled = load(voiceValues.enabled) > 0.5f;
+    voice.mode = static_cast<NovaTuneEnums::HarmonyMode>(index(voiceValues.mode));
+    voice.diatonicIntervalIndex = index(voiceValues.diatonic);
+    voice.semitoneOffset = index(voiceValues.semitones);
+    voice.levelDb = load(voiceValues.level);
+    voice.pan = load(voiceValues.pan);
+    voice.formantShift = load(voiceValues.formant);
+    voice.humanizeTimingMs = load(voiceValues.humTiming);
+    voice.humanizePitchCents = load(voiceValues.humPitch);
+  }
+
+  return params;
+}
+
+EngineParameters NovaTuneAudioProcessor::getEngineParameters() const noexcept {
+  return toEngineParameters(parameterValues, [](const std::atomic<float> *value) { return value->load(); });
+}
+
+const EngineParameters &NovaTuneAudioProcessor::updateBlockParameters(int numSamples) noexcept {
+  const juce::SpinLock::ScopedTryLockType lock(stateLoadLock);
+
+  // A state load is copying its snapshot in: keep the last block's parameters
+  if (!lock.isLocked())
+    return blockParameters;
+
+  blockParameters = stateLoading.load(std::memory_order_acquire) ? stateLoadSnapshot : getEngineParameters();
+  updateHarmonyPreset(blockParameters);
+  updateKeyBus(blockParameters, numSamples);
+  return blockParameters;
+}
+
+void NovaTuneAudioProcessor::updateKeyBus(EngineParameters &params, int numSamples) noexcept {
+  const auto mode = static_cast<NovaTuneEnums::KeyBusMode>(
+      juce::roundToInt(apvts.getRawParameterValue(ParamIDs::keyBus)->load()));
+
+  if (mode == NovaTuneEnums::KeyBusMode::Off)
+    return;
+
+  // This block on the host's timeline, if it has one
+  juce::int64 blockStart = KeyBus::now;
+
+  if (auto *host = getPlayHead())
+    if (const auto position = host->getPosition())
+      if (const auto samples = position->getTimeInSamples())
+        blockStart = *samples;
+
+  // Block granularity (see KeyBus.h): a change due anywhere in this block
+  // applies to all of it
+  const juce::int64 blockEnd = blockStart == KeyBus::now ? KeyBus::now : blockStart + numSamples - 1;
+  KeyBus::Change change;
+  const bool published = keyBus->getChangeAt(blockEnd, change);
+
+  if (mode == NovaTuneEnums::KeyBusMode::Follow) {
+    if (published) {
+      params.key = change.key;
+      params.scale = change.scale;
+    }
+
+    return;
+  }
+
+  // Publishing: whenever the bus disagrees here - a key change, or a loop
+  // back to before one - so followers always hear this instance's key
+  if (!published || change.key != params.key || change.scale != params.scale)
+    keyBus->publish(params.key, params.scale, blockStart);
+}
+
 void NovaTuneAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                           juce::MidiBuffer &midiMessages) {
   // Prevent denormals (very small floating point numbers that slow down CPU)
   juce::ScopedNoDenormals noDenormals;
 
+  const auto blockStart = BlockTimeHistogram::Clock::now();
+
   // Get channel counts
   auto totalNumInputChannels = getTotalNumInputChannels();
   auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -333,13 +573,110 @@ void NovaTuneAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
   // Check bypass
   bool isBypassed = apvts.getRawParameterValue(ParamIDs::bypass)->load() > 0.5f;
 
+  // Deterministic offline render: the session serves the block from the
+  // cache or processes it (a host back in real time without re-preparing
+  // falls through to the engine)
+  const auto &params = updateBlockParameters(buffer.getNumSamples());
+
+  if (renderSession != nullptr && isNonRealtime()) {
+    renderSession->process(buffer, midiMessages, params, isBypassed);
+    return;
+  }
+
   if (isBypassed) {
     // Bypass: pass audio through unchanged
     return;
   }
 
   // Process through the tuner engine
-  tunerEngine.process(buffer, midiMessages, apvts);
+  tunerEngine.setNonRealtime(isNonRealtime());
+  tunerEngine.process(buffer, midiMessages, params);
+
+  // Bypassed blocks return above, so only processed blocks are counted
+  blockTimeHistogram.recordBlock(blockStart, buffer.getNumSamples(), currentSampleRate);
+
+  if (telemetry.isRecording()) {
+    recordTelemetry(buffer.getNumSamples(), blockStart);
+  }
+}
+
+//==============================================================================
+// TELEMETRY
+//==============================================================================
+
+bool NovaTuneAudioProcessor::startTelemetry(const juce::File &file) {
+  stopTelemetry();
+
+  // Stage timings come from the profiler, so keep it running while recording
+  tunerEngine.getStageProfiler().addClient();
+  telemetryRestart.store(true, std::memory_order_release);
+
+  if (!telemetry.start(file)) {
+    tunerEngine.getStageProfiler().removeClient();
+    return false;
+  }
+
+  return true;
+}
+
+void NovaTuneAudioProcessor::stopTelemetry() {
+  if (!telemetry.isRecording())
+    return;
+
+  telemetry.stop();
+  tunerEngine.getStageProfiler().removeClient();
+}
+
+void NovaTuneAudioProcessor::recordTelemetry(int numSamples, BlockTimeHistogram::Clock::time_point blockStart) noexcept {
+  const auto &profiler = tunerEngine.getStageProfiler();
+  const auto totals = profiler.getTotals();
+
+  if (telemetryRestart.exchange(false, std::memory_order_acquire)) {
+    telemetrySamplePosition = 0;
+    telemetryLastBlockSize = numSamples;
+    telemetryTotals = totals; // This block's stage times are dropped - it started before the flag
+  }
+
+  const auto &detector = tunerEngine.getPitchDetector();
+
+  TelemetryFrame frame;
+  frame.samplePosition = telemetrySamplePosition;
+  frame.sampleRate = static_cast<float>(currentSampleRate);
+  frame.blockSize = static_cast<uint32_t>(numSamples);
+
+  if (detector.isVoiced())
+    frame.flags |= TelemetryFrame::voiced;
+
+  if (numSamples != telemetryLastBlockSize)
+    frame.flags |= TelemetryFrame::blockSizeChanged;
+
+  // The level for the next block was already chosen, so report the one this
+  // block ran at
+  frame.flags |= (static_cast<uint32_t>(telemetryGuardLevel) << TelemetryFrame::guardLevelShift) & TelemetryFrame::guardLevelMask;
+  telemetryGuardLevel = tunerEngine.getCpuGuard().getCurrentLevel();
+
+  frame.detectedHz = detector.isVoiced() ? detector.getFrequencyHz() : 0.0f;
+  frame.confidence = detector.getConfidence();
+  frame.targetMidiNote = tunerEngine.getPitchMapper().getLastResult().leadTargetMidiNote;
+  frame.leadRatio = NovaTuneUtils::semitonesToRatio(tunerEngine.getLeadCorrection().getCurrentCorrectionSemitones());
+
+  for (int v = 0; v < DSPConfig::maxHarmonyVoices; ++v) {
+    const auto &voice = tunerEngine.getHarmonyVoice(v);
+    frame.voiceRatios[v] = voice.isEnabled() ? voice.getCurrentPitchRatio() : 0.0f;
+  }
+
+  for (size_t i = 0; i < totals.stageNanos.size(); ++i) {
+    frame.stageMicros[i] = static_cast<float>(totals.stageNanos[i] - telemetryTotals.stageNanos[i]) * 1.0e-3f;
+  }
+
+  frame.blockMicros = static_cast<float>(
+      std::chrono::duration<double, std::micro>(BlockTimeHistogram::Clock::now() - blockStart).count());
+
+  telemetry.push(frame);
+
+  telemetryTotals = totals;
+  telemetrySamplePosition += static_cast<uint64_t>(numSamples);
+  telemetryLastBlockSize = numSamples;
 }
 
 //==============================================================================
@@ -359,19 +696,187 @@ juce::AudioProcessorEditor *NovaTuneAudioProcessor::createEditor() {
 //==============================================================================
 
 void NovaTuneAudioProcessor::getStateInformation(juce::MemoryBlock &destData) {
-  // Serialize the parameter state to XML, then to binary
-  if (auto xml = apvts.copyState().createXml()) {
-    copyXmlToBinary(*xml, destData);
-  }
+  // Compact binary (see StateFormat.h)
+  StateFormat::write(captureState(), destData);
 }
 
 void NovaTuneAudioProcessor::setStateInformation(const void *data, int sizeInBytes) {
-  // Deserialize from binary to XML, then to parameter state
-  if (auto xmlState = getXmlFromBinary(data, sizeInBytes)) {
-    if (xmlState->hasTagName(apvts.state.getType())) {
-      apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
-    }
+  // Binary, or the XML of sessions saved before it
+  auto state = StateFormat::read(data, sizeInBytes);
+
+  if (!state.hasType(apvts.state.getType()))
+    return;
+
+  // Sessions saved before Deterministic Render existed have no seed
+  if (!state.hasProperty(renderSeedProperty))
+    state.setProperty(renderSeedProperty, juce::Random::getSystemRandom().nextInt64(), nullptr);
+
+  loadState(state);
+}
+
+void NovaTuneAudioProcessor::loadState(const juce::ValueTree &state) {
+  // The engine takes the whole new state in one block (see stateLoadSnapshot)
+  const auto values = lookUpParameterValues<float>([this, &state](const char *id) {
+    const auto child = state.getChildWithProperty("id", juce::String(id));
+
+    // A parameter the state doesn't mention keeps its value, as in replaceState()
+    return child.isValid() ? static_cast<float>(child.getProperty("value")) : apvts.getRawParameterValue(id)->load();
+  });
+
+  // Voices follow the loaded Harmony Preset only where the state says so:
+  // one saved before they could keeps its own voice settings
+  const auto following = static_cast<uint32_t>(static_cast<int>(state.getProperty(harmonyFollowProperty, 0)));
+
+  {
+    const juce::SpinLock::ScopedLockType lock(stateLoadLock);
+    stateLoadSnapshot = toEngineParameters(values, [](float value) { return value; });
+    harmonyPresetState.store(packHarmonyPresetState(static_cast<int>(stateLoadSnapshot.harmonyPreset), following),
+                             std::memory_order_release);
+    stateLoading.store(true, std::memory_order_release);
   }
+
+  // The follow bits live in harmonyPresetState from here, not in the tree
+  auto parameters = state.createCopy();
+  parameters.removeProperty(harmonyFollowProperty, nullptr);
+
+  apvts.replaceState(parameters);
+  stateLoading.store(false, std::memory_order_release);
+}
+
+juce::ValueTree NovaTuneAudioProcessor::captureState() {
+  auto state = apvts.copyState();
+  const int preset = juce::roundToInt(parameterValues.harmonyPreset->load());
+
+  // A preset chosen since the last block is taken up here too
+  state.setProperty(harmonyFollowProperty, static_cast<int>(followHarmonyPreset(preset) & allHarmonyVoices), nullptr);
+  return state;
+}
+
+//==============================================================================
+// HARMONY PRESETS
+//==============================================================================
+
+uint32_t NovaTuneAudioProcessor::followHarmonyPreset(int preset) noexcept {
+  auto state = harmonyPresetState.load(std::memory_order_acquire);
+  const auto chosen = packHarmonyPresetState(preset, allHarmonyVoices);
+
+  // An edit clearing a voice's bit meanwhile fails the exchange: look again
+  while (harmonyPresetOf(state) != preset)
+    if (harmonyPresetState.compare_exchange_weak(state, chosen, std::memory_order_acq_rel))
+      return chosen;
+
+  return state;
+}
+
+void NovaTuneAudioProcessor::updateHarmonyPreset(EngineParameters &params) noexcept {
+  const auto state = followHarmonyPreset(static_cast<int>(params.harmonyPreset));
+
+  for (size_t v = 0; v < params.voices.size(); ++v)
+    params.voices[v].followPreset = ((state >> v) & 1u) != 0;
+}
+
+bool NovaTuneAudioProcessor::isVoiceFollowingHarmonyPreset(int voice) const noexcept {
+  const auto state = harmonyPresetState.load(std::memory_order_acquire);
+
+  // A preset the audio thread hasn't taken up yet has every voice
+  if (harmonyPresetOf(state) != juce::roundToInt(parameterValues.harmonyPreset->load()))
+    return true;
+
+  return ((state >> voice) & 1u) != 0;
+}
+
+void NovaTuneAudioProcessor::parameterChanged(const juce::String &parameterID, float) {
+  const bool onMessageThread = juce::MessageManager::existsAndIsCurrentThread();
+
+  // A loaded state brings its own voices, and which of them follow
+  if (stateLoading.load(std::memory_order_acquire) || (onMessageThread && adoptingHarmonyPreset))
+    return;
+
+  for (size_t v = 0; v < parameterIds.voices.size(); ++v) {
+    const auto &ids = parameterIds.voices[v];
+    const auto settings =
+        getPresetSettings(ids.enabled, ids.mode, ids.diatonic, ids.semitones, ids.level, ids.pan, ids.formant);
+
+    if (std::none_of(settings.begin(), settings.end(), [&](const char *id) { return parameterID == id; }))
+      continue;
+
+    const uint32_t bit = 1u << v;
+    const int preset = juce::roundToInt(parameterValues.harmonyPreset->load());
+
+    if ((followHarmonyPreset(preset) & bit) == 0)
+      return;
+
+    // The voice keeps the preset but for the edit. Host automation arrives
+    // on the audio thread, which sets no parameters: there the voice goes
+    // back to its own settings.
+    if (onMessageThread)
+      adoptHarmonyPreset(v, preset, parameterID);
+
+    harmonyPresetState.fetch_and(~bit, std::memory_order_acq_rel);
+    return;
+  }
+}
+
+void NovaTuneAudioProcessor::adoptHarmonyPreset(size_t voice, int preset, const juce::String &editedId) {
+  const auto settings = HarmonyMorph::getPresetVoices(static_cast<NovaTuneEnums::HarmonyPreset>(preset))[voice];
+  const auto &ids = parameterIds.voices[voice];
+  const juce::ScopedValueSetter<bool> adopting(adoptingHarmonyPreset, true);
+
+  // The voice sings the preset until its bit clears, so these aren't heard.
+  // Each is a change the user made, so the host records it with the edit.
+  auto set = [this, &editedId](const char *id, float value) {
+    auto *parameter = apvts.getParameter(id);
+    const float normalised = parameter->convertTo0to1(value);
+
+    if (editedId == id || juce::approximatelyEqual(parameter->getValue(), normalised))
+      return;
+
+    parameter->beginChangeGesture();
+    parameter->setValueNotifyingHost(normalised);
+    parameter->endChangeGesture();
+  };
+
+  set(ids.enabled, settings.enabled ? 1.0f : 0.0f);
+  set(ids.mode, static_cast<float>(settings.mode));
+  set(ids.diatonic, static_cast<float>(settings.diatonicIntervalIndex));
+  set(ids.semitones, static_cast<float>(settings.semitoneOffset));
+  set(ids.level, settings.levelDb);
+  set(ids.pan, settings.pan);
+  set(ids.formant, settings.formantShift);
+}
+
+//==============================================================================
+// PRESET LIBRARY
+//==============================================================================
+
+bool NovaTuneAudioProcessor::loadPreset(const juce::File &file) {
+  auto state = PresetLibrary::load(file);
+
+  if (!state.hasType(apvts.state.getType()))
+    return false;
+
+  // A preset sets the sound, not the session: the render seed stays
+  state.removeProperty(PresetLibrary::categoryProperty, nullptr);
+  state.removeProperty(PresetLibrary::tagsProperty, nullptr);
+  state.setProperty(renderSeedProperty, apvts.state.getProperty(renderSeedProperty), nullptr);
+
+  loadState(state);
+  currentPreset = file;
+  updateHostDisplay(ChangeDetails().withProgramChanged(true));
+  return true;
+}
+
+juce::File NovaTuneAudioProcessor::savePreset(const juce::String &name, const juce::String &category,
+                                              const juce::String &tags) {
+  auto state = captureState();
+  state.removeProperty(renderSeedProperty, nullptr);
+
+  const auto file = presetLibrary->save(name, category, tags, state);
+
+  if (file != juce::File())
+    currentPreset = file;
+
+  return file;
 }
 
 //==============================================================================
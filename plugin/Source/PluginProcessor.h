@@ -3,6 +3,11 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include "ParameterIDs.h"
 #include "dsp/TunerEngine.h"
+#include "dsp/BlockTimeHistogram.h"
+#include "TelemetryRecorder.h"
+#include "RenderCache.h"
+#include "PresetLibrary.h"
+#include "KeyBus.h"
 
 /**
  * PluginProcessor.h
@@ -32,7 +37,8 @@
 // Forward declaration to avoid circular includes
 class NovaTuneAudioProcessorEditor;
 
-class NovaTuneAudioProcessor : public juce::AudioProcessor {
+class NovaTuneAudioProcessor : public juce::AudioProcessor,
+                               private juce::AudioProcessorValueTreeState::Listener {
 public:
   //==========================================================================
   // TYPE ALIASES
@@ -110,7 +116,7 @@ public:
   double getTailLengthSeconds() const override;
 
   //==========================================================================
-  // PRESET / PROGRAM MANAGEMENT
+  // PRESET / PROGRAM MANAGEMENT (the preset library's presets)
   //==========================================================================
 
   /** How many presets does this plugin have? */
@@ -144,6 +150,24 @@ public:
    */
   void setStateInformation(const void *data, int sizeInBytes) override;
 
+  //==========================================================================
+  // PRESET LIBRARY (shared by every instance - see PresetLibrary.h)
+  //==========================================================================
+
+  PresetLibrary &getPresetLibrary() { return *presetLibrary; }
+
+  /**
+   * Load a preset file. The session's render seed is kept. Reads the
+   * file, so call from the message thread.
+   */
+  bool loadPreset(const juce::File &file);
+
+  /** Save the current parameters as a user preset. Returns the file, or File() on failure. */
+  juce::File savePreset(const juce::String &name, const juce::String &category, const juce::String &tags);
+
+  /** The preset last loaded or saved (File() if none) */
+  const juce::File &getCurrentPreset() const noexcept { return currentPreset; }
+
   //==========================================================================
   // PARAMETER ACCESS
   //==========================================================================
@@ -155,16 +179,93 @@ public:
   APVTS &getValueTreeState() { return apvts; }
   const APVTS &getValueTreeState() const { return apvts; }
 
+  /**
+   * Snapshot the current parameter values for the engine. Lock-free (one
+   * atomic load per parameter), so it is safe on the audio thread.
+   */
+  EngineParameters getEngineParameters() const noexcept;
+
+  /** True if harmony voice `voice` sings the Harmony Preset rather than its own settings */
+  bool isVoiceFollowingHarmonyPreset(int voice) const noexcept;
+
   //==========================================================================
   // DSP ENGINE ACCESS (for UI visualization)
   //==========================================================================
 
   /**
-   * Get the tuner engine for reading pitch detection results.
-   * Used by the Editor for pitch visualization.
+   * Get the tuner engine (read-only; the audio thread owns its state, so
+   * values read from it can be mid-update).
    */
   const TunerEngine &getTunerEngine() const { return tunerEngine; }
 
+  /**
+   * Get the per-hop pitch frame channel.
+   * Used by the Editor's pitch display - its single reader.
+   */
+  PitchHistory &getPitchHistory() { return tunerEngine.getPitchHistory(); }
+
+  /**
+   * Get the input / output level meters.
+   * Used by the Editor's meters - the single peak reader of each.
+   */
+  LevelMeter &getInputMeter() { return tunerEngine.getInputMeter(); }
+  LevelMeter &getOutputMeter() { return tunerEngine.getOutputMeter(); }
+
+  /**
+   * Get the engine's per-stage CPU profiler.
+   * Used by the Editor's CPU overlay, which switches it on while shown.
+   */
+  StageProfiler &getStageProfiler() { return tunerEngine.getStageProfiler(); }
+
+  /**
+   * Get the CPU guard (degradation policy and current level).
+   * Used by the Editor's guard indicator and CPU overlay.
+   */
+  const CpuGuard &getCpuGuard() const { return tunerEngine.getCpuGuard(); }
+
+  /**
+   * Get the processBlock wall-time histogram (always recording, cleared
+   * in prepareToPlay). Used by the Editor to show tail latency.
+   */
+  BlockTimeHistogram &getBlockTimeHistogram() { return blockTimeHistogram; }
+
+  //==========================================================================
+  // OFFLINE RENDERING
+  //==========================================================================
+
+  /**
+   * Repeatable humanization and a timeline origin for offline renders (see
+   * TunerEngine::setRandomSeed / setTimelineStart). Call before
+   * prepareToPlay(), which applies them.
+   */
+  void setRandomSeed(juce::int64 seed) noexcept { tunerEngine.setRandomSeed(seed); }
+  void setTimelineStart(juce::int64 position) noexcept { tunerEngine.setTimelineStart(position); }
+
+  /**
+   * Replay a cached pitch track instead of detecting, or record one (see
+   * TunerEngine::setPitchTrack / setPitchTrackRecorder, PitchAnalysisCache).
+   * Call before prepareToPlay(); pass nullptr to go back to detecting.
+   */
+  void setPitchTrack(const MappedPitchTrack *track) { tunerEngine.setPitchTrack(track); }
+  void setPitchTrackRecorder(PitchTrack *track) noexcept { tunerEngine.setPitchTrackRecorder(track); }
+
+  //==========================================================================
+  // TELEMETRY (opt-in per-block recording, see TelemetryRecorder.h)
+  //==========================================================================
+
+  /**
+   * Start recording per-block telemetry to a .nttl file.
+   * Also switches the stage timers on for the duration.
+   * Call from the message thread.
+   */
+  bool startTelemetry(const juce::File &file);
+
+  /** Stop recording and close the file */
+  void stopTelemetry();
+
+  bool isRecordingTelemetry() const noexcept { return telemetry.isRecording(); }
+  const TelemetryRecorder &getTelemetryRecorder() const { return telemetry; }
+
 private:
   //==========================================================================
   // PARAMETER STATE
@@ -180,6 +281,111 @@ private:
    */
   APVTS apvts;
 
+  /**
+   * One value per engine parameter: the raw parameter atomics the engine
+   * reads (looked up once), or the plain values of a state being loaded
+   */
+  template <typename Value>
+  struct VoiceParameterValues {
+    Value enabled, mode, diatonic, semitones, level, pan, formant, humTiming, humPitch;
+  };
+
+  template <typename Value>
+  struct ParameterValues {
+    Value key, scale, inputType, cpuGuard;
+    Value retuneSpeed, humanize, vibratoAmount, mix;
+    Value harmonyPreset, harmonyMorphTime;
+    std::array<VoiceParameterValues<Value>, DSPConfig::maxHarmonyVoices> voices;
+  };
+
+  ParameterValues<std::atomic<float> *> parameterValues;
+  ParameterValues<const char *> parameterIds;
+
+  /** Fill in every engine parameter with lookup(parameter ID) */
+  template <typename Value, typename Lookup>
+  static ParameterValues<Value> lookUpParameterValues(Lookup &&lookup);
+
+  /** The engine's view of a set of values, read with load(value) */
+  template <typename Value, typename Load>
+  static EngineParameters toEngineParameters(const ParameterValues<Value> &values, Load &&load) noexcept;
+
+  //==========================================================================
+  // STATE LOADING
+  //==========================================================================
+
+  /**
+   * replaceState() changes the parameters one at a time. While it runs, the
+   * audio thread uses a snapshot of the loaded state built beforehand, so
+   * no block runs on half the old state and half the new. The lock only
+   * guards the snapshot's copy: the audio thread never waits for it, and
+   * repeats its previous block's parameters when it is taken.
+   *
+   * stateLoading is set from the snapshot's copy until replaceState()
+   * returns. It also keeps the voice changes replaceState() makes from
+   * counting as edits (see parameterChanged).
+   */
+  juce::SpinLock stateLoadLock;
+  EngineParameters stateLoadSnapshot;
+  std::atomic<bool> stateLoading{false};
+
+  /** The parameters the last block ran with (audio thread) */
+  EngineParameters blockParameters;
+
+  /** The parameters for this block (audio thread) */
+  const EngineParameters &updateBlockParameters(int numSamples) noexcept;
+
+  //==========================================================================
+  // KEY BUS
+  //==========================================================================
+
+  /** Shared with every instance on the machine (see KeyBus.h) */
+  juce::SharedResourcePointer<KeyBus> keyBus;
+
+  /** Publish this block's key and scale, or replace them with the bus's (audio thread) */
+  void updateKeyBus(EngineParameters &params, int numSamples) noexcept;
+
+  /** Replace the parameters and state properties with `state` */
+  void loadState(const juce::ValueTree &state);
+
+  //==========================================================================
+  // PRESETS
+  //==========================================================================
+
+  juce::SharedResourcePointer<PresetLibrary> presetLibrary;
+  juce::File currentPreset;
+
+  //==========================================================================
+  // HARMONY PRESETS
+  //==========================================================================
+
+  /**
+   * The preset the voices last took up, and which of them still follow it
+   * (bit v for voice v), in one word so a new preset and an edit never
+   * half-update it. The engine reads the preset from the block's
+   * parameters and sings it in place of each following voice's settings
+   * (see HarmonyMorph.h); the voice parameters are left alone. Editing a
+   * following voice first writes the preset's settings into its other
+   * parameters, then lets it go, so it keeps everything but the edit.
+   * Saved with the state as a property.
+   */
+  std::atomic<uint32_t> harmonyPresetState{0};
+  bool adoptingHarmonyPreset = false; // Message thread
+
+  /** Take up `preset` if it is new: every voice follows it. Lock-free; returns the state. */
+  uint32_t followHarmonyPreset(int preset) noexcept;
+
+  /** Mark the voices that follow the block's Harmony Preset (audio thread) */
+  void updateHarmonyPreset(EngineParameters &params) noexcept;
+
+  /** A voice setting changed, on whichever thread set it: was a following voice edited? */
+  void parameterChanged(const juce::String &parameterID, float newValue) override;
+
+  /** Write `preset`'s settings for `voice` into its parameters, except `editedId` (message thread) */
+  void adoptHarmonyPreset(size_t voice, int preset, const juce::String &editedId);
+
+  /** The parameters and state properties, with which voices follow the Harmony Preset */
+  juce::ValueTree captureState();
+
   //==========================================================================
   // DSP ENGINE
   //==========================================================================
@@ -187,6 +393,45 @@ private:
   /** The main DSP processing engine */
   TunerEngine tunerEngine;
 
+  /** Per-block wall time vs deadline, for tail-latency (dropout) tracking */
+  BlockTimeHistogram blockTimeHistogram;
+
+  /** Sample rate from prepareToPlay(), for the block deadline */
+  double currentSampleRate = 44100.0;
+
+  //==========================================================================
+  // RENDER CACHE (Deterministic Render, offline only - see RenderCache.h)
+  //==========================================================================
+
+  RenderCache renderCache;
+
+  /**
+   * The offline render in progress. Started in prepareToPlay(); stored when
+   * the next one starts or resources are released.
+   */
+  std::unique_ptr<RenderCache::Session> renderSession;
+
+  /** Humanization seed saved with the state, so a session renders the same every time */
+  juce::int64 getRenderSeed() const;
+
+  //==========================================================================
+  // TELEMETRY
+  //==========================================================================
+
+  TelemetryRecorder telemetry;
+
+  /** Set by startTelemetry(); the audio thread restarts its counters */
+  std::atomic<bool> telemetryRestart{false};
+
+  // Audio thread state for building frames
+  StageProfiler::Totals telemetryTotals;
+  uint64_t telemetrySamplePosition = 0;
+  int telemetryLastBlockSize = 0;
+  int telemetryGuardLevel = 0; // CpuGuard level the current block ran at
+
+  /** Build and queue this block's telemetry frame (audio thread) */
+  void recordTelemetry(int numSamples, BlockTimeHistogram::Clock::time_point blockStart) noexcept;
+
   //==========================================================================
   // PREVENT COPYING
   //==========================================================================
@@ -0,0 +1,509 @@
+#include "PresetLibrary.h"
+#include "ParameterIDs.h"
+#include "StateFormat.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <unordered_map>
+
+/**
+ * PresetLibrary.cpp
+ *
+ * The index file, the scanner and preset file management.
+ */
+
+namespace {
+
+  char toLowerAscii(char c) noexcept { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+
+  std::string lowerAscii(const juce::String &text) {
+    std::string result(text.toRawUTF8());
+    std::transform(result.begin(), result.end(), result.begin(), toLowerAscii);
+    return result;
+  }
+
+  /** Builds the string pool: NUL-terminated UTF-8, addressed by byte offset */
+  class StringPool {
+  public:
+    uint32_t add(const std::string &text) {
+      const auto offset = static_cast<uint32_t>(bytes.size());
+      bytes.insert(bytes.end(), text.begin(), text.end());
+      bytes.push_back(0);
+      return offset;
+    }
+
+    uint32_t add(const juce::String &text) { return add(std::string(text.toRawUTF8())); }
+
+    const std::vector<char> &getBytes() const noexcept { return bytes; }
+
+  private:
+    std::vector<char> bytes;
+  };
+
+} // namespace
+
+const juce::Identifier PresetLibrary::categoryProperty("presetCategory");
+const juce::Identifier PresetLibrary::tagsProperty("presetTags");
+
+/** One preset while a scan builds the index */
+struct PresetLibrary::Record {
+  IndexEntry entry;
+  juce::String path, name, category, tags;
+};
+
+//==============================================================================
+// SCAN THREAD
+//==============================================================================
+
+class PresetLibrary::ScanThread : public juce::Thread {
+public:
+  explicit ScanThread(PresetLibrary &ownerToUse)
+      : juce::Thread("NovaTune Presets"),
+        owner(ownerToUse) {}
+
+  void run() override {
+    while (!threadShouldExit()) {
+      owner.scan();
+
+      // Until rescan() or shutdown: notify() isn't lost if it came during the scan
+      wait(-1);
+    }
+  }
+
+private:
+  PresetLibrary &owner;
+};
+
+//==============================================================================
+// INDEX
+//==============================================================================
+
+std::shared_ptr<const PresetLibrary::Index> PresetLibrary::Index::open(const juce::File &file) {
+  if (!file.existsAsFile())
+    return nullptr;
+
+  auto result = std::make_shared<Index>();
+  result->mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+
+  if (!result->attach(result->mapping->getData(), result->mapping->getSize()))
+    return nullptr;
+
+  return result;
+}
+
+std::shared_ptr<const PresetLibrary::Index> PresetLibrary::Index::fromMemory(juce::MemoryBlock &&data) {
+  auto result = std::make_shared<Index>();
+  result->memory = std::move(data);
+
+  if (!result->attach(result->memory.getData(), result->memory.getSize()))
+    return nullptr;
+
+  return result;
+}
+
+bool PresetLibrary::Index::attach(const void *data, size_t size) {
+  if (data == nullptr || size < sizeof(IndexHeader))
+    return false;
+
+  IndexHeader header;
+  std::memcpy(&header, data, sizeof(header));
+
+  const IndexHeader expected;
+  const size_t entryBytes = static_cast<size_t>(header.numEntries) * sizeof(IndexEntry);
+
+  if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version ||
+      header.numEntries > static_cast<uint32_t>(INT32_MAX) || header.stringBytes == 0 ||
+      size != sizeof(header) + entryBytes + header.stringBytes)
+    return false;
+
+  // Mapped memory is page-aligned and the header a multiple of 8 bytes, so the entries are aligned
+  const auto *bytes = static_cast<const char *>(data);
+  entries = reinterpret_cast<const IndexEntry *>(bytes + sizeof(header));
+  strings = bytes + sizeof(header) + entryBytes;
+  numEntries = static_cast<int>(header.numEntries);
+
+  // Every string has to end inside the pool
+  if (strings[header.stringBytes - 1] != 0)
+    return false;
+
+  for (int i = 0; i < numEntries; ++i) {
+    const auto &entry = entries[i];
+
+    for (auto offset : {entry.path, entry.name, entry.category, entry.tags, entry.searchText})
+      if (offset >= header.stringBytes)
+        return false;
+  }
+
+  return true;
+}
+
+PresetLibrary::Preset PresetLibrary::Index::getPreset(int index) const noexcept {
+  const auto &entry = entries[index];
+
+  Preset preset;
+  preset.path = getString(entry.path);
+  preset.name = getString(entry.name);
+  preset.category = getString(entry.category);
+  preset.tags = getString(entry.tags);
+  preset.key = entry.key;
+  preset.scale = entry.scale;
+  preset.voices = entry.voices;
+  preset.factory = (entry.flags & factoryPreset) != 0;
+  return preset;
+}
+
+int PresetLibrary::Index::find(const juce::File &file) const {
+  const auto path = file.getFullPathName();
+  const char *target = path.toRawUTF8();
+
+  for (int i = 0; i < numEntries; ++i)
+    if (std::strcmp(getString(entries[i].path), target) == 0)
+      return i;
+
+  return -1;
+}
+
+std::vector<int> PresetLibrary::Index::search(const juce::String &query, const juce::String &category) const {
+  std::vector<std::string> words;
+
+  for (const auto &word : juce::StringArray::fromTokens(query, true))
+    if (word.isNotEmpty())
+      words.push_back(lowerAscii(word));
+
+  const char *categoryText = category.toRawUTF8();
+  std::vector<int> matches;
+
+  for (int i = 0; i < numEntries; ++i) {
+    const auto &entry = entries[i];
+
+    if (category.isNotEmpty() && std::strcmp(getString(entry.category), categoryText) != 0)
+      continue;
+
+    const char *text = getString(entry.searchText);
+
+    if (std::all_of(words.begin(), words.end(),
+                    [text](const std::string &word) { return std::strstr(text, word.c_str()) != nullptr; }))
+      matches.push_back(i);
+  }
+
+  return matches;
+}
+
+juce::StringArray PresetLibrary::Index::getCategories() const {
+  juce::StringArray categories;
+
+  // Sorted by category, so each one starts a run
+  for (int i = 0; i < numEntries; ++i)
+    if (i == 0 || std::strcmp(getString(entries[i].category), getString(entries[i - 1].category)) != 0)
+      categories.add(juce::String::fromUTF8(getString(entries[i].category)));
+
+  return categories;
+}
+
+//==============================================================================
+// LIBRARY
+//==============================================================================
+
+juce::File PresetLibrary::getDefaultFactoryDirectory() {
+  return juce::File::getSpecialLocation(juce::File::commonApplicationDataDirectory)
+      .getChildFile("NovaTune")
+      .getChildFile("Presets");
+}
+
+juce::File PresetLibrary::getDefaultUserDirectory() {
+  return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+      .getChildFile("NovaTune")
+      .getChildFile("Presets");
+}
+
+juce::File PresetLibrary::getDefaultIndexFile() {
+  return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+      .getChildFile("NovaTune")
+      .getChildFile("PresetIndex.ntpi");
+}
+
+PresetLibrary::PresetLibrary()
+    : PresetLibrary({{getDefaultFactoryDirectory(), true}, {getDefaultUserDirectory(), false}}, getDefaultIndexFile()) {
+  startScanning();
+}
+
+PresetLibrary::PresetLibrary(std::vector<Directory> directoriesToUse, const juce::File &indexFileToUse)
+    : directories(std::move(directoriesToUse)),
+      indexFile(indexFileToUse),
+      index(std::make_shared<Index>()) {}
+
+PresetLibrary::~PresetLibrary() {
+  if (scanner != nullptr)
+    scanner->stopThread(5000);
+}
+
+std::shared_ptr<const PresetLibrary::Index> PresetLibrary::getIndex() const {
+  const juce::SpinLock::ScopedLockType lock(indexLock);
+  return index;
+}
+
+void PresetLibrary::publish(std::shared_ptr<const Index> newIndex) {
+  {
+    const juce::SpinLock::ScopedLockType lock(indexLock);
+    index = std::move(newIndex);
+  }
+
+  sendChangeMessage();
+}
+
+void PresetLibrary::startScanning() {
+  if (scanner != nullptr)
+    return;
+
+  scanner = std::make_unique<ScanThread>(*this);
+  scanner->startThread(juce::Thread::Priority::background);
+}
+
+void PresetLibrary::rescan() {
+  if (scanner != nullptr)
+    scanner->notify();
+}
+
+//==============================================================================
+// SCANNING
+//==============================================================================
+
+PresetLibrary::ScanResult PresetLibrary::scan() {
+  const juce::ScopedLock lock(scanLock);
+  const double startMs = juce::Time::getMillisecondCounterHiRes();
+
+  // Last session's index first: the browser has something to show while the disk is walked
+  if (!indexLoaded) {
+    indexLoaded = true;
+
+    if (auto stored = Index::open(indexFile))
+      publish(std::move(stored));
+  }
+
+  const auto previous = getIndex();
+
+  std::unordered_map<std::string, int> known;
+  known.reserve(static_cast<size_t>(previous->size()));
+
+  for (int i = 0; i < previous->size(); ++i)
+    known.emplace(previous->getPreset(i).path, i);
+
+  ScanResult result;
+  std::vector<Record> records;
+  int numFound = 0; // Entries of the previous index whose files are still there
+
+  for (const auto &directory : directories) {
+    for (const auto &item : juce::RangedDirectoryIterator(directory.root, true, juce::String("*") + fileExtension,
+                                                          juce::File::findFiles)) {
+      if (juce::Thread::currentThreadShouldExit())
+        return result;
+
+      ++result.numFiles;
+
+      const auto file = item.getFile();
+      const auto modified = item.getModificationTime().toMilliseconds();
+      const auto size = item.getFileSize();
+      const auto found = known.find(file.getFullPathName().toStdString());
+
+      Record record;
+
+      if (found != known.end()) {
+        ++numFound;
+
+        const auto &entry = previous->getEntry(found->second);
+
+        // Unchanged since the last scan: the entry stands
+        if (entry.modificationTime == modified && entry.fileSize == size) {
+          const auto preset = previous->getPreset(found->second);
+          record.entry = entry;
+          record.path = file.getFullPathName();
+          record.name = preset.getName();
+          record.category = preset.getCategory();
+          record.tags = juce::String::fromUTF8(preset.tags);
+          records.push_back(std::move(record));
+          continue;
+        }
+      }
+
+      // New, changed or unreadable before: open it. One that can't be read
+      // stays out of the index (and is tried again next scan).
+      if (!readRecord(file, directory, record))
+        continue;
+
+      record.entry.modificationTime = modified;
+      record.entry.fileSize = size;
+      records.push_back(std::move(record));
+      ++result.numRead;
+    }
+  }
+
+  result.numRemoved = previous->size() - numFound;
+
+  if (result.numRead > 0 || result.numRemoved > 0 || indexFileStale) {
+    auto data = build(records);
+    bool written = false;
+
+    if (indexFile.getParentDirectory().createDirectory()) {
+      juce::TemporaryFile temporary(indexFile);
+
+      written = temporary.getFile().replaceWithData(data.getData(), data.getSize()) &&
+                temporary.overwriteTargetFileWithTemporary();
+    }
+
+    // Can't replace a file that is still mapped on some systems: serve this
+    // one from memory, and write it next scan
+    auto built = written ? Index::open(indexFile) : nullptr;
+
+    if (built == nullptr)
+      built = Index::fromMemory(std::move(data));
+
+    indexFileStale = !written;
+    result.indexWritten = written;
+    publish(std::move(built));
+  }
+
+  result.milliseconds = juce::Time::getMillisecondCounterHiRes() - startMs;
+  return result;
+}
+
+bool PresetLibrary::readRecord(const juce::File &file, const Directory &directory, Record &record) {
+  const auto state = load(file);
+
+  if (!state.isValid())
+    return false;
+
+  // A preset without a stored category is filed under its folder
+  const auto folder = file.getParentDirectory();
+  const auto fallback = folder == directory.root ? juce::String(directory.factory ? "Factory" : "User")
+                                                 : folder.getFileName();
+
+  record.path = file.getFullPathName();
+  record.name = file.getFileNameWithoutExtension();
+  record.category = state.getProperty(categoryProperty, fallback).toString();
+  record.tags = state.getProperty(tagsProperty).toString();
+
+  auto valueOf = [&state](const char *id, float fallbackValue) {
+    const auto child = state.getChildWithProperty("id", juce::String(id));
+    return child.isValid() ? static_cast<float>(child.getProperty("value")) : fallbackValue;
+  };
+
+  auto &entry = record.entry;
+  entry.key = static_cast<int8_t>(juce::roundToInt(valueOf(ParamIDs::key, -1.0f)));
+  entry.scale = static_cast<int8_t>(juce::roundToInt(valueOf(ParamIDs::scale, -1.0f)));
+  entry.voices = 0;
+
+  const char *enabledIds[] = {ParamIDs::A_enabled, ParamIDs::B_enabled, ParamIDs::C_enabled};
+
+  for (size_t v = 0; v < std::size(enabledIds); ++v)
+    if (valueOf(enabledIds[v], 0.0f) > 0.5f)
+      entry.voices |= static_cast<uint8_t>(1u << v);
+
+  entry.flags = directory.factory ? factoryPreset : 0;
+  return true;
+}
+
+juce::MemoryBlock PresetLibrary::build(std::vector<Record> &records) {
+  // Browse order: by category, then name
+  std::sort(records.begin(), records.end(), [](const Record &a, const Record &b) {
+    if (const int order = a.category.compareNatural(b.category); order != 0)
+      return order < 0;
+
+    return a.name.compareNatural(b.name) < 0;
+  });
+
+  StringPool pool;
+  pool.add(std::string()); // Offset 0 is the empty string, so the pool is never empty
+
+  std::vector<IndexEntry> entries;
+  entries.reserve(records.size());
+
+  for (const auto &record : records) {
+    auto entry = record.entry;
+    entry.path = pool.add(record.path);
+    entry.name = pool.add(record.name);
+    entry.category = pool.add(record.category);
+    entry.tags = pool.add(record.tags);
+    entry.searchText = pool.add(lowerAscii(record.name + "\n" + record.category + "\n" + record.tags));
+    entries.push_back(entry);
+  }
+
+  IndexHeader header;
+  header.numEntries = static_cast<uint32_t>(entries.size());
+  header.stringBytes = static_cast<uint32_t>(pool.getBytes().size());
+
+  juce::MemoryBlock data;
+  data.append(&header, sizeof(header));
+  data.append(entries.data(), entries.size() * sizeof(IndexEntry));
+  data.append(pool.getBytes().data(), pool.getBytes().size());
+  return data;
+}
+
+//==============================================================================
+// EDITING
+//==============================================================================
+
+juce::ValueTree PresetLibrary::load(const juce::File &preset) {
+  juce::MemoryBlock data;
+
+  if (!preset.loadFileAsData(data))
+    return {};
+
+  return StateFormat::read(data.getData(), static_cast<int>(data.getSize()));
+}
+
+bool PresetLibrary::isUserPreset(const juce::File &preset) const {
+  return std::any_of(directories.begin(), directories.end(), [&preset](const Directory &directory) {
+    return !directory.factory && preset.isAChildOf(directory.root);
+  });
+}
+
+juce::File PresetLibrary::save(const juce::String &name, const juce::String &category, const juce::String &tags,
+                               juce::ValueTree state) {
+  const auto userDirectory = std::find_if(directories.begin(), directories.end(),
+                                          [](const Directory &directory) { return !directory.factory; });
+
+  if (userDirectory == directories.end() || juce::File::createLegalFileName(name).isEmpty())
+    return {};
+
+  auto folder = userDirectory->root;
+
+  if (category.isNotEmpty())
+    folder = folder.getChildFile(juce::File::createLegalFileName(category));
+
+  const auto file = folder.getChildFile(juce::File::createLegalFileName(name) + fileExtension);
+
+  state.setProperty(categoryProperty, category, nullptr);
+  state.setProperty(tagsProperty, tags, nullptr);
+
+  juce::MemoryBlock data;
+  StateFormat::write(state, data);
+
+  if (!folder.createDirectory() || !file.replaceWithData(data.getData(), data.getSize()))
+    return {};
+
+  rescan();
+  return file;
+}
+
+bool PresetLibrary::rename(const juce::File &preset, const juce::String &newName) {
+  const auto legalName = juce::File::createLegalFileName(newName);
+
+  if (!isUserPreset(preset) || legalName.isEmpty())
+    return false;
+
+  const auto target = preset.getSiblingFile(legalName + fileExtension);
+
+  if (target.exists() || !preset.moveFileTo(target))
+    return false;
+
+  rescan();
+  return true;
+}
+
+bool PresetLibrary::remove(const juce::File &preset) {
+  if (!isUserPreset(preset) || !preset.deleteFile())
+    return false;
+
+  rescan();
+  return true;
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <juce_events/juce_events.h>
+#include <juce_data_structures/juce_data_structures.h>
+#include <memory>
+#include <vector>
+
+/**
+ * PresetLibrary.h
+ *
+ * Factory and user presets, listed from a persistent index that a
+ * background thread keeps up to date.
+ *
+ * WHY?
+ * A preset's name comes from its file, but its category, tags, key, scale
+ * and harmony voices are inside it. Listing thousands of presets by
+ * opening each one takes seconds on a cold disk, and doing it when the
+ * editor opens would make the editor wait. Instead the library keeps an
+ * index of everything a browser shows, and the editor only ever reads the
+ * index.
+ *
+ * HOW IT WORKS:
+ * 1. The index file holds one fixed-size IndexEntry per preset, then a
+ *    pool of UTF-8 strings. It is mapped, not parsed: loading it is
+ *    validating offsets.
+ * 2. A scan walks the preset directories. A file whose modification time
+ *    and size match its entry keeps that entry, so only new or changed
+ *    files are read. Nothing is written if nothing changed.
+ * 3. Otherwise a new index is built, sorted by category and name, and
+ *    written via a temporary file. It replaces the published snapshot
+ *    and listeners get a change message.
+ *
+ * A scan of an unchanged library is a directory listing. Each entry also
+ * stores its name, category and tags ASCII lower-cased together, so a
+ * search is a substring test per preset with no allocation.
+ *
+ * FILE FORMAT (.ntpi, little-endian):
+ *   IndexHeader | numEntries x IndexEntry | string pool
+ *
+ * A preset file (.ntpreset) is a plugin state in StateFormat. Its
+ * category and tags are properties of the state's root.
+ *
+ * THREADING:
+ * getIndex() hands out the current snapshot as a shared pointer. A holder
+ * keeps its snapshot, mapping included, for as long as it needs it, and
+ * never waits for a scan. Scans run on the library's thread, one at a
+ * time. Saving, renaming and removing presets are message-thread calls
+ * that ask for a scan.
+ *
+ * ANALOGY: Like a mail client's message index - the mailbox is a folder
+ * of files, but the list view reads a database that only the files
+ * changed since the last sync are re-read into.
+ */
+
+class PresetLibrary : public juce::ChangeBroadcaster {
+public:
+  //==========================================================================
+  // INDEX FILE
+  //==========================================================================
+
+  /** First bytes of every .ntpi file */
+  struct IndexHeader {
+    char magic[4] = {'N', 'T', 'P', 'I'};
+    uint32_t version = 1;
+    uint32_t numEntries = 0;
+    uint32_t stringBytes = 0;
+  };
+
+  /** One preset. Strings are byte offsets into the pool. */
+  struct IndexEntry {
+    int64_t modificationTime = 0; // Milliseconds since 1970, as the scan saw it
+    int64_t fileSize = 0;
+    uint32_t path = 0;
+    uint32_t name = 0;
+    uint32_t category = 0;
+    uint32_t tags = 0;       // Comma-separated
+    uint32_t searchText = 0; // Name, category and tags, ASCII lower-cased
+    int8_t key = -1;         // NovaTuneEnums::Key, -1 if the preset doesn't set it
+    int8_t scale = -1;       // NovaTuneEnums::Scale, likewise
+    uint8_t voices = 0;      // Bit v set: harmony voice v enabled
+    uint8_t flags = 0;
+  };
+
+  enum EntryFlags : uint8_t {
+    factoryPreset = 1u << 0,
+  };
+
+  static_assert(std::is_trivially_copyable_v<IndexHeader> && std::is_trivially_copyable_v<IndexEntry>,
+                "The index is written to disk and mapped as raw bytes");
+
+  /** One preset as listed. The strings live in the index it came from. */
+  struct Preset {
+    const char *path = "";
+    const char *name = "";
+    const char *category = "";
+    const char *tags = "";
+    int key = -1;
+    int scale = -1;
+    uint8_t voices = 0;
+    bool factory = false;
+
+    juce::File getFile() const { return juce::File(juce::String::fromUTF8(path)); }
+    juce::String getName() const { return juce::String::fromUTF8(name); }
+    juce::String getCategory() const { return juce::String::fromUTF8(category); }
+  };
+
+  /** An immutable snapshot of the library */
+  class Index {
+  public:
+    /** An empty library */
+    Index() = default;
+
+    /** Map an index file. Returns nullptr if it is missing or not a valid index. */
+    static std::shared_ptr<const Index> open(const juce::File &file);
+
+    /** An index held in memory (when the file couldn't be replaced) */
+    static std::shared_ptr<const Index> fromMemory(juce::MemoryBlock &&data);
+
+    int size() const noexcept { return numEntries; }
+    Preset getPreset(int index) const noexcept;
+    const IndexEntry &getEntry(int index) const noexcept { return entries[index]; }
+
+    /** Position of the preset stored at `file`, or -1 */
+    int find(const juce::File &file) const;
+
+    /**
+     * Presets whose name, category or tags contain every word of `query`
+     * (ignoring ASCII case), optionally in one category only. In browse
+     * order.
+     */
+    std::vector<int> search(const juce::String &query, const juce::String &category = {}) const;
+
+    /** Every category, in browse order */
+    juce::StringArray getCategories() const;
+
+  private:
+    bool attach(const void *data, size_t size);
+    const char *getString(uint32_t offset) const noexcept { return strings + offset; }
+
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    juce::MemoryBlock memory;
+
+    const IndexEntry *entries = nullptr;
+    const char *strings = nullptr;
+    int numEntries = 0;
+  };
+
+  //==========================================================================
+  // LIBRARY
+  //==========================================================================
+
+  /** A directory searched for presets, with everything below it */
+  struct Directory {
+    juce::File root;
+    bool factory = false;
+  };
+
+  /** Root property names in a preset file */
+  static const juce::Identifier categoryProperty;
+  static const juce::Identifier tagsProperty;
+
+  static constexpr const char *fileExtension = ".ntpreset";
+
+  /** <common application data>/NovaTune/Presets (installed, read-only) */
+  static juce::File getDefaultFactoryDirectory();
+
+  /** <user documents>/NovaTune/Presets */
+  static juce::File getDefaultUserDirectory();
+
+  /** <user application data>/NovaTune/PresetIndex.ntpi */
+  static juce::File getDefaultIndexFile();
+
+  /** The default directories and index, scanning in the background (what the plugin shares) */
+  PresetLibrary();
+
+  /**
+   * A library of `directories`, indexed in `indexFile`. The first
+   * non-factory directory receives saved presets. Nothing is scanned until
+   * startScanning() or scan().
+   */
+  PresetLibrary(std::vector<Directory> directories, const juce::File &indexFile);
+
+  ~PresetLibrary() override;
+
+  /** The current snapshot. Never null, and never waits on the file system. */
+  std::shared_ptr<const Index> getIndex() const;
+
+  /** Start the background thread, which loads the index and scans */
+  void startScanning();
+
+  /** Ask the background thread to scan again (returns at once) */
+  void rescan();
+
+  struct ScanResult {
+    int numFiles = 0;   // Presets found
+    int numRead = 0;    // ...that were new or changed, so were opened
+    int numRemoved = 0; // Entries whose files are gone
+    bool indexWritten = false;
+    double milliseconds = 0.0;
+  };
+
+  /** Scan now, on this thread (what the background thread runs; blocks while it scans) */
+  ScanResult scan();
+
+  //==========================================================================
+  // EDITING (message thread)
+  //==========================================================================
+
+  /**
+   * Save `state` as a user preset, in a folder named after its category.
+   * Replaces a user preset of the same name and category. Returns the
+   * file, or File() if it couldn't be written.
+   */
+  juce::File save(const juce::String &name, const juce::String &category, const juce::String &tags,
+                  juce::ValueTree state);
+
+  /** Rename a user preset (not a factory one, nor onto an existing name) */
+  bool rename(const juce::File &preset, const juce::String &newName);
+
+  /** Delete a user preset */
+  bool remove(const juce::File &preset);
+
+  bool isUserPreset(const juce::File &preset) const;
+
+  /** Read a preset's state (with its category and tags properties). Invalid if unreadable. */
+  static juce::ValueTree load(const juce::File &preset);
+
+private:
+  class ScanThread;
+
+  struct Record;
+
+  void publish(std::shared_ptr<const Index> newIndex);
+  static bool readRecord(const juce::File &file, const Directory &directory, Record &record);
+  static juce::MemoryBlock build(std::vector<Record> &records);
+
+  const std::vector<Directory> directories;
+  const juce::File indexFile;
+
+  mutable juce::SpinLock indexLock; // Guards the pointer copy only
+  std::shared_ptr<const Index> index;
+
+  juce::CriticalSection scanLock; // One scan at a time
+  bool indexLoaded = false;       // The file has been mapped (scanLock)
+  bool indexFileStale = false;    // The published index isn't on disk yet (scanLock)
+
+  std::unique_ptr<ScanThread> scanner;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetLibrary)
+};
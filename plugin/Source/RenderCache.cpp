@@ -0,0 +1,486 @@
+#include "RenderCache.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+/**
+ * RenderCache.cpp
+ *
+ * Chain keys, the .ntrc reader and writer, and the per-render session.
+ */
+
+namespace {
+
+  // Renders mapped at the start of a render; more would mean many edits of one take
+  constexpr int maxCandidates = 8;
+
+  uint64_t bitsOf(float value) noexcept {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  uint64_t bitsOf(double value) noexcept {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  float floatOf(uint64_t word) noexcept {
+    const auto bits = static_cast<uint32_t>(word);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  template <typename Enum>
+  Enum enumOf(uint64_t word) noexcept {
+    return static_cast<Enum>(static_cast<int>(word));
+  }
+
+  /** Field by field: the struct's padding isn't part of the snapshot */
+  void toWords(const EngineParameters &params, bool bypassed, uint64_t *words) noexcept {
+    *words++ = bypassed ? 1u : 0u;
+    *words++ = static_cast<uint64_t>(params.key);
+    *words++ = static_cast<uint64_t>(params.scale);
+    *words++ = static_cast<uint64_t>(params.inputType);
+    *words++ = static_cast<uint64_t>(params.cpuGuard);
+    *words++ = bitsOf(params.retuneSpeed);
+    *words++ = bitsOf(params.humanize);
+    *words++ = bitsOf(params.vibratoAmount);
+    *words++ = bitsOf(params.mixPercent);
+    *words++ = static_cast<uint64_t>(params.harmonyPreset);
+    *words++ = bitsOf(params.harmonyMorphMs);
+
+    for (const auto &voice : params.voices) {
+      *words++ = voice.enabled ? 1u : 0u;
+      *words++ = static_cast<uint64_t>(voice.mode);
+      *words++ = static_cast<uint64_t>(static_cast<uint32_t>(voice.diatonicIntervalIndex));
+      *words++ = static_cast<uint64_t>(static_cast<uint32_t>(voice.semitoneOffset));
+      *words++ = bitsOf(voice.levelDb);
+      *words++ = bitsOf(voice.pan);
+      *words++ = bitsOf(voice.formantShift);
+      *words++ = bitsOf(voice.humanizeTimingMs);
+      *words++ = bitsOf(voice.humanizePitchCents);
+      *words++ = voice.followPreset ? 1u : 0u;
+    }
+  }
+
+  /** The inverse, for replaying a stored block */
+  EngineParameters fromWords(const uint64_t *words, bool &bypassed) noexcept {
+    EngineParameters params;
+    bypassed = *words++ != 0;
+    params.key = enumOf<NovaTuneEnums::Key>(*words++);
+    params.scale = enumOf<NovaTuneEnums::Scale>(*words++);
+    params.inputType = enumOf<NovaTuneEnums::InputType>(*words++);
+    params.cpuGuard = enumOf<NovaTuneEnums::CpuGuardMode>(*words++);
+    params.retuneSpeed = floatOf(*words++);
+    params.humanize = floatOf(*words++);
+    params.vibratoAmount = floatOf(*words++);
+    params.mixPercent = floatOf(*words++);
+    params.harmonyPreset = enumOf<NovaTuneEnums::HarmonyPreset>(*words++);
+    params.harmonyMorphMs = floatOf(*words++);
+
+    for (auto &voice : params.voices) {
+      voice.enabled = *words++ != 0;
+      voice.mode = enumOf<NovaTuneEnums::HarmonyMode>(*words++);
+      voice.diatonicIntervalIndex = static_cast<int32_t>(*words++);
+      voice.semitoneOffset = static_cast<int32_t>(*words++);
+      voice.levelDb = floatOf(*words++);
+      voice.pan = floatOf(*words++);
+      voice.formantShift = floatOf(*words++);
+      voice.humanizeTimingMs = floatOf(*words++);
+      voice.humanizePitchCents = floatOf(*words++);
+      voice.followPreset = *words++ != 0;
+    }
+
+    return params;
+  }
+
+  /** Snapshot, input and output */
+  uint64_t blockBytes(uint32_t numSamples, uint32_t numChannels) noexcept {
+    return sizeof(uint64_t) * RenderCache::numParameterWords + uint64_t(2) * numChannels * numSamples * sizeof(float);
+  }
+
+  juce::String toHex(const RenderCache::Key &key) {
+    return juce::String::toHexString(key.data(), static_cast<int>(key.size()), 0);
+  }
+
+  const char *renderWildcard = "*.ntrc";
+
+} // namespace
+
+//==============================================================================
+// DIRECTORY
+//==============================================================================
+
+juce::File RenderCache::getDefaultDirectory() {
+  return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+      .getChildFile("NovaTune")
+      .getChildFile("RenderCache");
+}
+
+RenderCache::RenderCache(const juce::File &directoryToUse) : directory(directoryToUse) {}
+
+void RenderCache::trim(juce::int64 maxBytes) const {
+  auto files = directory.findChildFiles(juce::File::findFiles, false, renderWildcard);
+
+  juce::int64 total = 0;
+  for (const auto &file : files)
+    total += file.getSize();
+
+  std::sort(files.begin(), files.end(), [](const juce::File &x, const juce::File &y) {
+    return x.getLastModificationTime() < y.getLastModificationTime();
+  });
+
+  for (const auto &file : files) {
+    if (total <= maxBytes)
+      break;
+
+    const auto size = file.getSize();
+
+    // A render another instance still has mapped may refuse; it goes next time
+    if (file.deleteFile())
+      total -= size;
+  }
+}
+
+//==============================================================================
+// MAPPED RENDER
+//==============================================================================
+
+/** A stored render, mapped read-only. Blocks are checked before they are served. */
+struct RenderCache::Session::MappedRender {
+  explicit MappedRender(const juce::File &fileToMap)
+      : file(fileToMap), mapping(fileToMap, juce::MemoryMappedFile::readOnly) {}
+
+  /** Header matches this render and the table lies within the file */
+  bool isValidFor(const Configuration &configuration) {
+    const auto *bytes = static_cast<const uint8_t *>(mapping.getData());
+    const size_t size = mapping.getSize();
+
+    if (bytes == nullptr || size < sizeof(FileHeader))
+      return false;
+
+    std::memcpy(&header, bytes, sizeof(header));
+    const FileHeader expected;
+
+    return std::memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0 &&
+           header.version == expected.version &&
+           header.numChannels == static_cast<uint32_t>(configuration.numChannels) &&
+           bitsOf(header.sampleRate) == bitsOf(configuration.sampleRate) &&
+           header.tableOffset >= sizeof(FileHeader) && header.tableOffset <= size &&
+           header.numBlocks <= (size - header.tableOffset) / sizeof(BlockEntry);
+  }
+
+  BlockEntry getEntry(int index) const noexcept {
+    BlockEntry entry;
+    std::memcpy(&entry, static_cast<const uint8_t *>(mapping.getData()) + header.tableOffset +
+                            static_cast<size_t>(index) * sizeof(BlockEntry),
+                sizeof(entry));
+    return entry;
+  }
+
+  /** Block `index` has this key and length, and lies within the data */
+  bool agrees(int index, const Key &key, int numSamples) const noexcept {
+    if (index >= static_cast<int>(header.numBlocks))
+      return false;
+
+    const auto entry = getEntry(index);
+
+    return entry.key == key && entry.numSamples == static_cast<uint32_t>(numSamples) &&
+           entry.dataOffset >= sizeof(FileHeader) && entry.dataOffset <= header.tableOffset &&
+           blockBytes(entry.numSamples, header.numChannels) <= header.tableOffset - entry.dataOffset;
+  }
+
+  const uint8_t *getBlock(const BlockEntry &entry) const noexcept {
+    return static_cast<const uint8_t *>(mapping.getData()) + entry.dataOffset;
+  }
+
+  const uint64_t *getParameterWords(const BlockEntry &entry) const noexcept {
+    return reinterpret_cast<const uint64_t *>(getBlock(entry));
+  }
+
+  /** Input channels, then output channels */
+  const float *getChannel(const BlockEntry &entry, int channel) const noexcept {
+    const auto *samples = reinterpret_cast<const float *>(getBlock(entry) + sizeof(uint64_t) * numParameterWords);
+    return samples + static_cast<size_t>(channel) * entry.numSamples;
+  }
+
+  const float *getInput(const BlockEntry &entry, int channel) const noexcept { return getChannel(entry, channel); }
+
+  const float *getOutput(const BlockEntry &entry, int channel) const noexcept {
+    return getChannel(entry, static_cast<int>(header.numChannels) + channel);
+  }
+
+  /** Copy an agreeing block's output out */
+  void readOutput(int index, juce::AudioBuffer<float> &buffer) const noexcept {
+    const auto entry = getEntry(index);
+
+    for (int ch = 0; ch < static_cast<int>(header.numChannels); ++ch)
+      std::memcpy(buffer.getWritePointer(ch), getOutput(entry, ch), entry.numSamples * sizeof(float));
+  }
+
+  juce::File file;
+  juce::MemoryMappedFile mapping;
+  FileHeader header;
+};
+
+//==============================================================================
+// SESSION
+//==============================================================================
+
+RenderCache::Session::Session(const RenderCache &cacheToUse, TunerEngine &engineToUse,
+                              const Configuration &configurationToUse)
+    : cache(cacheToUse), engine(engineToUse), configuration(configurationToUse) {
+  const FileHeader format;
+  const uint64_t words[] = {format.version,
+                            static_cast<uint64_t>(DSPConfig::engineVersion),
+                            bitsOf(configuration.sampleRate),
+                            static_cast<uint64_t>(configuration.numChannels),
+                            static_cast<uint64_t>(configuration.seed),
+                            static_cast<uint64_t>(configuration.timelineStart),
+                            configuration.renderQuality ? 1u : 0u};
+
+  // The first block chains from the configuration
+  lastKey = PitchAnalysisCache::combine({}, words, std::size(words));
+
+  inputCopy.setSize(configuration.numChannels, configuration.maxBlockSize);
+}
+
+RenderCache::Session::~Session() { finish(); }
+
+RenderCache::Key RenderCache::Session::chainKey(const juce::AudioBuffer<float> &buffer,
+                                                const EngineParameters &params, bool bypassed) {
+  blockHash.reset();
+  blockHash.addBlock(buffer, buffer.getNumSamples());
+  const auto input = blockHash.finish();
+
+  toWords(params, bypassed, parameterWords);
+
+  uint64_t words[2 + numParameterWords];
+  std::memcpy(words, input.data(), sizeof(uint64_t) * 2);
+  std::copy(std::begin(parameterWords), std::end(parameterWords), words + 2);
+
+  return PitchAnalysisCache::combine(lastKey, words, std::size(words));
+}
+
+void RenderCache::Session::process(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midi,
+                                   const EngineParameters &params, bool bypassed) {
+  const int numSamples = buffer.getNumSamples();
+  const Key key = chainKey(buffer, params, bypassed);
+
+  if (blockIndex == 0) {
+    firstKey = key;
+    findCandidates();
+  }
+
+  if (!diverged) {
+    auto agreeing = std::stable_partition(candidates.begin(), candidates.end(), [&](const auto &render) {
+      return render->agrees(blockIndex, key, numSamples);
+    });
+
+    if (agreeing != candidates.begin() && buffer.getNumChannels() == configuration.numChannels) {
+      candidates.erase(agreeing, candidates.end());
+      candidates.front()->readOutput(blockIndex, buffer);
+
+      engineStale = true;
+      ++numHits;
+      lastKey = key;
+      ++blockIndex;
+      return;
+    }
+
+    // The disagreeing candidates agreed up to here, so any of them holds the prefix
+    diverge();
+  }
+
+  if (recording != nullptr)
+    for (int ch = 0; ch < configuration.numChannels; ++ch)
+      inputCopy.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+
+  if (!bypassed)
+    engine.process(buffer, midi, params);
+
+  if (recording != nullptr)
+    record(key, buffer);
+
+  lastKey = key;
+  ++blockIndex;
+}
+
+void RenderCache::Session::findCandidates() {
+  auto files = cache.getDirectory().findChildFiles(juce::File::findFiles, false, toHex(firstKey) + "-*.ntrc");
+
+  std::sort(files.begin(), files.end(), [](const juce::File &x, const juce::File &y) {
+    return x.getLastModificationTime() > y.getLastModificationTime();
+  });
+
+  for (const auto &file : files) {
+    if (static_cast<int>(candidates.size()) >= maxCandidates)
+      break;
+
+    auto render = std::make_unique<MappedRender>(file);
+
+    if (render->isValidFor(configuration))
+      candidates.push_back(std::move(render));
+    else
+      file.deleteFile(); // Damaged (or another version): it can never be served
+  }
+}
+
+void RenderCache::Session::diverge() {
+  diverged = true;
+
+  const MappedRender *source = candidates.empty() || blockIndex == 0 ? nullptr : candidates.front().get();
+
+  if (source != nullptr && engineStale)
+    catchUp(*source);
+
+  startRecording(source);
+  candidates.clear();
+}
+
+void RenderCache::Session::catchUp(const MappedRender &source) {
+  // Exactly as the engine would have seen the blocks it skipped
+  engine.reset();
+
+  juce::MidiBuffer noMidi;
+  juce::AudioBuffer<float> block;
+
+  for (int i = 0; i < blockIndex; ++i) {
+    const auto entry = source.getEntry(i);
+    const int numSamples = static_cast<int>(entry.numSamples);
+
+    bool bypassed = false;
+    const auto params = fromWords(source.getParameterWords(entry), bypassed);
+
+    if (bypassed)
+      continue;
+
+    block.setSize(configuration.numChannels, numSamples, false, false, true);
+
+    for (int ch = 0; ch < configuration.numChannels; ++ch)
+      block.copyFrom(ch, 0, source.getInput(entry, ch), numSamples);
+
+    engine.process(block, noMidi, params);
+  }
+
+  engineStale = false;
+}
+
+//==============================================================================
+// RECORDING
+//==============================================================================
+
+void RenderCache::Session::startRecording(const MappedRender *source) {
+  if (!cache.getDirectory().createDirectory())
+    return;
+
+  recordingFile = std::make_unique<juce::TemporaryFile>(cache.getDirectory().getChildFile(toHex(firstKey) + ".ntrc"));
+  recording = std::make_unique<juce::FileOutputStream>(recordingFile->getFile());
+
+  // Placeholder; finish() writes the real header once the table's position is known
+  const FileHeader header;
+
+  if (!recording->openedOk() || !recording->write(&header, sizeof(header))) {
+    stopRecording();
+    return;
+  }
+
+  if (source == nullptr)
+    return;
+
+  // The agreed prefix, copied block for block
+  table.reserve(static_cast<size_t>(blockIndex));
+
+  for (int i = 0; i < blockIndex; ++i) {
+    auto entry = source->getEntry(i);
+    const auto *data = source->getBlock(entry);
+
+    entry.dataOffset = static_cast<uint64_t>(recording->getPosition());
+
+    if (!recording->write(data, blockBytes(entry.numSamples, source->header.numChannels))) {
+      stopRecording();
+      return;
+    }
+
+    table.push_back(entry);
+    recordedSamples += entry.numSamples;
+  }
+}
+
+void RenderCache::Session::record(const Key &key, const juce::AudioBuffer<float> &output) {
+  BlockEntry entry;
+  entry.key = key;
+  entry.numSamples = static_cast<uint32_t>(output.getNumSamples());
+  entry.dataOffset = static_cast<uint64_t>(recording->getPosition());
+
+  const auto channelBytes = entry.numSamples * sizeof(float);
+  bool ok = output.getNumChannels() == configuration.numChannels &&
+            recording->write(parameterWords, sizeof(parameterWords));
+
+  for (int ch = 0; ok && ch < configuration.numChannels; ++ch)
+    ok = recording->write(inputCopy.getReadPointer(ch), channelBytes);
+
+  for (int ch = 0; ok && ch < configuration.numChannels; ++ch)
+    ok = recording->write(output.getReadPointer(ch), channelBytes);
+
+  if (!ok) {
+    // Abandoned: the rest of the render goes on uncached
+    stopRecording();
+    return;
+  }
+
+  table.push_back(entry);
+  recordedSamples += entry.numSamples;
+}
+
+void RenderCache::Session::stopRecording() {
+  recording.reset();
+  recordingFile.reset(); // Deletes the partial file
+  table.clear();
+}
+
+void RenderCache::Session::finish() {
+  if (finished)
+    return;
+
+  finished = true;
+
+  // Served to the end without diverging: that render was used
+  if (!candidates.empty())
+    candidates.front()->file.setLastModificationTime(juce::Time::getCurrentTime());
+
+  candidates.clear();
+
+  if (recording == nullptr)
+    return;
+
+  if (table.empty()) {
+    stopRecording();
+    return;
+  }
+
+  FileHeader header;
+  header.numChannels = static_cast<uint32_t>(configuration.numChannels);
+  header.numBlocks = static_cast<uint32_t>(table.size());
+  header.sampleRate = configuration.sampleRate;
+  header.numSamples = recordedSamples;
+  header.tableOffset = static_cast<uint64_t>(recording->getPosition());
+
+  const bool written = recording->write(table.data(), table.size() * sizeof(BlockEntry)) &&
+                       recording->setPosition(0) && recording->write(&header, sizeof(header));
+
+  recording->flush();
+  const bool ok = written && !recording->getStatus().failed();
+  recording.reset();
+
+  if (ok) {
+    const auto target = cache.getDirectory().getChildFile(toHex(firstKey) + "-" + toHex(lastKey) + ".ntrc");
+    recordingFile->getFile().moveFileTo(target);
+  }
+
+  recordingFile.reset();
+  cache.trim(defaultMaxBytes);
+}
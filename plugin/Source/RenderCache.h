@@ -0,0 +1,181 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <memory>
+#include <vector>
+#include "PitchAnalysisCache.h"
+#include "dsp/TunerEngine.h"
+
+/**
+ * RenderCache.h
+ *
+ * Rendered blocks on disk, so a repeat bounce of an unchanged track is a
+ * copy instead of a render.
+ *
+ * WHY?
+ * Bouncing a session runs every NovaTune instance over its whole track,
+ * even when nothing upstream has changed since the last bounce. With
+ * Deterministic Render on, a render's output is stored as it is produced,
+ * and the next render of the same input with the same parameters is
+ * served from the file - a forty-track vocal session bounces again at
+ * disk speed.
+ *
+ * HOW IT WORKS:
+ * 1. Every block gets a CHAIN KEY: the hash of the previous block's key,
+ *    this block's input and the parameter snapshot it ran with. The first
+ *    block chains from the configuration (engine version, sample rate,
+ *    channels, seed, timeline origin, render quality). The engine's output
+ *    depends on everything before it, and so does the key.
+ * 2. A render is stored as one .ntrc file: its blocks in order, plus a
+ *    table of their keys. It is named after its first and last keys.
+ * 3. A new render maps every file that starts with its first key and
+ *    follows them block by block. While one still agrees, its block is
+ *    copied out and the engine doesn't run.
+ * 4. At the first block no file agrees with (an edit, an automation move),
+ *    the engine - idle through the hits - catches up: it is reset and
+ *    replays the agreed blocks from the file, which also stores each
+ *    block's input and parameter snapshot. From there it renders live;
+ *    nothing can agree again, so the agreed prefix and everything after it
+ *    are recorded and stored as a new file when the render finishes.
+ *
+ * Replaying exactly what the engine missed keeps every render
+ * bit-identical to one without the cache: a full hit costs a file copy,
+ * and a render that diverges costs what it would have uncached.
+ *
+ * FILE FORMAT (.ntrc, little-endian):
+ *   FileHeader | blocks | block table (numBlocks x BlockEntry)
+ *   Each block is its parameter snapshot (numParameterWords x uint64),
+ *   then its input and its output, channel after channel, as float32. The
+ *   table goes last so blocks stream to disk as they are rendered; the
+ *   header is written again at the end with its position.
+ *
+ * THREADING:
+ * A Session belongs to one processor and runs on its render thread. It
+ * maps, allocates and writes files there, so it is for non-realtime
+ * renders only.
+ *
+ * ANALOGY: Like a build system's cache of linked outputs - reused while
+ * every input up to it is unchanged, rebuilt from the first that isn't.
+ */
+
+class RenderCache {
+public:
+  using Key = PitchTrack::Key;
+
+  /** First bytes of every .ntrc file */
+  struct FileHeader {
+    char magic[4] = {'N', 'T', 'R', 'C'};
+    uint32_t version = 2;
+    uint32_t numChannels = 0;
+    uint32_t numBlocks = 0;
+    double sampleRate = 0.0;
+    uint64_t numSamples = 0;
+    uint64_t tableOffset = 0; // Bytes from the start of the file
+  };
+
+  /** One block in the table */
+  struct BlockEntry {
+    Key key = {};
+    uint32_t numSamples = 0;
+    uint32_t reserved = 0;
+    uint64_t dataOffset = 0; // Bytes from the start of the file
+  };
+
+  /** Bypass, the global parameters and harmony preset, then each voice's */
+  static constexpr int numParameterWords = 11 + DSPConfig::maxHarmonyVoices * 10;
+
+  static_assert(std::is_trivially_copyable_v<FileHeader> && std::is_trivially_copyable_v<BlockEntry>,
+                "Header and table are written to disk as raw bytes");
+
+  /** Size the plugin keeps its cache directory within (a stereo 48kHz minute is 46MB) */
+  static constexpr juce::int64 defaultMaxBytes = juce::int64(8192) << 20;
+
+  /** <user application data>/NovaTune/RenderCache */
+  static juce::File getDefaultDirectory();
+
+  explicit RenderCache(const juce::File &directory = getDefaultDirectory());
+
+  /** Delete least recently used renders until the directory is within maxBytes */
+  void trim(juce::int64 maxBytes) const;
+
+  const juce::File &getDirectory() const noexcept { return directory; }
+
+  /** Everything a render's output depends on besides its input and parameters */
+  struct Configuration {
+    double sampleRate = 44100.0;
+    int numChannels = 2;
+    int maxBlockSize = 512;
+    juce::int64 seed = 0;
+    juce::int64 timelineStart = 0;
+    bool renderQuality = false;
+  };
+
+  /**
+   * One render through one engine. Replaces the engine's process() call
+   * for every block of the render; the render ends at finish() (or when
+   * the session is destroyed).
+   */
+  class Session {
+  public:
+    /** `engine` must already be prepared for `configuration` */
+    Session(const RenderCache &cache, TunerEngine &engine, const Configuration &configuration);
+    ~Session();
+
+    /**
+     * Produce the output for `buffer` in place: from the cache while a
+     * stored render agrees, otherwise by processing it (or passing it
+     * through, when bypassed).
+     */
+    void process(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midi, const EngineParameters &params,
+                 bool bypassed);
+
+    /** Store what was rendered (if anything new was) and trim the cache */
+    void finish();
+
+    int getNumBlocks() const noexcept { return blockIndex; }
+    int getNumHits() const noexcept { return numHits; }
+
+  private:
+    struct MappedRender;
+
+    const RenderCache &cache;
+    TunerEngine &engine;
+    Configuration configuration;
+    bool finished = false;
+
+    // Chain state
+    PitchAnalysisCache::ContentHash blockHash;
+    Key firstKey = {};
+    Key lastKey = {}; // The previous block's (the configuration's, before the first)
+    int blockIndex = 0;
+    int numHits = 0;
+
+    // Stored renders still agreeing with this one (most recently used first)
+    std::vector<std::unique_ptr<MappedRender>> candidates;
+
+    // The engine skipped the hits, so its state is behind the render
+    bool engineStale = false;
+    bool diverged = false;
+
+    // This block's parameter snapshot, and its input while it is processed
+    uint64_t parameterWords[numParameterWords] = {};
+    juce::AudioBuffer<float> inputCopy;
+
+    // Recording, from the first miss on
+    std::unique_ptr<juce::TemporaryFile> recordingFile;
+    std::unique_ptr<juce::FileOutputStream> recording;
+    std::vector<BlockEntry> table;
+    uint64_t recordedSamples = 0;
+
+    Key chainKey(const juce::AudioBuffer<float> &buffer, const EngineParameters &params, bool bypassed);
+    void findCandidates();
+    void diverge();
+    void catchUp(const MappedRender &source);
+    void startRecording(const MappedRender *source);
+    void record(const Key &key, const juce::AudioBuffer<float> &output);
+    void stopRecording();
+  };
+
+private:
+  juce::File directory;
+};
@@ -0,0 +1,144 @@
+#include "StateFormat.h"
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <cstring>
+
+/**
+ * StateFormat.cpp
+ *
+ * Binary state writer and reader, with the legacy XML fallback.
+ */
+
+namespace {
+
+  // APVTS's names for a parameter entry
+  const juce::Identifier parameterType("PARAM");
+  const juce::Identifier idProperty("id");
+  const juce::Identifier valueProperty("value");
+
+  /** An APVTS parameter entry that fits the table (an ID of up to 255 bytes and a number) */
+  bool isParameterEntry(const juce::ValueTree &child) {
+    return child.hasType(parameterType) && child.getNumProperties() == 2 && child.getNumChildren() == 0 &&
+           child.getProperty(idProperty).isString() && child.getProperty(idProperty).toString().getNumBytesAsUTF8() <= 255 &&
+           (child.getProperty(valueProperty).isDouble() || child.getProperty(valueProperty).isInt());
+  }
+
+} // namespace
+
+//==============================================================================
+// WRITING
+//==============================================================================
+
+void StateFormat::write(const juce::ValueTree &state, juce::MemoryBlock &dest) {
+  Header header;
+  header.numProperties = static_cast<uint32_t>(state.getNumProperties());
+
+  for (const auto &child : state) {
+    if (isParameterEntry(child))
+      ++header.numParameters;
+    else
+      ++header.numOtherChildren;
+  }
+
+  // About 20 bytes a parameter; one allocation for a typical state
+  dest.setSize(0);
+  dest.ensureSize(sizeof(header) + 64 + header.numParameters * 24u);
+
+  juce::MemoryOutputStream stream(dest, false);
+  stream.write(&header, sizeof(header));
+  stream.writeString(state.getType().toString());
+
+  for (const auto &child : state) {
+    if (!isParameterEntry(child))
+      continue;
+
+    const auto id = child.getProperty(idProperty).toString().toRawUTF8();
+    const auto length = std::strlen(id);
+
+    stream.writeByte(static_cast<char>(length));
+    stream.write(id, length);
+    stream.writeFloat(static_cast<float>(child.getProperty(valueProperty)));
+  }
+
+  for (int i = 0; i < state.getNumProperties(); ++i) {
+    const auto name = state.getPropertyName(i);
+    stream.writeString(name.toString());
+    state.getProperty(name).writeToStream(stream);
+  }
+
+  for (const auto &child : state)
+    if (!isParameterEntry(child))
+      child.writeToStream(stream);
+
+  stream.flush();
+}
+
+//==============================================================================
+// READING
+//==============================================================================
+
+bool StateFormat::isBinary(const void *data, int sizeInBytes) noexcept {
+  return data != nullptr && sizeInBytes >= static_cast<int>(sizeof(Header)) &&
+         std::memcmp(data, Header().magic, sizeof(Header::magic)) == 0;
+}
+
+juce::ValueTree StateFormat::read(const void *data, int sizeInBytes) {
+  if (!isBinary(data, sizeInBytes)) {
+    // Legacy: XML, as copyXmlToBinary stored it
+    if (auto xml = juce::AudioProcessor::getXmlFromBinary(data, sizeInBytes))
+      return juce::ValueTree::fromXml(*xml);
+
+    return {};
+  }
+
+  Header header;
+  std::memcpy(&header, data, sizeof(header));
+
+  if (header.version > Header().version)
+    return {};
+
+  juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+  stream.skipNextBytes(sizeof(header));
+
+  const auto type = stream.readString();
+
+  if (type.isEmpty())
+    return {};
+
+  juce::ValueTree state(type);
+  char id[256];
+
+  for (uint32_t i = 0; i < header.numParameters; ++i) {
+    const auto length = static_cast<uint8_t>(stream.readByte());
+
+    if (stream.read(id, length) != length || stream.getNumBytesRemaining() < 4)
+      return {};
+
+    id[length] = 0;
+
+    const float value = stream.readFloat();
+    juce::ValueTree parameter(parameterType);
+    parameter.setProperty(idProperty, juce::String::fromUTF8(id, length), nullptr);
+    parameter.setProperty(valueProperty, value, nullptr);
+    state.appendChild(parameter, nullptr);
+  }
+
+  for (uint32_t i = 0; i < header.numProperties; ++i) {
+    const auto name = stream.readString();
+
+    if (name.isEmpty() || stream.isExhausted())
+      return {};
+
+    state.setProperty(name, juce::var::readFromStream(stream), nullptr);
+  }
+
+  for (uint32_t i = 0; i < header.numOtherChildren; ++i) {
+    auto child = juce::ValueTree::readFromStream(stream);
+
+    if (!child.isValid())
+      return {};
+
+    state.appendChild(child, nullptr);
+  }
+
+  return state;
+}
@@ -0,0 +1,186 @@
+#include "TelemetryRecorder.h"
+
+/**
+ * TelemetryRecorder.cpp
+ *
+ * Ring buffer, writer thread and file reader for the telemetry recorder.
+ */
+
+//==============================================================================
+// WRITER THREAD
+//==============================================================================
+
+class TelemetryRecorder::WriterThread : public juce::Thread {
+public:
+  explicit WriterThread(TelemetryRecorder &ownerToUse)
+      : juce::Thread("NovaTune Telemetry"),
+        owner(ownerToUse) {}
+
+  void run() override {
+    while (!threadShouldExit()) {
+      owner.drain();
+      wait(50);
+    }
+  }
+
+private:
+  TelemetryRecorder &owner;
+};
+
+//==============================================================================
+// CONSTRUCTION
+//==============================================================================
+
+TelemetryRecorder::TelemetryRecorder()
+    : ring(static_cast<size_t>(ringCapacity)),
+      ringSessions(static_cast<size_t>(ringCapacity)) {
+}
+
+TelemetryRecorder::~TelemetryRecorder() {
+  stop();
+}
+
+//==============================================================================
+// CONTROL
+//==============================================================================
+
+bool TelemetryRecorder::start(const juce::File &file) {
+  stop();
+
+  file.getParentDirectory().createDirectory();
+  file.deleteFile();
+
+  auto stream = std::make_unique<juce::FileOutputStream>(file);
+  if (!stream->openedOk())
+    return false;
+
+  const FileHeader header;
+  stream->write(&header, sizeof(header));
+
+  output = std::move(stream);
+  currentFile = file;
+  totalDropped.store(0, std::memory_order_relaxed);
+
+  // Anything still queued from the last session no longer matches
+  session.fetch_add(1, std::memory_order_release);
+
+  writer = std::make_unique<WriterThread>(*this);
+  writer->startThread(juce::Thread::Priority::low);
+
+  recording.store(true, std::memory_order_release);
+  return true;
+}
+
+void TelemetryRecorder::stop() {
+  if (writer == nullptr)
+    return;
+
+  recording.store(false, std::memory_order_release);
+
+  writer->stopThread(1000);
+  writer.reset();
+
+  // Whatever the audio thread queued before it saw the flag
+  drain();
+
+  output->flush();
+  output.reset();
+}
+
+//==============================================================================
+// AUDIO THREAD
+//==============================================================================
+
+void TelemetryRecorder::push(const TelemetryFrame &frame) noexcept {
+  // Read before the flag: a push that straddles stop() and start() keeps
+  // the old session, so its frame is dropped rather than misfiled
+  const uint32_t currentSession = session.load(std::memory_order_acquire);
+
+  if (!isRecording())
+    return;
+
+  if (currentSession != pushSession) {
+    // Drops counted in the last session don't belong to this one
+    pushSession = currentSession;
+    droppedSinceLastPush = 0;
+  }
+
+  const auto scope = fifo.write(1);
+
+  if (scope.blockSize1 == 0) {
+    // Ring full - the writer will hear about it from the next frame
+    ++droppedSinceLastPush;
+    totalDropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  auto &slot = ring[static_cast<size_t>(scope.startIndex1)];
+  slot = frame;
+  slot.droppedBefore = droppedSinceLastPush;
+  ringSessions[static_cast<size_t>(scope.startIndex1)] = currentSession;
+  droppedSinceLastPush = 0;
+}
+
+//==============================================================================
+// WRITER
+//==============================================================================
+
+void TelemetryRecorder::drain() {
+  const uint32_t currentSession = session.load(std::memory_order_acquire);
+  const auto scope = fifo.read(fifo.getNumReady());
+
+  // Frames from an earlier session are read out of the ring and dropped
+  auto writeFrames = [&](int start, int size) {
+    for (auto i = static_cast<size_t>(start); i < static_cast<size_t>(start + size); ++i)
+      if (ringSessions[i] == currentSession)
+        output->write(&ring[i], sizeof(TelemetryFrame));
+  };
+
+  writeFrames(scope.startIndex1, scope.blockSize1);
+  writeFrames(scope.startIndex2, scope.blockSize2);
+}
+
+//==============================================================================
+// READING
+//==============================================================================
+
+bool TelemetryRecorder::readFile(const juce::File &file, std::vector<TelemetryFrame> &frames, juce::String &error) {
+  juce::FileInputStream input(file);
+
+  if (!input.openedOk()) {
+    error = "can't open " + file.getFullPathName();
+    return false;
+  }
+
+  FileHeader header;
+  if (input.read(&header, sizeof(header)) != static_cast<int>(sizeof(header)) ||
+      std::memcmp(header.magic, FileHeader().magic, sizeof(header.magic)) != 0) {
+    error = file.getFileName() + " is not a NovaTune telemetry file";
+    return false;
+  }
+
+  if (header.frameSize < sizeof(TelemetryFrame) || header.numStages != StageProfiler::numStages) {
+    error = file.getFileName() + " was written with an incompatible frame layout";
+    return false;
+  }
+
+  const auto payload = input.getTotalLength() - input.getPosition();
+  const auto numFrames = payload / header.frameSize;
+
+  frames.clear();
+  frames.reserve(static_cast<size_t>(numFrames));
+
+  juce::HeapBlock<char> record(header.frameSize);
+
+  // A truncated final record (e.g. after a crash) is ignored
+  for (juce::int64 i = 0; i < numFrames; ++i) {
+    if (input.read(record.get(), static_cast<int>(header.frameSize)) != static_cast<int>(header.frameSize))
+      break;
+
+    TelemetryFrame frame;
+    std::memcpy(&frame, record.get(), sizeof(frame));
+    frames.push_back(frame);
+  }
+
+  return true;
+}
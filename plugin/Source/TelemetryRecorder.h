@@ -0,0 +1,161 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <vector>
+#include "DSPConfig.h"
+#include "dsp/StageProfiler.h"
+
+/**
+ * TelemetryRecorder.h
+ *
+ * Opt-in flight recorder for the audio thread: one compact record per
+ * processed block, streamed to a binary file.
+ *
+ * WHY?
+ * Tuning glitches in real sessions are intermittent and hard to
+ * reproduce. With the recorder on, the session leaves a trace of what the
+ * engine saw and did every block - detected f0 and confidence, target
+ * note, lead and harmony ratios, stage timings, block-size changes - so a
+ * glitch at 2:13 can be looked up instead of guessed at.
+ *
+ * HOW IT WORKS:
+ *
+ *   Audio thread                      Writer thread (juce::Thread)
+ *   ────────────                      ────────────────────────────
+ *   push(frame) ──► [ SPSC ring ] ──► drain every 50ms ──► .nttl file
+ *
+ * - push() is wait-free: a copy into a juce::AbstractFifo slot. If the
+ *   ring is full the frame is dropped and counted (the next frame that
+ *   gets through carries the count), so the audio thread never waits
+ * - The writer thread owns the file; nothing on the audio thread touches
+ *   the disk or allocates
+ *
+ * FILE FORMAT (.nttl, little-endian):
+ *   FileHeader, then TelemetryFrame records back to back. The header
+ *   stores the frame size, so readers can skip fields they don't know.
+ *   Tools/TelemetryDump converts a file to CSV/JSON.
+ *
+ * ANALOGY: Like an aircraft's flight data recorder - always cheap enough
+ * to leave on, only read after something went wrong.
+ */
+
+//==============================================================================
+// RECORD LAYOUT
+//==============================================================================
+
+/** One processed block */
+struct TelemetryFrame {
+  enum Flags : uint32_t {
+    voiced = 1u << 0,
+    blockSizeChanged = 1u << 1, // Host block size differs from the previous block
+    guardLevelMask = 0xfu << 8, // CPU guard level the block ran at (CpuGuard::Level)
+  };
+
+  static constexpr uint32_t guardLevelShift = 8;
+
+  int getGuardLevel() const noexcept { return static_cast<int>((flags & guardLevelMask) >> guardLevelShift); }
+
+  uint64_t samplePosition = 0; // Samples processed since recording started
+  float sampleRate = 0.0f;
+  uint32_t blockSize = 0;
+  uint32_t flags = 0;
+  uint32_t droppedBefore = 0;  // Frames lost to a full ring just before this one
+
+  float detectedHz = 0.0f;     // 0 when unvoiced
+  float confidence = 0.0f;
+  float targetMidiNote = 0.0f;
+  float leadRatio = 1.0f;
+  float voiceRatios[DSPConfig::maxHarmonyVoices] = {};
+
+  float stageMicros[StageProfiler::numStages] = {};
+  float blockMicros = 0.0f;    // Whole processBlock
+};
+
+static_assert(std::is_trivially_copyable_v<TelemetryFrame>, "Frames are written to disk as raw bytes");
+
+//==============================================================================
+// RECORDER
+//==============================================================================
+
+class TelemetryRecorder {
+public:
+  /** First bytes of every .nttl file */
+  struct FileHeader {
+    char magic[4] = {'N', 'T', 'T', 'L'};
+    uint32_t version = 1;
+    uint32_t frameSize = sizeof(TelemetryFrame);
+    uint32_t numStages = StageProfiler::numStages;
+  };
+
+  /** ~3 seconds of 64-sample blocks at 48kHz */
+  static constexpr int ringCapacity = 2048;
+
+  TelemetryRecorder();
+  ~TelemetryRecorder();
+
+  //==========================================================================
+  // CONTROL (message thread)
+  //==========================================================================
+
+  /**
+   * Create the file, write the header and start recording.
+   * Returns false (and leaves recording off) if the file can't be opened.
+   */
+  bool start(const juce::File &file);
+
+  /** Stop recording, write out whatever is still queued and close the file */
+  void stop();
+
+  bool isRecording() const noexcept { return recording.load(std::memory_order_relaxed); }
+
+  /** The file being (or last) recorded */
+  juce::File getFile() const { return currentFile; }
+
+  /** Frames dropped because the writer fell behind, since start() */
+  uint64_t getNumDropped() const noexcept { return totalDropped.load(std::memory_order_relaxed); }
+
+  //==========================================================================
+  // AUDIO THREAD
+  //==========================================================================
+
+  /** Queue a frame. Wait-free; drops (and counts) the frame if the ring is full. */
+  void push(const TelemetryFrame &frame) noexcept;
+
+  //==========================================================================
+  // READING
+  //==========================================================================
+
+  /**
+   * Read a .nttl file. Frames written by a newer version (larger frame
+   * size) are truncated to the fields this build knows.
+   */
+  static bool readFile(const juce::File &file, std::vector<TelemetryFrame> &frames, juce::String &error);
+
+private:
+  class WriterThread;
+
+  std::atomic<bool> recording{false};
+  juce::File currentFile;
+
+  // Bumped by start(). Each queued frame carries the session it was pushed
+  // in, so one that raced stop() and landed after the final drain is
+  // dropped instead of opening the next file.
+  std::atomic<uint32_t> session{0};
+
+  juce::AbstractFifo fifo{ringCapacity};
+  std::vector<TelemetryFrame> ring;
+  std::vector<uint32_t> ringSessions; // Session of each ring slot's frame
+
+  uint32_t droppedSinceLastPush = 0; // Audio thread only
+  uint32_t pushSession = 0;          // Audio thread only
+  std::atomic<uint64_t> totalDropped{0};
+
+  std::unique_ptr<juce::FileOutputStream> output;
+  std::unique_ptr<WriterThread> writer;
+
+  /** Move queued frames to the file (writer thread, or stop() once the writer is gone) */
+  void drain();
+
+  JUCE_DECLARE_NON_COPYABLE(TelemetryRecorder)
+};
@@ -0,0 +1,240 @@
+#include "NovaTuneBatch.h"
+#include "../dsp/TunerEngine.h"
+#include <algorithm>
+#include <vector>
+
+/**
+ * NovaTuneBatch.cpp
+ *
+ * Lockstep pitch analysis across streams, then per-stream processing.
+ */
+
+static_assert(NovaTuneBatch::maxHarmonyVoices == DSPConfig::maxHarmonyVoices,
+              "NovaTuneBatch::VoiceSettings must cover every harmony voice");
+
+namespace {
+
+  template <typename Enum>
+  Enum toEnum(int value, Enum count) {
+    return static_cast<Enum>(std::clamp(value, 0, static_cast<int>(count) - 1));
+  }
+
+  EngineParameters toEngineParameters(const NovaTuneBatch::Settings &settings) {
+    EngineParameters params;
+    params.key = toEnum(settings.key, NovaTuneEnums::Key::numKeys);
+    params.scale = toEnum(settings.scale, NovaTuneEnums::Scale::numScales);
+    params.inputType = toEnum(settings.inputType, NovaTuneEnums::InputType::numInputTypes);
+
+    // Offline: blocks have no deadline, so the guard never degrades anyway
+    params.cpuGuard = NovaTuneEnums::CpuGuardMode::Off;
+
+    params.retuneSpeed = std::clamp(settings.retuneSpeed, 0.0f, 100.0f);
+    params.humanize = std::clamp(settings.humanize, 0.0f, 100.0f);
+    params.vibratoAmount = std::clamp(settings.vibratoAmount, 0.0f, 100.0f);
+    params.mixPercent = std::clamp(settings.mixPercent, 0.0f, 100.0f);
+
+    for (int i = 0; i < DSPConfig::maxHarmonyVoices; ++i) {
+      const auto &voice = settings.voices[i];
+      auto &target = params.voices[static_cast<size_t>(i)];
+
+      target.enabled = voice.enabled;
+      target.mode = voice.semitoneMode ? NovaTuneEnums::HarmonyMode::Semitone : NovaTuneEnums::HarmonyMode::Diatonic;
+      target.diatonicIntervalIndex = std::clamp(voice.diatonicInterval, -7, 7) + 7;
+      target.semitoneOffset = std::clamp(voice.semitoneOffset, -12, 12);
+      target.levelDb = voice.levelDb;
+      target.pan = std::clamp(voice.pan, -1.0f, 1.0f);
+      target.formantShift = voice.formantShift;
+      target.humanizeTimingMs = std::max(0.0f, voice.humanizeTimingMs);
+      target.humanizePitchCents = std::max(0.0f, voice.humanizePitchCents);
+    }
+
+    return params;
+  }
+
+} // namespace
+
+//==============================================================================
+// STATE
+//==============================================================================
+
+struct NovaTuneBatch::Impl {
+  struct Stream {
+    TunerEngine engine;
+    EngineParameters params;
+  };
+
+  int maxBlockSize = 0;
+  std::vector<std::unique_ptr<Stream>> streams;
+
+  // Kernel input and output, [sample][lane] (see computeDifferenceFunctionLanes)
+  int frameSize = 0;
+  std::vector<float> frames;
+  std::vector<float> difference;
+
+  // Per-call bookkeeping, indexed like the blocks (sized once, no allocation per call)
+  std::vector<int> position;    // Samples pushed into the stream's detector
+  std::vector<int> hopOffset;   // Sample in the block at which its due hop fired
+  std::vector<int> due;         // Blocks with a hop waiting for the kernel
+  std::vector<char> listed;     // Per stream: already named in this call
+
+  PitchDetector &detectorFor(const StreamBlock &block) {
+    return streams[static_cast<size_t>(block.stream)]->engine.getPitchDetector();
+  }
+
+  /** Steps 1-3: run every block's pitch analysis, kernelLanes streams per kernel pass */
+  void analyse(const StreamBlock *blocks, int numBlocks, int numSamples) {
+    constexpr int lanes = PitchDetector::kernelLanes;
+
+    std::fill(position.begin(), position.begin() + numBlocks, 0);
+
+    for (;;) {
+      due.clear();
+
+      // Advance each stream to its next hop (or the end of the block)
+      for (int b = 0; b < numBlocks; ++b) {
+        const int pos = position[static_cast<size_t>(b)];
+
+        if (pos >= numSamples)
+          continue;
+
+        auto &detector = detectorFor(blocks[b]);
+        const int n = std::min(numSamples - pos, detector.getSamplesUntilNextHop());
+
+        if (detector.push(blocks[b].input + pos, n)) {
+          hopOffset[static_cast<size_t>(b)] = pos + n - 1;
+          due.push_back(b);
+        }
+
+        position[static_cast<size_t>(b)] = pos + n;
+      }
+
+      if (due.empty())
+        break;
+
+      // Due hops, a kernel's worth at a time; spare lanes analyse silence
+      for (size_t first = 0; first < due.size(); first += lanes) {
+        const int used = static_cast<int>(std::min(due.size() - first, static_cast<size_t>(lanes)));
+
+        for (int lane = 0; lane < lanes; ++lane) {
+          if (lane < used)
+            detectorFor(blocks[due[first + static_cast<size_t>(lane)]]).gatherFrame(frames.data() + lane, lanes);
+          else
+            for (int j = 0; j < frameSize; ++j)
+              frames[static_cast<size_t>(j * lanes + lane)] = 0.0f;
+        }
+
+        PitchDetector::computeDifferenceFunctionLanes(frames.data(), frameSize, difference.data());
+
+        for (int lane = 0; lane < used; ++lane) {
+          const int b = due[first + static_cast<size_t>(lane)];
+          detectorFor(blocks[b]).analyseHopFrom(hopOffset[static_cast<size_t>(b)], difference.data() + lane, lanes);
+        }
+      }
+    }
+  }
+};
+
+//==============================================================================
+// CONSTRUCTION
+//==============================================================================
+
+NovaTuneBatch::NovaTuneBatch(double sampleRate, int maxBlockSize, int numStreams) : impl(std::make_unique<Impl>()) {
+  impl->maxBlockSize = std::max(1, maxBlockSize);
+
+  const auto count = static_cast<size_t>(std::max(0, numStreams));
+  impl->streams.reserve(count);
+
+  for (size_t i = 0; i < count; ++i) {
+    auto stream = std::make_unique<Impl::Stream>();
+    stream->engine.setNonRealtime(true);
+    stream->engine.prepare(sampleRate, impl->maxBlockSize, 1);
+    impl->streams.push_back(std::move(stream));
+  }
+
+  // Same rate and frame duration everywhere, so one frame size for all
+  impl->frameSize = impl->streams.empty() ? 0 : impl->streams.front()->engine.getPitchDetector().getFrameSize();
+  impl->frames.resize(static_cast<size_t>(impl->frameSize * PitchDetector::kernelLanes));
+  impl->difference.resize(static_cast<size_t>(impl->frameSize / 2 * PitchDetector::kernelLanes));
+
+  impl->position.resize(count);
+  impl->hopOffset.resize(count);
+  impl->due.reserve(count);
+  impl->listed.resize(count);
+
+  for (int i = 0; i < numStreams; ++i)
+    resetStream(i);
+}
+
+NovaTuneBatch::~NovaTuneBatch() = default;
+
+void NovaTuneBatch::resetStream(int stream, std::int64_t seed) {
+  if (stream < 0 || stream >= getNumStreams())
+    return;
+
+  auto &engine = impl->streams[static_cast<size_t>(stream)]->engine;
+  engine.setRandomSeed(seed);
+  engine.setTimelineStart(0);
+  engine.reset();
+}
+
+//==============================================================================
+// PROCESSING
+//==============================================================================
+
+bool NovaTuneBatch::process(const StreamBlock *blocks, int numBlocks, int numSamples) {
+  if (numBlocks <= 0)
+    return numBlocks == 0;
+
+  if (blocks == nullptr || numBlocks > getNumStreams() || numSamples <= 0 || numSamples > impl->maxBlockSize)
+    return false;
+
+  // Validate everything before touching any stream
+  std::fill(impl->listed.begin(), impl->listed.end(), 0);
+
+  for (int b = 0; b < numBlocks; ++b) {
+    const auto &block = blocks[b];
+
+    if (block.stream < 0 || block.stream >= getNumStreams() || block.input == nullptr || block.output == nullptr ||
+        impl->listed[static_cast<size_t>(block.stream)] != 0)
+      return false;
+
+    impl->listed[static_cast<size_t>(block.stream)] = 1;
+  }
+
+  // This block's parameters first: the detector needs its input type and hop
+  for (int b = 0; b < numBlocks; ++b) {
+    auto &stream = *impl->streams[static_cast<size_t>(blocks[b].stream)];
+    stream.params = toEngineParameters(blocks[b].settings != nullptr ? *blocks[b].settings : Settings{});
+    stream.engine.updateFromParameters(stream.params);
+    stream.engine.getPitchDetector().beginBlock();
+  }
+
+  impl->analyse(blocks, numBlocks, numSamples);
+
+  // Step 4: the rest of the engine, one stream at a time, in place on the output
+  for (int b = 0; b < numBlocks; ++b) {
+    const auto &block = blocks[b];
+    auto &stream = *impl->streams[static_cast<size_t>(block.stream)];
+
+    if (block.output != block.input)
+      std::copy(block.input, block.input + numSamples, block.output);
+
+    float *channels[] = {block.output};
+    juce::AudioBuffer<float> buffer(channels, 1, numSamples);
+    stream.engine.processAnalysed(buffer, stream.params);
+  }
+
+  return true;
+}
+
+//==============================================================================
+// INFO
+//==============================================================================
+
+int NovaTuneBatch::getLatencySamples() const {
+  return impl->streams.empty() ? 0 : impl->streams.front()->engine.getLatencySamples();
+}
+
+int NovaTuneBatch::getNumStreams() const { return static_cast<int>(impl->streams.size()); }
+
+int NovaTuneBatch::getStreamsPerKernel() { return PitchDetector::kernelLanes; }
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+/**
+ * NovaTuneBatch.h
+ *
+ * The public API of the NovaTuneDSP library: tune many independent mono
+ * streams in one call, with no plugin host, GUI or JUCE headers.
+ *
+ * WHY A BATCH API?
+ * Server-side tuning runs thousands of short clips. Pushing each one
+ * through its own plugin instance spends much of the machine on per-call
+ * overhead, and analyses every stream's pitch on its own. Here one call
+ * takes a block from K streams, each with its own settings, and computes
+ * the detector's difference function - most of the detection cost - for
+ * getStreamsPerKernel() streams at once with SIMD.
+ *
+ * HOW IT WORKS:
+ * Each stream owns a mono TunerEngine. For each call:
+ * 1. Every stream's input is pushed into its detector up to its next hop
+ * 2. The frames of all streams with a hop due are laid out [sample][lane]
+ *    (structure of arrays) and one vector kernel computes their difference
+ *    functions (PitchDetector::computeDifferenceFunctionLanes)
+ * 3. Each stream finishes its hop; steps 1-3 repeat to the end of the block
+ * 4. Each stream's mapper, shifters and mixer run from those hops
+ *
+ * Every stream's output is the same as a TunerEngine processing it alone.
+ * The shifters stay per stream: WSOLA's grain search and splice points
+ * follow each stream's own pitch, so lanes would diverge at every grain.
+ *
+ * THREADING:
+ * A batch is used from one thread at a time. Batches share no state, so
+ * a server runs one per worker thread.
+ *
+ * ANALOGY: Like one `WHERE id IN (...)` query instead of a round trip per row.
+ */
+class NovaTuneBatch {
+public:
+  static constexpr int maxHarmonyVoices = 3;
+
+  /** One harmony voice. Defaults match the plugin's. */
+  struct VoiceSettings {
+    bool enabled = false;
+    bool semitoneMode = false;    // false = diatonic interval, true = fixed semitones
+    int diatonicInterval = 0;     // Scale degrees, -7 to +7
+    int semitoneOffset = 0;       // -12 to +12
+    float levelDb = -12.0f;
+    float pan = 0.0f;             // -1 to +1; mono streams get the left gain, as in a mono plugin instance
+    float formantShift = 0.0f;    // Semitones
+    float humanizeTimingMs = 5.0f;
+    float humanizePitchCents = 3.0f;
+  };
+
+  /** One stream's parameter snapshot. Defaults match the plugin's. */
+  struct Settings {
+    int key = 0;                  // 0 = C ... 11 = B
+    int scale = 0;                // Major, Natural Minor, Harmonic Minor, Melodic Minor, Chromatic
+    int inputType = 1;            // Soprano, Alto/Tenor, Low Male, Instrument
+
+    float retuneSpeed = 50.0f;    // 0-100
+    float humanize = 25.0f;       // 0-100
+    float vibratoAmount = 0.0f;   // 0-100
+    float mixPercent = 100.0f;    // 0-100
+
+    VoiceSettings voices[maxHarmonyVoices];
+  };
+
+  /** One stream's block in a process() call */
+  struct StreamBlock {
+    int stream = 0;
+    const float *input = nullptr;         // numSamples mono samples
+    float *output = nullptr;              // numSamples; may equal input
+    const Settings *settings = nullptr;   // nullptr = defaults
+  };
+
+  /**
+   * @param sampleRate Shared by every stream
+   * @param maxBlockSize Largest numSamples passed to process()
+   * @param numStreams Streams 0..numStreams-1, each with its own state
+   */
+  NovaTuneBatch(double sampleRate, int maxBlockSize, int numStreams);
+  ~NovaTuneBatch();
+
+  NovaTuneBatch(const NovaTuneBatch &) = delete;
+  NovaTuneBatch &operator=(const NovaTuneBatch &) = delete;
+
+  /**
+   * Clear a stream's state to start a new clip. Humanization is seeded, so
+   * a clip rendered twice with the same seed and settings is identical.
+   */
+  void resetStream(int stream, std::int64_t seed = 1);
+
+  /**
+   * Process one block of numSamples for each of `blocks`. Streams not
+   * listed keep their state untouched.
+   *
+   * Keep numSamples fixed between calls: like a host changing its block
+   * size, a new size re-prepares the shifters.
+   *
+   * @return false (and nothing is processed) if a block names an unknown
+   *         or repeated stream, lacks a buffer, or numSamples is out of range
+   */
+  bool process(const StreamBlock *blocks, int numBlocks, int numSamples);
+
+  /** Output delay in samples (the same for every stream) */
+  int getLatencySamples() const;
+
+  int getNumStreams() const;
+
+  /** Streams whose pitch analysis shares one pass of the vector kernel */
+  static int getStreamsPerKernel();
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl;
+};
@@ -0,0 +1,118 @@
+#include "BlockTimeHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * BlockTimeHistogram.cpp
+ *
+ * Bucketing and percentile queries for the block-time histogram.
+ */
+
+//==============================================================================
+// BUCKETS
+//==============================================================================
+
+int BlockTimeHistogram::getBucketIndex(double ratio) noexcept {
+  // Bucket 0 = underflow, 1..numBuckets-2 = log buckets, last = overflow
+  if (!(ratio > 0.0))
+    return 0;
+
+  const double position = (std::log2(ratio) - minExponent) * bucketsPerOctave;
+
+  if (position < 0.0)
+    return 0;
+
+  return std::min(numBuckets - 1, 1 + static_cast<int>(position));
+}
+
+double BlockTimeHistogram::getBucketLowerEdge(int bucket) noexcept {
+  if (bucket <= 0)
+    return 0.0;
+
+  return std::exp2(minExponent + static_cast<double>(bucket - 1) / bucketsPerOctave);
+}
+
+double BlockTimeHistogram::getBucketUpperEdge(int bucket) noexcept {
+  if (bucket >= numBuckets - 1)
+    return HUGE_VAL;
+
+  return std::exp2(minExponent + static_cast<double>(bucket) / bucketsPerOctave);
+}
+
+//==============================================================================
+// RECORDING (audio thread)
+//==============================================================================
+
+void BlockTimeHistogram::record(double elapsedNanos, double deadlineNanos) noexcept {
+  // Single writer: plain load/store instead of read-modify-write
+  if (resetRequested.load(std::memory_order_relaxed)) {
+    resetRequested.store(false, std::memory_order_relaxed);
+
+    for (auto &count : counts)
+      count.store(0, std::memory_order_relaxed);
+
+    totalBlocks.store(0, std::memory_order_relaxed);
+    maxRatio.store(0.0, std::memory_order_relaxed);
+  }
+
+  if (deadlineNanos <= 0.0)
+    return;
+
+  const double ratio = elapsedNanos / deadlineNanos;
+  auto &count = counts[static_cast<size_t>(getBucketIndex(ratio))];
+
+  count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  totalBlocks.store(totalBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+  if (ratio > maxRatio.load(std::memory_order_relaxed))
+    maxRatio.store(ratio, std::memory_order_relaxed);
+}
+
+//==============================================================================
+// QUERIES
+//==============================================================================
+
+BlockTimeHistogram::Snapshot BlockTimeHistogram::getSnapshot() const noexcept {
+  Snapshot snapshot;
+
+  // Sum the buckets rather than reading totalBlocks, so the snapshot is
+  // self-consistent even if a block was recorded mid-copy
+  for (size_t i = 0; i < counts.size(); ++i) {
+    snapshot.counts[i] = counts[i].load(std::memory_order_relaxed);
+    snapshot.totalBlocks += snapshot.counts[i];
+  }
+
+  snapshot.maxRatio = maxRatio.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+double BlockTimeHistogram::Snapshot::percentile(double fraction) const noexcept {
+  if (totalBlocks == 0)
+    return 0.0;
+
+  const auto rank = static_cast<uint64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(totalBlocks)));
+  uint64_t cumulative = 0;
+
+  for (int i = 0; i < numBuckets; ++i) {
+    cumulative += counts[static_cast<size_t>(i)];
+
+    if (cumulative >= std::max<uint64_t>(rank, 1))
+      return std::min(getBucketUpperEdge(i), maxRatio);
+  }
+
+  return maxRatio;
+}
+
+double BlockTimeHistogram::Snapshot::getMissRate() const noexcept {
+  if (totalBlocks == 0)
+    return 0.0;
+
+  // 1.0 is a bucket edge (2^0), so everything from its bucket up missed
+  const int firstMissBucket = getBucketIndex(1.0);
+  uint64_t missed = 0;
+
+  for (int i = firstMissBucket; i < numBuckets; ++i)
+    missed += counts[static_cast<size_t>(i)];
+
+  return static_cast<double>(missed) / static_cast<double>(totalBlocks);
+}
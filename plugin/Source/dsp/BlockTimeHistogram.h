@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * BlockTimeHistogram.h
+ *
+ * Tail-latency tracking for processBlock: a log-bucketed histogram of
+ * block wall time, normalised to the block's real-time deadline.
+ *
+ * WHY NOT JUST AVERAGE CPU?
+ * A dropout is one block that misses its deadline. A plugin averaging 20%
+ * can still click if one block in a thousand takes 120%. NovaTune has
+ * obvious sources of those outliers - several detector hops landing in one
+ * block, the WSOLA grain loop catching up, formant filter recomputes - so
+ * we track the whole distribution and read the tail (p99, p99.9, max).
+ *
+ * BUCKETS:
+ * 8 buckets per octave from 1/1024 of the deadline (~0.1%) to 16x the
+ * deadline, plus an underflow and an overflow bucket. Each bucket spans
+ * ~9%, so percentiles are accurate to within one bucket. The exact
+ * maximum is tracked separately.
+ *
+ * ANALOGY: Like the p50/p99 latency histograms an API gateway keeps per
+ * route - the average request is fast, but the slow tail is what users
+ * notice.
+ *
+ * THREADING:
+ * One writer (the audio thread) records; any thread may take a Snapshot or
+ * request a reset. The reset is carried out by the writer on its next
+ * record, so counters only ever have one writer.
+ */
+class BlockTimeHistogram {
+public:
+  static constexpr int bucketsPerOctave = 8;
+  static constexpr int minExponent = -10; // 2^-10 of the deadline
+  static constexpr int maxExponent = 4;   // 2^4 = 16x the deadline
+  static constexpr int numBuckets = (maxExponent - minExponent) * bucketsPerOctave + 2;
+
+  using Clock = std::chrono::steady_clock;
+
+  //==========================================================================
+  // AUDIO THREAD
+  //==========================================================================
+
+  /** Record one block that took elapsedNanos against a deadline of deadlineNanos */
+  void record(double elapsedNanos, double deadlineNanos) noexcept;
+
+  /** Record a block of numSamples that started at `blockStart` */
+  void recordBlock(Clock::time_point blockStart, int numSamples, double sampleRate) noexcept {
+    if (sampleRate <= 0.0 || numSamples <= 0)
+      return;
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - blockStart).count();
+    record(static_cast<double>(elapsed), 1.0e9 * numSamples / sampleRate);
+  }
+
+  //==========================================================================
+  // ANY THREAD
+  //==========================================================================
+
+  /** Clear the histogram (applied by the writer on its next record) */
+  void requestReset() noexcept { resetRequested.store(true, std::memory_order_relaxed); }
+
+  /** A copy of the counters, with percentile queries */
+  struct Snapshot {
+    std::array<uint64_t, numBuckets> counts{};
+    uint64_t totalBlocks = 0;
+    double maxRatio = 0.0; // Slowest block / its deadline
+
+    /**
+     * Block time (as a fraction of the deadline) that `fraction` of blocks
+     * stayed within, e.g. percentile(0.99). Reported as the upper edge of
+     * the bucket it falls in, capped at the exact maximum.
+     */
+    double percentile(double fraction) const noexcept;
+
+    /** Fraction of blocks that missed their deadline (ratio > 1) */
+    double getMissRate() const noexcept;
+  };
+
+  Snapshot getSnapshot() const noexcept;
+
+  /** Bucket edges as fractions of the deadline (bucket 0 starts at 0) */
+  static double getBucketLowerEdge(int bucket) noexcept;
+  static double getBucketUpperEdge(int bucket) noexcept;
+
+private:
+  std::array<std::atomic<uint64_t>, numBuckets> counts{};
+  std::atomic<uint64_t> totalBlocks{0};
+  std::atomic<double> maxRatio{0.0};
+  std::atomic<bool> resetRequested{false};
+
+  static int getBucketIndex(double ratio) noexcept;
+};
@@ -0,0 +1,163 @@
+#include "CpuGuard.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * CpuGuard.cpp
+ *
+ * Load tracking and level decisions for the CPU guard.
+ */
+
+//==============================================================================
+// POLICY
+//==============================================================================
+
+CpuGuard::Policy CpuGuard::getPolicy(NovaTuneEnums::CpuGuardMode mode) noexcept {
+  Policy policy;
+
+  switch (mode) {
+    case NovaTuneEnums::CpuGuardMode::Off:
+      policy.enabled = false;
+      break;
+
+    case NovaTuneEnums::CpuGuardMode::Live:
+      // Act early: leave room for the host and other plugins
+      policy.raiseLoad = 0.6f;
+      policy.lowerLoad = 0.3f;
+      policy.overrunRatio = 0.9f;
+      policy.overrunsToRaise = 1;
+      break;
+
+    case NovaTuneEnums::CpuGuardMode::Studio:
+    case NovaTuneEnums::CpuGuardMode::numCpuGuardModes:
+      // Only step in when dropouts are actually happening
+      break;
+  }
+
+  return policy;
+}
+
+const char *CpuGuard::getLevelName(Level level) noexcept {
+  switch (level) {
+    case full:
+      return "Full quality";
+    case narrowSearch:
+      return "Narrow grain search";
+    case longerHop:
+      return "Longer detector hop";
+    case fewerBands:
+      return "Fewer formant bands";
+    case shedVoice:
+      return "Muting 1 harmony";
+    case shedVoices:
+      return "Muting harmonies";
+    case numLevels:
+      break;
+  }
+
+  return "?";
+}
+
+//==============================================================================
+// AUDIO THREAD
+//==============================================================================
+
+void CpuGuard::reset() noexcept {
+  load = 0.0;
+  now = 0.0;
+  lastChange = 0.0;
+  lastLower = -1.0e9;
+  belowSince = -1.0;
+  restoreHold = baseRestoreHoldSeconds;
+  overrunWindowStart = 0.0;
+  overrunsInWindow = 0;
+
+  setLevel(full);
+  publishedLoad.store(0.0f, std::memory_order_relaxed);
+}
+
+void CpuGuard::setMode(NovaTuneEnums::CpuGuardMode newMode) noexcept {
+  mode.store(newMode, std::memory_order_relaxed);
+}
+
+void CpuGuard::setLevel(Level newLevel) noexcept {
+  level = newLevel;
+  lastChange = now;
+  belowSince = -1.0;
+  publishedLevel.store(level, std::memory_order_relaxed);
+}
+
+CpuGuard::Level CpuGuard::update(double elapsedNanos, double deadlineNanos) noexcept {
+  if (deadlineNanos <= 0.0)
+    return level;
+
+  const double blockSeconds = deadlineNanos * 1.0e-9;
+  const double ratio = elapsedNanos / deadlineNanos;
+  now += blockSeconds;
+
+  // Time-based smoothing, so the response doesn't depend on the block size
+  const double alpha = 1.0 - std::exp(-blockSeconds / loadTimeConstantSeconds);
+  load += alpha * (ratio - load);
+  publishedLoad.store(static_cast<float>(load), std::memory_order_relaxed);
+
+  const auto policy = getPolicy(getMode());
+
+  if (!policy.enabled) {
+    if (level != full)
+      setLevel(full);
+
+    return level;
+  }
+
+  //==========================================================================
+  // RAISE
+  //==========================================================================
+
+  if (now - overrunWindowStart > overrunWindowSeconds) {
+    overrunWindowStart = now;
+    overrunsInWindow = 0;
+  }
+
+  if (ratio > policy.overrunRatio)
+    ++overrunsInWindow;
+
+  const bool overloaded = load > policy.raiseLoad || overrunsInWindow >= policy.overrunsToRaise;
+
+  if (overloaded) {
+    // Give the previous step a moment to show up in the measurements
+    if (level < numLevels - 1 && now - lastChange >= settleSeconds) {
+      if (now - lastLower < bounceWindowSeconds)
+        restoreHold = std::min(restoreHold * 2.0, maxRestoreHoldSeconds);
+
+      overrunsInWindow = 0;
+      setLevel(static_cast<Level>(level + 1));
+    }
+
+    belowSince = -1.0;
+    return level;
+  }
+
+  //==========================================================================
+  // LOWER
+  //==========================================================================
+
+  if (level == full || load >= policy.lowerLoad) {
+    belowSince = -1.0;
+
+    // A long stable stretch forgives earlier bounces
+    if (now - lastChange > maxRestoreHoldSeconds)
+      restoreHold = baseRestoreHoldSeconds;
+
+    return level;
+  }
+
+  if (belowSince < 0.0)
+    belowSince = now;
+
+  if (now - belowSince >= restoreHold) {
+    lastLower = now;
+    setLevel(static_cast<Level>(level - 1));
+  }
+
+  return level;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include "../ParameterIDs.h"
+
+/**
+ * CpuGuard.h
+ *
+ * CPU-budget-aware graceful degradation for the TunerEngine.
+ *
+ * WHY?
+ * When a session gets heavy (small buffers, many instances, a busy
+ * machine) the engine's block time creeps towards the deadline. Missing it
+ * is a dropout - a click on stage. It is better to sound slightly worse
+ * for a few seconds than to glitch, so the guard sheds work in a fixed
+ * order, cheapest-to-hear first, and restores it once headroom returns.
+ *
+ * LEVELS (each includes the ones above it):
+ *   0 full           Everything on
+ *   1 narrowSearch   WSOLA similarity search narrowed to 1/4 of its range
+ *   2 longerHop      Pitch detector analyses half as often
+ *   3 fewerBands     Upper half of the formant filter bands faded out
+ *   4 shedVoice      Lowest-priority harmony voice faded out
+ *   5 shedVoices     All harmony voices but the highest-priority one faded out
+ *
+ * Voice priority is panel order: A before B before C.
+ *
+ * POLICY:
+ * The guard watches the engine's own block time as a fraction of the
+ * block deadline (numSamples / sampleRate):
+ * - load: exponential average over ~200ms
+ * - overruns: blocks above the policy's overrun ratio
+ *
+ * It raises the level one step when the load passes the policy's raise
+ * threshold or it sees too many overruns in a short window, then waits a
+ * moment so the next measurement reflects the new level. It lowers one step
+ * after the load has stayed below the lower threshold for the restore hold
+ * time. If a restore is undone within a few seconds (the freed work didn't
+ * fit after all), the restore hold doubles, so the guard settles instead of
+ * oscillating between two levels.
+ *
+ *   Mode     Raise load   Overruns to raise      Lower load
+ *   Studio   80%          2 blocks >100% in 0.5s 40%
+ *   Live     60%          1 block  >90%          30%
+ *
+ * ANALOGY: Like a web service shedding optional features (recommendations,
+ * thumbnails) under load so the checkout page keeps working.
+ *
+ * THREADING:
+ * update() is called by the audio thread once per block. The level and
+ * load are published through relaxed atomics for the UI.
+ */
+class CpuGuard {
+public:
+  enum Level {
+    full = 0,
+    narrowSearch,
+    longerHop,
+    fewerBands,
+    shedVoice,
+    shedVoices,
+    numLevels
+  };
+
+  /** Thresholds for one mode, as fractions of the block deadline */
+  struct Policy {
+    bool enabled = true;
+    float raiseLoad = 0.8f;     // Smoothed load that triggers the next level
+    float lowerLoad = 0.4f;     // Smoothed load that allows restoring a level
+    float overrunRatio = 1.0f;  // A single block above this counts as an overrun
+    int overrunsToRaise = 2;    // Overruns within overrunWindowSeconds that trigger the next level
+  };
+
+  static Policy getPolicy(NovaTuneEnums::CpuGuardMode mode) noexcept;
+
+  //==========================================================================
+  // AUDIO THREAD
+  //==========================================================================
+
+  /** Clear the history and return to full quality */
+  void reset() noexcept;
+
+  void setMode(NovaTuneEnums::CpuGuardMode newMode) noexcept;
+
+  /**
+   * Feed one block's engine time. Returns the level to run the next block
+   * at. Off mode always returns full.
+   */
+  Level update(double elapsedNanos, double deadlineNanos) noexcept;
+
+  Level getCurrentLevel() const noexcept { return level; }
+
+  //==========================================================================
+  // UI (any thread)
+  //==========================================================================
+
+  /** Level in effect, for display */
+  Level getPublishedLevel() const noexcept { return static_cast<Level>(publishedLevel.load(std::memory_order_relaxed)); }
+
+  /** Smoothed engine load (1 = whole deadline), for display */
+  float getPublishedLoad() const noexcept { return publishedLoad.load(std::memory_order_relaxed); }
+
+  NovaTuneEnums::CpuGuardMode getMode() const noexcept { return mode.load(std::memory_order_relaxed); }
+
+  /** Short description of what a level sheds, e.g. "Longer detector hop" */
+  static const char *getLevelName(Level level) noexcept;
+
+private:
+  static constexpr double loadTimeConstantSeconds = 0.2;
+  static constexpr double overrunWindowSeconds = 0.5;
+  static constexpr double settleSeconds = 0.25;          // After any change, before raising again
+  static constexpr double baseRestoreHoldSeconds = 2.0;
+  static constexpr double maxRestoreHoldSeconds = 32.0;
+  static constexpr double bounceWindowSeconds = 5.0;     // A raise this soon after a lower is a bounce
+
+  std::atomic<NovaTuneEnums::CpuGuardMode> mode{NovaTuneEnums::CpuGuardMode::Studio};
+
+  // Audio thread state (times are seconds of audio processed)
+  Level level = full;
+  double load = 0.0;
+  double now = 0.0;
+  double lastChange = 0.0;
+  double lastLower = -1.0e9;
+  double belowSince = -1.0;
+  double restoreHold = baseRestoreHoldSeconds;
+  double overrunWindowStart = 0.0;
+  int overrunsInWindow = 0;
+
+  std::atomic<int> publishedLevel{full};
+  std::atomic<float> publishedLoad{0.0f};
+
+  void setLevel(Level newLevel) noexcept;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include "../DSPConfig.h"
+#include "../ParameterIDs.h"
+
+/**
+ * EngineParameters.h
+ *
+ * A plain snapshot of every parameter the DSP reads, taken once per block.
+ *
+ * WHY A SNAPSHOT?
+ * The DSP used to read the AudioProcessorValueTreeState directly, which
+ * tied it to juce_audio_processors (and through it, the GUI modules). The
+ * plugin now copies its parameter atomics into this struct at the top of
+ * each block (NovaTuneAudioProcessor::getEngineParameters), and anything
+ * else - the batch API, the tools - can fill one in without a processor.
+ *
+ * Defaults match the plugin's parameter layout.
+ *
+ * ANALOGY: Like passing a request's parsed config object down a handler
+ * chain instead of letting each handler read environment variables.
+ */
+
+/** One harmony voice (A, B or C) */
+struct HarmonyVoiceParameters {
+  bool enabled = false;
+  NovaTuneEnums::HarmonyMode mode = NovaTuneEnums::HarmonyMode::Diatonic;
+  int diatonicIntervalIndex = 7; // 0-14, 7 = unison
+  int semitoneOffset = 0;        // -12 to +12
+  float levelDb = -12.0f;
+  float pan = 0.0f;
+  float formantShift = 0.0f;       // Semitones
+  float humanizeTimingMs = 5.0f;
+  float humanizePitchCents = 3.0f;
+
+  // Sing the harmony preset's settings instead of the ones above (set by the
+  // processor, which tracks which voices were edited since the preset)
+  bool followPreset = false;
+
+  // Interval glide (set by HarmonyMorph): the voice sings morphAmount of the
+  // way from the morphFrom interval to its own. 1 = no glide.
+  NovaTuneEnums::HarmonyMode morphFromMode = NovaTuneEnums::HarmonyMode::Diatonic;
+  int morphFromDiatonicIndex = 7;
+  int morphFromSemitoneOffset = 0;
+  float morphAmount = 1.0f;
+};
+
+struct EngineParameters {
+  NovaTuneEnums::Key key = NovaTuneEnums::Key::C;
+  NovaTuneEnums::Scale scale = NovaTuneEnums::Scale::Major;
+  NovaTuneEnums::InputType inputType = NovaTuneEnums::InputType::AltoTenor;
+  NovaTuneEnums::CpuGuardMode cpuGuard = NovaTuneEnums::CpuGuardMode::Studio;
+
+  float retuneSpeed = 50.0f;  // 0-100
+  float humanize = 25.0f;     // 0-100
+  float vibratoAmount = 0.0f; // 0-100
+  float mixPercent = 100.0f;  // 0-100
+
+  NovaTuneEnums::HarmonyPreset harmonyPreset = NovaTuneEnums::HarmonyPreset::None;
+  float harmonyMorphMs = 250.0f;
+
+  std::array<HarmonyVoiceParameters, DSPConfig::maxHarmonyVoices> voices;
+};
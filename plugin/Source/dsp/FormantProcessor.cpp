@@ -35,6 +35,7 @@ FormantProcessor::FormantProcessor() {
 
   // Initialize band envelopes
   bandEnvelopes.fill(0.0f);
+  bandGains.fill(1.0f);
 }
 
 void FormantProcessor::prepare(double sr, int maxBlock, int channels) {
@@ -68,6 +69,7 @@ void FormantProcessor::prepare(double sr, int maxBlock, int channels) {
   // Calculate smoothing coefficients
   shiftSmoothingCoeff = NovaTuneUtils::calculateSmoothingCoeff(10.0f, sampleRate);
   envelopeSmoothingCoeff = NovaTuneUtils::calculateSmoothingCoeff(5.0f, sampleRate);
+  bandFadeStep = static_cast<float>(1.0 / (0.02 * sampleRate));
 
   // Initialize filters with default (no shift) settings
   updateFilters();
@@ -89,6 +91,10 @@ void FormantProcessor::reset() {
     f.reset();
 
   bandEnvelopes.fill(0.0f);
+
+  for (int band = 0; band < numBands; ++band)
+    bandGains[static_cast<size_t>(band)] = band < activeBands ? 1.0f : 0.0f;
+
   currentShiftRatio = targetShiftRatio;
 
   analysisBuffer.clear();
@@ -213,6 +219,25 @@ void FormantProcessor::process(juce::AudioBuffer<float> &buffer) {
   //==========================================================================
 
   for (int band = 0; band < numBands; ++band) {
+    // Fade towards on/off; silent bands are skipped entirely
+    auto &bandGain = bandGains[static_cast<size_t>(band)];
+    const float targetGain = band < activeBands ? 1.0f : 0.0f;
+
+    if (targetGain > 0.0f && bandGain <= 0.0f) {
+      // Waking up: filters hold whatever they had when the band stopped
+      analysisFiltersL[static_cast<size_t>(band)].reset();
+      analysisFiltersR[static_cast<size_t>(band)].reset();
+      synthesisFiltersL[static_cast<size_t>(band)].reset();
+      synthesisFiltersR[static_cast<size_t>(band)].reset();
+    } else if (targetGain <= 0.0f && bandGain <= 0.0f) {
+      continue;
+    }
+
+    const float startGain = bandGain;
+    const float maxChange = bandFadeStep * static_cast<float>(numSamples);
+    bandGain = std::clamp(targetGain, startGain - maxChange, startGain + maxChange);
+    const float gainStep = (bandGain - startGain) / static_cast<float>(numSamples);
+
     // Process left channel
     if (channels >= 1) {
       // Copy input for this band's analysis
@@ -240,7 +265,7 @@ void FormantProcessor::process(juce::AudioBuffer<float> &buffer) {
 
         // Add to output, scaled by analysis envelope
         // This transfers the energy from the analysis band to the synthesis band
-        synthData[i] += synthSample;
+        synthData[i] += synthSample * (startGain + gainStep * static_cast<float>(i + 1));
       }
     }
 
@@ -258,7 +283,7 @@ void FormantProcessor::process(juce::AudioBuffer<float> &buffer) {
 
       for (int i = 0; i < numSamples; ++i) {
         float synthSample = synthesisFiltersR[static_cast<size_t>(band)].processSample(inputData[i]);
-        synthData[i] += synthSample;
+        synthData[i] += synthSample * (startGain + gainStep * static_cast<float>(i + 1));
       }
     }
   }
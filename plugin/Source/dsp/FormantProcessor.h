@@ -90,6 +90,15 @@ public:
    */
   void setPitchCompensation(float pitchRatio);
 
+  /**
+   * Run only the lowest `count` bands (the CPU guard sheds the upper ones;
+   * F1/F2 live in the low bands). Bands fade in and out over ~20ms and are
+   * skipped entirely once silent. Safe on the audio thread.
+   */
+  void setActiveBands(int count) noexcept { activeBands = std::clamp(count, 1, numBands); }
+
+  static constexpr int getNumBands() noexcept { return numBands; }
+
   /**
    * Process audio buffer.
    *
@@ -142,6 +151,11 @@ private:
   // Filter center frequencies (in Hz)
   std::array<float, numBands> bandCenterFreqs;
 
+  // Band fades for setActiveBands (1 = on, 0 = off and skipped)
+  int activeBands = numBands;
+  std::array<float, numBands> bandGains;
+  float bandFadeStep = 0.001f; // Gain change per sample
+
   // Band envelope followers
   std::array<float, numBands> bandEnvelopes;
   float envelopeSmoothingCoeff = 0.01f;
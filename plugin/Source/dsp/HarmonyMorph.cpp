@@ -0,0 +1,185 @@
+#include "HarmonyMorph.h"
+#include "../Utilities.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * HarmonyMorph.cpp
+ *
+ * The harmony preset table and the per-voice morphs.
+ */
+
+namespace {
+
+  using Voice = HarmonyVoiceParameters;
+
+  Voice diatonic(int scaleDegrees, float levelDb, float pan) {
+    Voice voice;
+    voice.enabled = true;
+    voice.mode = NovaTuneEnums::HarmonyMode::Diatonic;
+    voice.diatonicIntervalIndex = 7 + scaleDegrees;
+    voice.levelDb = levelDb;
+    voice.pan = pan;
+    return voice;
+  }
+
+  Voice semitones(int offset, float levelDb, float pan) {
+    Voice voice;
+    voice.enabled = true;
+    voice.mode = NovaTuneEnums::HarmonyMode::Semitone;
+    voice.semitoneOffset = offset;
+    voice.levelDb = levelDb;
+    voice.pan = pan;
+    return voice;
+  }
+
+  bool sameInterval(const Voice &a, const Voice &b) noexcept {
+    return a.mode == b.mode && (a.mode == NovaTuneEnums::HarmonyMode::Diatonic
+                                    ? a.diatonicIntervalIndex == b.diatonicIntervalIndex
+                                    : a.semitoneOffset == b.semitoneOffset);
+  }
+
+  /** `amount` of the way from `from` to `to` */
+  Voice blend(const Voice &from, const Voice &to, float amount) noexcept {
+    if (amount >= 1.0f)
+      return to;
+
+    Voice result = to;
+
+    // Gain, not dB: a voice switching on or off starts or ends in silence
+    const float fromGain = from.enabled ? NovaTuneUtils::dbToGain(from.levelDb) : 0.0f;
+    const float toGain = to.enabled ? NovaTuneUtils::dbToGain(to.levelDb) : 0.0f;
+
+    result.enabled = from.enabled || to.enabled;
+    result.levelDb = NovaTuneUtils::gainToDb(fromGain + amount * (toGain - fromGain));
+    result.pan = NovaTuneUtils::lerp(from.pan, to.pan, amount);
+    result.formantShift = NovaTuneUtils::lerp(from.formantShift, to.formantShift, amount);
+
+    if (!to.enabled) {
+      // Fading out: keep singing what it sang
+      result.mode = from.mode;
+      result.diatonicIntervalIndex = from.diatonicIntervalIndex;
+      result.semitoneOffset = from.semitoneOffset;
+      result.morphFromMode = from.morphFromMode;
+      result.morphFromDiatonicIndex = from.morphFromDiatonicIndex;
+      result.morphFromSemitoneOffset = from.morphFromSemitoneOffset;
+      result.morphAmount = from.morphAmount;
+    } else if (from.enabled && !sameInterval(from, to)) {
+      // Glide from the interval `from` was nearer to
+      const bool atTarget = from.morphAmount >= 0.5f;
+      result.morphFromMode = atTarget ? from.mode : from.morphFromMode;
+      result.morphFromDiatonicIndex = atTarget ? from.diatonicIntervalIndex : from.morphFromDiatonicIndex;
+      result.morphFromSemitoneOffset = atTarget ? from.semitoneOffset : from.morphFromSemitoneOffset;
+      result.morphAmount = amount;
+    }
+
+    // Fading in (from silence), the voice starts at its new interval
+    return result;
+  }
+
+} // namespace
+
+//==============================================================================
+// PRESETS
+//==============================================================================
+
+HarmonyMorph::Voices HarmonyMorph::getPresetVoices(NovaTuneEnums::HarmonyPreset preset) {
+  using Preset = NovaTuneEnums::HarmonyPreset;
+
+  // Scale degrees: a third is 2, a fifth 4
+  switch (preset) {
+    case Preset::Pop3rdUp:
+      return {diatonic(2, -12.0f, 0.0f), Voice(), Voice()};
+    case Preset::Pop3rdAnd5th:
+      return {diatonic(2, -12.0f, -0.3f), diatonic(4, -15.0f, 0.3f), Voice()};
+    case Preset::ThirdsAboveBelow:
+      return {diatonic(2, -12.0f, -0.4f), diatonic(-2, -14.0f, 0.4f), Voice()};
+    case Preset::FifthsWide:
+      return {diatonic(4, -14.0f, -0.8f), diatonic(-4, -14.0f, 0.8f), Voice()};
+    case Preset::OctaveDouble:
+      return {semitones(12, -14.0f, 0.0f), Voice(), Voice()};
+    case Preset::OctavePlus3rd:
+      return {semitones(12, -15.0f, -0.3f), diatonic(2, -13.0f, 0.3f), Voice()};
+    case Preset::ChoirStack:
+      return {diatonic(2, -13.0f, -0.5f), diatonic(-2, -15.0f, 0.5f), diatonic(4, -18.0f, 0.0f)};
+    case Preset::None:
+    case Preset::numPresets:
+      break;
+  }
+
+  return {};
+}
+
+void HarmonyMorph::copyPresetSettings(const Voice &preset, Voice &voice) noexcept {
+  voice.enabled = preset.enabled;
+  voice.mode = preset.mode;
+  voice.diatonicIntervalIndex = preset.diatonicIntervalIndex;
+  voice.semitoneOffset = preset.semitoneOffset;
+  voice.levelDb = preset.levelDb;
+  voice.pan = preset.pan;
+  voice.formantShift = preset.formantShift;
+}
+
+//==============================================================================
+// SETUP
+//==============================================================================
+
+void HarmonyMorph::prepare(double newSampleRate) {
+  sampleRate = newSampleRate;
+
+  for (size_t p = 0; p < presetVoices.size(); ++p)
+    presetVoices[p] = getPresetVoices(static_cast<NovaTuneEnums::HarmonyPreset>(p));
+
+  reset();
+}
+
+void HarmonyMorph::reset() noexcept {
+  states = {};
+  started = false;
+}
+
+bool HarmonyMorph::isMorphing() const noexcept {
+  return std::any_of(states.begin(), states.end(), [](const VoiceState &state) { return state.amount < 1.0f; });
+}
+
+//==============================================================================
+// AUDIO THREAD
+//==============================================================================
+
+void HarmonyMorph::startMorph(VoiceState &state, float morphSeconds) noexcept {
+  const double morphSamples = static_cast<double>(morphSeconds) * sampleRate;
+
+  state.from = state.current;
+  state.amount = morphSamples >= 1.0 ? 0.0f : 1.0f;
+  state.step = morphSamples >= 1.0 ? static_cast<float>(1.0 / morphSamples) : 1.0f;
+}
+
+void HarmonyMorph::process(EngineParameters &params, int numSamples) noexcept {
+  const int presetIndex = juce::jlimit(0, static_cast<int>(presetVoices.size()) - 1,
+                                       static_cast<int>(params.harmonyPreset));
+  const auto &voicesOfPreset = presetVoices[static_cast<size_t>(presetIndex)];
+  const bool presetChanged = started && params.harmonyPreset != preset;
+  const float morphSeconds = params.harmonyMorphMs / 1000.0f;
+
+  for (size_t v = 0; v < states.size(); ++v) {
+    auto &state = states[v];
+    auto target = params.voices[v];
+
+    if (target.followPreset)
+      copyPresetSettings(voicesOfPreset[v], target);
+
+    // The first block since a reset starts where its parameters are
+    if (!started)
+      state.current = target;
+    else if ((presetChanged && target.followPreset) || target.followPreset != state.followPreset)
+      startMorph(state, morphSeconds);
+
+    state.followPreset = target.followPreset;
+    state.amount = std::min(1.0f, state.amount + state.step * static_cast<float>(numSamples));
+    state.current = blend(state.from, target, state.amount);
+    params.voices[v] = state.current;
+  }
+
+  preset = params.harmonyPreset;
+  started = true;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include "EngineParameters.h"
+#include "../DSPConfig.h"
+#include "../ParameterIDs.h"
+
+/**
+ * HarmonyMorph.h
+ *
+ * Harmony presets applied on the audio thread, morphing every voice from
+ * what it sings now to the preset over a set time.
+ *
+ * WHY?
+ * A harmony preset sets seven parameters per voice. Set one by one, they
+ * reach the audio thread over several blocks, so a switch passes through
+ * voice configurations that are in neither preset, an interval or pan
+ * that changes at a block boundary jumps instead of moving, and the host
+ * records a burst of automation nobody wrote. Switching "Pop 3rd Up" to
+ * "Choir Stack" mid-song should sound like one move, not a series of
+ * steps.
+ *
+ * HOW IT WORKS:
+ *
+ *   Block snapshot (EngineParameters)        process() (audio thread)
+ *   ─────────────────────────────────        ────────────────────────
+ *   harmonyPreset, harmonyMorphMs ──►  preset changed? morph every
+ *   voices[v].followPreset                   following voice to it, then
+ *                                            replace the block's voice values
+ *
+ * - Every preset's voices are worked out once, in prepare(). The preset
+ *   is read from the block's parameters, so a change - chosen in the
+ *   editor or automated - lands in the block it happens in, in real time
+ *   and in a bounce alike.
+ * - A voice with followPreset sings the preset's settings instead of its
+ *   parameters, which the preset leaves alone. The processor decides which
+ *   voices follow: all of them after a new preset, fewer as voices are
+ *   edited.
+ * - Each voice morphs from its current state: gain, pan and formant
+ *   move linearly, and the interval glides in semitones. A voice switching
+ *   on starts silent at its new interval; one switching off fades out at
+ *   its old one. A voice that stops following morphs to its parameters
+ *   the same way.
+ * - A new preset during a glide starts from the nearer of the two
+ *   intervals being glided between.
+ *
+ * THREADING:
+ * prepare() runs on the message thread with audio stopped; reset() and
+ * process() run on the audio thread. process() doesn't wait or allocate.
+ *
+ * ANALOGY: Like a lighting desk's scene crossfade - the next look is
+ * recorded in advance and one fader takes every channel there together,
+ * instead of someone moving each fader by hand.
+ */
+
+class HarmonyMorph {
+public:
+  using Voices = std::array<HarmonyVoiceParameters, DSPConfig::maxHarmonyVoices>;
+
+  /** The voice settings behind a quick-access harmony preset */
+  static Voices getPresetVoices(NovaTuneEnums::HarmonyPreset preset);
+
+  /** Copy the settings a preset sets (not humanization) from `preset` into `voice` */
+  static void copyPresetSettings(const HarmonyVoiceParameters &preset, HarmonyVoiceParameters &voice) noexcept;
+
+  void prepare(double sampleRate);
+
+  /** Every voice back to its block values, no morph in progress (audio thread) */
+  void reset() noexcept;
+
+  /**
+   * Advance the morphs by numSamples and replace params.voices (the
+   * block's parameter values) with what each voice should sing this block.
+   */
+  void process(EngineParameters &params, int numSamples) noexcept;
+
+  /** True while any voice is between two configurations */
+  bool isMorphing() const noexcept;
+
+private:
+  struct VoiceState {
+    bool followPreset = false;       // Last block's
+    HarmonyVoiceParameters from;     // What the voice sang when the morph started
+    HarmonyVoiceParameters current;  // What it sang last block
+    float amount = 1.0f;             // Through the morph, 0 to 1
+    float step = 1.0f;               // Per sample
+  };
+
+  std::array<Voices, static_cast<size_t>(NovaTuneEnums::HarmonyPreset::numPresets)> presetVoices;
+  std::array<VoiceState, DSPConfig::maxHarmonyVoices> states;
+  NovaTuneEnums::HarmonyPreset preset = NovaTuneEnums::HarmonyPreset::None; // Last block's
+  double sampleRate = 44100.0;
+  bool started = false; // `current` and `preset` hold a block's values
+
+  void startMorph(VoiceState &state, float morphSeconds) noexcept;
+};
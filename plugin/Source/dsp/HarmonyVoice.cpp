@@ -8,7 +8,19 @@
  * Implementation of a single harmony voice.
  */
 
-HarmonyVoice::HarmonyVoice() {
+namespace {
+
+  /** SplitMix64 finaliser: decorrelates neighbouring (seed, update) pairs */
+  juce::int64 mixSeed(juce::int64 seed, juce::int64 updateIndex) noexcept {
+    uint64_t z = static_cast<uint64_t>(seed) + 0x9E3779B97F4A7C15ull * static_cast<uint64_t>(updateIndex + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return static_cast<juce::int64>(z ^ (z >> 31));
+  }
+
+} // namespace
+
+HarmonyVoice::HarmonyVoice() : randomSeed(juce::Random::getSystemRandom().nextInt64()) {
   // Will be properly initialized in prepare()
 }
 
@@ -20,6 +32,8 @@ void HarmonyVoice::prepare(double sr, int maxBlock, int channels) {
   // Create pitch shifters for each channel
   pitchShifters.resize(static_cast<size_t>(numChannels));
   for (auto &shifter : pitchShifters) {
+    shifter.setRenderQuality(renderQuality);
+    shifter.setOutputAdvance(outputAdvance);
     shifter.prepare(sampleRate, maxBlockSize);
   }
 
@@ -67,90 +81,59 @@ void HarmonyVoice::reset() {
   currentPitchRatio = 1.0f;
   targetGain = 0.0f;
   currentGain = 0.0f;
+  panGainL = targetPanGainL;
+  panGainR = targetPanGainR;
   pitchHumanizeOffset = 0.0f;
   timingHumanizeTarget = 0.0f;
-  samplesSinceHumanizeUpdate = 0;
+  timelinePosition = 0;
+  humanizeUpdateIndex = -1;
 
   voiceBuffer.clear();
 }
 
-void HarmonyVoice::updateFromParameters(int voiceIndex, juce::AudioProcessorValueTreeState &apvts) {
-  using namespace ParamIDs;
-
-  // Select parameter IDs based on voice index
-  const char *enabledId = nullptr;
-  const char *modeId = nullptr;
-  const char *diaId = nullptr;
-  const char *semiId = nullptr;
-  const char *levelId = nullptr;
-  const char *panId = nullptr;
-  const char *formId = nullptr;
-  const char *humTId = nullptr;
-  const char *humPId = nullptr;
-
-  switch (voiceIndex) {
-  case 0: // Voice A
-    enabledId = A_enabled;
-    modeId = A_mode;
-    diaId = A_intervalDiatonic;
-    semiId = A_intervalSemi;
-    levelId = A_level;
-    panId = A_pan;
-    formId = A_formantShift;
-    humTId = A_humTiming;
-    humPId = A_humPitch;
-    break;
-
-  case 1: // Voice B
-    enabledId = B_enabled;
-    modeId = B_mode;
-    diaId = B_intervalDiatonic;
-    semiId = B_intervalSemi;
-    levelId = B_level;
-    panId = B_pan;
-    formId = B_formantShift;
-    humTId = B_humTiming;
-    humPId = B_humPitch;
-    break;
-
-  case 2: // Voice C
-    enabledId = C_enabled;
-    modeId = C_mode;
-    diaId = C_intervalDiatonic;
-    semiId = C_intervalSemi;
-    levelId = C_level;
-    panId = C_pan;
-    formId = C_formantShift;
-    humTId = C_humTiming;
-    humPId = C_humPitch;
-    break;
-
-  default:
-    return;
-  }
+void HarmonyVoice::setTimelinePosition(juce::int64 position) noexcept {
+  timelinePosition = position;
+  humanizeUpdateIndex = -1;
+}
 
-  // Read parameters
-  enabled = apvts.getRawParameterValue(enabledId)->load() > 0.5f;
-  mode = static_cast<NovaTuneEnums::HarmonyMode>(
-      static_cast<int>(apvts.getRawParameterValue(modeId)->load()));
-  diatonicIntervalIndex = static_cast<int>(apvts.getRawParameterValue(diaId)->load());
-  semitoneOffset = static_cast<int>(apvts.getRawParameterValue(semiId)->load());
-  levelDb = apvts.getRawParameterValue(levelId)->load();
-  pan = apvts.getRawParameterValue(panId)->load();
-  formantShift = apvts.getRawParameterValue(formId)->load();
-  humanizeTimingMs = apvts.getRawParameterValue(humTId)->load();
-  humanizePitchCents = apvts.getRawParameterValue(humPId)->load();
+void HarmonyVoice::updateFromParameters(const HarmonyVoiceParameters &params) {
+  enabled = params.enabled;
+  mode = params.mode;
+  diatonicIntervalIndex = params.diatonicIntervalIndex;
+  semitoneOffset = params.semitoneOffset;
+  levelDb = params.levelDb;
+  pan = params.pan;
+  formantShift = params.formantShift;
+  humanizeTimingMs = params.humanizeTimingMs;
+  humanizePitchCents = params.humanizePitchCents;
+  morphFromMode = params.morphFromMode;
+  morphFromDiatonicIndex = params.morphFromDiatonicIndex;
+  morphFromSemitoneOffset = params.morphFromSemitoneOffset;
+  morphAmount = params.morphAmount;
 
   // Calculate gain from dB
-  targetGain = enabled ? NovaTuneUtils::dbToGain(levelDb) : 0.0f;
+  targetGain = enabled && !shed ? NovaTuneUtils::dbToGain(levelDb) : 0.0f;
 
-  // Calculate pan gains
-  NovaTuneUtils::constantPowerPan(pan, panGainL, panGainR);
+  // Calculate pan gains (reached sample by sample in applyGainAndPan)
+  NovaTuneUtils::constantPowerPan(pan, targetPanGainL, targetPanGainR);
 
   // Update formant processor
   formantProcessor.setFormantShift(formantShift);
 }
 
+int HarmonyVoice::getIntervalSemitones(NovaTuneEnums::HarmonyMode intervalMode, int diatonicIndex, int semitones,
+                                       const PitchMapper &mapper) {
+  if (intervalMode == NovaTuneEnums::HarmonyMode::Semitone)
+    return semitones;
+
+  // Convert diatonic interval index (0-14) to scale degrees (-7 to +7),
+  // then to semitones in the mapper's scale
+  const int scaleDegrees = NovaTuneEnums::diatonicIndexToScaleDegree(diatonicIndex);
+  const auto &scaleIntervals = NovaTuneEnums::getScaleIntervals(mapper.getScale());
+
+  return NovaTuneUtils::diatonicToSemitones(scaleDegrees, scaleIntervals);
+}
+
 float HarmonyVoice::calculateHarmonyPitchRatio(const PitchDetector &detector,
                                                const PitchMapper &mapper) {
   if (!detector.isVoiced()) {
@@ -165,31 +148,14 @@ float HarmonyVoice::calculateHarmonyPitchRatio(const PitchDetector &detector,
   }
 
   // Calculate harmony target note
-  float harmonyMidi = leadMidi;
-
-  switch (mode) {
-    case NovaTuneEnums::HarmonyMode::Diatonic: {
-      // Use the pitch mapper's calculation for diatonic intervals
-      // voiceIndex doesn't matter here since we have our own settings
-      // We need to calculate it ourselves based on our interval setting
-
-      // Convert diatonic interval index (0-14) to scale degrees (-7 to +7)
-      int scaleDegrees = NovaTuneEnums::diatonicIndexToScaleDegree(diatonicIntervalIndex);
-
-      // Get scale intervals
-      const auto &scaleIntervals = NovaTuneEnums::getScaleIntervals(mapper.getScale());
-
-      // Convert scale degrees to semitones
-      int semitones = NovaTuneUtils::diatonicToSemitones(scaleDegrees, scaleIntervals);
-
-      harmonyMidi = leadMidi + static_cast<float>(semitones);
-      break;
-    }
-
-    case NovaTuneEnums::HarmonyMode::Semitone: {
-      harmonyMidi = leadMidi + static_cast<float>(semitoneOffset);
-      break;
-    }
+  float harmonyMidi =
+      leadMidi + static_cast<float>(getIntervalSemitones(mode, diatonicIntervalIndex, semitoneOffset, mapper));
+
+  // Gliding between intervals (a harmony preset morph)
+  if (morphAmount < 1.0f) {
+    const float fromMidi = leadMidi + static_cast<float>(getIntervalSemitones(morphFromMode, morphFromDiatonicIndex,
+                                                                              morphFromSemitoneOffset, mapper));
+    harmonyMidi = NovaTuneUtils::lerp(fromMidi, harmonyMidi, morphAmount);
   }
 
   // Apply pitch humanization
@@ -211,24 +177,29 @@ float HarmonyVoice::calculateHarmonyPitchRatio(const PitchDetector &detector,
   return std::clamp(ratio, DSPConfig::minPitchShiftRatio, DSPConfig::maxPitchShiftRatio);
 }
 
-void HarmonyVoice::updateHumanization() {
+void HarmonyVoice::updateHumanization(juce::int64 updateIndex) {
   /**
    * Update humanization parameters.
    * This is called periodically (not every sample) to create
    * slowly-varying random offsets that make the harmony sound
    * more like a real singer.
+   *
+   * The values depend only on the seed and the update's place on the
+   * timeline (not on how many updates this voice has run), so a render
+   * split into segments draws the same offsets as one continuous pass.
    */
+  randomGenerator.setSeed(mixSeed(randomSeed, updateIndex));
 
   // Pitch humanization: random offset within specified range
   float pitchRange = humanizePitchCents;
-  float newPitchOffset = NovaTuneUtils::randomFloat(-pitchRange, pitchRange);
+  float newPitchOffset = -pitchRange + randomGenerator.nextFloat() * 2.0f * pitchRange;
 
   // Smooth transition to new offset (don't jump suddenly)
   pitchHumanizeOffset += 0.1f * (newPitchOffset - pitchHumanizeOffset);
 
   // Timing humanization: random delay within specified range
   float timingRange = humanizeTimingMs;
-  float newTimingMs = NovaTuneUtils::randomFloat(0.0f, timingRange);
+  float newTimingMs = randomGenerator.nextFloat() * timingRange;
   float newTimingSamples = (newTimingMs / 1000.0f) * static_cast<float>(sampleRate);
 
   // Smooth transition
@@ -292,8 +263,10 @@ void HarmonyVoice::applyGainAndPan(juce::AudioBuffer<float> &buffer) {
   const int channels = buffer.getNumChannels();
 
   for (int i = 0; i < numSamples; ++i) {
-    // Smooth gain changes
+    // Smooth gain and pan changes, so neither steps at a block boundary
     currentGain += gainSmoothing * (targetGain - currentGain);
+    panGainL += gainSmoothing * (targetPanGainL - panGainL);
+    panGainR += gainSmoothing * (targetPanGainR - panGainR);
 
     if (channels >= 1) {
       float *left = buffer.getWritePointer(0);
@@ -311,17 +284,35 @@ void HarmonyVoice::process(juce::AudioBuffer<float> &harmonyBuffer,
                            const juce::AudioBuffer<float> &leadBuffer,
                            const PitchDetector &detector,
                            const PitchMapper &mapper) {
-  // Early exit if voice is disabled
-  if (!enabled) {
+  // The timeline advances even while the voice is silent
+  const juce::int64 blockPosition = timelinePosition;
+  timelinePosition += leadBuffer.getNumSamples();
+
+  // Early exit if voice is disabled (or muted by the CPU guard)
+  if (!enabled || shed) {
     // Fade out if we were previously on
     if (currentGain > 0.001f) {
       targetGain = 0.0f;
       // Process one buffer to fade out
     } else {
+      currentGain = 0.0f;
+      idle = true;
       return;
     }
   }
 
+  // Coming back from silence: don't fade in grains of whatever was sung
+  // before the voice stopped
+  if (idle) {
+    for (auto &shifter : pitchShifters)
+      shifter.reset();
+
+    formantProcessor.reset();
+    idle = false;
+  }
+
+  StageProfiler::ScopedTimer timer(profiler, profilerStage);
+
   const int numSamples = leadBuffer.getNumSamples();
   const int channels = leadBuffer.getNumChannels();
 
@@ -335,10 +326,11 @@ void HarmonyVoice::process(juce::AudioBuffer<float> &harmonyBuffer,
   // UPDATE HUMANIZATION
   //==========================================================================
 
-  samplesSinceHumanizeUpdate += numSamples;
-  if (samplesSinceHumanizeUpdate >= humanizeUpdateIntervalSamples) {
-    updateHumanization();
-    samplesSinceHumanizeUpdate = 0;
+  const juce::int64 updateIndex = blockPosition / humanizeUpdateIntervalSamples;
+
+  if (updateIndex != humanizeUpdateIndex) {
+    updateHumanization(updateIndex);
+    humanizeUpdateIndex = updateIndex;
   }
 
   //==========================================================================
@@ -367,10 +359,14 @@ void HarmonyVoice::process(juce::AudioBuffer<float> &harmonyBuffer,
   // APPLY FORMANT PROCESSING
   //==========================================================================
 
+  timer.lap(profilerStage);
+
   // Set formant compensation based on pitch shift
   formantProcessor.setPitchCompensation(currentPitchRatio);
   formantProcessor.process(voiceBuffer);
 
+  timer.lap(StageProfiler::formant);
+
   //==========================================================================
   // APPLY TIMING HUMANIZATION
   //==========================================================================
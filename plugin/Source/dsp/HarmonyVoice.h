@@ -1,11 +1,12 @@
 #pragma once
 
 #include <juce_audio_basics/juce_audio_basics.h>
-#include <juce_audio_processors/juce_audio_processors.h>
 #include "PitchShifter.h"
 #include "FormantProcessor.h"
 #include "PitchDetector.h"
 #include "PitchMapper.h"
+#include "StageProfiler.h"
+#include "EngineParameters.h"
 #include "../ParameterIDs.h"
 #include "../DSPConfig.h"
 #include "../Utilities.h"
@@ -62,12 +63,11 @@ public:
   void reset();
 
   /**
-   * Update voice parameters from the plugin state.
+   * Update voice parameters from the block's parameter snapshot.
    *
-   * @param voiceIndex Which voice this is (0=A, 1=B, 2=C)
-   * @param apvts The parameter state
+   * @param params This voice's settings (EngineParameters::voices[i])
    */
-  void updateFromParameters(int voiceIndex, juce::AudioProcessorValueTreeState &apvts);
+  void updateFromParameters(const HarmonyVoiceParameters &params);
 
   /**
    * Process audio and add this voice's output to the harmony buffer.
@@ -87,16 +87,78 @@ public:
    */
   bool isEnabled() const noexcept { return enabled; }
 
+  //==========================================================================
+  // CPU GUARD (audio thread, see CpuGuard.h)
+  //==========================================================================
+
+  /** Narrow the shifters' grain search (see PitchShifter::setSearchRangeScale) */
+  void setSearchRangeScale(float scale) noexcept {
+    for (auto &shifter : pitchShifters)
+      shifter.setSearchRangeScale(scale);
+  }
+
+  /**
+   * Render (offline) shifter configuration (see PitchShifter::setRenderQuality
+   * and setOutputAdvance). Takes effect at the next prepare().
+   */
+  void setRenderQuality(bool render, int shifterOutputAdvance) noexcept {
+    renderQuality = render;
+    outputAdvance = shifterOutputAdvance;
+  }
+
+  /** Limit the formant filter bank to its lowest `numBands` bands */
+  void setFormantBandLimit(int numBands) noexcept { formantProcessor.setActiveBands(numBands); }
+
+  /**
+   * Mute the voice to save CPU. It fades out exactly like a disabled voice
+   * and stops processing once silent; clearing it fades the voice back in.
+   */
+  void setShed(bool shouldShed) noexcept { shed = shouldShed; }
+
+  bool isShed() const noexcept { return shed; }
+
   /**
    * Get the current harmony pitch in MIDI note number.
    */
   float getCurrentHarmonyMidi() const noexcept { return currentHarmonyMidi; }
 
+  /**
+   * Get the current (smoothed) pitch ratio applied by the shifter.
+   */
+  float getCurrentPitchRatio() const noexcept { return currentPitchRatio; }
+
   /**
    * Get the latency introduced by this voice in samples.
    */
   int getLatencySamples() const;
 
+  /**
+   * Charge this voice's processing time to `stage` (and its formant
+   * filtering to StageProfiler::formant). nullptr = not profiled.
+   */
+  void setProfiler(StageProfiler *profilerToUse, StageProfiler::Stage stage) noexcept {
+    profiler = profilerToUse;
+    profilerStage = stage;
+  }
+
+  //==========================================================================
+  // HUMANIZATION TIMELINE
+  //==========================================================================
+
+  /**
+   * Seed the humanization offsets. Each ~100ms update draws its values from
+   * the seed and the update's position on the timeline, so two voices with
+   * the same seed humanize identically however their streams were split.
+   * Defaults to a random seed per voice.
+   */
+  void setRandomSeed(juce::int64 seed) noexcept { randomSeed = seed; }
+
+  /**
+   * Place the start of the stream at `position` samples on the timeline.
+   * Call after reset(), before the first block.
+   */
+  void setTimelinePosition(juce::int64 position) noexcept;
+
 private:
   //==========================================================================
   // CONFIGURATION
@@ -108,6 +170,8 @@ private:
 
   // Voice parameters
   bool enabled = false;
+  bool shed = false;  // Muted by the CPU guard
+  bool idle = true;   // Skipped the last block - shifter history is stale
   NovaTuneEnums::HarmonyMode mode = NovaTuneEnums::HarmonyMode::Diatonic;
   int diatonicIntervalIndex = 7; // 7 = unison (center of -7 to +7 range)
   int semitoneOffset = 0;        // For semitone mode: -12 to +12
@@ -118,12 +182,20 @@ private:
   float humanizeTimingMs = 5.0f;   // Random timing variation
   float humanizePitchCents = 3.0f; // Random pitch variation
 
+  // Interval glide (see HarmonyVoiceParameters::morphAmount)
+  NovaTuneEnums::HarmonyMode morphFromMode = NovaTuneEnums::HarmonyMode::Diatonic;
+  int morphFromDiatonicIndex = 7;
+  int morphFromSemitoneOffset = 0;
+  float morphAmount = 1.0f;
+
   //==========================================================================
   // DSP COMPONENTS
   //==========================================================================
 
   // Pitch shifter for each channel
   std::vector<PitchShifter> pitchShifters;
+  bool renderQuality = false;
+  int outputAdvance = 0;
 
   // Formant processor
   FormantProcessor formantProcessor;
@@ -151,24 +223,36 @@ private:
   float currentGain = 0.0f;
   float gainSmoothing = 0.01f;
 
-  // Pan gains
+  // Pan gains, smoothed towards the targets like the gain
   float panGainL = 1.0f;
   float panGainR = 1.0f;
+  float targetPanGainL = 1.0f;
+  float targetPanGainR = 1.0f;
 
   // Humanization state
   float pitchHumanizeOffset = 0.0f;
   float timingHumanizeTarget = 0.0f;
   juce::Random randomGenerator;
-  int samplesSinceHumanizeUpdate = 0;
+  juce::int64 randomSeed = 0;
+  juce::int64 timelinePosition = 0;         // Samples since the start of the timeline
+  juce::int64 humanizeUpdateIndex = -1;     // Update the current values were drawn for
   int humanizeUpdateIntervalSamples = 4410; // ~100ms at 44.1kHz
 
   // Internal buffers
   juce::AudioBuffer<float> voiceBuffer;
 
+  // CPU profiling (owned by the TunerEngine)
+  StageProfiler *profiler = nullptr;
+  StageProfiler::Stage profilerStage = StageProfiler::harmonyA;
+
   //==========================================================================
   // HELPER METHODS
   //==========================================================================
 
+  /** Semitones above the lead for an interval setting, in the mapper's scale */
+  static int getIntervalSemitones(NovaTuneEnums::HarmonyMode intervalMode, int diatonicIndex, int semitones,
+                                  const PitchMapper &mapper);
+
   /**
    * Calculate the pitch ratio for this harmony voice.
    */
@@ -181,9 +265,9 @@ private:
   void applyTimingHumanization(juce::AudioBuffer<float> &buffer);
 
   /**
-   * Update humanization parameters (called periodically).
+   * Update humanization parameters (called once per update interval).
    */
-  void updateHumanization();
+  void updateHumanization(juce::int64 updateIndex);
 
   /**
    * Apply gain and panning to the voice buffer.
@@ -20,15 +20,18 @@ void LeadCorrection::prepare(double sr, int maxBlockSize, int channels) {
   // Create a pitch shifter for each channel
   pitchShifters.resize(static_cast<size_t>(numChannels));
   for (auto &shifter : pitchShifters) {
+    shifter.setRenderQuality(renderQuality);
+    shifter.setOutputAdvance(outputAdvance);
     shifter.prepare(sampleRate, maxBlockSize);
   }
 
-  // Dry buffer for mix
+  // Dry buffer for mix, and the line that delays it by the shifter latency
   dryBuffer.setSize(numChannels, maxBlockSize);
+  dryDelay.setSize(numChannels, std::max(1, getLatencySamples()));
+  ratioTrack.resize(static_cast<size_t>(maxBlockSize));
 
-  // Initialize smoothing coefficient based on default retune speed
-  pitchRatioSmoothingCoeff = NovaTuneUtils::calculateSmoothingCoeff(
-      retuneSpeedToTimeConstantMs(retuneSpeed), sampleRate);
+  // Initialize smoothing coefficients based on current retune speed
+  setRetuneSpeed(retuneSpeed);
 
   reset();
 }
@@ -47,15 +50,15 @@ void LeadCorrection::reset() {
   vibratoDepth = 0.0f;
 
   dryBuffer.clear();
+  dryDelay.clear();
+  dryDelayPosition = 0;
 }
 
-void LeadCorrection::updateFromParameters(juce::AudioProcessorValueTreeState &apvts) {
-  using namespace ParamIDs;
-
-  setRetuneSpeed(apvts.getRawParameterValue(ParamIDs::retuneSpeed)->load());
-  setHumanize(apvts.getRawParameterValue(ParamIDs::humanize)->load());
-  setVibrato(apvts.getRawParameterValue(ParamIDs::vibratoAmount)->load());
-  setMix(apvts.getRawParameterValue(ParamIDs::mix)->load() / 100.0f);
+void LeadCorrection::updateFromParameters(const EngineParameters &params) {
+  setRetuneSpeed(params.retuneSpeed);
+  setHumanize(params.humanize);
+  setVibrato(params.vibratoAmount);
+  setMix(params.mixPercent / 100.0f);
 }
 
 void LeadCorrection::setRetuneSpeed(float speed) {
@@ -64,6 +67,7 @@ void LeadCorrection::setRetuneSpeed(float speed) {
   // Update smoothing coefficient
   float timeConstantMs = retuneSpeedToTimeConstantMs(retuneSpeed);
   pitchRatioSmoothingCoeff = NovaTuneUtils::calculateSmoothingCoeff(timeConstantMs, sampleRate);
+  lookaheadSmoothingCoeff = NovaTuneUtils::calculateSmoothingCoeff(timeConstantMs * 0.5f, sampleRate);
 }
 
 void LeadCorrection::setHumanize(float amount) {
@@ -192,7 +196,13 @@ void LeadCorrection::process(juce::AudioBuffer<float> &buffer,
   const int channels = buffer.getNumChannels();
 
   // Store dry signal for mix
-  dryBuffer.makeCopyOf(buffer, true);
+  storeDry(buffer);
+
+  if (renderQuality) {
+    shiftWithLookahead(buffer, detector, mapper);
+    applyMix(buffer);
+    return;
+  }
 
   //==========================================================================
   // CALCULATE TARGET PITCH RATIO
@@ -246,6 +256,127 @@ void LeadCorrection::process(juce::AudioBuffer<float> &buffer,
   // APPLY DRY/WET MIX
   //==========================================================================
 
+  applyMix(buffer);
+}
+
+float LeadCorrection::calculateHopPitchRatio(const PitchDetector::HopResult &hop, const PitchMapper &mapper) {
+  // calculateTargetPitchRatio() and its humanization, for one hop
+  if (!hop.voiced)
+    return 1.0f;
+
+  const auto mapping = mapper.mapNote(hop.midiNote, hop.frequencyHz, hop.voiced);
+
+  if (mapping.leadTargetFrequencyHz <= 0.0f || mapping.detectedFrequencyHz <= 0.0f)
+    return 1.0f;
+
+  float ratio = std::clamp(mapping.leadTargetFrequencyHz / mapping.detectedFrequencyHz,
+                           DSPConfig::minPitchShiftRatio, DSPConfig::maxPitchShiftRatio);
+
+  if (humanizeAmount > 0.0f)
+    ratio = applyHumanization(ratio, mapping.detectedMidiNote, mapping.leadTargetMidiNote);
+
+  return ratio;
+}
+
+void LeadCorrection::shiftWithLookahead(juce::AudioBuffer<float> &buffer,
+                                        const PitchDetector &detector,
+                                        const PitchMapper &mapper) {
+  const int numSamples = std::min(buffer.getNumSamples(), static_cast<int>(ratioTrack.size()));
+  const int channels = buffer.getNumChannels();
+  float *track = ratioTrack.data();
+
+  //==========================================================================
+  // TARGET TRACK: each hop's ratio holds until the next hop
+  //==========================================================================
+
+  int filled = 0;
+
+  for (int h = 0; h < detector.getNumHopsInLastBlock(); ++h) {
+    const auto &hop = detector.getHopResult(h);
+    const int start = std::clamp(hop.sampleOffset, filled, numSamples);
+
+    std::fill(track + filled, track + start, targetPitchRatio);
+    filled = start;
+    targetPitchRatio = calculateHopPitchRatio(hop, mapper);
+  }
+
+  std::fill(track + filled, track + numSamples, targetPitchRatio);
+
+  //==========================================================================
+  // ZERO-PHASE SMOOTHING
+  // Forward pass carries state between blocks; the backward pass starts from
+  // the block's end and pulls each change earlier by the same amount
+  //==========================================================================
+
+  float smoothed = currentPitchRatio;
+
+  for (int i = 0; i < numSamples; ++i) {
+    smoothed += lookaheadSmoothingCoeff * (track[i] - smoothed);
+    track[i] = smoothed;
+  }
+
+  currentPitchRatio = smoothed;
+
+  for (int i = numSamples - 1; i >= 0; --i) {
+    smoothed += lookaheadSmoothingCoeff * (track[i] - smoothed);
+    track[i] = smoothed;
+  }
+
+  currentCorrectionAmount = NovaTuneUtils::ratioToSemitones(numSamples > 0 ? track[numSamples - 1] : currentPitchRatio);
+
+  //==========================================================================
+  // APPLY PITCH SHIFTING, a short run at a time
+  //==========================================================================
+
+  for (int start = 0; start < numSamples; start += DSPConfig::renderRatioUpdateSamples) {
+    const int length = std::min(DSPConfig::renderRatioUpdateSamples, numSamples - start);
+    const float ratio = track[start + length / 2];
+
+    for (int ch = 0; ch < channels && ch < static_cast<int>(pitchShifters.size()); ++ch) {
+      auto &shifter = pitchShifters[static_cast<size_t>(ch)];
+      shifter.setPitchRatio(ratio);
+      shifter.process(buffer.getWritePointer(ch, start), length);
+    }
+  }
+}
+
+void LeadCorrection::storeDry(const juce::AudioBuffer<float> &buffer) {
+  const int numSamples = buffer.getNumSamples();
+  const int channels = std::min(buffer.getNumChannels(), dryDelay.getNumChannels());
+  const int latency = std::min(getLatencySamples(), dryDelay.getNumSamples()); // Sized in prepare()
+
+  dryBuffer.setSize(buffer.getNumChannels(), numSamples, false, false, true);
+
+  if (latency <= 0) {
+    dryBuffer.makeCopyOf(buffer, true);
+    return;
+  }
+
+  // Every channel reads `latency` samples back and writes the block in its place
+  int position = dryDelayPosition;
+
+  for (int ch = 0; ch < channels; ++ch) {
+    const float *in = buffer.getReadPointer(ch);
+    float *dry = dryBuffer.getWritePointer(ch);
+    float *line = dryDelay.getWritePointer(ch);
+    position = dryDelayPosition;
+
+    for (int i = 0; i < numSamples; ++i) {
+      dry[i] = line[position];
+      line[position] = in[i];
+
+      if (++position == latency)
+        position = 0;
+    }
+  }
+
+  dryDelayPosition = position;
+}
+
+void LeadCorrection::applyMix(juce::AudioBuffer<float> &buffer) {
+  const int numSamples = buffer.getNumSamples();
+  const int channels = buffer.getNumChannels();
+
   if (mix < 1.0f) {
     float wetGain = mix;
     float dryGain = 1.0f - mix;
@@ -1,10 +1,10 @@
 #pragma once
 
 #include <juce_audio_basics/juce_audio_basics.h>
-#include <juce_audio_processors/juce_audio_processors.h>
 #include "PitchDetector.h"
 #include "PitchMapper.h"
 #include "PitchShifter.h"
+#include "EngineParameters.h"
 #include "../DSPConfig.h"
 #include "../Utilities.h"
 
@@ -62,10 +62,10 @@ public:
   void reset();
 
   /**
-   * Update parameters from the plugin state.
+   * Update parameters from the block's parameter snapshot.
    * Call this at the start of each process block.
    */
-  void updateFromParameters(juce::AudioProcessorValueTreeState &apvts);
+  void updateFromParameters(const EngineParameters &params);
 
   /**
    * Set retune speed (0-100).
@@ -90,6 +90,23 @@ public:
    */
   void setMix(float wetAmount);
 
+  /** Narrow the shifters' grain search (see PitchShifter::setSearchRangeScale) */
+  void setSearchRangeScale(float scale) noexcept {
+    for (auto &shifter : pitchShifters)
+      shifter.setSearchRangeScale(scale);
+  }
+
+  /**
+   * Render (offline) configuration, from the next prepare(): the pitch
+   * track is smoothed with lookahead (see shiftWithLookahead) and the
+   * shifters use render grain placement, starting `shifterOutputAdvance`
+   * samples early (see PitchShifter::setOutputAdvance).
+   */
+  void setRenderQuality(bool enabled, int shifterOutputAdvance) noexcept {
+    renderQuality = enabled;
+    outputAdvance = shifterOutputAdvance;
+  }
+
   /**
    * Process audio buffer.
    *
@@ -127,6 +144,10 @@ private:
   float vibratoAmount = 0.0f;   // 0-100
   float mix = 1.0f;             // 0.0-1.0 (wet amount)
 
+  // Render configuration (see setRenderQuality)
+  bool renderQuality = false;
+  int outputAdvance = 0;
+
   //==========================================================================
   // INTERNAL STATE
   //==========================================================================
@@ -139,12 +160,22 @@ private:
   float currentPitchRatio = 1.0f;
   float pitchRatioSmoothingCoeff = 0.1f;
 
+  // Render: each pass of the forward-backward smoother has half the time
+  // constant, so the pair settles in about the same time as one real-time pass
+  float lookaheadSmoothingCoeff = 0.1f;
+  std::vector<float> ratioTrack; // Per-sample pitch ratio for the block
+
   // Current correction amount (for UI)
   float currentCorrectionAmount = 0.0f;
 
   // Dry signal buffer for mix
   juce::AudioBuffer<float> dryBuffer;
 
+  // The dry signal's delay line: the shifted signal is getLatencySamples()
+  // late, so the dry one is mixed in as late to line up with it
+  juce::AudioBuffer<float> dryDelay;
+  int dryDelayPosition = 0;
+
   // Humanization state
   float humanizeOffset = 0.0f; // Current humanize pitch offset
   float humanizePhase = 0.0f;  // LFO phase for subtle drift
@@ -177,4 +208,22 @@ private:
    * Apply humanization to the target pitch ratio.
    */
   float applyHumanization(float targetRatio, float detectedMidi, float targetMidi);
+
+  /** The (humanized) target ratio for one detector hop */
+  float calculateHopPitchRatio(const PitchDetector::HopResult &hop, const PitchMapper &mapper);
+
+  /**
+   * Render path: build a per-sample target from every hop in the block,
+   * smooth it forwards and then backwards (zero phase - a note change is
+   * approached as early as it is left late, instead of lagging behind the
+   * detector), and shift the block in short runs that follow the track.
+   * Lookahead is the block itself, so it needs no extra latency.
+   */
+  void shiftWithLookahead(juce::AudioBuffer<float> &buffer, const PitchDetector &detector, const PitchMapper &mapper);
+
+  /** Copy the block into dryBuffer through the dry delay line */
+  void storeDry(const juce::AudioBuffer<float> &buffer);
+
+  /** Dry/wet mix against the stored dry signal */
+  void applyMix(juce::AudioBuffer<float> &buffer);
 };
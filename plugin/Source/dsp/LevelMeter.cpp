@@ -0,0 +1,110 @@
+#include "LevelMeter.h"
+#include <juce_dsp/juce_dsp.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/**
+ * LevelMeter.cpp
+ *
+ * Fused copy-and-measure kernel and the lock-free publication.
+ */
+
+//==============================================================================
+// MEASUREMENT
+//==============================================================================
+
+LevelMeter::Levels LevelMeter::copyAndMeasure(float *dest, const float *source, int numSamples) noexcept {
+  Levels levels;
+  int i = 0;
+
+#if JUCE_USE_SIMD
+  using Vec = juce::dsp::SIMDRegister<float>;
+  constexpr int width = static_cast<int>(Vec::SIMDNumElements);
+
+  // Host buffers have no alignment guarantee, so lanes are moved with
+  // memcpy (an unaligned vector load/store) rather than fromRawArray()
+  auto peaks = Vec::expand(0.0f);
+  auto squares = Vec::expand(0.0f);
+
+  for (; i + width <= numSamples; i += width) {
+    Vec samples;
+    std::memcpy(&samples.value, source + i, sizeof(samples.value));
+    std::memcpy(dest + i, &samples.value, sizeof(samples.value));
+
+    peaks = Vec::max(peaks, Vec::abs(samples));
+    squares = squares + samples * samples;
+  }
+
+  for (size_t lane = 0; lane < Vec::SIMDNumElements; ++lane)
+    levels.peak = std::max(levels.peak, peaks.get(lane));
+
+  levels.sumOfSquares = squares.sum();
+#endif
+
+  // Tail (or everything, without SIMD)
+  for (; i < numSamples; ++i) {
+    dest[i] = source[i];
+    accumulate(levels, source[i]);
+  }
+
+  return levels;
+}
+
+//==============================================================================
+// PUBLICATION (audio thread)
+//==============================================================================
+
+void LevelMeter::addBlock(int channel, const Levels &levels, int numSamples) noexcept {
+  if (channel < 0 || channel >= maxChannels || numSamples <= 0)
+    return;
+
+  auto &meter = channels[static_cast<size_t>(channel)];
+
+  // Single writer: plain load/store instead of read-modify-write
+  if (levels.peak > meter.peak.load(std::memory_order_relaxed))
+    meter.peak.store(levels.peak, std::memory_order_relaxed);
+
+  meter.sumOfSquares.store(meter.sumOfSquares.load(std::memory_order_relaxed) + levels.sumOfSquares,
+                           std::memory_order_relaxed);
+  meter.numSamples.store(meter.numSamples.load(std::memory_order_relaxed) + static_cast<uint64_t>(numSamples),
+                         std::memory_order_release);
+}
+
+//==============================================================================
+// CONTROL AND READING
+//==============================================================================
+
+void LevelMeter::setNumChannels(int numChannels) noexcept {
+  activeChannels.store(std::clamp(numChannels, 1, maxChannels), std::memory_order_relaxed);
+}
+
+float LevelMeter::takePeak(int channel) noexcept {
+  if (channel < 0 || channel >= maxChannels)
+    return 0.0f;
+
+  return channels[static_cast<size_t>(channel)].peak.exchange(0.0f, std::memory_order_relaxed);
+}
+
+LevelMeter::Totals LevelMeter::getTotals(int channel) const noexcept {
+  Totals totals;
+
+  if (channel < 0 || channel >= maxChannels)
+    return totals;
+
+  const auto &meter = channels[static_cast<size_t>(channel)];
+
+  // Count first: the sum read after it covers at least those samples
+  totals.numSamples = meter.numSamples.load(std::memory_order_acquire);
+  totals.sumOfSquares = meter.sumOfSquares.load(std::memory_order_relaxed);
+  return totals;
+}
+
+float LevelMeter::getRms(const Totals &previous, const Totals &current) noexcept {
+  if (current.numSamples <= previous.numSamples)
+    return 0.0f;
+
+  const double meanSquare = (current.sumOfSquares - previous.sumOfSquares) /
+                            static_cast<double>(current.numSamples - previous.numSamples);
+  return static_cast<float>(std::sqrt(std::max(0.0, meanSquare)));
+}
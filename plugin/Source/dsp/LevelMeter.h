@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * LevelMeter.h
+ *
+ * Peak and RMS metering published from the audio thread without locks or,
+ * in real time, an extra pass over the audio.
+ *
+ * HOW IT WORKS:
+ * - The engine measures each channel inside loops it already runs: the
+ *   input while copying the dry signal (copyAndMeasure, SIMD), the output
+ *   in the soft clipper. A block costs a max and a multiply-add per
+ *   sample, on data that is already in registers. The render-quality
+ *   clipper is oversampled, so its output is metered in a pass after
+ *   downsampling instead
+ * - addBlock() folds the block's peak into a "peak since last read" and
+ *   adds its sum of squares and sample count to cumulative counters
+ * - The UI diffs the cumulative counters against its previous read for
+ *   RMS over its refresh interval (like StageProfiler's totals), and
+ *   takes the peak with takePeak(). Peak hold and decay are the UI's job
+ *
+ * THREADING:
+ * One writer (the audio thread), one peak reader. takePeak() races with
+ * the writer's load/store only in the harmless direction - a peak can be
+ * reported in two reads, but is never lost, so a clip always shows.
+ */
+class LevelMeter {
+public:
+  /** Channels metered; any beyond this are ignored */
+  static constexpr int maxChannels = 2;
+
+  /** One channel's measurement of one block */
+  struct Levels {
+    float peak = 0.0f; // Largest absolute sample
+    float sumOfSquares = 0.0f;
+  };
+
+  /** Cumulative counters for one channel, as read by the UI */
+  struct Totals {
+    double sumOfSquares = 0.0;
+    uint64_t numSamples = 0;
+  };
+
+  //==========================================================================
+  // MEASUREMENT (pure - use on any thread)
+  //==========================================================================
+
+  /** dest = source, measuring source on the way - one pass, vectorised */
+  static Levels copyAndMeasure(float *dest, const float *source, int numSamples) noexcept;
+
+  /** Add one sample to a running measurement (for loops that already touch every sample) */
+  static void accumulate(Levels &levels, float sample) noexcept {
+    const float magnitude = sample < 0.0f ? -sample : sample;
+    levels.peak = magnitude > levels.peak ? magnitude : levels.peak;
+    levels.sumOfSquares += sample * sample;
+  }
+
+  //==========================================================================
+  // AUDIO THREAD
+  //==========================================================================
+
+  /** Publish one channel's block */
+  void addBlock(int channel, const Levels &levels, int numSamples) noexcept;
+
+  //==========================================================================
+  // CONTROL (message thread, before playback)
+  //==========================================================================
+
+  /** Number of channels the engine is metering (1 = mono) */
+  void setNumChannels(int numChannels) noexcept;
+  int getNumChannels() const noexcept { return activeChannels.load(std::memory_order_relaxed); }
+
+  //==========================================================================
+  // UI
+  //==========================================================================
+
+  /** Largest absolute sample since the previous call (single reader) */
+  float takePeak(int channel) noexcept;
+
+  /** Cumulative sum of squares and sample count (any number of readers) */
+  Totals getTotals(int channel) const noexcept;
+
+  /** RMS of the samples between two reads of getTotals() (0 if none) */
+  static float getRms(const Totals &previous, const Totals &current) noexcept;
+
+private:
+  struct Channel {
+    std::atomic<float> peak{0.0f};
+    std::atomic<double> sumOfSquares{0.0};
+    std::atomic<uint64_t> numSamples{0};
+  };
+
+  std::array<Channel, maxChannels> channels;
+  std::atomic<int> activeChannels{maxChannels};
+};
@@ -1,6 +1,8 @@
 #include "PitchDetector.h"
 #include <cmath>
+#include <complex>
 #include <algorithm>
+#include <cstring>
 
 /**
  * PitchDetector.cpp
@@ -24,18 +26,41 @@ void PitchDetector::prepare(double sr, int maxBlockSize) {
   // Calculate frame size that works well at this sample rate
   // We want roughly the same time duration regardless of sample rate
   // ~46ms at 44.1kHz = 2048 samples
-  frameSize = static_cast<int>(0.046 * sampleRate);
+  frameSize = static_cast<int>(frameDurationSeconds * sampleRate);
   // Round up to nearest power of 2 for efficiency
   frameSize = juce::nextPowerOfTwo(frameSize);
   frameSize = std::min(frameSize, 4096); // Cap to prevent excessive latency
+  baseFrameSize = frameSize;
+
+  if (fullLag) {
+    // Twice the real-time window, and every lag down to the lowest input type
+    integrationWindow = baseFrameSize;
+    numLags = std::min(baseFrameSize, static_cast<int>(std::ceil(sampleRate / DSPConfig::instrumentMinHz)) + 2);
+    frameSize = integrationWindow + numLags;
+  } else {
+    integrationWindow = frameSize / 2;
+    numLags = frameSize / 2;
+  }
 
   // Hop size: how often we analyze (smaller = more responsive, more CPU)
-  hopSize = frameSize / 8; // Analyze every ~6ms
+  hopSize = std::max(1, baseFrameSize / hopDivisor) * hopMultiplier; // Analyze every ~6ms by default
 
   // Resize internal buffers
   monoBuffer.setSize(1, maxBlockSize);
   analysisFrame.setSize(1, frameSize);
-  yinBuffer.resize(static_cast<size_t>(frameSize / 2));
+  yinBuffer.resize(static_cast<size_t>(numLags));
+
+  if (fullLag) {
+    // Linear (not circular) correlation needs the whole frame within one FFT
+    const int fftOrder = juce::roundToInt(std::log2(juce::nextPowerOfTwo(frameSize)));
+    lagFFT = std::make_unique<juce::dsp::FFT>(fftOrder);
+    lagFrameSpectrum.assign(static_cast<size_t>(lagFFT->getSize() * 2), 0.0f);
+    lagWindowSpectrum.assign(static_cast<size_t>(lagFFT->getSize() * 2), 0.0f);
+  } else {
+    lagFFT.reset();
+    lagFrameSpectrum = {};
+    lagWindowSpectrum = {};
+  }
 
   // Ring buffer must be at least frameSize
   int ringSize = std::max(DSPConfig::ringBufferSize, frameSize * 2);
@@ -65,6 +90,22 @@ void PitchDetector::setInputType(NovaTuneEnums::InputType type) {
   updateFrequencyRange();
 }
 
+void PitchDetector::setFrameDuration(double seconds) {
+  frameDurationSeconds = std::max(0.005, seconds);
+}
+
+void PitchDetector::setHopDivisor(int divisor) {
+  hopDivisor = std::max(1, divisor);
+  hopSize = std::max(1, baseFrameSize / hopDivisor) * hopMultiplier;
+  samplesUntilNextAnalysis = std::min(samplesUntilNextAnalysis, hopSize);
+}
+
+void PitchDetector::setHopMultiplier(int multiplier) {
+  hopMultiplier = std::max(1, multiplier);
+  hopSize = std::max(1, baseFrameSize / hopDivisor) * hopMultiplier;
+  samplesUntilNextAnalysis = std::min(samplesUntilNextAnalysis, hopSize);
+}
+
 void PitchDetector::updateFrequencyRange() {
   // Set frequency search range based on voice type
   // This prevents octave errors by limiting where we look for the pitch
@@ -93,6 +134,8 @@ void PitchDetector::process(const juce::AudioBuffer<float> &buffer) {
   const int numSamples = buffer.getNumSamples();
   const int numChannels = buffer.getNumChannels();
 
+  numHopsInBlock = 0;
+
   if (numSamples == 0)
     return;
 
@@ -154,45 +197,69 @@ void PitchDetector::process(const juce::AudioBuffer<float> &buffer) {
       //==================================================================
 
       // 4a: Compute difference function
-      computeDifferenceFunction(frame, frameSize);
-
-      // 4b: Cumulative mean normalized difference
-      computeCumulativeMeanNormalizedDifference();
-
-      // 4c: Absolute threshold to find period
-      float rawPeriod = absoluteThreshold();
-
-      if (rawPeriod > 0.0f) {
-        // 4d: Refine with parabolic interpolation
-        detectedPeriod = parabolicInterpolation(static_cast<int>(rawPeriod));
-        detectedFrequencyHz = periodToFrequency(detectedPeriod);
-
-        // Validate frequency is in expected range
-        if (detectedFrequencyHz >= minFreqHz && detectedFrequencyHz <= maxFreqHz) {
-          voiced = true;
-          detectedMidiNote = NovaTuneUtils::frequencyToMidiNote(detectedFrequencyHz);
-
-          // Confidence is inverse of the YIN value at the detected period
-          int tauInt = static_cast<int>(rawPeriod);
-          if (tauInt < static_cast<int>(yinBuffer.size())) {
-            confidence = 1.0f - yinBuffer[static_cast<size_t>(tauInt)];
-            confidence = std::clamp(confidence, 0.0f, 1.0f);
-          }
-        } else {
-          // Frequency out of range - likely an octave error
-          voiced = false;
-          confidence = 0.0f;
-        }
-      } else {
-        // No pitch detected (silence or noise)
-        voiced = false;
-        detectedFrequencyHz = 0.0f;
-        detectedMidiNote = 0.0f;
-        detectedPeriod = 0.0f;
-        confidence = 0.0f;
+      if (fullLag)
+        computeDifferenceFunctionFullLag(frame);
+      else
+        computeDifferenceFunction(frame, frameSize);
+
+      analyseHop(i);
+    }
+  }
+}
+
+void PitchDetector::analyseHop(int sampleOffset) {
+  /**
+   * Steps 4b-5 for one hop, from the difference function in yinBuffer
+   * (computed here by process(), or across streams by analyseHopFrom()).
+   */
+
+  // 4b: Cumulative mean normalized difference
+  computeCumulativeMeanNormalizedDifference();
+
+  // 4c: Absolute threshold to find period
+  float rawPeriod = absoluteThreshold();
+
+  if (rawPeriod > 0.0f) {
+    // 4d: Refine with parabolic interpolation
+    detectedPeriod = parabolicInterpolation(static_cast<int>(rawPeriod));
+    detectedFrequencyHz = periodToFrequency(detectedPeriod);
+
+    // Validate frequency is in expected range
+    if (detectedFrequencyHz >= minFreqHz && detectedFrequencyHz <= maxFreqHz) {
+      voiced = true;
+      detectedMidiNote = NovaTuneUtils::frequencyToMidiNote(detectedFrequencyHz);
+
+      // Confidence is inverse of the YIN value at the detected period
+      int tauInt = static_cast<int>(rawPeriod);
+      if (tauInt < static_cast<int>(yinBuffer.size())) {
+        confidence = 1.0f - yinBuffer[static_cast<size_t>(tauInt)];
+        confidence = std::clamp(confidence, 0.0f, 1.0f);
       }
+    } else {
+      // Frequency out of range - likely an octave error
+      voiced = false;
+      confidence = 0.0f;
     }
+  } else {
+    // No pitch detected (silence or noise)
+    voiced = false;
+    detectedFrequencyHz = 0.0f;
+    detectedMidiNote = 0.0f;
+    detectedPeriod = 0.0f;
+    confidence = 0.0f;
   }
+
+  //==================================================================
+  // Step 5: Record the hop for per-hop consumers (UI pitch history)
+  //==================================================================
+
+  auto &hop = hopResults[static_cast<size_t>(std::min(numHopsInBlock, maxHopsPerBlock - 1))];
+  hop.sampleOffset = sampleOffset;
+  hop.voiced = voiced;
+  hop.frequencyHz = voiced ? detectedFrequencyHz : 0.0f;
+  hop.midiNote = voiced ? detectedMidiNote : 0.0f;
+  hop.confidence = confidence;
+  numHopsInBlock = std::min(numHopsInBlock + 1, maxHopsPerBlock);
 }
 
 void PitchDetector::computeDifferenceFunction(const float *input, int numSamples) {
@@ -228,6 +295,171 @@ void PitchDetector::computeDifferenceFunction(const float *input, int numSamples
   }
 }
 
+void PitchDetector::computeDifferenceFunctionFullLag(const float *frame) {
+  /**
+   * The same sum as computeDifferenceFunction(), but the window is the
+   * newest integrationWindow samples and each is compared with the sample
+   * τ BEFORE it. The frame is exactly numLags + integrationWindow long, so
+   * the largest lag stays inside it.
+   *
+   * Summed directly that is integrationWindow x numLags multiplies a hop -
+   * about five million at 48kHz, as much as the rest of a render. Expanded,
+   *   d(τ) = Σ w[j]² + Σ w[j-τ]² - 2 Σ w[j]·w[j-τ]
+   * the first term is constant, the second slides by one sample per lag,
+   * and the third is a cross-correlation of the window with the frame: one
+   * FFT of each, a product, and an inverse FFT.
+   */
+
+  const int fftSize = lagFFT->getSize();
+  const int frameLength = integrationWindow + numLags;
+  const float *window = frame + numLags;
+
+  std::copy(frame, frame + frameLength, lagFrameSpectrum.begin());
+  std::fill(lagFrameSpectrum.begin() + frameLength, lagFrameSpectrum.end(), 0.0f);
+  std::copy(window, window + integrationWindow, lagWindowSpectrum.begin());
+  std::fill(lagWindowSpectrum.begin() + integrationWindow, lagWindowSpectrum.end(), 0.0f);
+
+  lagFFT->performRealOnlyForwardTransform(lagFrameSpectrum.data());
+  lagFFT->performRealOnlyForwardTransform(lagWindowSpectrum.data());
+
+  // Frame x conj(window): the inverse gives r[k] = Σ w[j]·frame[j + k]
+  auto *frameBins = reinterpret_cast<std::complex<float> *>(lagFrameSpectrum.data());
+  const auto *windowBins = reinterpret_cast<const std::complex<float> *>(lagWindowSpectrum.data());
+
+  for (int k = 0; k < fftSize; ++k)
+    frameBins[k] *= std::conj(windowBins[k]);
+
+  lagFFT->performRealOnlyInverseTransform(lagFrameSpectrum.data());
+  const float *correlation = lagFrameSpectrum.data();
+
+  // Energies in double: the sliding sum runs over every lag
+  double windowEnergy = 0.0;
+  for (int j = 0; j < integrationWindow; ++j)
+    windowEnergy += static_cast<double>(window[j]) * window[j];
+
+  double laggedEnergy = windowEnergy;
+
+  yinBuffer[0] = 0.0f;
+
+  for (int tau = 1; tau < numLags; ++tau) {
+    // Window shifted back by τ: gains frame[numLags - τ], loses its newest sample
+    const double entering = window[-tau];
+    const double leaving = window[integrationWindow - tau];
+    laggedEnergy += entering * entering - leaving * leaving;
+
+    const double cross = correlation[numLags - tau];
+    const double difference = windowEnergy + laggedEnergy - 2.0 * cross;
+
+    // Rounding can leave a perfect match a hair below zero
+    yinBuffer[static_cast<size_t>(tau)] = static_cast<float>(std::max(0.0, difference));
+  }
+}
+
+//==============================================================================
+// LOCKSTEP ANALYSIS
+//==============================================================================
+
+bool PitchDetector::push(const float *mono, int numSamples) noexcept {
+  const int ringSize = static_cast<int>(inputRingBuffer.size());
+
+  for (int i = 0; i < numSamples; ++i) {
+    inputRingBuffer[static_cast<size_t>(ringBufferWritePos)] = mono[i];
+    ringBufferWritePos = (ringBufferWritePos + 1) % ringSize;
+  }
+
+  // Same countdown as process(), taken a run of samples at a time
+  samplesUntilNextAnalysis -= numSamples;
+
+  if (samplesUntilNextAnalysis > 0)
+    return false;
+
+  samplesUntilNextAnalysis = hopSize;
+  return true;
+}
+
+void PitchDetector::gatherFrame(float *dest, int stride) const noexcept {
+  const int ringSize = static_cast<int>(inputRingBuffer.size());
+  const int readPos = (ringBufferWritePos - frameSize + ringSize) % ringSize;
+
+  for (int j = 0; j < frameSize; ++j)
+    dest[static_cast<size_t>(j) * static_cast<size_t>(stride)] =
+        inputRingBuffer[static_cast<size_t>((readPos + j) % ringSize)];
+}
+
+void PitchDetector::analyseHopFrom(int sampleOffset, const float *difference, int stride) noexcept {
+  jassert(!fullLag); // The lane kernel computes the half-frame form
+
+  for (size_t tau = 0; tau < yinBuffer.size(); ++tau)
+    yinBuffer[tau] = difference[tau * static_cast<size_t>(stride)];
+
+  analyseHop(sampleOffset);
+}
+
+void PitchDetector::replayHop(int sampleOffset, float frequencyHz, float hopConfidence, bool hopVoiced) noexcept {
+  // The state analyseHop() leaves behind, so the getters agree with the hop
+  voiced = hopVoiced && frequencyHz > 0.0f;
+  detectedFrequencyHz = voiced ? frequencyHz : 0.0f;
+  detectedMidiNote = voiced ? NovaTuneUtils::frequencyToMidiNote(frequencyHz) : 0.0f;
+  detectedPeriod = voiced ? static_cast<float>(sampleRate) / frequencyHz : 0.0f;
+  confidence = voiced ? std::clamp(hopConfidence, 0.0f, 1.0f) : 0.0f;
+
+  auto &hop = hopResults[static_cast<size_t>(std::min(numHopsInBlock, maxHopsPerBlock - 1))];
+  hop.sampleOffset = sampleOffset;
+  hop.voiced = voiced;
+  hop.frequencyHz = detectedFrequencyHz;
+  hop.midiNote = detectedMidiNote;
+  hop.confidence = confidence;
+  numHopsInBlock = std::min(numHopsInBlock + 1, maxHopsPerBlock);
+}
+
+void PitchDetector::computeDifferenceFunctionLanes(const float *frames, int frameSize, float *difference) noexcept {
+  /**
+   * computeDifferenceFunction() for kernelLanes frames side by side. Each
+   * lane accumulates its own sum in the same order as the scalar loop, so
+   * every lane's d(τ) matches what that frame alone would produce.
+   */
+
+  const int yinSize = frameSize / 2;
+  constexpr int lanes = kernelLanes;
+
+  std::fill(difference, difference + lanes, 0.0f);
+
+#if JUCE_USE_SIMD
+  using Vec = juce::dsp::SIMDRegister<float>;
+
+  // memcpy loads: the caller's buffers need not be SIMD-aligned
+  auto load = [](const float *source) {
+    Vec v;
+    std::memcpy(&v.value, source, sizeof(v.value));
+    return v;
+  };
+
+  for (int tau = 1; tau < yinSize; ++tau) {
+    Vec sum(0.0f);
+
+    for (int j = 0; j < yinSize; ++j) {
+      const Vec diff = load(frames + j * lanes) - load(frames + (j + tau) * lanes);
+      sum += diff * diff;
+    }
+
+    std::memcpy(difference + tau * lanes, &sum.value, sizeof(sum.value));
+  }
+#else
+  for (int tau = 1; tau < yinSize; ++tau) {
+    float sum[lanes] = {};
+
+    for (int j = 0; j < yinSize; ++j) {
+      for (int lane = 0; lane < lanes; ++lane) {
+        const float diff = frames[j * lanes + lane] - frames[(j + tau) * lanes + lane];
+        sum[lane] += diff * diff;
+      }
+    }
+
+    std::copy(sum, sum + lanes, difference + tau * lanes);
+  }
+#endif
+}
+
 void PitchDetector::computeCumulativeMeanNormalizedDifference() {
   /**
    * Cumulative Mean Normalized Difference Function d'(τ):
@@ -283,7 +515,7 @@ float PitchDetector::absoluteThreshold() {
   // Search for the first dip below threshold
   int tau = minTau;
   while (tau < maxTau) {
-    if (yinBuffer[static_cast<size_t>(tau)] < DSPConfig::yinThreshold) {
+    if (yinBuffer[static_cast<size_t>(tau)] < threshold) {
       // Found a candidate - now find the local minimum
       while (tau + 1 < maxTau &&
              yinBuffer[static_cast<size_t>(tau + 1)] < yinBuffer[static_cast<size_t>(tau)]) {
@@ -1,6 +1,10 @@
 #pragma once
 
 #include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+#include <algorithm>
+#include <array>
+#include <memory>
 #include <vector>
 #include "../DSPConfig.h"
 #include "../Utilities.h"
@@ -35,6 +39,18 @@
  */
 class PitchDetector {
 public:
+  /** One analysis hop, as recorded during the last process() call */
+  struct HopResult {
+    int sampleOffset = 0;     // Sample in the block at which the hop ran
+    float frequencyHz = 0.0f; // 0 when unvoiced
+    float midiNote = 0.0f;    // 0 when unvoiced
+    float confidence = 0.0f;
+    bool voiced = false;
+  };
+
+  /** Hops kept per block; beyond this the last slot is overwritten */
+  static constexpr int maxHopsPerBlock = 64;
+
   PitchDetector();
   ~PitchDetector() = default;
 
@@ -68,6 +84,66 @@ public:
    */
   void setInputType(NovaTuneEnums::InputType type);
 
+  //==========================================================================
+  // ANALYSIS CONFIGURATION
+  // Defaults match DSPConfig. The tools sweep these to trade accuracy for CPU.
+  //==========================================================================
+
+  /**
+   * Set the analysis frame duration (default ~46ms).
+   * Takes effect on the next prepare(), where the frame buffers are sized.
+   * The frame is rounded up to a power of 2 and capped at 4096 samples.
+   */
+  void setFrameDuration(double seconds);
+
+  /**
+   * Analyse every frameSize / divisor samples (default 8).
+   * Larger divisor = more responsive, more CPU. Safe on the audio thread.
+   */
+  void setHopDivisor(int divisor);
+
+  /**
+   * Stretch the hop to `multiplier` times its normal length (default 1).
+   * Used by the CPU guard to analyse less often. Safe on the audio thread.
+   */
+  void setHopMultiplier(int multiplier);
+
+  /**
+   * Full-lag analysis (default off; the render configuration turns it on).
+   * Takes effect on the next prepare().
+   *
+   * Real time, d(τ) compares the first half of the frame with the frame
+   * shifted by τ, so the estimate describes audio about 1.5 half-frames
+   * old. Full-lag integrates over a window twice as long, placed at the
+   * NEWEST end of a longer frame and compared with the audio τ before it,
+   * for every lag down to the lowest input type's pitch. Longer integration
+   * (steadier estimates) without older estimates - tracking isn't slowed.
+   */
+  void setFullLag(bool shouldUseFullLag) { fullLag = shouldUseFullLag; }
+
+  /**
+   * Set the YIN absolute threshold (default DSPConfig::yinThreshold).
+   * Lower = stricter voicing decision, fewer octave errors.
+   */
+  void setThreshold(float newThreshold) { threshold = newThreshold; }
+
+  /** Analysis frame size in samples (window + lags when full-lag) */
+  int getFrameSize() const noexcept { return frameSize; }
+
+  /** Samples between analyses */
+  int getHopSize() const noexcept { return hopSize; }
+
+  /**
+   * How far before a hop's sample the audio its pitch describes lies (see
+   * setFullLag): the frame ends at the hop, so the estimate is of the past
+   */
+  int getAnalysisDelaySamples() const noexcept { return fullLag ? integrationWindow / 2 : frameSize * 3 / 4; }
+
+  /** The rest of the analysis configuration (cached tracks are keyed on it) */
+  double getSampleRate() const noexcept { return sampleRate; }
+  float getThreshold() const noexcept { return threshold; }
+  bool isFullLag() const noexcept { return fullLag; }
+
   //==========================================================================
   // GETTERS - Call these after process() to get detection results
   //==========================================================================
@@ -87,6 +163,70 @@ public:
   /** Get the detected period in samples */
   float getPeriodSamples() const noexcept { return detectedPeriod; }
 
+  /**
+   * Every analysis that ran during the last process() call, in order.
+   * The getters above only report the last one; a block can contain
+   * several hops (or none).
+   */
+  int getNumHopsInLastBlock() const noexcept { return numHopsInBlock; }
+  const HopResult &getHopResult(int index) const noexcept { return hopResults[static_cast<size_t>(index)]; }
+
+  //==========================================================================
+  // LOCKSTEP ANALYSIS (NovaTuneBatch)
+  // Feeds the detector sample-wise instead of through process(), so the
+  // difference function of several detectors' frames can be computed in
+  // one pass of computeDifferenceFunctionLanes(). Results are identical.
+  //==========================================================================
+
+  /** Frames the cross-detector kernel handles per pass (the float SIMD width) */
+#if JUCE_USE_SIMD
+  static constexpr int kernelLanes = static_cast<int>(juce::dsp::SIMDRegister<float>::SIMDNumElements);
+#else
+  static constexpr int kernelLanes = 4;
+#endif
+
+  /** Start a block fed through push() (clears the hop list) */
+  void beginBlock() noexcept { numHopsInBlock = 0; }
+
+  /** Most samples push() may take before a hop is due (at least 1) */
+  int getSamplesUntilNextHop() const noexcept { return std::max(1, samplesUntilNextAnalysis); }
+
+  /**
+   * Append mono input; numSamples must not exceed getSamplesUntilNextHop().
+   * Returns true when a hop is due - gather its frame and finish it with
+   * analyseHopFrom() before pushing more.
+   */
+  bool push(const float *mono, int numSamples) noexcept;
+
+  /** Copy the due hop's frame to dest[j * stride], j = 0..frameSize-1 */
+  void gatherFrame(float *dest, int stride) const noexcept;
+
+  /**
+   * Finish a due hop from a difference function computed elsewhere:
+   * d(τ) at difference[τ * stride], τ = 0..frameSize/2-1. Half-frame
+   * analysis only (not full-lag).
+   */
+  void analyseHopFrom(int sampleOffset, const float *difference, int stride) noexcept;
+
+  /**
+   * The YIN difference function of kernelLanes frames at once.
+   *
+   * Frames are interleaved [sample][lane] (frames[j * kernelLanes + lane])
+   * so every lag is one vector of sums across frames - no horizontal
+   * reductions, and every lane does exactly the same work.
+   *
+   * @param difference frameSize / 2 lags, interleaved the same way
+   */
+  static void computeDifferenceFunctionLanes(const float *frames, int frameSize, float *difference) noexcept;
+
+  //==========================================================================
+  // REPLAY (PitchTrack)
+  // Records a hop analysed earlier - e.g. read from the pitch analysis
+  // cache - as if it had just run. Call beginBlock() first.
+  //==========================================================================
+
+  void replayHop(int sampleOffset, float frequencyHz, float hopConfidence, bool hopVoiced) noexcept;
+
 private:
   //==========================================================================
   // INTERNAL STATE
@@ -95,6 +235,18 @@ private:
   double sampleRate = 44100.0;
   int frameSize = DSPConfig::pitchDetectionFrameSize;
   int hopSize = DSPConfig::pitchDetectionHopSize;
+  double frameDurationSeconds = 0.046;
+  int hopDivisor = DSPConfig::pitchDetectionHopDivisor;
+
+  // The frame duration in samples; hops and the full-lag window derive from it
+  int baseFrameSize = DSPConfig::pitchDetectionFrameSize;
+
+  // Full-lag: integrationWindow newest samples, numLags lags (see setFullLag)
+  bool fullLag = false;
+  int integrationWindow = DSPConfig::pitchDetectionFrameSize / 2;
+  int numLags = DSPConfig::pitchDetectionFrameSize / 2;
+  int hopMultiplier = 1;
+  float threshold = DSPConfig::yinThreshold;
 
   // Input type affects the pitch search range
   NovaTuneEnums::InputType inputType = NovaTuneEnums::InputType::AltoTenor;
@@ -108,11 +260,20 @@ private:
   bool voiced = false;
   float confidence = 0.0f;
 
+  // Hops analysed during the current process() call
+  std::array<HopResult, maxHopsPerBlock> hopResults;
+  int numHopsInBlock = 0;
+
   // Internal buffers (pre-allocated to avoid runtime allocation)
   juce::AudioBuffer<float> monoBuffer;    // Summed mono input
   juce::AudioBuffer<float> analysisFrame; // Current analysis frame
   std::vector<float> yinBuffer;           // YIN difference function
   std::vector<float> inputRingBuffer;     // Ring buffer for accumulating input
+
+  // Full-lag only: cross-correlation by FFT (see computeDifferenceFunctionFullLag)
+  std::unique_ptr<juce::dsp::FFT> lagFFT;
+  std::vector<float> lagFrameSpectrum;  // 2 x FFT size: the frame, then the correlation
+  std::vector<float> lagWindowSpectrum; // 2 x FFT size: the newest integrationWindow samples
   int ringBufferWritePos = 0;
   int samplesUntilNextAnalysis = 0;
 
@@ -131,6 +292,19 @@ private:
    */
   void computeDifferenceFunction(const float *input, int numSamples);
 
+  /**
+   * Step 1, full-lag: d(τ) = Σ (x[j] - x[j-τ])² over the newest
+   * integrationWindow samples of the frame, for τ < numLags. Expanded into
+   * two energies and a cross-correlation, the last computed by FFT.
+   */
+  void computeDifferenceFunctionFullLag(const float *frame);
+
+  /**
+   * Steps 2-4 and the hop record, from the difference function already in
+   * yinBuffer. Shared by process() and analyseHopFrom().
+   */
+  void analyseHop(int sampleOffset);
+
   /**
    * Step 2: Compute cumulative mean normalized difference function d'(τ).
    *
@@ -0,0 +1,37 @@
+#include "PitchHistory.h"
+#include <algorithm>
+
+/**
+ * PitchHistory.cpp
+ *
+ * SPSC ring for per-hop pitch frames.
+ */
+
+PitchHistory::PitchHistory()
+    : ring(static_cast<size_t>(capacity)) {
+}
+
+void PitchHistory::push(const PitchFrame &frame) noexcept {
+  const auto scope = fifo.write(1);
+
+  if (scope.blockSize1 == 0) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  ring[static_cast<size_t>(scope.startIndex1)] = frame;
+}
+
+int PitchHistory::pop(PitchFrame *dest, int maxFrames) noexcept {
+  const auto scope = fifo.read(std::min(maxFrames, fifo.getNumReady()));
+
+  std::copy_n(ring.begin() + scope.startIndex1, scope.blockSize1, dest);
+  std::copy_n(ring.begin() + scope.startIndex2, scope.blockSize2, dest + scope.blockSize1);
+
+  return scope.blockSize1 + scope.blockSize2;
+}
+
+void PitchHistory::discardAll() noexcept {
+  // Reading without copying - reset() would race with the writer
+  fifo.read(fifo.getNumReady());
+}
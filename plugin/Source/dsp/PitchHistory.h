@@ -0,0 +1,91 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "../DSPConfig.h"
+
+/**
+ * PitchHistory.h
+ *
+ * Lock-free channel carrying one PitchFrame per detector hop from the
+ * audio thread to the editor.
+ *
+ * WHY?
+ * The editor used to read PitchDetector and PitchMapper members through a
+ * const reference while the audio thread was writing them - a torn read -
+ * and only saw whatever the last hop happened to be every 33ms. With the
+ * channel, every hop reaches the UI intact, in order, with its own
+ * timestamp, and the UI never touches the DSP objects.
+ *
+ *   Audio thread (TunerEngine)             Message thread (editor)
+ *   ──────────────────────────             ───────────────────────
+ *   push(frame) per hop ──► [ SPSC ring ] ──► pop() on each timer tick
+ *
+ * - push() is wait-free: one copy into a juce::AbstractFifo slot. If the
+ *   ring is full (editor closed, or stalled) the frame is dropped and
+ *   counted - the audio thread never waits
+ * - Exactly one reader. The editor drains the ring and hands the frames to
+ *   whichever components need them
+ *
+ * ANALOGY: Like a WebSocket event stream replacing a UI that polled a
+ * shared object - the client gets every event, in order, and can't catch
+ * the server mid-update.
+ */
+
+//==============================================================================
+// FRAME
+//==============================================================================
+
+/** One detector hop, mapped and stamped */
+struct PitchFrame {
+  double timeSeconds = 0.0;          // Stream time of the hop, since the engine was reset
+  bool voiced = false;
+  float detectedMidiNote = 0.0f;     // 0 when unvoiced
+  float confidence = 0.0f;
+  float targetMidiNote = 0.0f;       // Scale-quantised target, 0 when unvoiced
+  float correctionSemitones = 0.0f;  // Correction the lead shifter was applying
+  float voiceMidiNotes[DSPConfig::maxHarmonyVoices] = {}; // 0 = voice off or muted
+};
+
+static_assert(std::is_trivially_copyable_v<PitchFrame>, "Frames are copied between threads by value");
+
+//==============================================================================
+// CHANNEL
+//==============================================================================
+
+class PitchHistory {
+public:
+  /** ~12 seconds of hops at the default ~6ms hop */
+  static constexpr int capacity = 2048;
+
+  PitchHistory();
+
+  //==========================================================================
+  // AUDIO THREAD
+  //==========================================================================
+
+  /** Queue a frame. Wait-free; drops (and counts) the frame if the ring is full. */
+  void push(const PitchFrame &frame) noexcept;
+
+  //==========================================================================
+  // READER (one thread - the editor)
+  //==========================================================================
+
+  /** Move up to maxFrames queued frames, oldest first, into dest. Returns the count. */
+  int pop(PitchFrame *dest, int maxFrames) noexcept;
+
+  /** Throw away everything queued (e.g. the backlog built up while no editor was open) */
+  void discardAll() noexcept;
+
+  /** Frames dropped because the ring was full, since construction */
+  uint64_t getNumDropped() const noexcept { return dropped.load(std::memory_order_relaxed); }
+
+private:
+  juce::AbstractFifo fifo{capacity};
+  std::vector<PitchFrame> ring;
+  std::atomic<uint64_t> dropped{0};
+
+  JUCE_DECLARE_NON_COPYABLE(PitchHistory)
+};
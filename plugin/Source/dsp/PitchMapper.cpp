@@ -22,44 +22,37 @@ void PitchMapper::reset() {
   lastResult = PitchMappingResult();
 }
 
-void PitchMapper::updateFromParameters(juce::AudioProcessorValueTreeState &apvts) {
-  using namespace ParamIDs;
-
+void PitchMapper::updateFromParameters(const EngineParameters &params) {
   // Get key and scale
-  int keyIndex = static_cast<int>(apvts.getRawParameterValue(key)->load());
-  int scaleIndex = static_cast<int>(apvts.getRawParameterValue(scale)->load());
-
-  currentKey = static_cast<NovaTuneEnums::Key>(keyIndex);
-  currentScale = static_cast<NovaTuneEnums::Scale>(scaleIndex);
+  currentKey = params.key;
+  currentScale = params.scale;
 
   // Update cached scale data
-  keyRootNote = keyIndex; // 0=C, 1=C#, etc.
+  keyRootNote = static_cast<int>(currentKey); // 0=C, 1=C#, etc.
   scaleIntervals = NovaTuneEnums::getScaleIntervals(currentScale);
 
   // Update harmony settings for each voice
-  const char *enabledIds[] = {A_enabled, B_enabled, C_enabled};
-  const char *modeIds[] = {A_mode, B_mode, C_mode};
-  const char *diaIds[] = {A_intervalDiatonic, B_intervalDiatonic, C_intervalDiatonic};
-  const char *semiIds[] = {A_intervalSemi, B_intervalSemi, C_intervalSemi};
-
   for (int i = 0; i < DSPConfig::maxHarmonyVoices; ++i) {
-    harmonySettings[i].enabled = apvts.getRawParameterValue(enabledIds[i])->load() > 0.5f;
-    harmonySettings[i].mode = static_cast<NovaTuneEnums::HarmonyMode>(
-        static_cast<int>(apvts.getRawParameterValue(modeIds[i])->load()));
-    harmonySettings[i].diatonicIntervalIndex =
-        static_cast<int>(apvts.getRawParameterValue(diaIds[i])->load());
-    harmonySettings[i].semitoneOffset =
-        static_cast<int>(apvts.getRawParameterValue(semiIds[i])->load());
+    const auto &voice = params.voices[static_cast<size_t>(i)];
+    harmonySettings[i].enabled = voice.enabled;
+    harmonySettings[i].mode = voice.mode;
+    harmonySettings[i].diatonicIntervalIndex = voice.diatonicIntervalIndex;
+    harmonySettings[i].semitoneOffset = voice.semitoneOffset;
   }
 }
 
 PitchMappingResult PitchMapper::map(const PitchDetector &detector) {
+  lastResult = mapNote(detector.getMidiNote(), detector.getFrequencyHz(), detector.isVoiced());
+  return lastResult;
+}
+
+PitchMappingResult PitchMapper::mapNote(float detectedMidiNote, float detectedFrequencyHz, bool isVoiced) const {
   PitchMappingResult result;
 
   // Copy detection results
-  result.detectedMidiNote = detector.getMidiNote();
-  result.detectedFrequencyHz = detector.getFrequencyHz();
-  result.isVoiced = detector.isVoiced();
+  result.detectedMidiNote = detectedMidiNote;
+  result.detectedFrequencyHz = detectedFrequencyHz;
+  result.isVoiced = isVoiced;
 
   if (!result.isVoiced) {
     // No pitch detected - copy zeros for everything
@@ -71,7 +64,6 @@ PitchMappingResult PitchMapper::map(const PitchDetector &detector) {
       result.harmonyTargetMidiNotes[i] = 0.0f;
     }
 
-    lastResult = result;
     return result;
   }
 
@@ -91,7 +83,6 @@ PitchMappingResult PitchMapper::map(const PitchDetector &detector) {
     }
   }
 
-  lastResult = result;
   return result;
 }
 
@@ -1,7 +1,8 @@
 #pragma once
 
-#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_core/juce_core.h>
 #include "../ParameterIDs.h"
+#include "EngineParameters.h"
 #include "../Utilities.h"
 #include "PitchDetector.h"
 
@@ -69,12 +70,12 @@ public:
   void reset();
 
   /**
-   * Update mapping parameters from the plugin's parameter state.
+   * Update mapping parameters from the block's parameter snapshot.
    * Call this once per process block before calling map().
    *
-   * @param apvts The AudioProcessorValueTreeState containing all parameters
+   * @param params Key, scale and harmony intervals
    */
-  void updateFromParameters(juce::AudioProcessorValueTreeState &apvts);
+  void updateFromParameters(const EngineParameters &params);
 
   /**
    * Map detected pitch to target notes.
@@ -84,6 +85,12 @@ public:
    */
   PitchMappingResult map(const PitchDetector &detector);
 
+  /**
+   * Map an arbitrary detection with the current settings, without touching
+   * getLastResult(). Used to map individual detector hops.
+   */
+  PitchMappingResult mapNote(float detectedMidiNote, float detectedFrequencyHz, bool isVoiced) const;
+
   /**
    * Calculate the target MIDI note for a specific harmony voice.
    *
@@ -33,7 +33,8 @@ void PitchShifter::prepare(double sr, int maxBlock) {
 
   // Latency is approximately the window size
   // We need to buffer at least one window before we can output
-  latencySamples = windowSize;
+  // (less any advance a later stage uses for its own delay)
+  latencySamples = windowSize - std::min(outputAdvance, windowSize / 4);
 
   // Size input buffer to hold enough for analysis
   // Need at least 2x window size + search range
@@ -72,7 +73,7 @@ void PitchShifter::reset() {
   inputWritePos = 0;
   inputSamplesAvailable = 0;
   outputReadPos = 0;
-  outputWritePos = windowSize; // Start with latency offset
+  outputWritePos = latencySamples; // Start with latency offset
   inputPhase = 0.0f;
   outputPhase = 0.0f;
   lastInputGrainStart = 0;
@@ -168,7 +169,8 @@ void PitchShifter::processGrains() {
 
   // Calculate where to read the next grain from
   // We advance by analysisHopSize in the input for each grain
-  int grainStartPos = lastInputGrainStart + analysisHopSize;
+  // (wrapped, so the distance check below stays within one ring length)
+  int grainStartPos = (lastInputGrainStart + analysisHopSize) % inputBufferSize;
 
   // Ensure we have enough samples
   int availableFromStart = inputWritePos - grainStartPos;
@@ -194,7 +196,8 @@ void PitchShifter::processGrains() {
 
   // Nominal position is where we'd place it based purely on synthesis hop
   // Search range is how far we look for a better position
-  int searchRange = analysisHopSize / 2;
+  const int fullSearchRange = renderQuality ? analysisHopSize : analysisHopSize / 2;
+  int searchRange = static_cast<int>(static_cast<float>(fullSearchRange) * searchRangeScale);
   int nominalPos = outputWritePos;
 
   int bestPos = findBestGrainPosition(nominalPos, searchRange);
@@ -250,17 +253,28 @@ int PitchShifter::findBestGrainPosition(int nominalPos, int searchRange) {
 
   const int outputBufferSize = static_cast<int>(outputBuffer.size());
 
+  // Render: the earliest start that hasn't been read out yet
+  int earliestPos = nominalPos - searchRange;
+
+  if (renderQuality) {
+    int ahead = (nominalPos - outputReadPos + outputBufferSize) % outputBufferSize;
+    if (ahead > outputBufferSize / 2)
+      ahead -= outputBufferSize; // Nominal position is already behind the read position
+
+    earliestPos = nominalPos - ahead;
+  }
+
   // If this is the first grain, just use nominal position
-  if (outputWritePos == windowSize) {
-    return nominalPos;
+  if (outputWritePos == latencySamples) {
+    return std::max(nominalPos, earliestPos);
   }
 
-  int bestPos = nominalPos;
+  int bestPos = std::max(nominalPos, earliestPos);
   float bestCorrelation = -1.0f;
 
   // Search around nominal position
-  int searchStart = nominalPos - searchRange;
-  int searchEnd = nominalPos + searchRange;
+  int searchStart = std::max(nominalPos - searchRange, earliestPos);
+  int searchEnd = std::max(nominalPos + searchRange, searchStart);
 
   for (int pos = searchStart; pos <= searchEnd; ++pos) {
     float correlation = 0.0f;
@@ -269,7 +283,7 @@ int PitchShifter::findBestGrainPosition(int nominalPos, int searchRange) {
 
     // Calculate correlation over the overlap region
     // We only need to check the first part of the grain (the overlap)
-    int overlapLength = std::min(windowSize / 2, windowSize);
+    int overlapLength = renderQuality ? windowSize : windowSize / 2;
 
     for (int i = 0; i < overlapLength; ++i) {
       int outputPos = (pos + i) % outputBufferSize;
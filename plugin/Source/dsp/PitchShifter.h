@@ -78,6 +78,29 @@ public:
    */
   void setPitchSemitones(float semitones);
 
+  /**
+   * Scale the waveform-similarity search range (1 = the full +/- half hop,
+   * 0 = plain overlap-add at the nominal position). The search is most of
+   * the shifter's CPU, so the CPU guard narrows it first.
+   * Safe on the audio thread; applies from the next grain.
+   */
+  void setSearchRangeScale(float scale) noexcept { searchRangeScale = std::clamp(scale, 0.0f, 1.0f); }
+
+  /**
+   * Render (offline) grain placement: search +/- a whole analysis hop
+   * (twice the real-time range), score each candidate over the whole grain
+   * rather than its first half, and never start a grain on output that has
+   * already been read. Safe on the audio thread; applies from the next grain.
+   */
+  void setRenderQuality(bool enabled) noexcept { renderQuality = enabled; }
+
+  /**
+   * Start the output `samples` earlier than the window length, so a later
+   * stage with its own delay (the render clipper's oversampling) keeps the
+   * total at the real-time latency. Call before prepare().
+   */
+  void setOutputAdvance(int samples) noexcept { outputAdvance = std::max(0, samples); }
+
   /**
    * Get the current pitch ratio.
    */
@@ -119,6 +142,13 @@ private:
   // Analysis hop size (how far we move between grains)
   int analysisHopSize = 256;
 
+  // Fraction of the full similarity search range in use
+  float searchRangeScale = 1.0f;
+
+  // Render configuration (see setRenderQuality / setOutputAdvance)
+  bool renderQuality = false;
+  int outputAdvance = 0;
+
   // Current pitch ratio (1.0 = no shift)
   float targetPitchRatio = 1.0f;
   float currentPitchRatio = 1.0f;    // Smoothed version
@@ -0,0 +1,218 @@
+#include "PitchTrack.h"
+#include <cmath>
+#include <cstring>
+
+/**
+ * PitchTrack.cpp
+ *
+ * Hop recording, the .ntpt encoder, and the memory-mapped decoder.
+ */
+
+namespace {
+
+  // Pitch unit: 1/1000 semitone
+  constexpr float pitchScale = 1000.0f;
+
+  uint32_t zigzag(int32_t value) noexcept {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+  }
+
+  int32_t unzigzag(uint32_t value) noexcept {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1u);
+  }
+
+  void writeVarint(juce::MemoryOutputStream &out, uint32_t value) {
+    while (value >= 0x80u) {
+      out.writeByte(static_cast<char>((value & 0x7fu) | 0x80u));
+      value >>= 7;
+    }
+
+    out.writeByte(static_cast<char>(value));
+  }
+
+  /** Advances `pos`; false if the varint runs past `end` or is over 5 bytes */
+  bool readVarint(const uint8_t *&pos, const uint8_t *end, uint32_t &value) noexcept {
+    value = 0;
+
+    for (int shift = 0; shift < 35 && pos < end; shift += 7) {
+      const uint8_t byte = *pos++;
+      value |= static_cast<uint32_t>(byte & 0x7fu) << shift;
+
+      if ((byte & 0x80u) == 0)
+        return true;
+    }
+
+    return false;
+  }
+
+} // namespace
+
+//==============================================================================
+// RECORDING
+//==============================================================================
+
+void PitchTrack::reset(double sampleRate, int hopSize) {
+  timing = {sampleRate, hopSize, 0};
+  hops.clear();
+  valid = sampleRate > 0.0 && hopSize > 0;
+}
+
+void PitchTrack::append(juce::int64 sample, const PitchDetector::HopResult &hop) {
+  if (hops.empty())
+    timing.firstHopSample = sample;
+  else if (sample != timing.firstHopSample + static_cast<juce::int64>(hops.size()) * timing.hopSize)
+    valid = false;
+
+  hops.push_back({hop.voiced ? hop.frequencyHz : 0.0f, hop.voiced ? hop.confidence : 0.0f, hop.voiced});
+}
+
+//==============================================================================
+// ENCODING
+//==============================================================================
+
+bool PitchTrack::write(juce::OutputStream &stream, const Key &key) const {
+  if (!isValid())
+    return false;
+
+  const int numChunks = (getNumHops() + hopsPerChunk - 1) / hopsPerChunk;
+
+  // Chunks first, so the index can hold their offsets
+  juce::MemoryOutputStream chunkData;
+  std::vector<uint32_t> index;
+  index.reserve(static_cast<size_t>(numChunks) + 1);
+
+  for (int chunk = 0; chunk < numChunks; ++chunk) {
+    index.push_back(static_cast<uint32_t>(chunkData.getDataSize()));
+    int32_t previousPitch = 0;
+
+    const int end = std::min(getNumHops(), (chunk + 1) * hopsPerChunk);
+
+    for (int h = chunk * hopsPerChunk; h < end; ++h) {
+      const auto &hop = getHop(h);
+
+      if (!hop.voiced || hop.frequencyHz <= 0.0f) {
+        chunkData.writeByte(0);
+        continue;
+      }
+
+      const auto pitch = static_cast<int32_t>(std::lround(NovaTuneUtils::frequencyToMidiNote(hop.frequencyHz) * pitchScale));
+      chunkData.writeByte(static_cast<char>(1 + std::lround(std::clamp(hop.confidence, 0.0f, 1.0f) * 254.0f)));
+      writeVarint(chunkData, zigzag(pitch - previousPitch));
+      previousPitch = pitch;
+    }
+  }
+
+  index.push_back(static_cast<uint32_t>(chunkData.getDataSize()));
+
+  FileHeader header;
+  header.key = key;
+  header.sampleRate = timing.sampleRate;
+  header.firstHopSample = timing.firstHopSample;
+  header.hopSize = static_cast<uint32_t>(timing.hopSize);
+  header.numHops = static_cast<uint32_t>(getNumHops());
+  header.numChunks = static_cast<uint32_t>(numChunks);
+
+  return stream.write(&header, sizeof(header)) &&
+         stream.write(index.data(), index.size() * sizeof(uint32_t)) &&
+         stream.write(chunkData.getData(), chunkData.getDataSize());
+}
+
+//==============================================================================
+// MAPPED READER
+//==============================================================================
+
+std::unique_ptr<MappedPitchTrack> MappedPitchTrack::open(const juce::File &file, const PitchTrack::Key *expectedKey,
+                                                         juce::String &error) {
+  std::unique_ptr<MappedPitchTrack> track(new MappedPitchTrack(file));
+
+  const auto *bytes = static_cast<const uint8_t *>(track->mapping.getData());
+  const size_t size = track->mapping.getSize();
+
+  if (bytes == nullptr || size < sizeof(PitchTrack::FileHeader)) {
+    error = "Could not map " + file.getFullPathName();
+    return nullptr;
+  }
+
+  PitchTrack::FileHeader header;
+  std::memcpy(&header, bytes, sizeof(header));
+
+  const PitchTrack::FileHeader expected;
+
+  if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version ||
+      header.hopsPerChunk != expected.hopsPerChunk) {
+    error = file.getFileName() + " is not a version " + juce::String(expected.version) + " pitch track";
+    return nullptr;
+  }
+
+  if (expectedKey != nullptr && header.key != *expectedKey) {
+    error = file.getFileName() + " is a track of different audio or settings";
+    return nullptr;
+  }
+
+  const size_t indexBytes = (static_cast<size_t>(header.numChunks) + 1) * sizeof(uint32_t);
+
+  if (header.sampleRate <= 0.0 || header.hopSize == 0 || header.numHops > static_cast<uint32_t>(INT32_MAX) ||
+      header.numChunks != (header.numHops + PitchTrack::hopsPerChunk - 1) / PitchTrack::hopsPerChunk ||
+      size < sizeof(header) + indexBytes) {
+    error = file.getFileName() + " has a damaged header";
+    return nullptr;
+  }
+
+  track->timing = {header.sampleRate, static_cast<int>(header.hopSize), header.firstHopSample};
+  track->numHops = static_cast<int>(header.numHops);
+  track->numChunks = static_cast<int>(header.numChunks);
+
+  // The mapping is page-aligned and the header a multiple of 4 bytes, so the index is aligned
+  track->chunkIndex = reinterpret_cast<const uint32_t *>(bytes + sizeof(header));
+  track->data = bytes + sizeof(header) + indexBytes;
+  track->dataSize = size - sizeof(header) - indexBytes;
+
+  if (track->chunkIndex[track->numChunks] > track->dataSize) {
+    error = file.getFileName() + " is truncated";
+    return nullptr;
+  }
+
+  return track;
+}
+
+int MappedPitchTrack::decodeChunk(int chunk, PitchTrack::Hop *dest) const noexcept {
+  if (chunk < 0 || chunk >= numChunks)
+    return 0;
+
+  const uint32_t begin = chunkIndex[chunk];
+  const uint32_t end = chunkIndex[chunk + 1];
+
+  if (begin > end || end > dataSize)
+    return 0;
+
+  const uint8_t *pos = data + begin;
+  const uint8_t *const stop = data + end;
+
+  const int count = std::min(PitchTrack::hopsPerChunk, numHops - chunk * PitchTrack::hopsPerChunk);
+  int32_t pitch = 0;
+
+  for (int h = 0; h < count; ++h) {
+    if (pos >= stop)
+      return 0;
+
+    const uint8_t flag = *pos++;
+    auto &hop = dest[h];
+
+    if (flag == 0) {
+      hop = {};
+      continue;
+    }
+
+    uint32_t delta = 0;
+    if (!readVarint(pos, stop, delta))
+      return 0;
+
+    pitch += unzigzag(delta);
+
+    hop.voiced = true;
+    hop.confidence = static_cast<float>(flag - 1) / 254.0f;
+    hop.frequencyHz = NovaTuneUtils::midiNoteToFrequency(static_cast<float>(pitch) / pitchScale);
+  }
+
+  return count;
+}
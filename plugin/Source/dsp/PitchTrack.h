@@ -0,0 +1,150 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <memory>
+#include <vector>
+#include "PitchDetector.h"
+
+/**
+ * PitchTrack.h
+ *
+ * The detector's hops for a whole stream, and their compact on-disk form.
+ *
+ * WHY?
+ * Offline work renders the same takes again and again - a new preset on
+ * yesterday's lead, an edit in the graph, a batch re-run - and every
+ * render repeated the YIN pass although neither the audio nor the detector
+ * settings had changed. A PitchTrack records the hops of one render; later
+ * renders replay it (TunerEngine::setPitchTrack) instead of detecting.
+ * PitchAnalysisCache keeps tracks on disk, keyed by audio and settings.
+ *
+ * FILE FORMAT (.ntpt, little-endian):
+ *   FileHeader | chunk index: (numChunks + 1) x uint32 | chunk data
+ *
+ *   Hops are stored hopsPerChunk to a chunk, each as:
+ *   - 1 byte: 0 = unvoiced, else 1 + confidence quantised to 0..254
+ *   - voiced only: the pitch in 1/1000 semitone (0.1 cent) as a zigzag
+ *     varint, the delta from the previous voiced hop of the chunk
+ *   A held note costs about 2 bytes a hop instead of 12. Every chunk
+ *   starts from zero, so any hop is reached by decoding one chunk; the
+ *   index holds each chunk's offset into the data (and the data's end).
+ *
+ * Replayed hops match the recorded ones to within 0.05 cent and 0.002
+ * confidence.
+ *
+ * ANALOGY: Like a video stream's keyframes - deltas in between, and an
+ * index to seek straight to any one of them.
+ */
+
+class PitchTrack {
+public:
+  /** One hop, as replayed */
+  struct Hop {
+    float frequencyHz = 0.0f; // 0 when unvoiced
+    float confidence = 0.0f;
+    bool voiced = false;
+  };
+
+  /** Where the hops fall: hop k ran at timeline sample firstHopSample + k * hopSize */
+  struct Timing {
+    double sampleRate = 0.0;
+    int hopSize = 0;
+    juce::int64 firstHopSample = 0;
+  };
+
+  /** Identifies the analysed audio and settings (see PitchAnalysisCache::makeKey) */
+  using Key = std::array<uint8_t, 16>;
+
+  static constexpr int hopsPerChunk = 256;
+
+  /** First bytes of every .ntpt file */
+  struct FileHeader {
+    char magic[4] = {'N', 'T', 'P', 'T'};
+    uint32_t version = 1;
+    Key key = {};
+    double sampleRate = 0.0;
+    int64_t firstHopSample = 0;
+    uint32_t hopSize = 0;
+    uint32_t numHops = 0;
+    uint32_t hopsPerChunk = PitchTrack::hopsPerChunk;
+    uint32_t numChunks = 0;
+  };
+
+  static_assert(std::is_trivially_copyable_v<FileHeader>, "The header is written to disk as raw bytes");
+
+  //==========================================================================
+  // RECORDING
+  //==========================================================================
+
+  /** Clear the track for a stream at this rate and hop */
+  void reset(double sampleRate, int hopSize);
+
+  /**
+   * Append a hop that ran at timeline sample `sample`. Allocates: offline
+   * renders only. A hop off the regular grid (a changed hop size, a
+   * dropped block) makes the track invalid, since replay assumes the grid.
+   */
+  void append(juce::int64 sample, const PitchDetector::HopResult &hop);
+
+  bool isValid() const noexcept { return valid && !hops.empty(); }
+
+  const Timing &getTiming() const noexcept { return timing; }
+  int getNumHops() const noexcept { return static_cast<int>(hops.size()); }
+  const Hop &getHop(int index) const noexcept { return hops[static_cast<size_t>(index)]; }
+
+  //==========================================================================
+  // FILE
+  //==========================================================================
+
+  /** Encode to `stream` in the .ntpt format */
+  bool write(juce::OutputStream &stream, const Key &key) const;
+
+private:
+  Timing timing;
+  std::vector<Hop> hops;
+  bool valid = true;
+};
+
+//==============================================================================
+// MAPPED READER
+//==============================================================================
+
+/**
+ * A .ntpt file mapped read-only. Opening checks the header and index
+ * (no hop data is read); chunks are decoded on demand, so pages are only
+ * touched where a render actually plays. Decoding is const and keeps no
+ * state, so one mapped track can feed several engines at once.
+ */
+class MappedPitchTrack {
+public:
+  /**
+   * Map `file`. Returns nullptr with an error if it isn't a valid track,
+   * or (with expectedKey) is a track of something else.
+   */
+  static std::unique_ptr<MappedPitchTrack> open(const juce::File &file, const PitchTrack::Key *expectedKey,
+                                                juce::String &error);
+
+  const PitchTrack::Timing &getTiming() const noexcept { return timing; }
+  int getNumHops() const noexcept { return numHops; }
+  int getNumChunks() const noexcept { return numChunks; }
+
+  /**
+   * Decode chunk `chunk` into dest (PitchTrack::hopsPerChunk entries).
+   * Returns the hops decoded - fewer in the last chunk, 0 if the chunk is
+   * corrupt.
+   */
+  int decodeChunk(int chunk, PitchTrack::Hop *dest) const noexcept;
+
+private:
+  MappedPitchTrack(const juce::File &file) : mapping(file, juce::MemoryMappedFile::readOnly) {}
+
+  juce::MemoryMappedFile mapping;
+  PitchTrack::Timing timing;
+  int numHops = 0;
+  int numChunks = 0;
+
+  const uint32_t *chunkIndex = nullptr; // numChunks + 1 offsets into data
+  const uint8_t *data = nullptr;
+  size_t dataSize = 0;
+};
@@ -0,0 +1,63 @@
+#include "StageProfiler.h"
+
+/**
+ * StageProfiler.cpp
+ *
+ * Counter bookkeeping for the per-stage CPU profiler.
+ */
+
+StageProfiler::Totals StageProfiler::getTotals() const noexcept {
+  Totals totals;
+
+  for (size_t i = 0; i < stageNanos.size(); ++i)
+    totals.stageNanos[i] = stageNanos[i].load(std::memory_order_relaxed);
+
+  totals.budgetNanos = budgetNanos.load(std::memory_order_relaxed);
+  totals.processNanos = processNanos.load(std::memory_order_relaxed);
+  totals.peakBlockPermille = peakBlockPermille.load(std::memory_order_relaxed);
+  totals.blocks = blocks.load(std::memory_order_relaxed);
+  return totals;
+}
+
+const char *StageProfiler::getStageName(Stage stage) noexcept {
+  switch (stage) {
+    case detection:
+      return "Detection";
+    case mapping:
+      return "Mapping";
+    case leadShift:
+      return "Lead Shift";
+    case harmonyA:
+      return "Harmony A";
+    case harmonyB:
+      return "Harmony B";
+    case harmonyC:
+      return "Harmony C";
+    case formant:
+      return "Formant";
+    case mix:
+      return "Mix";
+    case clip:
+      return "Clip";
+    case numStages:
+      break;
+  }
+
+  return "?";
+}
+
+void StageProfiler::endBlock(Clock::time_point blockStart, int numSamples, double sampleRate) noexcept {
+  const int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - blockStart).count();
+  const int64_t budget = blockBudgetNanos(numSamples, sampleRate);
+
+  budgetNanos.fetch_add(budget, std::memory_order_relaxed);
+  processNanos.fetch_add(elapsed, std::memory_order_relaxed);
+  blocks.fetch_add(1, std::memory_order_relaxed);
+
+  // Single writer, so a plain compare-and-store is enough for the max
+  if (budget > 0) {
+    const int64_t permille = elapsed * 1000 / budget;
+    if (permille > peakBlockPermille.load(std::memory_order_relaxed))
+      peakBlockPermille.store(permille, std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * StageProfiler.h
+ *
+ * Low-overhead per-stage CPU timing for the TunerEngine, always compiled
+ * in and switched on at runtime by its clients (the editor's CPU overlay,
+ * the telemetry recorder).
+ *
+ * When a user on a heavy session reports dropouts, this answers "which
+ * stage is eating the budget?" without attaching a profiler.
+ *
+ * HOW IT WORKS:
+ * - The audio thread times each stage with a ScopedTimer and adds the
+ *   nanoseconds to lock-free cumulative counters
+ * - Every block also adds its real-time budget (numSamples / sampleRate)
+ * - Readers diff the cumulative totals against their previous read, so
+ *   stage time / budget time = share of the CPU budget used. Counters are
+ *   never cleared, so any number of readers can do this independently
+ *
+ * ANALOGY: Like the timing breakdown in a browser's network tab - the
+ * request (block) has a deadline and each phase (DNS, connect, TTFB...)
+ * gets a bar showing how much of it that phase took.
+ *
+ * COST:
+ * Disabled, a ScopedTimer is one relaxed atomic load. Enabled, it is one
+ * steady_clock read per lap plus one relaxed fetch_add per stage.
+ *
+ * THREADING:
+ * One writer (the audio thread), any number of readers. Totals are read
+ * stage by stage, so a snapshot can straddle a block - harmless for a
+ * display averaged over many blocks.
+ */
+class StageProfiler {
+public:
+  /** Timed stages, in signal-flow order */
+  enum Stage {
+    detection = 0,
+    mapping,
+    leadShift,
+    harmonyA,
+    harmonyB,
+    harmonyC,
+    formant, // All voices' formant filters
+    mix,
+    clip,
+    numStages
+  };
+
+  /** Cumulative counters, as read by the UI */
+  struct Totals {
+    std::array<int64_t, numStages> stageNanos{};
+    int64_t budgetNanos = 0;       // Sum of every block's real-time deadline
+    int64_t processNanos = 0;      // Whole-block time, including untimed glue
+    int64_t peakBlockPermille = 0; // Worst single block, 1000 = whole budget
+    int64_t blocks = 0;
+  };
+
+  //==========================================================================
+  // CONTROL (any thread)
+  //==========================================================================
+
+  /** Timers run while at least one client is registered */
+  void addClient() noexcept { clients.fetch_add(1, std::memory_order_relaxed); }
+  void removeClient() noexcept { clients.fetch_sub(1, std::memory_order_relaxed); }
+  bool isEnabled() const noexcept { return clients.load(std::memory_order_relaxed) > 0; }
+
+  /** Restart peak tracking (the other counters are cumulative) */
+  void resetPeak() noexcept { peakBlockPermille.store(0, std::memory_order_relaxed); }
+
+  /** Current cumulative totals */
+  Totals getTotals() const noexcept;
+
+  /** Display name, e.g. "Harmony A" */
+  static const char *getStageName(Stage stage) noexcept;
+
+  /** Harmony stage for a voice index (0 = A) */
+  static Stage harmonyStage(int voiceIndex) noexcept {
+    return static_cast<Stage>(harmonyA + voiceIndex);
+  }
+
+  //==========================================================================
+  // AUDIO THREAD
+  //==========================================================================
+
+  using Clock = std::chrono::steady_clock;
+
+  /** Record a finished block that started at `blockStart` (only call while enabled) */
+  void endBlock(Clock::time_point blockStart, int numSamples, double sampleRate) noexcept;
+
+  /** Add time to a stage */
+  void addTime(Stage stage, int64_t nanos) noexcept {
+    stageNanos[static_cast<size_t>(stage)].fetch_add(nanos, std::memory_order_relaxed);
+  }
+
+  /**
+   * Times a sequence of stages. Each lap() charges the time since the
+   * previous lap (or construction) to a stage; the destructor charges the
+   * rest to the stage given at construction, unless release() stopped the
+   * timer first. A null or disabled profiler makes every call a no-op.
+   *
+   *   StageProfiler::ScopedTimer timer(profiler, StageProfiler::mix);
+   *   detect();  timer.lap(StageProfiler::detection);
+   *   map();     timer.lap(StageProfiler::mapping);
+   *   mixDown(); // charged to mix on scope exit
+   */
+  class ScopedTimer {
+  public:
+    ScopedTimer(StageProfiler *profilerToUse, Stage finalStage) noexcept
+        : profiler(profilerToUse != nullptr && profilerToUse->isEnabled() ? profilerToUse : nullptr),
+          stage(finalStage) {
+      if (profiler != nullptr)
+        lapStart = Clock::now();
+    }
+
+    ~ScopedTimer() { lap(stage); }
+
+    void lap(Stage chargedStage) noexcept {
+      if (profiler == nullptr)
+        return;
+
+      const auto now = Clock::now();
+      profiler->addTime(chargedStage, std::chrono::duration_cast<std::chrono::nanoseconds>(now - lapStart).count());
+      lapStart = now;
+    }
+
+    /** Restart the lap without charging it (the time was charged elsewhere) */
+    void skip() noexcept {
+      if (profiler != nullptr)
+        lapStart = Clock::now();
+    }
+
+    /** Stop timing: later laps and the destructor charge nothing (the block is closed) */
+    void release() noexcept { profiler = nullptr; }
+
+  private:
+    StageProfiler *profiler;
+    Stage stage;
+    Clock::time_point lapStart;
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+  };
+
+private:
+  std::atomic<int> clients{0};
+
+  std::array<std::atomic<int64_t>, numStages> stageNanos{};
+  std::atomic<int64_t> budgetNanos{0};
+  std::atomic<int64_t> processNanos{0};
+  std::atomic<int64_t> peakBlockPermille{0};
+  std::atomic<int64_t> blocks{0};
+
+  static int64_t blockBudgetNanos(int numSamples, double sampleRate) noexcept {
+    return sampleRate > 0.0 ? static_cast<int64_t>(1.0e9 * numSamples / sampleRate) : 0;
+  }
+};
@@ -8,6 +8,10 @@
 
 TunerEngine::TunerEngine() {
   // Components will be properly initialized in prepare()
+
+  for (int i = 0; i < DSPConfig::maxHarmonyVoices; ++i) {
+    harmonyVoices[static_cast<size_t>(i)].setProfiler(&profiler, StageProfiler::harmonyStage(i));
+  }
 }
 
 void TunerEngine::prepare(double sr, int blockSize, int channels) {
@@ -15,12 +19,29 @@ void TunerEngine::prepare(double sr, int blockSize, int channels) {
   samplesPerBlock = blockSize;
   numChannels = channels;
 
+  // Render quality: oversampled clipper, whose delay the shifters absorb
+  clipOversampler.reset();
+  clipLatency = 0;
+
+  if (renderQuality) {
+    clipOversampler = std::make_unique<juce::dsp::Oversampling<float>>(
+        static_cast<size_t>(numChannels), static_cast<size_t>(DSPConfig::renderClipOversamplingOrder),
+        juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true, false);
+    clipOversampler->initProcessing(static_cast<size_t>(samplesPerBlock));
+    clipLatency = juce::roundToInt(clipOversampler->getLatencyInSamples());
+  }
+
   // Prepare all DSP components
+  pitchDetector.setFullLag(renderQuality);
+  pitchDetector.setHopDivisor(renderQuality ? DSPConfig::renderHopDivisor : DSPConfig::pitchDetectionHopDivisor);
   pitchDetector.prepare(sampleRate, samplesPerBlock);
   pitchMapper.prepare(sampleRate);
+  harmonyMorph.prepare(sampleRate);
+  leadCorrection.setRenderQuality(renderQuality, clipLatency);
   leadCorrection.prepare(sampleRate, samplesPerBlock, numChannels);
 
   for (auto &voice : harmonyVoices) {
+    voice.setRenderQuality(renderQuality, clipLatency);
     voice.prepare(sampleRate, samplesPerBlock, numChannels);
   }
 
@@ -29,6 +50,9 @@ void TunerEngine::prepare(double sr, int blockSize, int channels) {
   harmonyBuffer.setSize(numChannels, samplesPerBlock);
   dryBuffer.setSize(numChannels, samplesPerBlock);
 
+  inputMeter.setNumChannels(numChannels);
+  outputMeter.setNumChannels(numChannels);
+
   reset();
 }
 
@@ -36,40 +60,103 @@ void TunerEngine::reset() {
   pitchDetector.reset();
   pitchMapper.reset();
   leadCorrection.reset();
+  harmonyMorph.reset();
 
   for (auto &voice : harmonyVoices) {
     voice.reset();
+    voice.setTimelinePosition(timelineStart);
   }
 
+  if (clipOversampler != nullptr)
+    clipOversampler->reset();
+
+  cpuGuard.reset();
+  samplesProcessed = static_cast<uint64_t>(timelineStart);
+
+  if (pitchTrackRecorder != nullptr)
+    pitchTrackRecorder->reset(sampleRate, pitchDetector.getHopSize());
+
   leadBuffer.clear();
   harmonyBuffer.clear();
   dryBuffer.clear();
 }
 
-void TunerEngine::updateFromParameters(juce::AudioProcessorValueTreeState &apvts) {
-  using namespace ParamIDs;
+void TunerEngine::setRandomSeed(juce::int64 seed) noexcept {
+  for (int i = 0; i < DSPConfig::maxHarmonyVoices; ++i)
+    harmonyVoices[static_cast<size_t>(i)].setRandomSeed(seed + i);
+}
 
+void TunerEngine::updateFromParameters(const EngineParameters &params) {
   // Update input type for pitch detector
-  int inputTypeIndex = static_cast<int>(apvts.getRawParameterValue(inputType)->load());
-  pitchDetector.setInputType(static_cast<NovaTuneEnums::InputType>(inputTypeIndex));
+  pitchDetector.setInputType(params.inputType);
 
   // Update pitch mapper (key, scale, harmony intervals)
-  pitchMapper.updateFromParameters(apvts);
+  pitchMapper.updateFromParameters(params);
 
   // Update lead correction (retune speed, humanize, vibrato, mix)
-  leadCorrection.updateFromParameters(apvts);
+  leadCorrection.updateFromParameters(params);
 
   // Update each harmony voice
   for (int i = 0; i < DSPConfig::maxHarmonyVoices; ++i) {
-    harmonyVoices[static_cast<size_t>(i)].updateFromParameters(i, apvts);
+    harmonyVoices[static_cast<size_t>(i)].updateFromParameters(params.voices[static_cast<size_t>(i)]);
+  }
+
+  // CPU guard policy, and the level chosen at the end of the last block
+  cpuGuard.setMode(params.cpuGuard);
+  applyCpuGuardLevel(cpuGuard.getCurrentLevel());
+}
+
+void TunerEngine::applyCpuGuardLevel(CpuGuard::Level level) {
+  // Levels are cumulative - each one keeps everything shed below it
+  const float searchScale = level >= CpuGuard::narrowSearch ? 0.25f : 1.0f;
+  const int hopMultiplier = level >= CpuGuard::longerHop ? 2 : 1;
+  const int formantBands = level >= CpuGuard::fewerBands ? FormantProcessor::getNumBands() / 2
+                                                         : FormantProcessor::getNumBands();
+
+  leadCorrection.setSearchRangeScale(searchScale);
+  pitchDetector.setHopMultiplier(hopMultiplier);
+
+  // Shed the lowest-priority (highest-index) enabled voices, always
+  // keeping at least one so a harmony part never vanishes entirely
+  int voicesToShed = level >= CpuGuard::shedVoices ? DSPConfig::maxHarmonyVoices
+                     : level >= CpuGuard::shedVoice ? 1
+                                                    : 0;
+
+  const int enabledVoices = static_cast<int>(std::count_if(harmonyVoices.begin(), harmonyVoices.end(),
+                                                           [](const HarmonyVoice &voice) { return voice.isEnabled(); }));
+  voicesToShed = std::min(voicesToShed, std::max(0, enabledVoices - 1));
+
+  for (int i = DSPConfig::maxHarmonyVoices - 1; i >= 0; --i) {
+    auto &voice = harmonyVoices[static_cast<size_t>(i)];
+    const bool shedThis = voice.isEnabled() && voicesToShed > 0;
+
+    voice.setSearchRangeScale(searchScale);
+    voice.setFormantBandLimit(formantBands);
+    voice.setShed(shedThis);
+
+    if (shedThis)
+      --voicesToShed;
   }
 }
 
 void TunerEngine::process(juce::AudioBuffer<float> &buffer,
                           juce::MidiBuffer & /*midi*/,
-                          juce::AudioProcessorValueTreeState &apvts) {
+                          const EngineParameters &params) {
+  processBlock(buffer, params, true);
+}
+
+void TunerEngine::processAnalysed(juce::AudioBuffer<float> &buffer, const EngineParameters &params) {
+  processBlock(buffer, params, false);
+}
+
+void TunerEngine::processBlock(juce::AudioBuffer<float> &buffer, const EngineParameters &params, bool runDetector) {
   const int numSamples = buffer.getNumSamples();
 
+  // Whole-block time (including parameter updates) for the CPU guard and
+  // the CPU overlay
+  const bool profiling = profiler.isEnabled();
+  const auto blockStart = StageProfiler::Clock::now();
+
   // Handle block size changes at runtime (some DAWs do this)
   if (numSamples != samplesPerBlock) {
     samplesPerBlock = numSamples;
@@ -82,6 +169,9 @@ void TunerEngine::process(juce::AudioBuffer<float> &buffer,
     for (auto &voice : harmonyVoices) {
       voice.prepare(sampleRate, samplesPerBlock, numChannels);
     }
+
+    if (clipOversampler != nullptr)
+      clipOversampler->initProcessing(static_cast<size_t>(samplesPerBlock));
   }
 
   //==========================================================================
@@ -89,21 +179,43 @@ void TunerEngine::process(juce::AudioBuffer<float> &buffer,
   // Read the current parameter values from the thread-safe state
   //==========================================================================
 
-  updateFromParameters(apvts);
+  // The voices as a harmony preset morph has them this block (once per
+  // block, so here rather than in updateFromParameters)
+  EngineParameters blockParams = params;
+  harmonyMorph.process(blockParams, numSamples);
+
+  updateFromParameters(blockParams);
+
+  // Each lap() below charges the time since the previous one to a stage
+  StageProfiler::ScopedTimer timer(&profiler, StageProfiler::clip);
 
   //==========================================================================
   // STORE DRY SIGNAL
-  // Keep a copy for dry/wet mixing later
+  // Keep a copy for dry/wet mixing later, metering the input on the way
   //==========================================================================
 
-  dryBuffer.makeCopyOf(buffer, true);
+  const int numActiveChannels = std::min(numChannels, buffer.getNumChannels());
+
+  for (int ch = 0; ch < numActiveChannels; ++ch) {
+    const auto levels = LevelMeter::copyAndMeasure(dryBuffer.getWritePointer(ch), buffer.getReadPointer(ch), numSamples);
+    inputMeter.addBlock(ch, levels, numSamples);
+  }
+
+  timer.lap(StageProfiler::mix);
 
   //==========================================================================
   // STEP 1: PITCH DETECTION
   // Analyze the input to determine what note the singer is currently singing
   //==========================================================================
 
-  pitchDetector.process(buffer);
+  if (runDetector && !replayPitchTrack(numSamples)) {
+    pitchDetector.process(buffer);
+
+    if (pitchTrackRecorder != nullptr)
+      recordPitchTrack();
+  }
+
+  timer.lap(StageProfiler::detection);
 
   //==========================================================================
   // STEP 2: PITCH MAPPING
@@ -112,6 +224,8 @@ void TunerEngine::process(juce::AudioBuffer<float> &buffer,
 
   auto mappingResult = pitchMapper.map(pitchDetector);
 
+  timer.lap(StageProfiler::mapping);
+
   //==========================================================================
   // STEP 3: LEAD CORRECTION
   // Pitch-shift the lead vocal to the target note
@@ -123,6 +237,13 @@ void TunerEngine::process(juce::AudioBuffer<float> &buffer,
   // Apply pitch correction
   leadCorrection.process(leadBuffer, pitchDetector, pitchMapper);
 
+  timer.lap(StageProfiler::leadShift);
+
+  // Every hop of this block, mapped, for the editor's pitch display
+  publishPitchFrames();
+
+  timer.lap(StageProfiler::mapping);
+
   //==========================================================================
   // STEP 4: HARMONY GENERATION
   // Generate harmony voices from the corrected lead
@@ -140,6 +261,9 @@ void TunerEngine::process(juce::AudioBuffer<float> &buffer,
         pitchMapper);
   }
 
+  // Voices time themselves (harmony and formant stages separately)
+  timer.skip();
+
   //==========================================================================
   // STEP 5: MIX OUTPUT
   // Combine corrected lead with harmony voices
@@ -153,19 +277,164 @@ void TunerEngine::process(juce::AudioBuffer<float> &buffer,
     buffer.addFrom(ch, 0, harmonyBuffer, ch, 0, numSamples);
   }
 
+  timer.lap(StageProfiler::mix);
+
   //==========================================================================
   // STEP 6: SOFT CLIP / PROTECT
   // Prevent digital clipping when harmonies stack up
   //==========================================================================
 
   // Simple soft clipper using tanh
-  // This prevents harsh digital distortion when all voices are loud
-  for (int ch = 0; ch < numChannels; ++ch) {
-    float *data = buffer.getWritePointer(ch);
-    for (int i = 0; i < numSamples; ++i) {
-      // Soft clip at approximately ±1.5 dB headroom
+  // This prevents harsh digital distortion when all voices are loud.
+  // In real time the output meter is measured in the same loop.
+  if (clipOversampler != nullptr) {
+    clipOversampled(buffer, numSamples);
+  } else {
+    for (int ch = 0; ch < numChannels; ++ch) {
+      float *data = buffer.getWritePointer(ch);
+      LevelMeter::Levels levels;
+
+      for (int i = 0; i < numSamples; ++i) {
+        // Soft clip at approximately ±1.5 dB headroom
+        data[i] = std::tanh(data[i] * 0.9f) / 0.9f;
+        LevelMeter::accumulate(levels, data[i]);
+      }
+
+      outputMeter.addBlock(ch, levels, numSamples);
+    }
+  }
+
+  timer.lap(StageProfiler::clip);
+  timer.release(); // endBlock and the CPU guard below aren't a stage
+
+  if (profiling) {
+    profiler.endBlock(blockStart, numSamples, sampleRate);
+  }
+
+  //==========================================================================
+  // CPU GUARD
+  // Pick the degradation level for the next block from this one's time
+  //==========================================================================
+
+  samplesProcessed += static_cast<uint64_t>(numSamples);
+
+  if (nonRealtime) {
+    if (cpuGuard.getCurrentLevel() != CpuGuard::full)
+      cpuGuard.reset();
+  } else {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(StageProfiler::Clock::now() - blockStart);
+    cpuGuard.update(static_cast<double>(elapsed.count()), 1.0e9 * numSamples / sampleRate);
+  }
+}
+
+void TunerEngine::setPitchTrack(const MappedPitchTrack *track) {
+  pitchTrack = track;
+  pitchTrackChunk.resize(static_cast<size_t>(PitchTrack::hopsPerChunk));
+  pitchTrackChunkIndex = -1;
+  pitchTrackChunkHops = 0;
+}
+
+bool TunerEngine::replayPitchTrack(int numSamples) {
+  if (pitchTrack == nullptr)
+    return false;
+
+  const auto &timing = pitchTrack->getTiming();
+
+  if (!juce::exactlyEqual(timing.sampleRate, sampleRate) || timing.hopSize != pitchDetector.getHopSize())
+    return false;
+
+  pitchDetector.beginBlock();
+
+  // First hop at or after this block's start
+  const auto blockStart = static_cast<juce::int64>(samplesProcessed);
+  const auto hop = static_cast<juce::int64>(timing.hopSize);
+  const auto sinceFirst = blockStart - timing.firstHopSample;
+  auto index = sinceFirst <= 0 ? juce::int64{0} : (sinceFirst + hop - 1) / hop;
+
+  for (; index < pitchTrack->getNumHops(); ++index) {
+    const auto offset = timing.firstHopSample + index * hop - blockStart;
+
+    if (offset >= numSamples)
+      break;
+
+    const int chunk = static_cast<int>(index / PitchTrack::hopsPerChunk);
+
+    if (chunk != pitchTrackChunkIndex) {
+      pitchTrackChunkHops = pitchTrack->decodeChunk(chunk, pitchTrackChunk.data());
+      pitchTrackChunkIndex = chunk;
+    }
+
+    const int slot = static_cast<int>(index % PitchTrack::hopsPerChunk);
+
+    if (slot >= pitchTrackChunkHops)
+      break; // Damaged chunk - hold the last pitch
+
+    const auto &h = pitchTrackChunk[static_cast<size_t>(slot)];
+    pitchDetector.replayHop(static_cast<int>(offset), h.frequencyHz, h.confidence, h.voiced);
+  }
+
+  return true;
+}
+
+void TunerEngine::recordPitchTrack() {
+  for (int h = 0; h < pitchDetector.getNumHopsInLastBlock(); ++h) {
+    const auto &hop = pitchDetector.getHopResult(h);
+    pitchTrackRecorder->append(static_cast<juce::int64>(samplesProcessed) + hop.sampleOffset, hop);
+  }
+}
+
+void TunerEngine::clipOversampled(juce::AudioBuffer<float> &buffer, int numSamples) {
+  const int channels = std::min(numChannels, buffer.getNumChannels());
+
+  juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(), static_cast<size_t>(channels),
+                                     static_cast<size_t>(numSamples));
+  auto upsampled = clipOversampler->processSamplesUp(block);
+
+  for (size_t ch = 0; ch < upsampled.getNumChannels(); ++ch) {
+    float *data = upsampled.getChannelPointer(ch);
+
+    for (size_t i = 0; i < upsampled.getNumSamples(); ++i)
       data[i] = std::tanh(data[i] * 0.9f) / 0.9f;
+  }
+
+  clipOversampler->processSamplesDown(block);
+
+  // Meter what leaves the plugin, after the downsampling filter. The
+  // oversampler writes the output inside its filter stages, so this is a
+  // pass of its own - render quality only, and one accumulate per output
+  // sample where metering the clip loop above would cost one per upsampled one
+  for (int ch = 0; ch < channels; ++ch) {
+    const float *data = buffer.getReadPointer(ch);
+    LevelMeter::Levels levels;
+
+    for (int i = 0; i < numSamples; ++i)
+      LevelMeter::accumulate(levels, data[i]);
+
+    outputMeter.addBlock(ch, levels, numSamples);
+  }
+}
+
+void TunerEngine::publishPitchFrames() {
+  const float correction = leadCorrection.getCurrentCorrectionSemitones();
+
+  for (int h = 0; h < pitchDetector.getNumHopsInLastBlock(); ++h) {
+    const auto &hop = pitchDetector.getHopResult(h);
+    const auto mapping = pitchMapper.mapNote(hop.midiNote, hop.frequencyHz, hop.voiced);
+
+    PitchFrame frame;
+    frame.timeSeconds = static_cast<double>(samplesProcessed + static_cast<uint64_t>(hop.sampleOffset)) / sampleRate;
+    frame.voiced = hop.voiced;
+    frame.detectedMidiNote = hop.midiNote;
+    frame.confidence = hop.confidence;
+    frame.targetMidiNote = mapping.leadTargetMidiNote;
+    frame.correctionSemitones = correction;
+
+    for (int v = 0; v < DSPConfig::maxHarmonyVoices; ++v) {
+      const auto &voice = harmonyVoices[static_cast<size_t>(v)];
+      frame.voiceMidiNotes[v] = voice.isEnabled() && !voice.isShed() ? mapping.harmonyTargetMidiNotes[v] : 0.0f;
     }
+
+    pitchHistory.push(frame);
   }
 }
 
@@ -178,6 +447,10 @@ int TunerEngine::getLatencySamples() const {
   // Lead correction latency (includes pitch shifter)
   latency += leadCorrection.getLatencySamples();
 
+  // Render quality: the clip oversampler (the shifters start early by as
+  // much, so the total matches real time)
+  latency += clipLatency;
+
   // Note: Pitch detection runs in parallel, doesn't add to output latency
   // Note: Harmony voices run in parallel with lead, so we take the max
   //       but since they're based on the same shifter, it's roughly equal
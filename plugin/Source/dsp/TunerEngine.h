@@ -1,10 +1,18 @@
 #pragma once
 
-#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+#include "EngineParameters.h"
 #include "PitchDetector.h"
+#include "PitchTrack.h"
 #include "PitchMapper.h"
 #include "LeadCorrection.h"
 #include "HarmonyVoice.h"
+#include "HarmonyMorph.h"
+#include "StageProfiler.h"
+#include "CpuGuard.h"
+#include "PitchHistory.h"
+#include "LevelMeter.h"
 #include "../DSPConfig.h"
 #include "../ParameterIDs.h"
 
@@ -62,8 +70,9 @@
  * - Fast (avoid branches, use SIMD where possible)
  * - Real-time safe
  *
- * Parameter updates come from the message thread via atomic values
- * in the AudioProcessorValueTreeState.
+ * Parameters arrive as an EngineParameters snapshot with each block (the
+ * plugin copies its parameter atomics into one), so the engine has no
+ * dependency on the plugin framework.
  */
 class TunerEngine {
 public:
@@ -91,17 +100,83 @@ public:
    *
    * @param buffer Audio buffer to process (modified in place)
    * @param midi MIDI buffer (unused in current implementation)
-   * @param apvts Parameter state for reading current values
+   * @param params This block's parameter snapshot
    */
   void process(juce::AudioBuffer<float> &buffer,
                juce::MidiBuffer &midi,
-               juce::AudioProcessorValueTreeState &apvts);
+               const EngineParameters &params);
+
+  /**
+   * Like process(), for a caller that has already run this block through
+   * getPitchDetector() - the batch API analyses many streams' hops in one
+   * vectorised pass, then finishes each stream here.
+   */
+  void processAnalysed(juce::AudioBuffer<float> &buffer, const EngineParameters &params);
+
+  /**
+   * Update all DSP components from the parameter snapshot.
+   * Called at the start of each process block; a caller feeding the
+   * detector itself calls it first so the input type and hop are current.
+   */
+  void updateFromParameters(const EngineParameters &params);
 
   /**
    * Get the total latency introduced by the engine in samples.
    */
   int getLatencySamples() const;
 
+  /**
+   * Tell the engine the host is rendering offline. Blocks then have no
+   * deadline, so the CPU guard stays at full quality.
+   */
+  void setNonRealtime(bool isNonRealtime) noexcept { nonRealtime = isNonRealtime; }
+
+  /**
+   * Render quality for offline bounces (takes effect at the next prepare).
+   * With no deadline, each stage spends what real time can't afford:
+   * - Detector: twice the integration window, ending at the newest sample
+   *   (see PitchDetector::setFullLag), at DSPConfig::renderHopDivisor
+   * - Lead: zero-phase pitch smoothing across the block
+   *   (see LeadCorrection::setRenderQuality)
+   * - Shifters: grain search over the whole hop
+   * - Clipper: oversampled, so tanh's harmonics don't alias
+   *
+   * Reported latency is the same as in real time: the oversampler's delay
+   * is taken off the shifters (PitchShifter::setOutputAdvance), so a
+   * track bounced offline lines up with its real-time playback.
+   */
+  void setRenderQuality(bool enabled) noexcept { renderQuality = enabled; }
+  bool isRenderQuality() const noexcept { return renderQuality; }
+
+  /**
+   * Seed the harmony voices' humanization (voice i uses seed + i). Renders
+   * with the same seed and parameters are repeatable.
+   */
+  void setRandomSeed(juce::int64 seed) noexcept;
+
+  /**
+   * Start the stream at `position` samples on the timeline instead of 0
+   * (takes effect at the next reset). Lets a render of part of a file
+   * humanize and timestamp exactly like a pass over the whole file.
+   */
+  void setTimelineStart(juce::int64 position) noexcept { timelineStart = position; }
+  juce::int64 getTimelineStart() const noexcept { return timelineStart; }
+
+  /**
+   * Replay hops from an analysed track instead of running the detector
+   * (nullptr = detect). A hop plays in the block containing its timeline
+   * sample. Ignored unless the track's rate and hop match the detector's;
+   * the caller keeps the track alive and keys it to this audio and
+   * configuration (see PitchAnalysisCache).
+   */
+  void setPitchTrack(const MappedPitchTrack *track);
+
+  /**
+   * Record every detected hop into `track` (nullptr = off), from the next
+   * reset(). Offline only: recording allocates.
+   */
+  void setPitchTrackRecorder(PitchTrack *track) noexcept { pitchTrackRecorder = track; }
+
   //==========================================================================
   // ACCESSORS FOR UI / METERING
   //==========================================================================
@@ -109,6 +184,9 @@ public:
   /** Get the pitch detector for UI visualization */
   const PitchDetector &getPitchDetector() const { return pitchDetector; }
 
+  /** The detector itself, for callers that feed it (see processAnalysed) */
+  PitchDetector &getPitchDetector() { return pitchDetector; }
+
   /** Get the pitch mapper for UI visualization */
   const PitchMapper &getPitchMapper() const { return pitchMapper; }
 
@@ -120,6 +198,20 @@ public:
     return harmonyVoices[static_cast<size_t>(std::clamp(index, 0, DSPConfig::maxHarmonyVoices - 1))];
   }
 
+  /** Per-stage CPU timers (disabled until the UI switches them on) */
+  StageProfiler &getStageProfiler() { return profiler; }
+  const StageProfiler &getStageProfiler() const { return profiler; }
+
+  /** Degradation policy and current level */
+  const CpuGuard &getCpuGuard() const { return cpuGuard; }
+
+  /** Per-hop pitch frames for the editor (single reader) */
+  PitchHistory &getPitchHistory() { return pitchHistory; }
+
+  /** Input (pre-processing) and output (post-clip) levels */
+  LevelMeter &getInputMeter() { return inputMeter; }
+  LevelMeter &getOutputMeter() { return outputMeter; }
+
 private:
   //==========================================================================
   // CONFIGURATION
@@ -138,6 +230,41 @@ private:
   LeadCorrection leadCorrection;
   std::array<HarmonyVoice, DSPConfig::maxHarmonyVoices> harmonyVoices;
 
+  /** Puts the harmony preset in place of the voice parameters that follow it, morphing between them */
+  HarmonyMorph harmonyMorph;
+
+  /** Per-stage timing, shared with the harmony voices */
+  StageProfiler profiler;
+
+  /** Sheds work when block time nears the deadline */
+  CpuGuard cpuGuard;
+  bool nonRealtime = false;
+
+  /** Render quality (see setRenderQuality); the oversampled clipper exists only then */
+  bool renderQuality = false;
+  std::unique_ptr<juce::dsp::Oversampling<float>> clipOversampler;
+  int clipLatency = 0; // Oversampler delay, absorbed by the shifters
+
+  /** Pitch track replay (see setPitchTrack): the decoded chunk around the playhead */
+  const MappedPitchTrack *pitchTrack = nullptr;
+  std::vector<PitchTrack::Hop> pitchTrackChunk;
+  int pitchTrackChunkIndex = -1;
+  int pitchTrackChunkHops = 0;
+  PitchTrack *pitchTrackRecorder = nullptr;
+
+  /** One frame per detector hop, for the UI */
+  PitchHistory pitchHistory;
+  uint64_t samplesProcessed = 0; // Stream position for frame timestamps
+  juce::int64 timelineStart = 0;  // samplesProcessed after reset()
+
+  /**
+   * Measured in the dry copy and the real-time soft clipper - no extra
+   * pass. The render-quality clipper meters in a pass of its own after
+   * downsampling (see clipOversampled).
+   */
+  LevelMeter inputMeter;
+  LevelMeter outputMeter;
+
   //==========================================================================
   // INTERNAL BUFFERS
   //==========================================================================
@@ -155,9 +282,24 @@ private:
   // HELPER METHODS
   //==========================================================================
 
+  /** True if this block's hops came from the pitch track (detector skipped) */
+  bool replayPitchTrack(int numSamples);
+
+  /** Append this block's detected hops to the recorder */
+  void recordPitchTrack();
+
+  /** Step 6 at render quality: tanh at DSPConfig::renderClipOversamplingOrder, then the output meter */
+  void clipOversampled(juce::AudioBuffer<float> &buffer, int numSamples);
+
+  /** process() / processAnalysed(), with or without running the detector */
+  void processBlock(juce::AudioBuffer<float> &buffer, const EngineParameters &params, bool runDetector);
+
   /**
-   * Update all DSP components from the parameter state.
-   * Called at the start of each process block.
+   * Configure the components for a CPU guard level (see CpuGuard.h).
+   * Called every block, after the voices have read their parameters.
    */
-  void updateFromParameters(juce::AudioProcessorValueTreeState &apvts);
+  void applyCpuGuardLevel(CpuGuard::Level level);
+
+  /** Map and queue this block's detector hops for the UI */
+  void publishPitchFrames();
 };
@@ -0,0 +1,135 @@
+#include "EditRenderer.h"
+#include "../DSPConfig.h"
+#include <algorithm>
+
+/**
+ * EditRenderer.cpp
+ *
+ * Full and incremental renders of a NoteModel, and the splice between them.
+ */
+
+namespace {
+
+  constexpr int runSize = DSPConfig::renderRatioUpdateSamples;
+
+} // namespace
+
+EditRenderer::EditRenderer(const juce::AudioBuffer<float> &sourceToUse, double sampleRate, juce::int64 start)
+    : source(sourceToUse), timelineStart(start) {
+  shifters.resize(static_cast<size_t>(source.getNumChannels()));
+
+  for (auto &shifter : shifters) {
+    shifter.setRenderQuality(true);
+    shifter.prepare(sampleRate, runSize);
+  }
+
+  latency = shifters.empty() ? 0 : shifters.front().getLatencySamples();
+  fadeSamples = std::max(1, static_cast<int>(spliceFadeSeconds * sampleRate));
+  margin = latency;
+
+  rendered.setSize(source.getNumChannels(), source.getNumSamples());
+  rendered.clear();
+}
+
+void EditRenderer::renderAll(NoteModel &model) {
+  model.takeChangedRanges();
+  renderSpan(model, 0, 0, source.getNumSamples());
+
+  for (int ch = 0; ch < rendered.getNumChannels(); ++ch)
+    rendered.copyFrom(ch, 0, scratch, ch, 0, source.getNumSamples());
+}
+
+EditRenderer::Result EditRenderer::applyEdits(NoteModel &model) {
+  const double startMs = juce::Time::getMillisecondCounterHiRes();
+  const juce::int64 length = source.getNumSamples();
+
+  // Changed spans in source samples, widened by the grain reach, merged
+  // where their fades would meet
+  struct Span {
+    juce::int64 start, end;
+  };
+
+  std::vector<Span> spans;
+
+  for (const auto &range : model.takeChangedRanges()) {
+    const juce::int64 start = std::clamp<juce::int64>(range.start - timelineStart - margin, 0, length);
+    const juce::int64 end = std::clamp<juce::int64>(range.end - timelineStart + margin, 0, length);
+
+    if (end <= start)
+      continue;
+
+    if (!spans.empty() && start <= spans.back().end + 2 * fadeSamples)
+      spans.back().end = std::max(spans.back().end, end);
+    else
+      spans.push_back({start, end});
+  }
+
+  Result result;
+
+  for (const auto &span : spans) {
+    const juce::int64 from = std::max<juce::int64>(0, span.start - fadeSamples);
+    const juce::int64 to = std::min(length, span.end + fadeSamples);
+    const juce::int64 warmFrom = std::max<juce::int64>(0, from - warmUpWindows * latency) / runSize * runSize;
+
+    renderSpan(model, warmFrom, from, to);
+
+    for (int ch = 0; ch < rendered.getNumChannels(); ++ch) {
+      float *out = rendered.getWritePointer(ch);
+      const float *fresh = scratch.getReadPointer(ch);
+
+      for (juce::int64 i = from; i < to; ++i) {
+        float gain = 1.0f;
+
+        if (i < span.start)
+          gain = static_cast<float>(i - from + 1) / static_cast<float>(span.start - from + 1);
+        else if (i >= span.end)
+          gain = static_cast<float>(to - i) / static_cast<float>(to - span.end + 1);
+
+        out[i] += gain * (fresh[i - from] - out[i]);
+      }
+    }
+
+    ++result.numSpans;
+    result.samplesRendered += to - warmFrom;
+  }
+
+  result.milliseconds = juce::Time::getMillisecondCounterHiRes() - startMs;
+  return result;
+}
+
+void EditRenderer::renderSpan(const NoteModel &model, juce::int64 warmFrom, juce::int64 from, juce::int64 to) {
+  const int numChannels = source.getNumChannels();
+  const juce::int64 length = source.getNumSamples();
+
+  scratch.setSize(numChannels, static_cast<int>(to - from), false, false, true);
+
+  for (auto &shifter : shifters)
+    shifter.reset();
+
+  float input[runSize];
+  float output[runSize];
+
+  // Output at feed position x is source sample x - latency
+  for (juce::int64 x = warmFrom; x < to + latency; x += runSize) {
+    const int run = static_cast<int>(std::min<juce::int64>(runSize, to + latency - x));
+    const float ratio = model.getRatioAt(timelineStart + x + run / 2);
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+      const float *in = source.getReadPointer(ch);
+
+      for (int i = 0; i < run; ++i)
+        input[i] = x + i < length ? in[x + i] : 0.0f;
+
+      auto &shifter = shifters[static_cast<size_t>(ch)];
+      shifter.setPitchRatio(ratio);
+      shifter.process(input, output, run);
+
+      // The part of this run that lands in [from, to)
+      const juce::int64 first = std::max(x - latency, from);
+      const juce::int64 last = std::min(x + run - latency, to);
+
+      for (juce::int64 s = first; s < last; ++s)
+        scratch.setSample(ch, static_cast<int>(s - from), output[s - (x - latency)]);
+    }
+  }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <vector>
+#include "../dsp/PitchShifter.h"
+#include "NoteModel.h"
+
+/**
+ * EditRenderer.h
+ *
+ * Renders a take through its NoteModel, and keeps the render current as
+ * notes are edited by re-rendering only what each edit changed.
+ *
+ * WHY?
+ * Graph mode is interactive: drag a note, hear it. Rendering the whole
+ * take after every drag costs a pitch shift over minutes of audio; one
+ * note is a few hundred milliseconds of it. The model knows which span an
+ * edit changed, so only that span (plus what the shifter needs around it)
+ * is rendered again and spliced into the previous render.
+ *
+ * HOW IT WORKS:
+ * 1. renderAll() runs the whole take through one render-quality
+ *    PitchShifter per channel, with the model's ratio updated every
+ *    DSPConfig::renderRatioUpdateSamples, and keeps the latency-compensated
+ *    result.
+ * 2. applyEdits() takes the model's changed spans, widens each by the
+ *    shifter's window (a grain reaches that far around a ratio change) and
+ *    merges those that meet.
+ * 3. Each span is rendered by fresh shifters started warmUpWindows
+ *    windows early (so their buffers are full when the span begins), on the
+ *    same ratio-update grid as the full render.
+ * 4. The new audio is crossfaded in over spliceFadeSeconds at each end.
+ *    Outside the edited span the two renders are the same audio at the same
+ *    ratio, resynthesised from different grain histories - the fade hides
+ *    that seam.
+ *
+ * A one-note edit renders well under a second of audio, so it costs
+ * milliseconds however long the take is.
+ *
+ * THREADING:
+ * Not thread-safe; editing and rendering happen on one (non-audio)
+ * thread. The model's hop timing is in the timeline of the engine that
+ * recorded the track, so the source carries its timeline start.
+ *
+ * ANALOGY: Like an incremental compiler - a change recompiles the
+ * functions it touched, and the linker splices them into the last build.
+ */
+
+class EditRenderer {
+public:
+  /** Samples of crossfade at each end of a splice */
+  static constexpr double spliceFadeSeconds = 0.01;
+
+  /** Shifter windows rendered (and discarded) before a splice */
+  static constexpr int warmUpWindows = 2;
+
+  /**
+   * `source` must outlive the renderer; its sample 0 is timeline sample
+   * `timelineStart`.
+   */
+  EditRenderer(const juce::AudioBuffer<float> &source, double sampleRate, juce::int64 timelineStart = 0);
+
+  /** Render the whole take (and drop the model's pending changes) */
+  void renderAll(NoteModel &model);
+
+  struct Result {
+    int numSpans = 0;
+    juce::int64 samplesRendered = 0; // Including warm-up
+    double milliseconds = 0.0;
+  };
+
+  /** Bring the render up to date with the model's changes since the last call */
+  Result applyEdits(NoteModel &model);
+
+  /** The current render: the source's length and channels */
+  const juce::AudioBuffer<float> &getRendered() const noexcept { return rendered; }
+
+private:
+  const juce::AudioBuffer<float> &source;
+  juce::int64 timelineStart = 0;
+
+  std::vector<PitchShifter> shifters;
+  int latency = 0;
+  int fadeSamples = 0;
+  int margin = 0; // Around each changed span
+
+  juce::AudioBuffer<float> rendered;
+  juce::AudioBuffer<float> scratch;
+
+  /**
+   * Render source samples [from, to) into `scratch` (from 0), with fresh
+   * shifters started at `warmFrom` - a multiple of the ratio-update run, so
+   * the runs line up with renderAll()'s.
+   */
+  void renderSpan(const NoteModel &model, juce::int64 warmFrom, juce::int64 from, juce::int64 to);
+};
@@ -0,0 +1,327 @@
+#include "NoteModel.h"
+#include "../Utilities.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * NoteModel.cpp
+ *
+ * Note segmentation, edits and the per-hop ratios they produce.
+ */
+
+namespace {
+
+  float median(std::vector<float> &values) {
+    const auto middle = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+  }
+
+  std::vector<PitchTrack::Hop> decodeAll(const MappedPitchTrack &track) {
+    std::vector<PitchTrack::Hop> hops(static_cast<size_t>(track.getNumChunks()) * PitchTrack::hopsPerChunk);
+    size_t count = 0;
+
+    for (int chunk = 0; chunk < track.getNumChunks(); ++chunk)
+      count += static_cast<size_t>(track.decodeChunk(chunk, hops.data() + count));
+
+    hops.resize(count);
+    return hops;
+  }
+
+  std::vector<PitchTrack::Hop> copyAll(const PitchTrack &track) {
+    std::vector<PitchTrack::Hop> hops(static_cast<size_t>(track.getNumHops()));
+
+    for (int h = 0; h < track.getNumHops(); ++h)
+      hops[static_cast<size_t>(h)] = track.getHop(h);
+
+    return hops;
+  }
+
+} // namespace
+
+NoteModel::NoteModel(const MappedPitchTrack &track, int delay, const Options &options)
+    : timing(track.getTiming()), analysisDelay(delay) {
+  segment(decodeAll(track), options);
+}
+
+NoteModel::NoteModel(const PitchTrack &track, int delay, const Options &options)
+    : timing(track.getTiming()), analysisDelay(delay) {
+  segment(copyAll(track), options);
+}
+
+NoteModel::NoteModel(const MappedPitchTrack &track, int delay) : NoteModel(track, delay, Options()) {}
+
+NoteModel::NoteModel(const PitchTrack &track, int delay) : NoteModel(track, delay, Options()) {}
+
+//==============================================================================
+// SEGMENTATION
+//==============================================================================
+
+void NoteModel::segment(const std::vector<PitchTrack::Hop> &trackHops, const Options &options) {
+  const int numHops = static_cast<int>(trackHops.size());
+  const double hopsPerSecond = timing.hopSize > 0 ? timing.sampleRate / timing.hopSize : 0.0;
+  const int splitHops = std::max(1, static_cast<int>(std::lround(options.splitSeconds * hopsPerSecond)));
+  const int minNoteHops = std::max(1, static_cast<int>(std::lround(options.minNoteSeconds * hopsPerSecond)));
+  const int vibratoHalfWindow = std::max(1, static_cast<int>(std::lround(options.vibratoWindowSeconds * hopsPerSecond / 2)));
+  const int medianHalf = std::max(0, options.medianHops / 2);
+
+  hops.assign(static_cast<size_t>(numHops), {});
+  ratios.assign(static_cast<size_t>(numHops), 1.0f);
+
+  for (int h = 0; h < numHops; ++h) {
+    const auto &hop = trackHops[static_cast<size_t>(h)];
+    hops[static_cast<size_t>(h)].midi = hop.voiced ? NovaTuneUtils::frequencyToMidiNote(hop.frequencyHz) : 0.0f;
+  }
+
+  auto midiAt = [this](int h) { return hops[static_cast<size_t>(h)].midi; };
+
+  // Median over the voiced hops around each voiced hop: octave blips and
+  // onset glitches shouldn't start notes
+  std::vector<float> filtered(static_cast<size_t>(numHops), 0.0f);
+  std::vector<float> window;
+
+  for (int h = 0; h < numHops; ++h) {
+    if (midiAt(h) <= 0.0f)
+      continue;
+
+    window.clear();
+
+    for (int k = std::max(0, h - medianHalf); k <= std::min(numHops - 1, h + medianHalf); ++k)
+      if (midiAt(k) > 0.0f)
+        window.push_back(midiAt(k));
+
+    filtered[static_cast<size_t>(h)] = median(window);
+  }
+
+  // The model works from the filtered pitch, so a glitched hop can't swing
+  // a scaled vibrato
+  for (int h = 0; h < numHops; ++h)
+    hops[static_cast<size_t>(h)].midi = filtered[static_cast<size_t>(h)];
+
+  // Voiced runs, cut where the pitch holds away from the note's running centre
+  struct Span {
+    int first, last; // Hops [first, last)
+  };
+
+  std::vector<Span> spans;
+  int h = 0;
+
+  while (h < numHops) {
+    if (filtered[static_cast<size_t>(h)] <= 0.0f) {
+      ++h;
+      continue;
+    }
+
+    const int first = h;
+    double sum = 0.0;
+    int count = 0, away = 0;
+
+    for (; h < numHops && filtered[static_cast<size_t>(h)] > 0.0f; ++h) {
+      const float value = filtered[static_cast<size_t>(h)];
+
+      if (count > 0 && std::abs(value - static_cast<float>(sum / count)) > options.splitSemitones) {
+        if (++away >= splitHops) {
+          h -= away - 1; // The new note starts where the pitch left
+          break;
+        }
+        continue;
+      }
+
+      // Hops that returned to the centre count again
+      for (int k = h - away; k <= h; ++k) {
+        sum += filtered[static_cast<size_t>(k)];
+        ++count;
+      }
+
+      away = 0;
+    }
+
+    spans.push_back({first, h});
+  }
+
+  // Short notes: join the note they follow on from, else drop them
+  std::vector<Span> merged;
+
+  for (const auto &span : spans) {
+    if (span.last - span.first >= minNoteHops)
+      merged.push_back(span);
+    else if (!merged.empty() && merged.back().last == span.first)
+      merged.back().last = span.last;
+  }
+
+  // Hops outside any note: no drift, no vibrato, centred on themselves
+  for (auto &hop : hops)
+    hop.slow = hop.centre = hop.midi;
+
+  for (const auto &span : merged) {
+    window.clear();
+
+    for (int k = span.first; k < span.last; ++k)
+      if (midiAt(k) > 0.0f)
+        window.push_back(midiAt(k));
+
+    Note note;
+    note.start = getHopCentre(span.first) - timing.hopSize / 2;
+    note.end = getHopCentre(span.last) - timing.hopSize / 2;
+    note.detectedPitch = note.pitch = median(window);
+
+    // Slow line: moving average of the note's own voiced hops
+    double sumSquared = 0.0;
+    int voiced = 0;
+
+    for (int k = span.first; k < span.last; ++k) {
+      auto &hop = hops[static_cast<size_t>(k)];
+      hop.centre = note.detectedPitch;
+
+      if (hop.midi <= 0.0f)
+        continue;
+
+      double sum = 0.0;
+      int count = 0;
+
+      for (int j = std::max(span.first, k - vibratoHalfWindow); j < std::min(span.last, k + vibratoHalfWindow + 1); ++j) {
+        if (midiAt(j) > 0.0f) {
+          sum += midiAt(j);
+          ++count;
+        }
+      }
+
+      hop.slow = static_cast<float>(sum / count);
+      sumSquared += static_cast<double>(hop.midi - hop.slow) * (hop.midi - hop.slow);
+      ++voiced;
+    }
+
+    // Depth as the peak of a sine with the same RMS: one wide hop doesn't set it
+    const double depth = voiced > 0 ? std::sqrt(2.0 * sumSquared / voiced) : 0.0;
+    note.detectedVibratoCents = note.vibratoCents = static_cast<float>(depth * 100.0);
+    notes.push_back(note);
+  }
+
+  originalNotes = notes;
+}
+
+//==============================================================================
+// NOTES
+//==============================================================================
+
+int NoteModel::findNote(juce::int64 sample) const noexcept {
+  auto it = std::upper_bound(notes.begin(), notes.end(), sample,
+                             [](juce::int64 value, const Note &note) { return value < note.end; });
+
+  if (it == notes.end() || sample < it->start)
+    return -1;
+
+  return static_cast<int>(it - notes.begin());
+}
+
+//==============================================================================
+// EDITING
+//==============================================================================
+
+void NoteModel::setPitch(int index, float midiNote) {
+  auto &note = notes[static_cast<size_t>(index)];
+  note.pitch = midiNote;
+  touch(note.start, note.end);
+}
+
+void NoteModel::setTiming(int index, juce::int64 start, juce::int64 end) {
+  auto &note = notes[static_cast<size_t>(index)];
+
+  const juce::int64 earliest = index > 0 ? notes[static_cast<size_t>(index - 1)].end : getHopCentre(0) - timing.hopSize / 2;
+  const juce::int64 latest = index + 1 < getNumNotes() ? notes[static_cast<size_t>(index + 1)].start
+                                                       : getHopCentre(static_cast<int>(hops.size())) - timing.hopSize / 2;
+
+  start = std::clamp(start, earliest, latest - timing.hopSize);
+  end = std::clamp(end, start + timing.hopSize, latest);
+
+  const juce::int64 oldStart = note.start, oldEnd = note.end;
+  note.start = start;
+  note.end = end;
+
+  // The hops the note gave up return to the detected pitch
+  touch(std::min(oldStart, start), std::max(oldEnd, end));
+}
+
+void NoteModel::setVibrato(int index, float cents) {
+  auto &note = notes[static_cast<size_t>(index)];
+  note.vibratoCents = std::max(0.0f, cents);
+  touch(note.start, note.end);
+}
+
+void NoteModel::revert(int index) {
+  const auto &original = originalNotes[static_cast<size_t>(index)];
+  auto &note = notes[static_cast<size_t>(index)];
+
+  note.pitch = original.pitch;
+  note.vibratoCents = original.vibratoCents;
+  setTiming(index, original.start, original.end);
+}
+
+std::vector<NoteModel::Range> NoteModel::takeChangedRanges() {
+  std::sort(changed.begin(), changed.end(), [](const Range &a, const Range &b) { return a.start < b.start; });
+
+  std::vector<Range> result;
+
+  for (const auto &range : changed) {
+    if (!result.empty() && range.start <= result.back().end)
+      result.back().end = std::max(result.back().end, range.end);
+    else
+      result.push_back(range);
+  }
+
+  changed.clear();
+  return result;
+}
+
+void NoteModel::touch(juce::int64 start, juce::int64 end) {
+  if (hops.empty() || timing.hopSize <= 0)
+    return;
+
+  // Hops whose centre lies in the span
+  const juce::int64 origin = timing.firstHopSample - analysisDelay;
+  const int first = static_cast<int>(std::clamp<juce::int64>((start - origin + timing.hopSize - 1) / timing.hopSize, 0,
+                                                             static_cast<juce::int64>(hops.size())));
+  const int last = static_cast<int>(std::clamp<juce::int64>((end - origin + timing.hopSize - 1) / timing.hopSize, 0,
+                                                            static_cast<juce::int64>(hops.size())));
+
+  for (int h = first; h < last; ++h) {
+    const auto &hop = hops[static_cast<size_t>(h)];
+    const int index = findNote(getHopCentre(h));
+    float shift = 0.0f;
+
+    if (index >= 0 && hop.midi > 0.0f) {
+      const auto &note = notes[static_cast<size_t>(index)];
+      const float scale = note.detectedVibratoCents >= 1.0f ? note.vibratoCents / note.detectedVibratoCents : 1.0f;
+
+      // Zero for an unedited note, so its ratio is exactly 1
+      shift = (note.pitch - hop.centre) + (scale - 1.0f) * (hop.midi - hop.slow);
+    }
+
+    ratios[static_cast<size_t>(h)] = std::clamp(std::exp2(shift / 12.0f), 0.5f, 2.0f);
+  }
+
+  // getRatioAt() interpolates towards the neighbouring hops
+  changed.push_back({getHopCentre(std::max(0, first - 1)), getHopCentre(last)});
+}
+
+//==============================================================================
+// RENDERING
+//==============================================================================
+
+float NoteModel::getRatioAt(juce::int64 sample) const noexcept {
+  if (hops.empty() || timing.hopSize <= 0)
+    return 1.0f;
+
+  const double position = static_cast<double>(sample - (timing.firstHopSample - analysisDelay)) / timing.hopSize;
+
+  if (position <= 0.0)
+    return ratios.front();
+
+  const auto index = static_cast<size_t>(position);
+
+  if (index + 1 >= ratios.size())
+    return ratios.back();
+
+  const auto fraction = static_cast<float>(position - static_cast<double>(index));
+  return ratios[index] + fraction * (ratios[index + 1] - ratios[index]);
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <vector>
+#include "../dsp/PitchTrack.h"
+
+/**
+ * NoteModel.h
+ *
+ * The pitch of a take as editable notes - the model behind Graph mode.
+ *
+ * WHY?
+ * Auto mode corrects every note by the same rule. Graph mode lets the user
+ * fix one note by hand: move it to another pitch, change where it starts
+ * or ends, calm or widen its vibrato. That needs the take's pitch as notes
+ * rather than hops, and a record of what each edit touched so only that
+ * part is rendered again (EditRenderer).
+ *
+ * HOW IT WORKS:
+ * 1. SEGMENT: the stored pitch track's voiced hops are median-filtered and
+ *    cut into notes wherever the pitch leaves the running note centre by
+ *    more than splitSemitones for splitSeconds (or the voice stops). Notes
+ *    shorter than minNoteSeconds join the note they follow on from, or are
+ *    dropped (their hops keep the detected pitch).
+ * 2. DESCRIBE: each note gets its median pitch, and a slow pitch line (a
+ *    moving average over vibratoWindowSeconds). What the (filtered) hops do
+ *    around that line is the vibrato; its depth is the peak of a sine with
+ *    the same RMS.
+ * 3. EDIT: a note's target pitch replaces its centre (drift and vibrato
+ *    ride on top of it), its vibrato is scaled to the target depth, and its
+ *    start and end decide which hops follow it - so a timing edit moves
+ *    where the pitch change happens. Every edit records the span it
+ *    changed.
+ * 4. RATIO: each hop's pitch ratio (target / detected) is kept up to date,
+ *    and getRatioAt() interpolates it for any sample.
+ *
+ * An unedited model has a ratio of exactly 1 everywhere. A note with
+ * (almost) no vibrato has none to widen: setVibrato() only scales what was
+ * sung.
+ *
+ * ANALOGY: Like a text editor's syntax tree over a file - edits change
+ * nodes, and only the lines under the changed nodes are re-highlighted.
+ */
+
+class NoteModel {
+public:
+  struct Options {
+    float splitSemitones = 0.6f;       // Pitch jump that starts a new note
+    double splitSeconds = 0.03;        // ...held this long
+    double minNoteSeconds = 0.06;      // Shorter notes join the previous one
+    double vibratoWindowSeconds = 0.2; // Slow pitch line: about one vibrato cycle
+    int medianHops = 5;                // Segmentation smoothing (odd)
+  };
+
+  struct Note {
+    juce::int64 start = 0; // Timeline samples [start, end)
+    juce::int64 end = 0;
+    float detectedPitch = 0.0f;        // Median of the note's hops (MIDI)
+    float detectedVibratoCents = 0.0f; // Depth around the slow pitch line
+
+    // Edits
+    float pitch = 0.0f;        // Target (MIDI); detectedPitch when unedited
+    float vibratoCents = 0.0f; // Target depth; scales the note's own vibrato
+  };
+
+  /** A span of timeline samples [start, end) */
+  struct Range {
+    juce::int64 start = 0;
+    juce::int64 end = 0;
+  };
+
+  /**
+   * Segment a track. `analysisDelay` places each hop's pitch on the audio it
+   * describes (PitchDetector::getAnalysisDelaySamples of the detector that
+   * produced it).
+   */
+  NoteModel(const MappedPitchTrack &track, int analysisDelay, const Options &options);
+  NoteModel(const PitchTrack &track, int analysisDelay, const Options &options);
+
+  /** With the default Options */
+  NoteModel(const MappedPitchTrack &track, int analysisDelay);
+  NoteModel(const PitchTrack &track, int analysisDelay);
+
+  //==========================================================================
+  // NOTES
+  //==========================================================================
+
+  int getNumNotes() const noexcept { return static_cast<int>(notes.size()); }
+  const Note &getNote(int index) const noexcept { return notes[static_cast<size_t>(index)]; }
+
+  /** The note at timeline sample `sample`, or -1 */
+  int findNote(juce::int64 sample) const noexcept;
+
+  //==========================================================================
+  // EDITING (each marks the span it changes for re-rendering)
+  //==========================================================================
+
+  void setPitch(int note, float midiNote);
+
+  /**
+   * Move a note's boundaries. Clamped so it keeps at least one hop and
+   * doesn't cross its neighbours (shorten a neighbour first).
+   */
+  void setTiming(int note, juce::int64 start, juce::int64 end);
+
+  void setVibrato(int note, float cents);
+
+  /** Back to the detected pitch, timing and vibrato */
+  void revert(int note);
+
+  /** The spans changed since the last call, in order, overlaps merged */
+  std::vector<Range> takeChangedRanges();
+
+  //==========================================================================
+  // RENDERING
+  //==========================================================================
+
+  /** Pitch ratio to apply at timeline sample `sample` (1 outside edited notes) */
+  float getRatioAt(juce::int64 sample) const noexcept;
+
+  const PitchTrack::Timing &getTiming() const noexcept { return timing; }
+
+private:
+  struct HopInfo {
+    float midi = 0.0f;   // Detected pitch, 0 when unvoiced
+    float slow = 0.0f;   // Slow pitch line
+    float centre = 0.0f; // Detected pitch of the note it was segmented into
+  };
+
+  PitchTrack::Timing timing;
+  int analysisDelay = 0;
+
+  std::vector<HopInfo> hops;
+  std::vector<float> ratios; // Per hop
+  std::vector<Note> notes;
+  std::vector<Note> originalNotes;
+  std::vector<Range> changed;
+
+  void segment(const std::vector<PitchTrack::Hop> &trackHops, const Options &options);
+
+  /** Timeline sample the hop's pitch describes */
+  juce::int64 getHopCentre(int hop) const noexcept {
+    return timing.firstHopSample + static_cast<juce::int64>(hop) * timing.hopSize - analysisDelay;
+  }
+
+  /** Mark [start, end) changed and recompute the ratios of the hops in it */
+  void touch(juce::int64 start, juce::int64 end);
+};
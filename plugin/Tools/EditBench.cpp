@@ -0,0 +1,265 @@
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include "dsp/PitchDetector.h"
+#include "dsp/PitchTrack.h"
+#include "edit/EditRenderer.h"
+#include "edit/NoteModel.h"
+#include "ToolUtilities.h"
+#include "VocalCorpus.h"
+
+/**
+ * EditBench.cpp
+ *
+ * Graph-mode edit latency and splice accuracy.
+ *
+ * Renders a long synthetic take (a phrase of held, vibrato and gliding
+ * notes, repeated), segments its pitch track into a NoteModel, and renders
+ * it whole. Then, for each kind of edit (pitch, timing, vibrato) on a note
+ * in the middle of the take, it times the incremental re-render against a
+ * whole render of the edited model and checks the splices:
+ *
+ *   spliceMs / fullMs  - incremental vs whole render time
+ *   renderedSeconds    - audio the incremental render processed (incl. warm-up)
+ *   changedSeconds     - audio that differs from the render before the edit
+ *   seamStep / maxStep - largest sample-to-sample step inside the splice
+ *                        fades, and anywhere in the render (a click would
+ *                        make the first stand out)
+ *   editedCents        - pitch of the edited note in the render vs its target,
+ *                        as the shifter delivers it (see PitchAccuracy)
+ *
+ * A whole render isn't a sample-exact reference for the splice: WSOLA
+ * grain placement depends on everything before it, so after an edit a
+ * whole render differs from the previous one to the end of the take.
+ *
+ * USAGE:
+ *   EditBench [--sample-rate=44100] [--seconds=60] [--output=FILE] [--csv]
+ */
+
+using namespace NovaTuneTools;
+
+namespace {
+
+  std::vector<ScoreNote> buildPhrase() {
+    std::vector<ScoreNote> phrase;
+    phrase.push_back({57.0f, 0.6});
+    phrase.push_back({60.0f, 0.5, 0.08});
+    phrase.push_back({62.0f, 0.9, 0.0, 40.0f});
+    phrase.push_back(rest(0.25));
+    phrase.push_back({64.0f, 0.4});
+    phrase.push_back({62.0f, 0.4, 0.05});
+    phrase.push_back({59.0f, 1.1, 0.1, 30.0f});
+    phrase.push_back(rest(0.35));
+    return phrase;
+  }
+
+  /** Record the detector's hops over `audio`, block by block as a render would */
+  PitchTrack analyse(PitchDetector &detector, const juce::AudioBuffer<float> &audio, double sampleRate) {
+    constexpr int blockSize = 512;
+
+    PitchTrack track;
+    track.reset(sampleRate, detector.getHopSize());
+
+    juce::AudioBuffer<float> block(1, blockSize);
+
+    for (int start = 0; start < audio.getNumSamples(); start += blockSize) {
+      const int length = std::min(blockSize, audio.getNumSamples() - start);
+      block.setSize(1, length, false, false, true);
+      block.copyFrom(0, 0, audio, 0, start, length);
+      detector.process(block);
+
+      for (int h = 0; h < detector.getNumHopsInLastBlock(); ++h) {
+        const auto &hop = detector.getHopResult(h);
+        track.append(start + hop.sampleOffset, hop);
+      }
+    }
+
+    return track;
+  }
+
+  /** Median detected pitch (MIDI) of `audio` over [start, end) */
+  float measurePitch(const juce::AudioBuffer<float> &audio, juce::int64 start, juce::int64 end, double sampleRate) {
+    // The edit can leave the take's voice type: search the widest range
+    PitchDetector detector;
+    detector.setInputType(NovaTuneEnums::InputType::Instrument);
+    detector.setFullLag(true);
+    detector.setHopDivisor(DSPConfig::renderHopDivisor);
+    detector.prepare(sampleRate, 512);
+
+    const auto track = analyse(detector, audio, sampleRate);
+    const NoteModel probe(track, detector.getAnalysisDelaySamples());
+    const int note = probe.findNote((start + end) / 2);
+
+    return note >= 0 ? probe.getNote(note).detectedPitch : 0.0f;
+  }
+
+  struct Seams {
+    juce::int64 changedSamples = 0;
+    float maxSeamStep = 0.0f; // Largest sample-to-sample step inside the splice fades
+    float maxStep = 0.0f;     // ...and in the whole render
+  };
+
+  /** Where the render changed, and how sharp its splices are */
+  Seams measureSeams(const juce::AudioBuffer<float> &spliced, const juce::AudioBuffer<float> &before, int fadeSamples) {
+    Seams result;
+    const float *a = spliced.getReadPointer(0);
+    const float *old = before.getReadPointer(0);
+    const int numSamples = spliced.getNumSamples();
+
+    for (int i = 1; i < numSamples; ++i)
+      result.maxStep = std::max(result.maxStep, std::abs(a[i] - a[i - 1]));
+
+    for (int i = 0; i < numSamples;) {
+      if (juce::exactlyEqual(a[i], old[i])) {
+        ++i;
+        continue;
+      }
+
+      int end = i;
+      while (end < numSamples && !juce::exactlyEqual(a[end], old[end]))
+        ++end;
+
+      result.changedSamples += end - i;
+
+      // The fade in at the start of the change and the fade out at its end
+      for (int k = std::max(1, i - 1); k < std::min(end, i + fadeSamples); ++k)
+        result.maxSeamStep = std::max(result.maxSeamStep, std::abs(a[k] - a[k - 1]));
+
+      for (int k = std::max(i + 1, end - fadeSamples); k < std::min(numSamples, end + 1); ++k)
+        result.maxSeamStep = std::max(result.maxSeamStep, std::abs(a[k] - a[k - 1]));
+
+      i = end;
+    }
+
+    return result;
+  }
+
+  void printUsage() {
+    std::cout << "EditBench - graph-mode incremental render latency and splice accuracy\n\n"
+              << "  --sample-rate=HZ        Sample rate (default 44100)\n"
+              << "  --seconds=N             Take length (default 60)\n"
+              << "  --output=FILE           Write results to FILE (default stdout)\n"
+              << "  --csv                   Write CSV instead of JSON\n";
+  }
+
+} // namespace
+
+//==============================================================================
+// MAIN
+//==============================================================================
+
+int main(int argc, char *argv[]) {
+  juce::ScopedNoDenormals noDenormals;
+  juce::ArgumentList args(argc, argv);
+
+  if (args.containsOption("--help|-h")) {
+    printUsage();
+    return 0;
+  }
+
+  const double sampleRate = parseNumber(args, "--sample-rate", 44100.0);
+  const double seconds = parseNumber(args, "--seconds", 60.0);
+
+  //==========================================================================
+  // TAKE, TRACK, MODEL
+  //==========================================================================
+
+  const auto phrase = buildPhrase();
+  double phraseSeconds = 0.0;
+  for (const auto &note : phrase)
+    phraseSeconds += note.seconds;
+
+  std::vector<ScoreNote> score;
+  for (int i = 0; i < std::max(1, static_cast<int>(seconds / phraseSeconds)); ++i)
+    score.insert(score.end(), phrase.begin(), phrase.end());
+
+  const auto take = renderTake("edit", NovaTuneEnums::InputType::AltoTenor, score, sampleRate);
+
+  PitchDetector detector;
+  detector.setFullLag(true);
+  detector.setHopDivisor(DSPConfig::renderHopDivisor);
+  detector.prepare(sampleRate, 512);
+
+  const auto track = analyse(detector, take.audio, sampleRate);
+
+  NoteModel model(track, detector.getAnalysisDelaySamples());
+  std::cerr << "take " << take.audio.getNumSamples() / sampleRate << "s, " << track.getNumHops() << " hops, "
+            << model.getNumNotes() << " notes" << std::endl;
+
+  EditRenderer renderer(take.audio, sampleRate);
+
+  renderer.renderAll(model);
+
+  //==========================================================================
+  // EDITS
+  //==========================================================================
+
+  // A note with vibrato, in the middle of the take
+  int target = model.findNote(take.audio.getNumSamples() / 2);
+  for (int n = std::max(0, target); n < model.getNumNotes(); ++n) {
+    if (model.getNote(n).detectedVibratoCents > 20.0f) {
+      target = n;
+      break;
+    }
+  }
+
+  if (target < 0) {
+    std::cerr << "No note to edit" << std::endl;
+    return 1;
+  }
+
+  struct Edit {
+    const char *name;
+    std::function<void(NoteModel &)> apply;
+  };
+
+  const auto note = model.getNote(target);
+  const Edit edits[] = {
+      {"pitch", [&](NoteModel &m) { m.setPitch(target, note.detectedPitch + 2.0f); }},
+      {"timing", [&](NoteModel &m) {
+         const auto shift = static_cast<juce::int64>(0.05 * sampleRate);
+         m.setTiming(target, note.start + shift, note.end - shift);
+       }},
+      {"vibrato", [&](NoteModel &m) { m.setVibrato(target, 0.0f); }},
+      {"revert", [&](NoteModel &m) { m.revert(target); }},
+  };
+
+  ResultTable table;
+  Stopwatch stopwatch;
+
+  for (const auto &edit : edits) {
+    const juce::AudioBuffer<float> before(renderer.getRendered());
+
+    edit.apply(model);
+    const auto result = renderer.applyEdits(model);
+
+    const auto seams = measureSeams(renderer.getRendered(), before,
+                                    static_cast<int>(EditRenderer::spliceFadeSeconds * sampleRate));
+
+    // The whole take rendered again, for comparison
+    EditRenderer reference(take.audio, sampleRate);
+    stopwatch.start();
+    reference.renderAll(model);
+    const double fullMs = stopwatch.elapsedNs() / 1.0e6;
+
+    const auto &edited = model.getNote(target);
+    const float measured = measurePitch(renderer.getRendered(), edited.start, edited.end, sampleRate);
+
+    std::cerr << edit.name << ": " << result.milliseconds << " ms (whole take " << fullMs << " ms), "
+              << static_cast<double>(seams.changedSamples) / sampleRate << "s changed, seam step " << seams.maxSeamStep << " (max "
+              << seams.maxStep << ")" << std::endl;
+
+    table.addRow({{"edit", edit.name},
+                  {"spliceMs", result.milliseconds},
+                  {"fullMs", fullMs},
+                  {"spans", result.numSpans},
+                  {"renderedSeconds", static_cast<double>(result.samplesRendered) / sampleRate},
+                  {"changedSeconds", static_cast<double>(seams.changedSamples) / sampleRate},
+                  {"seamStep", seams.maxSeamStep},
+                  {"maxStep", seams.maxStep},
+                  {"editedCents", (measured - edited.pitch) * 100.0f}});
+  }
+
+  return table.write(args.getValueForOption("--output"), args.containsOption("--csv")) ? 0 : 1;
+}
@@ -0,0 +1,430 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+#include "SyntheticVocal.h"
+#include "ToolUtilities.h"
+
+/**
+ * EditorPaintBench.cpp
+ *
+ * Headless message-thread cost of the NovaTune editor.
+ *
+ * In a big template dozens of editors can be open at once, and every one
+ * of them ticks timers and repaints on the one message thread the host
+ * also uses for its own UI. This measures what an editor costs there,
+ * without a display: components are painted into a software image.
+ *
+ * MODES:
+ *   components (default) - paints each editor component (and the whole
+ *                          editor) into an image --iterations times, after
+ *                          a second of singing so every view has content
+ *   session              - simulates editors open on processors fed with
+ *                          audio: the editor's own timers are driven at
+ *                          the rate each one asks for, and whatever they
+ *                          repaint() is painted (clipped to the dirty area)
+ *                          as the host's message loop would
+ *
+ * USAGE:
+ *   EditorPaintBench [--mode=components|session] [--iterations=200]
+ *                    [--scale=1] [--editors=1,8] [--seconds=5]
+ *                    [--scenarios=singing,breath,stopped,hidden]
+ *                    [--output=FILE] [--csv]
+ *
+ * SESSION SCENARIOS:
+ *   singing - a voiced melody (the display and graph are busy)
+ *   breath  - unvoiced breath noise only
+ *   stopped - transport stopped (no processBlock calls)
+ *   hidden  - singing, with the editor hidden (e.g. minimised)
+ *
+ * SESSION COLUMNS:
+ *   ticksPerSec     - timer callbacks per simulated second, per editor
+ *   repaintsPerSec  - paint passes per simulated second, per editor
+ *   meanDirtyKpx    - average painted area (thousands of pixels)
+ *   usPerSec        - message-thread microseconds per second, per editor
+ *   loadPercent     - all editors together, as a share of one thread
+ */
+
+using namespace NovaTuneTools;
+
+namespace {
+
+  //==========================================================================
+  // CONFIGURATION
+  //==========================================================================
+
+  constexpr double sampleRate = 48000.0;
+  constexpr int blockSize = 256;
+
+  const juce::StringArray allScenarios{"singing", "breath", "stopped", "hidden"};
+
+  //==========================================================================
+  // REPAINT CAPTURE
+  //==========================================================================
+
+  /**
+   * Attached to the editor (the top of the tree, so every child's repaint()
+   * ends up here) to record what would have been sent to the window.
+   * paint() is never used - it only runs when painting into a parent.
+   */
+  class RepaintRecorder : public juce::CachedComponentImage {
+  public:
+    explicit RepaintRecorder(juce::Component &owner) : component(owner) {}
+
+    void paint(juce::Graphics &) override {}
+    void releaseResources() override {}
+
+    bool invalidateAll() override { return invalidate(component.getLocalBounds()); }
+
+    bool invalidate(const juce::Rectangle<int> &area) override {
+      dirty = dirty.isEmpty() ? area : dirty.getUnion(area);
+      return true;
+    }
+
+    /** The dirty area since the last call, cleared */
+    juce::Rectangle<int> takeDirty() noexcept { return std::exchange(dirty, {}); }
+
+  private:
+    juce::Component &component;
+    juce::Rectangle<int> dirty;
+  };
+
+  //==========================================================================
+  // OPEN EDITOR
+  //==========================================================================
+
+  /** A processor with its editor open, fed with synthetic vocal */
+  struct OpenEditor {
+    std::unique_ptr<NovaTuneAudioProcessor> processor;
+    std::unique_ptr<juce::AudioProcessorEditor> editor;
+    RepaintRecorder *recorder = nullptr; // Owned by the editor
+
+    struct TimerSlot {
+      juce::Timer *timer;
+      double nextDue;
+    };
+
+    std::vector<TimerSlot> timers;
+
+    SyntheticVocal vocal;
+    juce::AudioBuffer<float> buffer{2, blockSize};
+    juce::MidiBuffer midi;
+    juce::Image canvas;
+    double audioTime = 0.0;
+
+    OpenEditor(int index, bool voiced) {
+      processor = std::make_unique<NovaTuneAudioProcessor>();
+      processor->setPlayConfigDetails(2, 2, sampleRate, blockSize);
+      setActiveHarmonyVoices(processor->getValueTreeState(), 2);
+      processor->prepareToPlay(sampleRate, blockSize);
+
+      vocal.prepare(sampleRate);
+      vocal.setVoiced(voiced);
+      audioTime = 0.37 * index; // Editors don't all sing the same note at once
+
+      // Top-level components start invisible; a host would show it
+      editor.reset(processor->createEditor());
+      editor->setVisible(true);
+
+      recorder = new RepaintRecorder(*editor);
+      editor->setCachedComponentImage(recorder);
+
+      canvas = juce::Image(juce::Image::ARGB, editor->getWidth(), editor->getHeight(), true, juce::SoftwareImageType());
+      findTimers(*editor);
+    }
+
+    ~OpenEditor() {
+      editor.reset(); // Before its processor
+      processor->releaseResources();
+    }
+
+    void findTimers(juce::Component &parent) {
+      for (auto *child : parent.getChildren()) {
+        if (auto *timer = dynamic_cast<juce::Timer *>(child))
+          timers.push_back({timer, 0.0});
+
+        findTimers(*child);
+      }
+    }
+
+    /** A slow melody over a scale, with vibrato */
+    void processBlock() {
+      static const int melody[] = {0, 2, 4, 5, 7, 5, 4, 2};
+      auto *left = buffer.getWritePointer(0);
+
+      for (int i = 0; i < blockSize; ++i) {
+        const double t = audioTime + i / sampleRate;
+        const double note = 57.0 + melody[static_cast<int>(t * 2.0) % 8] +
+                            0.3 * std::sin(juce::MathConstants<double>::twoPi * 5.0 * t);
+        vocal.setFundamental(NovaTuneUtils::midiNoteToFrequency(static_cast<float>(note)));
+        left[i] = vocal.nextSample();
+      }
+
+      buffer.copyFrom(1, 0, buffer, 0, 0, blockSize);
+      audioTime += blockSize / sampleRate;
+
+      processor->processBlock(buffer, midi);
+    }
+
+    /** Run every timer due at `now` at the interval it currently asks for; returns the time taken */
+    double runDueTimers(double now, int &numTicks) {
+      Stopwatch stopwatch;
+      stopwatch.start();
+
+      for (auto &slot : timers) {
+        if (!slot.timer->isTimerRunning() || now < slot.nextDue)
+          continue;
+
+        slot.timer->timerCallback();
+        slot.nextDue = now + slot.timer->getTimerInterval() / 1000.0;
+        ++numTicks;
+      }
+
+      return stopwatch.elapsedNs();
+    }
+
+    /** Paint what the timers invalidated, as the host's message loop would; returns the time taken */
+    double paintDirty(int &numPaints, double &dirtyPixels) {
+      const auto dirty = recorder->takeDirty();
+
+      if (dirty.isEmpty())
+        return 0.0;
+
+      Stopwatch stopwatch;
+      stopwatch.start();
+
+      {
+        juce::Graphics g(canvas);
+        g.reduceClipRegion(dirty);
+        editor->paintEntireComponent(g, true);
+      }
+
+      ++numPaints;
+      dirtyPixels += static_cast<double>(dirty.getWidth()) * dirty.getHeight();
+      return stopwatch.elapsedNs();
+    }
+  };
+
+  //==========================================================================
+  // COMPONENTS MODE
+  //==========================================================================
+
+  juce::String describe(juce::Component &component) {
+    if (dynamic_cast<PitchDisplayComponent *>(&component) != nullptr)
+      return "PitchDisplay";
+    if (dynamic_cast<PitchGraphComponent *>(&component) != nullptr)
+      return "PitchGraph";
+    if (dynamic_cast<LevelMeterComponent *>(&component) != nullptr)
+      return "LevelMeters";
+    if (dynamic_cast<PerformanceOverlay *>(&component) != nullptr)
+      return "PerformanceOverlay";
+    if (dynamic_cast<CpuGuardIndicator *>(&component) != nullptr)
+      return "CpuGuardIndicator";
+    if (dynamic_cast<HarmonyVoicePanel *>(&component) != nullptr)
+      return "HarmonyVoicePanel";
+
+    // Plain JUCE widgets (sliders, boxes) aren't ours to optimise
+    return {};
+  }
+
+  double percentile(std::vector<double> values, double fraction) {
+    if (values.empty())
+      return 0.0;
+    std::sort(values.begin(), values.end());
+    const auto index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1));
+    return values[index];
+  }
+
+  void benchmarkPaint(ResultTable &results, const juce::String &name, juce::Component &component,
+                      int iterations, float scale) {
+    juce::Image canvas(juce::Image::ARGB,
+                       juce::jmax(1, juce::roundToInt(static_cast<float>(component.getWidth()) * scale)),
+                       juce::jmax(1, juce::roundToInt(static_cast<float>(component.getHeight()) * scale)),
+                       true, juce::SoftwareImageType());
+
+    std::vector<double> paintNs;
+    paintNs.reserve(static_cast<size_t>(iterations));
+
+    for (int i = 0; i < iterations + iterations / 10; ++i) {
+      Stopwatch stopwatch;
+      stopwatch.start();
+
+      {
+        juce::Graphics g(canvas);
+        g.addTransform(juce::AffineTransform::scale(scale));
+        component.paintEntireComponent(g, true);
+      }
+
+      // The first tenth warms caches (glyphs, gradients) and isn't counted
+      if (i >= iterations / 10)
+        paintNs.push_back(stopwatch.elapsedNs());
+    }
+
+    double total = 0.0;
+    for (auto ns : paintNs)
+      total += ns;
+
+    results.addRow({{"component", name},
+                    {"width", component.getWidth()},
+                    {"height", component.getHeight()},
+                    {"scale", scale},
+                    {"iterations", iterations},
+                    {"meanUs", total / static_cast<double>(paintNs.size()) / 1000.0},
+                    {"p99Us", percentile(paintNs, 0.99) / 1000.0},
+                    {"maxUs", percentile(paintNs, 1.0) / 1000.0}});
+
+    std::cerr << name << ": " << total / static_cast<double>(paintNs.size()) / 1000.0 << " us/paint" << std::endl;
+  }
+
+  void runComponents(ResultTable &results, int iterations, float scale) {
+    OpenEditor open(0, true);
+
+    // A second of singing, with the timers running, so every view has content
+    int numTicks = 0;
+    for (double t = 0.0; t < 1.0; t += blockSize / sampleRate) {
+      open.processBlock();
+      open.runDueTimers(t, numTicks);
+    }
+
+    juce::StringArray done;
+
+    for (auto *child : open.editor->getChildren()) {
+      const auto name = describe(*child);
+
+      if (name.isEmpty() || done.contains(name))
+        continue;
+
+      done.add(name);
+
+      // The CPU overlay is hidden unless toggled on
+      const bool wasVisible = child->isVisible();
+      child->setVisible(true);
+      benchmarkPaint(results, name, *child, iterations, scale);
+      child->setVisible(wasVisible);
+    }
+
+    benchmarkPaint(results, "Editor", *open.editor, iterations, scale);
+  }
+
+  //==========================================================================
+  // SESSION MODE
+  //==========================================================================
+
+  void runSession(ResultTable &results, const juce::String &scenario, int numEditors, double seconds) {
+    std::vector<std::unique_ptr<OpenEditor>> editors;
+
+    for (int i = 0; i < numEditors; ++i) {
+      editors.push_back(std::make_unique<OpenEditor>(i, scenario != "breath"));
+
+      if (scenario == "hidden")
+        editors.back()->editor->setVisible(false);
+    }
+
+    const bool playing = scenario != "stopped";
+    const double blockSeconds = blockSize / sampleRate;
+
+    int numTicks = 0;
+    int numPaints = 0;
+    double dirtyPixels = 0.0;
+    double tickNs = 0.0;
+    double paintNs = 0.0;
+
+    for (double t = 0.0; t < seconds; t += blockSeconds) {
+      for (auto &open : editors) {
+        if (playing)
+          open->processBlock();
+
+        tickNs += open->runDueTimers(t, numTicks);
+        paintNs += open->paintDirty(numPaints, dirtyPixels);
+      }
+    }
+
+    const double perEditorSeconds = seconds * numEditors;
+    const double messageNs = tickNs + paintNs;
+
+    results.addRow({{"scenario", scenario},
+                    {"editors", numEditors},
+                    {"seconds", seconds},
+                    {"ticksPerSec", numTicks / perEditorSeconds},
+                    {"repaintsPerSec", numPaints / perEditorSeconds},
+                    {"meanDirtyKpx", numPaints > 0 ? dirtyPixels / numPaints / 1000.0 : 0.0},
+                    {"tickUsPerSec", tickNs / perEditorSeconds / 1000.0},
+                    {"paintUsPerSec", paintNs / perEditorSeconds / 1000.0},
+                    {"usPerSec", messageNs / perEditorSeconds / 1000.0},
+                    {"loadPercent", 100.0 * messageNs / (seconds * 1.0e9)}});
+
+    std::cerr << scenario << " x" << numEditors << ": " << numPaints / perEditorSeconds << " repaints/s, "
+              << messageNs / perEditorSeconds / 1000.0 << " us/s per editor, "
+              << 100.0 * messageNs / (seconds * 1.0e9) << "% of the message thread" << std::endl;
+  }
+
+  void printUsage() {
+    std::cout << "EditorPaintBench - message-thread cost of the NovaTune editor (headless)\n\n"
+              << "  --mode=MODE        components (paint cost per component, default)\n"
+              << "                     or session (simulated open editors over time)\n"
+              << "  --iterations=N     Paints per component (default 200)\n"
+              << "  --scale=S          Render scale, e.g. 2 for a HiDPI display (default 1)\n"
+              << "  --editors=LIST     Open editors per session run (default 1,8)\n"
+              << "  --seconds=N        Simulated seconds per session run (default 5)\n"
+              << "  --scenarios=LIST   singing,breath,stopped,hidden (default all)\n"
+              << "  --output=FILE      Write results to FILE (default stdout)\n"
+              << "  --csv              Write CSV instead of JSON\n";
+  }
+
+} // namespace
+
+//==============================================================================
+// MAIN
+//==============================================================================
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  juce::ArgumentList args(argc, argv);
+
+  if (args.containsOption("--help|-h")) {
+    printUsage();
+    return 0;
+  }
+
+  const auto mode = args.containsOption("--mode") ? args.getValueForOption("--mode") : juce::String("components");
+  ResultTable results;
+
+  if (mode == "components") {
+    const int iterations = juce::jmax(1, static_cast<int>(parseNumber(args, "--iterations", 200.0)));
+    const auto scale = static_cast<float>(juce::jlimit(0.5, 4.0, parseNumber(args, "--scale", 1.0)));
+    runComponents(results, iterations, scale);
+  } else if (mode == "session") {
+    const double seconds = juce::jmax(0.5, parseNumber(args, "--seconds", 5.0));
+
+    auto scenarios = allScenarios;
+    if (args.containsOption("--scenarios")) {
+      scenarios = juce::StringArray::fromTokens(args.getValueForOption("--scenarios"), ",", "");
+      scenarios.trim();
+      scenarios.removeEmptyStrings();
+    }
+
+    for (const auto &scenario : scenarios) {
+      if (!allScenarios.contains(scenario)) {
+        std::cerr << "Unknown scenario: " << scenario << std::endl;
+        return 1;
+      }
+
+      for (int count : parseList<int>(args, "--editors", {1, 8}))
+        runSession(results, scenario, juce::jlimit(1, 256, count), seconds);
+    }
+  } else {
+    std::cerr << "Unknown mode: " << mode << std::endl;
+    printUsage();
+    return 1;
+  }
+
+  if (!results.write(args.getValueForOption("--output"), args.containsOption("--csv"))) {
+    std::cerr << "Failed to write results" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,177 @@
+#include <juce_core/juce_core.h>
+#include "KeyBus.h"
+#include "ToolUtilities.h"
+
+/**
+ * KeyBusCheck.cpp
+ *
+ * Key bus cost, and a cross-process follow check.
+ *
+ * Times publish() and getChangeAt() on this process's bus, then starts a
+ * copy of itself as a publisher: it publishes --changes key/scale changes
+ * in bursts, change n at timeline sample n * 480, while this
+ * process follows. Every change the follower reads must be one the
+ * publisher wrote (key and scale follow from the change's number), so a
+ * torn read shows up as a mismatch. After the publisher exits, the last
+ * changes must each be found at their own timeline position.
+ *
+ * COLUMNS:
+ *   phase       - publish / lookup (ns per call), follow (cross-process)
+ *   value       - ns per call, or changes seen by the follower
+ *   errors      - changes read with the wrong key or scale, or missing
+ *
+ * USAGE:
+ *   KeyBusCheck [--changes=200000] [--output=FILE] [--csv]
+ */
+
+using namespace NovaTuneTools;
+
+namespace {
+
+  constexpr juce::int64 samplesPerChange = 480;
+
+  /** What change `number` holds, in a run of this tool */
+  NovaTuneEnums::Key keyOf(uint64_t number) {
+    return static_cast<NovaTuneEnums::Key>(number % static_cast<uint64_t>(NovaTuneEnums::Key::numKeys));
+  }
+
+  NovaTuneEnums::Scale scaleOf(uint64_t number) {
+    return static_cast<NovaTuneEnums::Scale>(number % static_cast<uint64_t>(NovaTuneEnums::Scale::numScales));
+  }
+
+  /** The child process: publish changes numbered from the bus's count */
+  int runPublisher(int numChanges) {
+    KeyBus bus;
+
+    juce::Random random(1);
+
+    for (int i = 0; i < numChanges; ++i) {
+      // Numbers are the bus's, so derive the change from the one it will get
+      const uint64_t number = bus.getNumPublished() + 1;
+      bus.publish(keyOf(number), scaleOf(number), static_cast<juce::int64>(number) * samplesPerChange);
+
+      // Bursts and gaps of up to a few microseconds, so the follower reads mid-write as well as between writes
+      const auto until = juce::Time::getHighResolutionTicks() +
+                         juce::Time::secondsToHighResolutionTicks(random.nextInt(4000) * 1.0e-9);
+      while (juce::Time::getHighResolutionTicks() < until) {
+      }
+    }
+
+    return 0;
+  }
+
+  void printUsage() {
+    std::cout << "KeyBusCheck - key bus cost and cross-process follow check\n\n"
+              << "  --changes=N             Changes the publisher process writes (default 200000)\n"
+              << "  --output=FILE           Write results to FILE (default stdout)\n"
+              << "  --csv                   Write CSV instead of JSON\n";
+  }
+
+} // namespace
+
+//==============================================================================
+// MAIN
+//==============================================================================
+
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+
+  if (args.containsOption("--help|-h")) {
+    printUsage();
+    return 0;
+  }
+
+  const int numChanges = juce::jmax(1, static_cast<int>(parseNumber(args, "--changes", 200000.0)));
+
+  if (args.containsOption("--publisher"))
+    return runPublisher(numChanges);
+
+  KeyBus bus;
+
+  if (!bus.isMachineWide()) {
+    std::cerr << "The machine-wide bus couldn't be opened; only this process would share it" << std::endl;
+    return 1;
+  }
+
+  ResultTable table;
+  Stopwatch stopwatch;
+  bool ok = true;
+
+  //==========================================================================
+  // COST
+  //==========================================================================
+
+  constexpr int repeats = 1000000;
+
+  stopwatch.start();
+  for (int i = 0; i < repeats; ++i) {
+    const uint64_t number = bus.getNumPublished() + 1;
+    bus.publish(keyOf(number), scaleOf(number), static_cast<juce::int64>(number) * samplesPerChange);
+  }
+  const double publishNs = stopwatch.elapsedNs() / repeats;
+
+  // Positions across the changes still held: from the newest (one slot read) to the oldest (all of them)
+  const uint64_t oldest = bus.getNumPublished() - KeyBus::capacity + 1;
+  KeyBus::Change change;
+  int found = 0;
+
+  stopwatch.start();
+  for (int i = 0; i < repeats; ++i) {
+    const uint64_t number = oldest + static_cast<uint64_t>(i % KeyBus::capacity);
+    found += bus.getChangeAt(static_cast<juce::int64>(number) * samplesPerChange, change) ? 1 : 0;
+  }
+  const double lookupNs = stopwatch.elapsedNs() / repeats;
+
+  std::cerr << "publish: " << publishNs << " ns, lookup: " << lookupNs << " ns (" << found << " found)" << std::endl;
+  table.addRow({{"phase", "publish"}, {"value", publishNs}, {"errors", 0}});
+  table.addRow({{"phase", "lookup"}, {"value", lookupNs}, {"errors", repeats - found}});
+  ok = found == repeats;
+
+  //==========================================================================
+  // CROSS-PROCESS
+  //==========================================================================
+
+  juce::ChildProcess publisher;
+  const auto self = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getFullPathName();
+
+  if (!publisher.start(juce::StringArray{self, "--publisher", "--changes=" + juce::String(numChanges)})) {
+    std::cerr << "Couldn't start the publisher process" << std::endl;
+    return 1;
+  }
+
+  int seen = 0;
+  int errors = 0;
+  uint64_t lastNumber = 0;
+
+  while (publisher.isRunning()) {
+    if (!bus.getChangeAt(KeyBus::now, change) || change.number == lastNumber)
+      continue;
+
+    ++seen;
+    lastNumber = change.number;
+
+    if (change.key != keyOf(change.number) || change.scale != scaleOf(change.number) ||
+        change.timelineSample != static_cast<juce::int64>(change.number) * samplesPerChange)
+      ++errors;
+  }
+
+  // Every change still held is found at its own position
+  const uint64_t newest = bus.getNumPublished();
+
+  for (uint64_t number = newest - KeyBus::capacity + 1; number <= newest; ++number) {
+    const bool atPosition = bus.getChangeAt(static_cast<juce::int64>(number) * samplesPerChange, change) &&
+                            change.number == number && change.key == keyOf(number) && change.scale == scaleOf(number);
+    errors += atPosition ? 0 : 1;
+  }
+
+  ok = ok && errors == 0 && publisher.getExitCode() == 0;
+
+  std::cerr << "follow: " << seen << " changes seen while " << numChanges << " were published, " << errors
+            << " errors" << std::endl;
+  table.addRow({{"phase", "follow"}, {"value", seen}, {"errors", errors}});
+
+  if (!table.write(args.getValueForOption("--output"), args.containsOption("--csv")))
+    return 1;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,377 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "PluginProcessor.h"
+#include "SyntheticVocal.h"
+#include "ToolUtilities.h"
+
+/**
+ * MultiInstanceStress.cpp
+ *
+ * Headless stress test: how many NovaTune instances fit in one project?
+ *
+ * N processors are created in-process and driven by M worker threads the
+ * way a DAW graph drives parallel tracks: every audio period, all N
+ * instances must process one block, workers pull the next unprocessed
+ * instance from a shared counter, and the period is finished when the
+ * last instance is done. The calling thread is one of the M workers, just
+ * like a host's audio callback thread.
+ *
+ * Periods run back to back (no sleeping), so the wall time of each period
+ * is compared against the real-time deadline (blockSize / sampleRate).
+ *
+ * USAGE:
+ *   MultiInstanceStress [--instances=1,2,4,...,256] [--threads=M]
+ *                       [--block-size=256] [--sample-rate=48000]
+ *                       [--voices=2] [--seconds=2] [--output=FILE] [--csv]
+ *
+ * COLUMNS:
+ *   missRate          - fraction of periods that overran the deadline
+ *   perInstanceUs     - average time one instance spent in processBlock
+ *   realtimeInstances - instance-seconds of audio processed per wall second
+ *
+ * The first instance count with missed deadlines is reported on stderr.
+ */
+
+using namespace NovaTuneTools;
+
+namespace {
+
+  //==========================================================================
+  // CONFIGURATION
+  //==========================================================================
+
+  /** Distinct input renders shared between instances (keeps memory flat at N = 256) */
+  constexpr int numInputVariants = 8;
+
+  struct StressConfig {
+    int numInstances = 1;
+    int numThreads = 1;
+    int blockSize = 256;
+    double sampleRate = 48000.0;
+    int numVoices = 2;
+    double seconds = 2.0;
+  };
+
+  struct StressResult {
+    int numPeriods = 0;
+    int missedPeriods = 0;
+    double wallNs = 0.0;
+    double instanceNs = 0.0; // Summed over all instances and periods
+    std::vector<double> periodNs;
+  };
+
+  /** One plugin "track" in the simulated session */
+  struct Instance {
+    std::unique_ptr<NovaTuneAudioProcessor> processor;
+    juce::AudioBuffer<float> buffer;
+    juce::MidiBuffer midi;
+    const juce::AudioBuffer<float> *input = nullptr;
+    int readPosition = 0;
+    double processNs = 0.0;
+  };
+
+  //==========================================================================
+  // INPUT
+  //==========================================================================
+
+  /** A few seconds of vocal at a per-variant pitch, so instances don't all sing in unison */
+  juce::AudioBuffer<float> renderVariant(double sampleRate, int variant) {
+    const int numSamples = static_cast<int>(sampleRate * 2.0);
+    juce::AudioBuffer<float> input(2, numSamples);
+
+    SyntheticVocal vocal;
+    vocal.prepare(sampleRate);
+
+    auto *left = input.getWritePointer(0);
+    const double baseNote = 50.0 + 2.3 * variant;
+
+    for (int i = 0; i < numSamples; ++i) {
+      const double t = static_cast<double>(i) / sampleRate;
+      const double midi = baseNote + 1.5 * std::sin(juce::MathConstants<double>::twoPi * 0.4 * t);
+      vocal.setFundamental(NovaTuneUtils::midiNoteToFrequency(static_cast<float>(midi)));
+      left[i] = vocal.nextSample();
+    }
+
+    input.copyFrom(1, 0, input, 0, 0, numSamples);
+    return input;
+  }
+
+  /** Copy the next block of this instance's looping input into its I/O buffer */
+  void fillBlock(Instance &instance, int blockSize) {
+    const auto &input = *instance.input;
+
+    for (int done = 0; done < blockSize;) {
+      const int chunk = std::min(blockSize - done, input.getNumSamples() - instance.readPosition);
+
+      for (int ch = 0; ch < instance.buffer.getNumChannels(); ++ch)
+        instance.buffer.copyFrom(ch, done, input, ch, instance.readPosition, chunk);
+
+      done += chunk;
+      instance.readPosition = (instance.readPosition + chunk) % input.getNumSamples();
+    }
+  }
+
+  //==========================================================================
+  // GRAPH SCHEDULER
+  //==========================================================================
+
+  /**
+   * Minimal model of a DAW's parallel graph: a period is published by
+   * bumping `generation`, every worker claims instances from `nextInstance`
+   * until none are left, and the period ends when `completed` reaches N.
+   *
+   * Workers spin (with yield) rather than block, as real-time graph
+   * threads do, so wake-up latency doesn't dominate small block sizes.
+   */
+  class GraphScheduler {
+  public:
+    GraphScheduler(std::vector<Instance> &instancesToRun, int numInstances, int numThreads, int blockSize)
+        : instances(instancesToRun), activeInstances(numInstances), samplesPerBlock(blockSize) {
+      for (int t = 1; t < numThreads; ++t)
+        helpers.emplace_back([this] { helperLoop(); });
+    }
+
+    ~GraphScheduler() {
+      running.store(false);
+      generation.fetch_add(1);
+      for (auto &thread : helpers)
+        thread.join();
+    }
+
+    /** Run one period on all instances; returns when every instance is done */
+    void runPeriod() {
+      // completed must be cleared first: a late worker from the previous
+      // period may claim (and legitimately run) an instance as soon as
+      // nextInstance is reset
+      completed.store(0, std::memory_order_relaxed);
+      nextInstance.store(0, std::memory_order_release);
+      generation.fetch_add(1, std::memory_order_release);
+
+      processAvailable();
+
+      while (completed.load(std::memory_order_acquire) < activeInstances)
+        std::this_thread::yield();
+    }
+
+  private:
+    std::vector<Instance> &instances;
+    const int activeInstances;
+    const int samplesPerBlock;
+
+    std::vector<std::thread> helpers;
+    std::atomic<bool> running{true};
+    std::atomic<juce::uint64> generation{0};
+    std::atomic<int> nextInstance{0};
+    std::atomic<int> completed{0};
+
+    void helperLoop() {
+      juce::uint64 seen = generation.load(std::memory_order_acquire);
+
+      while (true) {
+        juce::uint64 current;
+        while ((current = generation.load(std::memory_order_acquire)) == seen)
+          std::this_thread::yield();
+
+        seen = current;
+        if (!running.load())
+          return;
+
+        processAvailable();
+      }
+    }
+
+    void processAvailable() {
+      int index;
+      while ((index = nextInstance.fetch_add(1, std::memory_order_relaxed)) < activeInstances) {
+        auto &instance = instances[static_cast<size_t>(index)];
+
+        fillBlock(instance, samplesPerBlock);
+
+        Stopwatch stopwatch;
+        stopwatch.start();
+        instance.processor->processBlock(instance.buffer, instance.midi);
+        instance.processNs += stopwatch.elapsedNs();
+
+        completed.fetch_add(1, std::memory_order_release);
+      }
+    }
+  };
+
+  //==========================================================================
+  // RUN
+  //==========================================================================
+
+  StressResult runStress(const StressConfig &config, std::vector<Instance> &instances) {
+    for (int i = 0; i < config.numInstances; ++i) {
+      auto &instance = instances[static_cast<size_t>(i)];
+      instance.processor->prepareToPlay(config.sampleRate, config.blockSize);
+      instance.buffer.setSize(2, config.blockSize);
+      instance.readPosition = (i * 997) % instance.input->getNumSamples(); // Decorrelate phrases
+      instance.processNs = 0.0;
+    }
+
+    const double deadlineNs = 1.0e9 * config.blockSize / config.sampleRate;
+    const int numPeriods = juce::jmax(1, static_cast<int>(config.seconds * config.sampleRate / config.blockSize));
+    const int warmupPeriods = juce::jmax(1, numPeriods / 10);
+
+    StressResult result;
+    result.periodNs.reserve(static_cast<size_t>(numPeriods));
+
+    GraphScheduler scheduler(instances, config.numInstances, config.numThreads, config.blockSize);
+
+    for (int p = 0; p < warmupPeriods; ++p)
+      scheduler.runPeriod();
+
+    for (int i = 0; i < config.numInstances; ++i)
+      instances[static_cast<size_t>(i)].processNs = 0.0;
+
+    Stopwatch total;
+    total.start();
+
+    for (int p = 0; p < numPeriods; ++p) {
+      Stopwatch period;
+      period.start();
+      scheduler.runPeriod();
+      const double ns = period.elapsedNs();
+
+      result.periodNs.push_back(ns);
+      if (ns > deadlineNs)
+        ++result.missedPeriods;
+    }
+
+    result.wallNs = total.elapsedNs();
+    result.numPeriods = numPeriods;
+
+    for (int i = 0; i < config.numInstances; ++i)
+      result.instanceNs += instances[static_cast<size_t>(i)].processNs;
+
+    return result;
+  }
+
+  double percentile(std::vector<double> values, double fraction) {
+    if (values.empty())
+      return 0.0;
+    std::sort(values.begin(), values.end());
+    const auto index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1));
+    return values[index];
+  }
+
+  void printUsage() {
+    std::cout << "MultiInstanceStress - how many NovaTune instances fit in real time\n\n"
+              << "  --instances=LIST   Instance counts to run (default 1,2,4,...,256)\n"
+              << "  --threads=M        Graph worker threads including the audio thread\n"
+              << "                     (default: number of CPU cores)\n"
+              << "  --block-size=N     Host buffer size (default 256)\n"
+              << "  --sample-rate=HZ   Sample rate (default 48000)\n"
+              << "  --voices=N         Harmony voices enabled per instance (default 2)\n"
+              << "  --seconds=N        Audio processed per instance count (default 2)\n"
+              << "  --output=FILE      Write results to FILE (default stdout)\n"
+              << "  --csv              Write CSV instead of JSON\n";
+  }
+
+} // namespace
+
+//==============================================================================
+// MAIN
+//==============================================================================
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  juce::ArgumentList args(argc, argv);
+
+  if (args.containsOption("--help|-h")) {
+    printUsage();
+    return 0;
+  }
+
+  StressConfig base;
+  base.numThreads = juce::jmax(1, static_cast<int>(parseNumber(args, "--threads", juce::SystemStats::getNumCpus())));
+  base.blockSize = juce::jmax(16, static_cast<int>(parseNumber(args, "--block-size", 256.0)));
+  base.sampleRate = parseNumber(args, "--sample-rate", 48000.0);
+  base.numVoices = juce::jlimit(0, DSPConfig::maxHarmonyVoices, static_cast<int>(parseNumber(args, "--voices", 2.0)));
+  base.seconds = parseNumber(args, "--seconds", 2.0);
+
+  auto instanceCounts = parseList<int>(args, "--instances", {1, 2, 4, 8, 16, 32, 64, 128, 256});
+  for (auto &count : instanceCounts)
+    count = juce::jlimit(1, 256, count);
+
+  const int maxInstances = *std::max_element(instanceCounts.begin(), instanceCounts.end());
+
+  //==========================================================================
+  // SESSION SETUP
+  //==========================================================================
+
+  std::vector<juce::AudioBuffer<float>> inputs;
+  for (int v = 0; v < numInputVariants; ++v)
+    inputs.push_back(renderVariant(base.sampleRate, v));
+
+  std::vector<Instance> instances(static_cast<size_t>(maxInstances));
+
+  for (int i = 0; i < maxInstances; ++i) {
+    auto &instance = instances[static_cast<size_t>(i)];
+    instance.processor = std::make_unique<NovaTuneAudioProcessor>();
+    instance.processor->setPlayConfigDetails(2, 2, base.sampleRate, base.blockSize);
+    instance.input = &inputs[static_cast<size_t>(i % numInputVariants)];
+    setActiveHarmonyVoices(instance.processor->getValueTreeState(), base.numVoices);
+  }
+
+  //==========================================================================
+  // SWEEP
+  //==========================================================================
+
+  const double deadlineNs = 1.0e9 * base.blockSize / base.sampleRate;
+  int firstMissingCount = 0;
+  ResultTable results;
+
+  for (int count : instanceCounts) {
+    auto config = base;
+    config.numInstances = count;
+
+    const auto result = runStress(config, instances);
+
+    const double audioNs = 1.0e9 * result.numPeriods * config.blockSize / config.sampleRate;
+    const double periodMeanNs = result.wallNs / result.numPeriods;
+    const double perInstanceNs = result.instanceNs / (static_cast<double>(result.numPeriods) * count);
+
+    if (result.missedPeriods > 0 && firstMissingCount == 0)
+      firstMissingCount = count;
+
+    results.addRow({{"instances", count},
+                    {"threads", config.numThreads},
+                    {"blockSize", config.blockSize},
+                    {"sampleRate", config.sampleRate},
+                    {"voices", config.numVoices},
+                    {"periods", result.numPeriods},
+                    {"deadlineUs", deadlineNs / 1000.0},
+                    {"meanPeriodUs", periodMeanNs / 1000.0},
+                    {"p99PeriodUs", percentile(result.periodNs, 0.99) / 1000.0},
+                    {"maxPeriodUs", percentile(result.periodNs, 1.0) / 1000.0},
+                    {"missedPeriods", result.missedPeriods},
+                    {"missRate", static_cast<double>(result.missedPeriods) / result.numPeriods},
+                    {"perInstanceUs", perInstanceNs / 1000.0},
+                    {"perInstanceLoad", perInstanceNs / deadlineNs},
+                    {"realtimeInstances", count * audioNs / result.wallNs}});
+
+    std::cerr << count << " instances: mean period " << periodMeanNs / deadlineNs * 100.0
+              << "% of deadline, " << result.missedPeriods << "/" << result.numPeriods << " missed" << std::endl;
+  }
+
+  if (firstMissingCount > 0)
+    std::cerr << "Deadline misses begin at " << firstMissingCount << " instances" << std::endl;
+  else
+    std::cerr << "No deadline misses up to " << maxInstances << " instances" << std::endl;
+
+  for (auto &instance : instances)
+    instance.processor->releaseResources();
+
+  if (!results.write(args.getValueForOption("--output"), args.containsOption("--csv"))) {
+    std::cerr << "Failed to write results" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,428 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+#include <functional>
+#include "PluginProcessor.h"
+#include "dsp/TunerEngine.h"
+#include "dsp/PitchDetector.h"
+#include "dsp/PitchMapper.h"
+#include "dsp/PitchShifter.h"
+#include "dsp/FormantProcessor.h"
+#include "dsp/HarmonyVoice.h"
+#include "dsp/LeadCorrection.h"
+#include "dsp/BlockTimeHistogram.h"
+#include "PerfCounters.h"
+#include "SyntheticVocal.h"
+#include "ToolUtilities.h"
+
+/**
+ * NovaTuneBench.cpp
+ *
+ * Headless micro-benchmark for the NovaTune DSP chain.
+ *
+ * Each DSP stage is timed in isolation (plus the full TunerEngine) across
+ * a sweep of sample rates, block sizes and harmony voice counts, and the
+ * results are written as JSON or CSV so runs can be diffed over time.
+ *
+ * USAGE:
+ *   NovaTuneBench [--sample-rates=44100,48000] [--block-sizes=64,512]
+ *                 [--voices=0,1,2,3] [--stages=detector,engine]
+ *                 [--seconds=1.0] [--output=results.json] [--csv]
+ *                 [--histogram-output=buckets.csv]
+ *
+ * COLUMNS:
+ *   nsPerSample    - average processing cost per sample
+ *   realtimeFactor - audio duration / processing time (>1 = faster than real time)
+ *   maxBlockNs     - slowest single block
+ *   p50/p99/p999   - block time percentiles as a fraction of the block
+ *                    deadline (BlockTimeHistogram, 1.0 = deadline)
+ *   maxDeadline    - slowest block as a fraction of the deadline
+ *   missRate       - fraction of blocks over the deadline
+ *
+ * --histogram-output writes the raw histogram buckets (one row per
+ * non-empty bucket per measurement) in the same format as --output.
+ *
+ * HARDWARE COUNTERS (Linux, --perf-counters):
+ * Counts cycles, instructions, L1D and LLC read misses and branch misses
+ * around each measured region (see PerfCounters.h) and adds per-sample
+ * columns (cyclesPerSample, l1dMissesPerSample, ...) plus ipc. Counter
+ * reads happen outside the stopwatch, so timings are unaffected.
+ * Unavailable events are left empty.
+ */
+
+using namespace NovaTuneTools;
+
+namespace {
+
+  //==========================================================================
+  // CONFIGURATION
+  //==========================================================================
+
+  const juce::StringArray allStages{"detector", "shifter", "formant", "harmony", "lead", "engine"};
+
+  struct BenchConfig {
+    double sampleRate = 44100.0;
+    int blockSize = 512;
+    int numVoices = 0;
+  };
+
+  struct BlockTiming {
+    double totalNs = 0.0;
+    double maxNs = 0.0;
+    juce::int64 numSamples = 0;
+    BlockTimeHistogram::Snapshot blockTimes; // Normalised to the block deadline
+    PerfCounters::Values counters;           // Only with --perf-counters
+  };
+
+  /** Fraction of the input used to warm caches/state before timing starts */
+  constexpr double warmupFraction = 0.1;
+
+  /** Hardware counters around every timed() call, or nullptr */
+  PerfCounters *perfCounters = nullptr;
+
+  //==========================================================================
+  // HELPERS
+  //==========================================================================
+
+  /** Time a single call in nanoseconds (and count it, with --perf-counters) */
+  template <typename Fn>
+  double timed(Fn &&fn) {
+    if (perfCounters != nullptr)
+      perfCounters->begin();
+
+    Stopwatch stopwatch;
+    stopwatch.start();
+    fn();
+    const double ns = stopwatch.elapsedNs();
+
+    if (perfCounters != nullptr)
+      perfCounters->end();
+
+    return ns;
+  }
+
+  /**
+   * Render a stereo test signal: a synthetic vocal gliding slowly between
+   * notes with a slight detune, so the correction path always has work to do.
+   */
+  juce::AudioBuffer<float> renderInput(double sampleRate, double seconds) {
+    const int numSamples = static_cast<int>(sampleRate * seconds);
+    juce::AudioBuffer<float> input(2, numSamples);
+
+    SyntheticVocal vocal;
+    vocal.prepare(sampleRate);
+
+    auto *left = input.getWritePointer(0);
+    for (int i = 0; i < numSamples; ++i) {
+      const double t = static_cast<double>(i) / sampleRate;
+      // A3 +/- a fourth, 0.5 Hz glide, ~20 cents sharp
+      const double midi = 57.2 + 2.5 * std::sin(juce::MathConstants<double>::pi * t);
+      vocal.setFundamental(NovaTuneUtils::midiNoteToFrequency(static_cast<float>(midi)));
+      left[i] = vocal.nextSample();
+    }
+
+    input.copyFrom(1, 0, input, 0, 0, numSamples);
+    return input;
+  }
+
+  /**
+   * Feed the input through processBlock() in blockSize chunks.
+   * processBlock returns the time it spent in the measured region.
+   */
+  BlockTiming runBlocks(const juce::AudioBuffer<float> &input,
+                        const BenchConfig &config,
+                        const std::function<double(juce::AudioBuffer<float> &)> &processBlock) {
+    const int blockSize = config.blockSize;
+    const double deadlineNs = 1.0e9 * blockSize / config.sampleRate;
+
+    juce::AudioBuffer<float> block(input.getNumChannels(), blockSize);
+    const int numBlocks = input.getNumSamples() / blockSize;
+    const int warmupBlocks = static_cast<int>(numBlocks * warmupFraction);
+
+    BlockTiming timing;
+    BlockTimeHistogram histogram;
+
+    for (int b = 0; b < numBlocks; ++b) {
+      for (int ch = 0; ch < input.getNumChannels(); ++ch)
+        block.copyFrom(ch, 0, input, ch, b * blockSize, blockSize);
+
+      const double ns = processBlock(block);
+
+      if (b < warmupBlocks)
+        continue;
+
+      timing.totalNs += ns;
+      timing.maxNs = std::max(timing.maxNs, ns);
+      timing.numSamples += blockSize;
+      histogram.record(ns, deadlineNs);
+
+      if (perfCounters != nullptr)
+        timing.counters += perfCounters->getLastDelta();
+    }
+
+    timing.blockTimes = histogram.getSnapshot();
+    return timing;
+  }
+
+  //==========================================================================
+  // STAGES
+  //==========================================================================
+
+  BlockTiming benchDetector(const BenchConfig &config, const juce::AudioBuffer<float> &input) {
+    PitchDetector detector;
+    detector.prepare(config.sampleRate, config.blockSize);
+
+    return runBlocks(input, config, [&](juce::AudioBuffer<float> &block) {
+      return timed([&] { detector.process(block); });
+    });
+  }
+
+  BlockTiming benchShifter(const BenchConfig &config, const juce::AudioBuffer<float> &input) {
+    PitchShifter shifter;
+    shifter.prepare(config.sampleRate, config.blockSize);
+    shifter.setPitchSemitones(2.0f);
+
+    return runBlocks(input, config, [&](juce::AudioBuffer<float> &block) {
+      return timed([&] { shifter.process(block.getWritePointer(0), block.getNumSamples()); });
+    });
+  }
+
+  BlockTiming benchFormant(const BenchConfig &config, const juce::AudioBuffer<float> &input) {
+    FormantProcessor formant;
+    formant.prepare(config.sampleRate, config.blockSize, input.getNumChannels());
+    formant.setFormantShift(2.0f); // Non-zero so the filter bank is never skipped
+
+    return runBlocks(input, config, [&](juce::AudioBuffer<float> &block) {
+      return timed([&] { formant.process(block); });
+    });
+  }
+
+  BlockTiming benchHarmony(const BenchConfig &config,
+                           const juce::AudioBuffer<float> &input,
+                           const EngineParameters &params) {
+    PitchDetector detector;
+    PitchMapper mapper;
+    std::vector<HarmonyVoice> voices(static_cast<size_t>(config.numVoices));
+    juce::AudioBuffer<float> harmonyBuffer(input.getNumChannels(), config.blockSize);
+
+    detector.prepare(config.sampleRate, config.blockSize);
+    mapper.prepare(config.sampleRate);
+    mapper.updateFromParameters(params);
+
+    for (size_t i = 0; i < voices.size(); ++i) {
+      voices[i].prepare(config.sampleRate, config.blockSize, input.getNumChannels());
+      voices[i].updateFromParameters(params.voices[i]);
+    }
+
+    return runBlocks(input, config, [&](juce::AudioBuffer<float> &block) {
+      // Analysis is not part of this stage
+      detector.process(block);
+      mapper.map(detector);
+      harmonyBuffer.clear();
+
+      return timed([&] {
+        for (auto &voice : voices)
+          voice.process(harmonyBuffer, block, detector, mapper);
+      });
+    });
+  }
+
+  BlockTiming benchLead(const BenchConfig &config,
+                        const juce::AudioBuffer<float> &input,
+                        const EngineParameters &params) {
+    PitchDetector detector;
+    PitchMapper mapper;
+    LeadCorrection lead;
+
+    detector.prepare(config.sampleRate, config.blockSize);
+    mapper.prepare(config.sampleRate);
+    mapper.updateFromParameters(params);
+    lead.prepare(config.sampleRate, config.blockSize, input.getNumChannels());
+    lead.updateFromParameters(params);
+
+    return runBlocks(input, config, [&](juce::AudioBuffer<float> &block) {
+      detector.process(block);
+      mapper.map(detector);
+
+      return timed([&] { lead.process(block, detector, mapper); });
+    });
+  }
+
+  BlockTiming benchEngine(const BenchConfig &config,
+                          const juce::AudioBuffer<float> &input,
+                          const EngineParameters &params) {
+    TunerEngine engine;
+    juce::MidiBuffer midi;
+    engine.prepare(config.sampleRate, config.blockSize, input.getNumChannels());
+
+    return runBlocks(input, config, [&](juce::AudioBuffer<float> &block) {
+      return timed([&] { engine.process(block, midi, params); });
+    });
+  }
+
+  /** Per-sample counter columns plus IPC; unavailable events are left empty */
+  void addCounterColumns(ResultTable::Row &row, const PerfCounters::Values &values, juce::int64 numSamples) {
+    auto perSample = [&](PerfCounters::Event event) -> juce::var {
+      const auto i = static_cast<size_t>(event);
+      return values.available[i] ? juce::var(values.counts[i] / static_cast<double>(numSamples)) : juce::var();
+    };
+
+    for (int e = 0; e < PerfCounters::numEvents; ++e) {
+      const auto event = static_cast<PerfCounters::Event>(e);
+      row.emplace_back(juce::String(PerfCounters::getEventName(event)) + "PerSample", perSample(event));
+    }
+
+    const bool hasIpc = values.available[PerfCounters::cycles] && values.available[PerfCounters::instructions] &&
+                        values.counts[PerfCounters::cycles] > 0.0;
+    row.emplace_back("ipc", hasIpc ? juce::var(values.counts[PerfCounters::instructions] / values.counts[PerfCounters::cycles])
+                                   : juce::var());
+  }
+
+  void printUsage() {
+    std::cout << "NovaTuneBench - headless DSP micro-benchmark\n\n"
+              << "  --sample-rates=LIST  Sample rates in Hz (default 44100..192000)\n"
+              << "  --block-sizes=LIST   Block sizes in samples (default 32..4096)\n"
+              << "  --voices=LIST        Harmony voice counts (default 0,1,2,3)\n"
+              << "  --stages=LIST        " << allStages.joinIntoString(",") << "\n"
+              << "  --seconds=N          Audio rendered per measurement (default 1.0)\n"
+              << "  --output=FILE        Write results to FILE (default stdout)\n"
+              << "  --csv                Write CSV instead of JSON\n"
+              << "  --histogram-output=FILE  Also write the raw block-time histogram buckets\n"
+              << "  --perf-counters      Add hardware counter columns (Linux perf_event_open)\n";
+  }
+
+} // namespace
+
+//==============================================================================
+// MAIN
+//==============================================================================
+
+int main(int argc, char *argv[]) {
+  // The parameter state relies on the message manager existing
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  juce::ScopedNoDenormals noDenormals;
+
+  juce::ArgumentList args(argc, argv);
+
+  if (args.containsOption("--help|-h")) {
+    printUsage();
+    return 0;
+  }
+
+  const auto sampleRates = parseList<double>(args, "--sample-rates", {44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0});
+  const auto blockSizes = parseList<int>(args, "--block-sizes", {32, 64, 128, 256, 512, 1024, 2048, 4096});
+  const auto voiceCounts = parseList<int>(args, "--voices", {0, 1, 2, 3});
+  const double seconds = parseNumber(args, "--seconds", 1.0);
+
+  juce::StringArray stages = allStages;
+  if (args.containsOption("--stages")) {
+    stages = juce::StringArray::fromTokens(args.getValueForOption("--stages"), ",", "");
+    stages.removeEmptyStrings();
+  }
+
+  // Counters are per thread - every stage runs on this one
+  PerfCounters counters;
+  if (args.containsOption("--perf-counters")) {
+    if (counters.open())
+      perfCounters = &counters;
+    else
+      std::cerr << "Hardware counters unavailable, continuing without: " << counters.getError() << std::endl;
+  }
+
+  // A real processor instance owns the parameter layout; the DSP reads its snapshot
+  NovaTuneAudioProcessor processor;
+  auto &apvts = processor.getValueTreeState();
+
+  ResultTable results;
+  ResultTable histograms;
+
+  for (double sampleRate : sampleRates) {
+    const auto input = renderInput(sampleRate, seconds * (1.0 + warmupFraction));
+
+    for (int blockSize : blockSizes) {
+      for (const auto &stage : stages) {
+        // Only harmony and the full engine depend on the voice count
+        const bool usesVoices = stage == "harmony" || stage == "engine";
+        const std::vector<int> voicesToRun = usesVoices ? voiceCounts : std::vector<int>{0};
+
+        for (int numVoices : voicesToRun) {
+          if (stage == "harmony" && numVoices == 0)
+            continue;
+
+          const BenchConfig config{sampleRate, blockSize, juce::jlimit(0, DSPConfig::maxHarmonyVoices, numVoices)};
+          setActiveHarmonyVoices(apvts, config.numVoices);
+
+          BlockTiming timing;
+
+          if (stage == "detector")
+            timing = benchDetector(config, input);
+          else if (stage == "shifter")
+            timing = benchShifter(config, input);
+          else if (stage == "formant")
+            timing = benchFormant(config, input);
+          else if (stage == "harmony")
+            timing = benchHarmony(config, input, processor.getEngineParameters());
+          else if (stage == "lead")
+            timing = benchLead(config, input, processor.getEngineParameters());
+          else if (stage == "engine")
+            timing = benchEngine(config, input, processor.getEngineParameters());
+          else {
+            std::cerr << "Unknown stage: " << stage << std::endl;
+            return 1;
+          }
+
+          if (timing.numSamples == 0)
+            continue;
+
+          const double audioNs = 1.0e9 * static_cast<double>(timing.numSamples) / sampleRate;
+
+          ResultTable::Row row{{"stage", stage},
+                               {"sampleRate", sampleRate},
+                               {"blockSize", blockSize},
+                               {"voices", config.numVoices},
+                               {"samples", timing.numSamples},
+                               {"nsPerSample", timing.totalNs / static_cast<double>(timing.numSamples)},
+                               {"realtimeFactor", timing.totalNs > 0.0 ? audioNs / timing.totalNs : 0.0},
+                               {"maxBlockNs", timing.maxNs},
+                               {"p50", timing.blockTimes.percentile(0.5)},
+                               {"p99", timing.blockTimes.percentile(0.99)},
+                               {"p999", timing.blockTimes.percentile(0.999)},
+                               {"maxDeadline", timing.blockTimes.maxRatio},
+                               {"missRate", timing.blockTimes.getMissRate()}};
+
+          if (perfCounters != nullptr)
+            addCounterColumns(row, timing.counters, timing.numSamples);
+
+          results.addRow(row);
+
+          for (int bucket = 0; bucket < BlockTimeHistogram::numBuckets; ++bucket) {
+            const auto count = timing.blockTimes.counts[static_cast<size_t>(bucket)];
+            if (count == 0)
+              continue;
+
+            const double upper = BlockTimeHistogram::getBucketUpperEdge(bucket);
+            histograms.addRow({{"stage", stage},
+                               {"sampleRate", sampleRate},
+                               {"blockSize", blockSize},
+                               {"voices", config.numVoices},
+                               {"bucketLow", BlockTimeHistogram::getBucketLowerEdge(bucket)},
+                               {"bucketHigh", std::isfinite(upper) ? upper : timing.blockTimes.maxRatio},
+                               {"count", static_cast<juce::int64>(count)}});
+          }
+        }
+      }
+    }
+  }
+
+  if (!results.write(args.getValueForOption("--output"), args.containsOption("--csv"))) {
+    std::cerr << "Failed to write results" << std::endl;
+    return 1;
+  }
+
+  if (args.containsOption("--histogram-output") &&
+      !histograms.write(args.getValueForOption("--histogram-output"), args.containsOption("--csv"))) {
+    std::cerr << "Failed to write histograms" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
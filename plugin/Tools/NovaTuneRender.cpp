@@ -0,0 +1,519 @@
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "OfflineRender.h"
+#include "PitchAnalysisCache.h"
+#include "PluginProcessor.h"
+#include "SegmentRender.h"
+#include "ToolUtilities.h"
+
+/**
+ * NovaTuneRender.cpp
+ *
+ * Headless batch render: run WAV/AIFF/FLAC files through NovaTune faster
+ * than real time, with the parameters of a saved state or preset, and
+ * write the tuned files - no DAW session needed.
+ *
+ * Each file is streamed through the processor a block at a time (see
+ * OfflineRender), so an hour-long podcast uses the same memory as a
+ * three-second stem. The reported latency is trimmed, so every output is
+ * sample-aligned with its input and the same length.
+ *
+ * Files are rendered concurrently: --jobs workers (default: one per CPU)
+ * each own a processor and pull the next file from a shared counter.
+ *
+ * With --split, files are instead rendered one at a time, each cut into
+ * segments that all the workers render in parallel (see SegmentRender) -
+ * for a few long files rather than many short ones. --verify then also
+ * renders each file sequentially and reports how far the two differ.
+ *
+ * Humanization is seeded (--seed), so renders are repeatable.
+ *
+ * With --pitch-cache, each file's audio is hashed first and its pitch
+ * track looked up (see PitchAnalysisCache): a hit replays the track
+ * instead of running the detector; a sequential render that misses
+ * records the track and files it for next time.
+ *
+ * USAGE:
+ *   NovaTuneRender FILE|DIR... [--state=FILE] [--output-dir=DIR]
+ *                  [--suffix=-tuned] [--format=wav|aiff|flac] [--jobs=N]
+ *                  [--block-size=1024] [--no-trim] [--seed=1]
+ *                  [--split] [--segment-seconds=60] [--warm-up-seconds=2]
+ *                  [--splice-tolerance-db=-40] [--verify]
+ *                  [--pitch-cache[=DIR]] [--pitch-cache-mb=1024]
+ *                  [--report=FILE] [--csv]
+ *
+ * Directories are searched (not recursively) for audio files. Outputs go
+ * next to each input unless --output-dir is given, named
+ * <input><suffix>.<format>, at the input's sample rate, channel count and
+ * (where the format allows) bit depth.
+ *
+ * EXIT CODE:
+ *   0 = every file rendered, 1 = any file failed
+ */
+
+using namespace NovaTuneTools;
+
+namespace {
+
+  //==========================================================================
+  // CONFIGURATION
+  //==========================================================================
+
+  struct RenderConfig {
+    juce::File outputDir; // Empty = next to each input
+    juce::String suffix = "-tuned";
+    juce::String format; // Empty = same as the input
+    int blockSize = 1024;
+    bool trimLatency = true;
+    bool split = false;
+    bool verify = false;
+    SegmentRender::Options segments; // Also carries the seed for sequential renders
+    const PitchAnalysisCache *pitchCache = nullptr; // --pitch-cache
+  };
+
+  struct FileResult {
+    juce::File input;
+    juce::File output;
+    bool ok = false;
+    juce::String error;
+    double seconds = 0.0; // Audio duration
+    double wallSeconds = 0.0;
+    int latencySamples = 0;
+
+    // --pitch-cache
+    juce::String pitchCache = "off"; // off, hit, miss or stored
+    double cacheSeconds = 0.0;       // Hashing and lookup (included in wallSeconds)
+
+    // --split
+    int numSegments = 1;
+    int splicesOverTolerance = 0;
+    float worstSpliceDb = -100.0f;
+
+    // --verify
+    bool verified = false;
+    float maxDifferenceDb = -100.0f;
+    float rmsDifferenceDb = -100.0f;
+  };
+
+  void printUsage() {
+    std::cout << "NovaTuneRender - render audio files through NovaTune offline\n\n"
+              << "  NovaTuneRender FILE|DIR... [options]\n\n"
+              << "  --state=FILE       Plugin state or .xml preset to render with (default: initial settings)\n"
+              << "  --output-dir=DIR   Write outputs here (default: next to each input)\n"
+              << "  --suffix=TEXT      Appended to output names (default -tuned)\n"
+              << "  --format=EXT       wav, aiff or flac (default: same as the input)\n"
+              << "  --jobs=N           Files rendered concurrently (default: CPU count)\n"
+              << "  --block-size=N     Samples per processBlock call (default 1024)\n"
+              << "  --no-trim          Keep the engine's latency at the start of the output\n"
+              << "  --seed=N           Humanization seed (default 1)\n"
+              << "  --split            Render each file in parallel segments (always latency-trimmed)\n"
+              << "  --segment-seconds=S  Target segment length for --split (default 60)\n"
+              << "  --warm-up-seconds=S  Rendered and discarded before each segment (default 2)\n"
+              << "  --splice-tolerance-db=DB  Report splices whose error exceeds this (default -40)\n"
+              << "  --verify           Also render sequentially and report the difference\n"
+              << "  --pitch-cache[=DIR]  Reuse pitch analysis of audio rendered before (default DIR: user app data)\n"
+              << "  --pitch-cache-mb=N Keep the pitch cache under N MB, least recently used out (default 1024)\n"
+              << "  --report=FILE      Write per-file results to FILE\n"
+              << "  --csv              Write the report as CSV instead of JSON\n";
+  }
+
+  //==========================================================================
+  // INPUTS
+  //==========================================================================
+
+  /** Expand the positional arguments into a list of audio files */
+  juce::Array<juce::File> collectInputs(const juce::ArgumentList &args, const RenderConfig &config) {
+    juce::Array<juce::File> files;
+
+    for (const auto &arg : args.arguments) {
+      if (arg.isOption())
+        continue;
+
+      const auto path = arg.resolveAsFile();
+
+      if (path.isDirectory()) {
+        auto found = path.findChildFiles(juce::File::findFiles, false, OfflineRender::fileWildcard);
+        found.sort();
+
+        // Don't pick up the outputs of an earlier run in the same folder
+        for (const auto &file : found)
+          if (config.suffix.isEmpty() || !file.getFileNameWithoutExtension().endsWith(config.suffix))
+            files.addIfNotAlreadyThere(file);
+      } else {
+        files.addIfNotAlreadyThere(path);
+      }
+    }
+
+    return files;
+  }
+
+  juce::File outputFileFor(const juce::File &input, const RenderConfig &config) {
+    const auto dir = config.outputDir == juce::File() ? input.getParentDirectory() : config.outputDir;
+    const auto extension = config.format.isEmpty() ? input.getFileExtension() : "." + config.format;
+    return dir.getChildFile(input.getFileNameWithoutExtension() + config.suffix + extension);
+  }
+
+  //==========================================================================
+  // PITCH CACHE
+  //==========================================================================
+
+  /** The cache key of `reader`'s audio for a render by `processor` (prepared for it) */
+  PitchTrack::Key pitchCacheKey(const NovaTuneAudioProcessor &processor, juce::AudioFormatReader &reader) {
+    constexpr int hashBlockSize = 65536;
+
+    juce::AudioBuffer<float> buffer(static_cast<int>(reader.numChannels), hashBlockSize);
+    PitchAnalysisCache::ContentHash hash;
+
+    for (juce::int64 start = 0; start < reader.lengthInSamples; start += hashBlockSize) {
+      const int numSamples = static_cast<int>(std::min<juce::int64>(hashBlockSize, reader.lengthInSamples - start));
+      reader.read(&buffer, 0, numSamples, start, true, true);
+      hash.addBlock(buffer, numSamples);
+    }
+
+    return PitchAnalysisCache::makeKey(hash, processor.getTunerEngine().getPitchDetector(),
+                                       processor.getEngineParameters().inputType);
+  }
+
+  //==========================================================================
+  // RENDERING
+  //==========================================================================
+
+  /**
+   * Render one file. Sequentially on the calling thread with the first
+   * processor, or with --split across all of them.
+   */
+  FileResult renderFile(const std::vector<NovaTuneAudioProcessor *> &processors, juce::AudioFormatManager &formats,
+                        const juce::File &input, const RenderConfig &config) {
+    FileResult result;
+    result.input = input;
+    result.output = outputFileFor(input, config);
+
+    if (result.output == input) {
+      result.error = "output would overwrite the input (use --suffix or --output-dir)";
+      return result;
+    }
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(input));
+
+    if (reader == nullptr) {
+      result.error = "not a readable audio file";
+      return result;
+    }
+
+    const int numChannels = static_cast<int>(reader->numChannels);
+
+    if (numChannels < 1 || numChannels > 2) {
+      result.error = juce::String(numChannels) + " channels (NovaTune is mono/stereo)";
+      return result;
+    }
+
+    auto writer = OfflineRender::createWriter(formats, result.output, reader->sampleRate, numChannels,
+                                              static_cast<int>(reader->bitsPerSample), result.error);
+
+    if (writer == nullptr)
+      return result;
+
+    auto &processor = *processors.front();
+    result.seconds = static_cast<double>(reader->lengthInSamples) / reader->sampleRate;
+
+    Stopwatch stopwatch;
+
+    // Pitch cache: replay a track of this audio, or record one. The key
+    // needs the detector as this render configures it, so prepare first.
+    PitchTrack::Key cacheKey{};
+    std::unique_ptr<MappedPitchTrack> cachedTrack;
+    PitchTrack recordedTrack;
+
+    if (config.pitchCache != nullptr) {
+      OfflineRender::prepareProcessor(processor, numChannels, reader->sampleRate, config.blockSize);
+      cacheKey = pitchCacheKey(processor, *reader);
+      processor.releaseResources();
+
+      cachedTrack = config.pitchCache->find(cacheKey);
+      result.pitchCache = cachedTrack != nullptr ? "hit" : "miss";
+      result.cacheSeconds = stopwatch.elapsedNs() / 1.0e9;
+
+      for (auto *p : processors)
+        p->setPitchTrack(cachedTrack.get());
+
+      // Sequential renders cover the file in order, so they can record it
+      if (cachedTrack == nullptr && !config.split)
+        processor.setPitchTrackRecorder(&recordedTrack);
+    }
+
+    if (config.split) {
+      // Every worker opens its own reader
+      auto openReader = [input] {
+        juce::AudioFormatManager workerFormats;
+        workerFormats.registerBasicFormats();
+        return std::unique_ptr<juce::AudioFormatReader>(workerFormats.createReaderFor(input));
+      };
+
+      const auto segmented = SegmentRender::render(processors, openReader, *writer, config.segments);
+
+      result.ok = segmented.ok;
+      result.error = segmented.error;
+      result.latencySamples = segmented.latencySamples;
+      result.numSegments = segmented.numSegments;
+
+      for (const auto &boundary : segmented.boundaries) {
+        result.worstSpliceDb = juce::jmax(result.worstSpliceDb, boundary.errorDb);
+        result.splicesOverTolerance += boundary.withinTolerance ? 0 : 1;
+      }
+    } else {
+      processor.setRandomSeed(config.segments.seed);
+      processor.setTimelineStart(0);
+      OfflineRender::prepareProcessor(processor, numChannels, reader->sampleRate, config.blockSize);
+      result.latencySamples = processor.getLatencySamples();
+
+      result.ok = OfflineRender::renderRange(processor, *reader, 0, reader->lengthInSamples, config.blockSize,
+                                             config.trimLatency,
+                                             [&](const juce::AudioBuffer<float> &buffer, int offset, int numSamples) {
+                                               return writer->writeFromAudioSampleBuffer(buffer, offset, numSamples);
+                                             });
+
+      processor.releaseResources();
+
+      if (!result.ok)
+        result.error = "write failed (disk full?)";
+    }
+
+    if (config.pitchCache != nullptr) {
+      for (auto *p : processors) {
+        p->setPitchTrack(nullptr);
+        p->setPitchTrackRecorder(nullptr);
+      }
+
+      if (result.ok && recordedTrack.isValid() && config.pitchCache->store(cacheKey, recordedTrack))
+        result.pitchCache = "stored";
+    }
+
+    // Flush the header/tail before timing stops
+    writer.reset();
+    result.wallSeconds = stopwatch.elapsedNs() / 1.0e9;
+
+    if (!result.ok) {
+      result.output.deleteFile();
+      return result;
+    }
+
+    if (config.verify) {
+      std::unique_ptr<juce::AudioFormatReader> rendered(formats.createReaderFor(result.output));
+
+      if (rendered != nullptr) {
+        const auto comparison = SegmentRender::compareWithSequential(processor, *reader, *rendered, config.segments);
+        result.verified = comparison.ok;
+        result.maxDifferenceDb = comparison.maxDifferenceDb;
+        result.rmsDifferenceDb = comparison.rmsDifferenceDb;
+      }
+    }
+
+    return result;
+  }
+
+} // namespace
+
+//==============================================================================
+// MAIN
+//==============================================================================
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  juce::ArgumentList args(argc, argv);
+
+  if (args.containsOption("--help|-h")) {
+    printUsage();
+    return 0;
+  }
+
+  RenderConfig config;
+  config.blockSize = juce::jlimit(32, 16384, static_cast<int>(parseNumber(args, "--block-size", 1024.0)));
+  config.trimLatency = !args.containsOption("--no-trim");
+  config.split = args.containsOption("--split");
+  config.verify = args.containsOption("--verify");
+
+  auto &segments = config.segments;
+  segments.blockSize = config.blockSize;
+  segments.seed = static_cast<juce::int64>(parseNumber(args, "--seed", 1.0));
+  segments.segmentSeconds = juce::jlimit(5.0, 600.0, parseNumber(args, "--segment-seconds", segments.segmentSeconds));
+  segments.warmUpSeconds = juce::jlimit(0.0, 30.0, parseNumber(args, "--warm-up-seconds", segments.warmUpSeconds));
+  segments.toleranceDb = static_cast<float>(parseNumber(args, "--splice-tolerance-db", segments.toleranceDb));
+
+  // Segments are spliced on the aligned signal
+  if (config.split)
+    config.trimLatency = true;
+
+  if (args.containsOption("--suffix"))
+    config.suffix = args.getValueForOption("--suffix");
+
+  if (args.containsOption("--format"))
+    config.format = args.getValueForOption("--format").trimCharactersAtStart(".").toLowerCase();
+
+  if (args.containsOption("--output-dir")) {
+    config.outputDir = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--output-dir"));
+
+    if (!config.outputDir.createDirectory()) {
+      std::cerr << "Could not create " << config.outputDir.getFullPathName() << std::endl;
+      return 1;
+    }
+  }
+
+  const auto inputs = collectInputs(args, config);
+
+  // Shared by every worker (it holds no state beyond the directory)
+  std::unique_ptr<PitchAnalysisCache> pitchCache;
+
+  if (args.containsOption("--pitch-cache")) {
+    const auto dir = args.getValueForOption("--pitch-cache");
+    pitchCache = std::make_unique<PitchAnalysisCache>(
+        dir.isEmpty() ? PitchAnalysisCache::getDefaultDirectory()
+                      : juce::File::getCurrentWorkingDirectory().getChildFile(dir));
+    config.pitchCache = pitchCache.get();
+  }
+
+  if (inputs.isEmpty()) {
+    printUsage();
+    return 1;
+  }
+
+  juce::MemoryBlock state;
+
+  if (args.containsOption("--state")) {
+    juce::String error;
+
+    if (!OfflineRender::loadStateFile(args.getFileForOption("--state"), state, error)) {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+  }
+
+  //==========================================================================
+  // WORKERS
+  //==========================================================================
+
+  // Processors are built (and their state set) here on the message thread;
+  // each worker then owns one for every file (or segment) it renders
+  const int requestedJobs = static_cast<int>(parseNumber(args, "--jobs", juce::SystemStats::getNumCpus()));
+  const int numJobs = juce::jlimit(1, config.split ? 256 : inputs.size(), requestedJobs);
+
+  std::vector<std::unique_ptr<NovaTuneAudioProcessor>> processors;
+  std::vector<NovaTuneAudioProcessor *> allProcessors;
+
+  for (int j = 0; j < numJobs; ++j) {
+    processors.push_back(std::make_unique<NovaTuneAudioProcessor>());
+    OfflineRender::applyState(*processors.back(), state);
+    allProcessors.push_back(processors.back().get());
+  }
+
+  std::vector<FileResult> results(static_cast<size_t>(inputs.size()));
+  std::atomic<int> nextFile{0};
+  std::mutex printLock;
+
+  // With --split there is one "worker" (this thread) that hands each file to all processors
+  auto worker = [&](const std::vector<NovaTuneAudioProcessor *> &workerProcessors) {
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    for (int i = nextFile.fetch_add(1); i < inputs.size(); i = nextFile.fetch_add(1)) {
+      auto result = renderFile(workerProcessors, formats, inputs[i], config);
+
+      {
+        const std::lock_guard<std::mutex> lock(printLock);
+
+        if (result.ok) {
+          std::cerr << result.input.getFileName() << " -> " << result.output.getFullPathName() << " ("
+                    << juce::String(result.seconds / juce::jmax(1.0e-9, result.wallSeconds), 1) << "x realtime";
+
+          if (config.pitchCache != nullptr)
+            std::cerr << ", pitch " << result.pitchCache << " (" << juce::String(result.cacheSeconds * 1000.0, 1)
+                      << " ms)";
+
+          if (config.split)
+            std::cerr << ", " << result.numSegments << " segments, worst splice "
+                      << juce::String(result.worstSpliceDb, 1) << " dB";
+
+          if (result.verified)
+            std::cerr << ", vs sequential max " << juce::String(result.maxDifferenceDb, 1) << " dBFS";
+
+          std::cerr << ")" << std::endl;
+
+          if (result.splicesOverTolerance > 0)
+            std::cerr << "  warning: " << result.splicesOverTolerance << " splice(s) above "
+                      << juce::String(config.segments.toleranceDb, 1) << " dB - try a longer --warm-up-seconds"
+                      << std::endl;
+        } else
+          std::cerr << result.input.getFileName() << ": " << result.error << std::endl;
+      }
+
+      results[static_cast<size_t>(i)] = std::move(result);
+    }
+  };
+
+  Stopwatch total;
+  std::vector<std::thread> threads;
+
+  if (config.split) {
+    worker(allProcessors);
+  } else {
+    for (int j = 1; j < numJobs; ++j)
+      threads.emplace_back(worker, std::vector<NovaTuneAudioProcessor *>{allProcessors[static_cast<size_t>(j)]});
+
+    worker({allProcessors.front()});
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+
+  const double totalSeconds = total.elapsedNs() / 1.0e9;
+
+  if (pitchCache != nullptr)
+    pitchCache->trim(static_cast<juce::int64>(parseNumber(args, "--pitch-cache-mb", 1024.0) * 1024.0 * 1024.0));
+
+  //==========================================================================
+  // REPORT
+  //==========================================================================
+
+  ResultTable report;
+  int failures = 0;
+  double audioSeconds = 0.0;
+
+  for (const auto &result : results) {
+    failures += result.ok ? 0 : 1;
+    audioSeconds += result.ok ? result.seconds : 0.0;
+
+    report.addRow({{"input", result.input.getFullPathName()},
+                   {"output", result.ok ? result.output.getFullPathName() : juce::String()},
+                   {"ok", result.ok},
+                   {"error", result.error},
+                   {"seconds", result.seconds},
+                   {"wallSeconds", result.wallSeconds},
+                   {"realtimeFactor", result.wallSeconds > 0.0 ? result.seconds / result.wallSeconds : 0.0},
+                   {"latencySamples", result.latencySamples},
+                   {"latencyTrimmed", result.ok && config.trimLatency},
+                   {"pitchCache", result.pitchCache},
+                   {"cacheSeconds", result.cacheSeconds},
+                   {"segments", result.numSegments},
+                   {"worstSpliceDb", result.worstSpliceDb},
+                   {"splicesOverTolerance", result.splicesOverTolerance},
+                   {"verified", result.verified},
+                   {"maxDifferenceDb", result.maxDifferenceDb},
+                   {"rmsDifferenceDb", result.rmsDifferenceDb}});
+  }
+
+  std::cerr << (inputs.size() - failures) << "/" << inputs.size() << " files, "
+            << juce::String(audioSeconds, 1) << " s of audio in " << juce::String(totalSeconds, 1) << " s on "
+            << numJobs << " jobs" << std::endl;
+
+  if (args.containsOption("--report") &&
+      !report.write(args.getValueForOption("--report"), args.containsOption("--csv"))) {
+    std::cerr << "Could not write the report" << std::endl;
+    return 1;
+  }
+
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+#include "OfflineRender.h"
+#include <algorithm>
+#include "StateFormat.h"
+
+/**
+ * OfflineRender.cpp
+ *
+ * Streaming file render and output-format helpers.
+ */
+
+namespace NovaTuneTools {
+  namespace OfflineRender {
+
+    //==========================================================================
+    // STATE
+    //==========================================================================
+
+    bool loadStateFile(const juce::File &file, juce::MemoryBlock &state, juce::String &error) {
+      if (!file.existsAsFile()) {
+        error = "State file not found: " + file.getFullPathName();
+        return false;
+      }
+
+      if (!file.loadFileAsData(state) || state.isEmpty()) {
+        error = "Could not read " + file.getFullPathName();
+        return false;
+      }
+
+      // Plain XML (a preset) is converted to the binary form hosts store
+      if (auto xml = juce::parseXML(state.toString())) {
+        state.reset();
+        juce::AudioProcessor::copyXmlToBinary(*xml, state);
+        return true;
+      }
+
+      if (!StateFormat::read(state.getData(), static_cast<int>(state.getSize())).isValid()) {
+        error = file.getFileName() + " is not a NovaTune state or preset file";
+        return false;
+      }
+
+      return true;
+    }
+
+    void applyState(NovaTuneAudioProcessor &processor, const juce::MemoryBlock &state) {
+      if (!state.isEmpty())
+        processor.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+    }
+
+    void prepareProcessor(NovaTuneAudioProcessor &processor, int numChannels, double sampleRate, int blockSize) {
+      processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+
+      // Offline: no deadline, so the CPU guard stays at full quality
+      processor.setNonRealtime(true);
+      processor.prepareToPlay(sampleRate, blockSize);
+    }
+
+    //==========================================================================
+    // RENDERING
+    //==========================================================================
+
+    bool renderRange(NovaTuneAudioProcessor &processor, juce::AudioFormatReader &reader,
+                     juce::int64 start, juce::int64 length, int blockSize, bool trimLatency,
+                     const OutputCallback &output) {
+      const int numChannels = processor.getTotalNumInputChannels();
+      const juce::int64 latency = trimLatency ? processor.getLatencySamples() : 0;
+
+      juce::AudioBuffer<float> buffer(numChannels, blockSize);
+      juce::MidiBuffer midi;
+
+      // Input is read for `length` samples, then silence flushes the
+      // latency out; output before `latency` is dropped
+      juce::int64 consumed = 0;
+      juce::int64 produced = 0;
+
+      while (produced < length + latency) {
+        // Every block is a full one: the engine takes a new block size for a
+        // host resize and re-prepares its shifters, so a short last block
+        // would come out of reset shifters. The padding's output is dropped.
+        const int numWanted = static_cast<int>(std::min<juce::int64>(blockSize, length + latency - produced));
+        const int numToRead = static_cast<int>(std::clamp<juce::int64>(length - consumed, 0, blockSize));
+
+        buffer.clear();
+
+        if (numToRead > 0)
+          reader.read(&buffer, 0, numToRead, start + consumed, true, true);
+
+        consumed += numToRead;
+        processor.processBlock(buffer, midi);
+
+        // Skip whatever part of this block is still inside the latency
+        const int skip = static_cast<int>(std::clamp<juce::int64>(latency - produced, 0, numWanted));
+        produced += numWanted;
+
+        if (skip < numWanted && !output(buffer, skip, numWanted - skip))
+          return false;
+      }
+
+      return true;
+    }
+
+    //==========================================================================
+    // OUTPUT FILES
+    //==========================================================================
+
+    std::unique_ptr<juce::AudioFormatWriter> createWriter(juce::AudioFormatManager &formats, const juce::File &file,
+                                                          double sampleRate, int numChannels, int preferredBits,
+                                                          juce::String &error) {
+      auto *format = formats.findFormatForFileExtension(file.getFileExtension());
+
+      if (format == nullptr || (numChannels == 1 && !format->canDoMono()) || (numChannels == 2 && !format->canDoStereo())) {
+        error = "Can't write " + file.getFileExtension() + " files with " + juce::String(numChannels) + " channels";
+        return nullptr;
+      }
+
+      // Keep the input's depth if the format can; otherwise the nearest one above (or the deepest)
+      const auto depths = format->getPossibleBitDepths();
+      int bits = depths.isEmpty() ? 16 : depths.getLast();
+
+      for (int depth : depths) {
+        if (depth >= preferredBits) {
+          bits = depth;
+          break;
+        }
+      }
+
+      file.deleteFile();
+      std::unique_ptr<juce::OutputStream> stream = file.createOutputStream();
+
+      if (stream == nullptr) {
+        error = "Could not create " + file.getFullPathName();
+        return nullptr;
+      }
+
+      // On success the writer takes the stream
+      auto writer = format->createWriterFor(stream, juce::AudioFormatWriterOptions{}
+                                                        .withSampleRate(sampleRate)
+                                                        .withNumChannels(numChannels)
+                                                        .withBitsPerSample(bits));
+
+      if (writer == nullptr) {
+        error = "Could not write " + file.getFileName() + " at " + juce::String(sampleRate) + " Hz";
+        return nullptr;
+      }
+
+      return writer;
+    }
+
+  } // namespace OfflineRender
+} // namespace NovaTuneTools
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <functional>
+#include <memory>
+#include "PluginProcessor.h"
+
+/**
+ * OfflineRender.h
+ *
+ * Faster-than-real-time rendering of audio files through a NovaTune
+ * processor, shared by the offline tools.
+ *
+ * Files are streamed: a range of the reader is pulled through the
+ * processor one block at a time, so memory stays bounded however long the
+ * file is. The processor runs in non-realtime mode (the CPU guard never
+ * degrades), and the engine's reported latency is trimmed - the first
+ * getLatencySamples() of output are dropped and the tail is flushed with
+ * silence - so the output lines up sample-for-sample with the input.
+ *
+ * ANALOGY: Like piping a file through a stream transform instead of
+ * loading it into memory - `cat in.wav | novatune > out.wav`.
+ */
+
+namespace NovaTuneTools {
+  namespace OfflineRender {
+
+    /** Extensions the render tools accept */
+    inline const juce::String fileWildcard = "*.wav;*.aif;*.aiff;*.flac";
+
+    //==========================================================================
+    // STATE
+    //==========================================================================
+
+    /**
+     * Read a parameter state file: either the plugin's binary state (as
+     * saved by a host / getStateInformation) or the XML form of it
+     * (a .xml preset). Returns false with an error if it is neither.
+     */
+    bool loadStateFile(const juce::File &file, juce::MemoryBlock &state, juce::String &error);
+
+    /**
+     * Apply a state loaded by loadStateFile(). Call on the message thread
+     * (parameter state is a ValueTree), before handing the processor to a
+     * render thread.
+     */
+    void applyState(NovaTuneAudioProcessor &processor, const juce::MemoryBlock &state);
+
+    /**
+     * Configure a processor for rendering one file: channel layout,
+     * non-realtime mode and prepareToPlay(). Call on the thread that will
+     * render, before renderRange().
+     */
+    void prepareProcessor(NovaTuneAudioProcessor &processor, int numChannels, double sampleRate, int blockSize);
+
+    //==========================================================================
+    // RENDERING
+    //==========================================================================
+
+    /**
+     * Receives rendered output: `numSamples` samples of `buffer` starting
+     * at `offset`. Return false to abort the render.
+     */
+    using OutputCallback = std::function<bool(const juce::AudioBuffer<float> &buffer, int offset, int numSamples)>;
+
+    /**
+     * Stream [start, start + length) of `reader` through a prepared
+     * processor, block by block. With trimLatency, output is shifted back
+     * by the processor's latency so exactly `length` aligned samples reach
+     * `output`; otherwise the raw (delayed) output is passed through.
+     * Every processBlock() call gets exactly `blockSize` samples: the last
+     * block is padded with silence and only the wanted part is output.
+     * Returns false if the output callback aborted.
+     */
+    bool renderRange(NovaTuneAudioProcessor &processor, juce::AudioFormatReader &reader,
+                     juce::int64 start, juce::int64 length, int blockSize, bool trimLatency,
+                     const OutputCallback &output);
+
+    //==========================================================================
+    // OUTPUT FILES
+    //==========================================================================
+
+    /**
+     * Create a writer for `file`, choosing the format from its extension
+     * and the nearest supported bit depth to `preferredBits`.
+     */
+    std::unique_ptr<juce::AudioFormatWriter> createWriter(juce::AudioFormatManager &formats, const juce::File &file,
+                                                          double sampleRate, int numChannels, int preferredBits,
+                                                          juce::String &error);
+
+  } // namespace OfflineRender
+} // namespace NovaTuneTools
@@ -0,0 +1,194 @@
+#include "PerfCounters.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * PerfCounters.cpp
+ *
+ * perf_event_open(2) wrapper. Everything is counted for the calling
+ * thread, on any CPU, user space only.
+ */
+
+namespace NovaTuneTools {
+
+  PerfCounters::Values &PerfCounters::Values::operator+=(const Values &other) noexcept {
+    for (size_t i = 0; i < counts.size(); ++i) {
+      counts[i] += other.counts[i];
+      available[i] = available[i] || other.available[i];
+    }
+
+    return *this;
+  }
+
+  const char *PerfCounters::getEventName(Event event) noexcept {
+    switch (event) {
+      case cycles:
+        return "cycles";
+      case instructions:
+        return "instructions";
+      case l1dMisses:
+        return "l1dMisses";
+      case llcMisses:
+        return "llcMisses";
+      case branchMisses:
+        return "branchMisses";
+      case numEvents:
+        break;
+    }
+
+    return "?";
+  }
+
+  PerfCounters::~PerfCounters() {
+    close();
+  }
+
+  void PerfCounters::begin() noexcept {
+    startValues = read();
+  }
+
+  void PerfCounters::end() noexcept {
+    const auto endValues = read();
+
+    for (size_t i = 0; i < lastDelta.counts.size(); ++i) {
+      lastDelta.available[i] = endValues.available[i];
+      lastDelta.counts[i] = endValues.counts[i] - startValues.counts[i];
+    }
+  }
+
+#if defined(__linux__)
+
+  //==========================================================================
+  // LINUX
+  //==========================================================================
+
+  namespace {
+
+    /** Read format: value, time enabled, time running (for multiplex scaling) */
+    struct ReadFormat {
+      uint64_t value;
+      uint64_t timeEnabled;
+      uint64_t timeRunning;
+    };
+
+    constexpr uint64_t cacheEvent(uint64_t cache, uint64_t op, uint64_t result) {
+      return cache | (op << 8) | (result << 16);
+    }
+
+    int openEvent(uint32_t type, uint64_t config) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = type;
+      attr.config = config;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      // pid 0 / cpu -1 = this thread, on whichever CPU it runs
+      return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+  } // namespace
+
+  bool PerfCounters::open() {
+    close();
+
+    const std::array<std::pair<uint32_t, uint64_t>, numEvents> events{{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+        {PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    }};
+
+    int lastErrno = 0;
+
+    for (size_t i = 0; i < events.size(); ++i) {
+      fds[i] = openEvent(events[i].first, events[i].second);
+
+      if (fds[i] < 0) {
+        lastErrno = errno;
+        continue;
+      }
+
+      ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+      ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+      ++numOpen;
+    }
+
+    if (numOpen == 0) {
+      error = std::string("perf_event_open failed: ") + std::strerror(lastErrno);
+
+      if (lastErrno == EACCES || lastErrno == EPERM)
+        error += " (check /proc/sys/kernel/perf_event_paranoid)";
+
+      return false;
+    }
+
+    error.clear();
+    return true;
+  }
+
+  void PerfCounters::close() {
+    for (auto &fd : fds) {
+      if (fd >= 0)
+        ::close(fd);
+
+      fd = -1;
+    }
+
+    numOpen = 0;
+  }
+
+  PerfCounters::Values PerfCounters::read() const noexcept {
+    Values values;
+
+    for (size_t i = 0; i < fds.size(); ++i) {
+      ReadFormat data{};
+
+      if (fds[i] < 0 || ::read(fds[i], &data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)))
+        continue;
+
+      // Scale up if the event only ran for part of the time it was enabled
+      const double scale = data.timeRunning > 0
+                               ? static_cast<double>(data.timeEnabled) / static_cast<double>(data.timeRunning)
+                               : 0.0;
+
+      values.counts[i] = static_cast<double>(data.value) * scale;
+      values.available[i] = data.timeRunning > 0;
+    }
+
+    return values;
+  }
+
+#else
+
+  //==========================================================================
+  // OTHER PLATFORMS
+  //==========================================================================
+
+  bool PerfCounters::open() {
+    error = "hardware counters need Linux perf_event_open";
+    return false;
+  }
+
+  void PerfCounters::close() {
+    numOpen = 0;
+  }
+
+  PerfCounters::Values PerfCounters::read() const noexcept {
+    return {};
+  }
+
+#endif
+
+} // namespace NovaTuneTools
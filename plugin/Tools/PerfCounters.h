@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+ * PerfCounters.h
+ *
+ * Hardware performance counters for the calling thread, via Linux
+ * perf_event_open(2).
+ *
+ * Timing says how long a stage took; counters say why. The engine copies
+ * frames between buffers, indexes rings with modulo arithmetic and runs a
+ * filter pass per formant band - work that is often memory-bound rather
+ * than compute-bound. IPC (instructions per cycle) and cache/branch miss
+ * counts per stage show where data-layout work would pay off.
+ *
+ * USAGE:
+ *   PerfCounters counters;
+ *   if (counters.open()) {
+ *     counters.begin();
+ *     stage.process(block);
+ *     counters.end();              // getLastDelta() = this call only
+ *   }
+ *
+ * Each event is opened separately, so a machine (or VM) that lacks e.g.
+ * the LLC event still reports the others. Counts are scaled if the kernel
+ * had to multiplex the counters.
+ *
+ * Linux only - on other platforms open() always fails. It also fails when
+ * /proc/sys/kernel/perf_event_paranoid forbids user-space counting
+ * (set it to 2 or lower, or run with CAP_PERFMON).
+ */
+
+namespace NovaTuneTools {
+
+  class PerfCounters {
+  public:
+    enum Event {
+      cycles = 0,
+      instructions,
+      l1dMisses,    // L1 data cache read misses
+      llcMisses,    // Last-level cache read misses
+      branchMisses,
+      numEvents
+    };
+
+    /** Counts for each event; unavailable events stay at 0 with available = false */
+    struct Values {
+      std::array<double, numEvents> counts{};
+      std::array<bool, numEvents> available{};
+
+      Values &operator+=(const Values &other) noexcept;
+    };
+
+    PerfCounters() = default;
+    ~PerfCounters();
+
+    /**
+     * Open the counters for the calling thread. Returns true if at least
+     * one event is available; otherwise getError() says why.
+     */
+    bool open();
+    void close();
+
+    bool isOpen() const noexcept { return numOpen > 0; }
+    const std::string &getError() const noexcept { return error; }
+
+    /** Snapshot the counters at the start of a measured region */
+    void begin() noexcept;
+
+    /** Snapshot again and store the difference (see getLastDelta) */
+    void end() noexcept;
+
+    /** Counts between the last begin()/end() pair */
+    const Values &getLastDelta() const noexcept { return lastDelta; }
+
+    /** Short column-friendly name, e.g. "l1dMisses" */
+    static const char *getEventName(Event event) noexcept;
+
+  private:
+    std::array<int, numEvents> fds{{-1, -1, -1, -1, -1}};
+    int numOpen = 0;
+    std::string error;
+
+    Values startValues;
+    Values lastDelta;
+
+    Values read() const noexcept;
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+  };
+
+} // namespace NovaTuneTools
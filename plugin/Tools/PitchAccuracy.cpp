@@ -0,0 +1,375 @@
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <cmath>
+#include "dsp/PitchDetector.h"
+#include "dsp/PitchShifter.h"
+#include "ToolUtilities.h"
+#include "VocalCorpus.h"
+
+/**
+ * PitchAccuracy.cpp
+ *
+ * Pitch-accuracy regression harness - the quality gate for faster
+ * detector or shifter engines.
+ *
+ * Runs every PitchDetector configuration (frame length x hop x YIN
+ * threshold) over the synthetic VocalCorpus and scores it against the
+ * known F0. Then runs the PitchShifter over the same takes at several
+ * shift amounts and measures the pitch of its *output* with a fixed,
+ * high-resolution reference detector.
+ *
+ * METRICS (per take, plus an "all" row per configuration):
+ *   voicingAccuracy - frames where voiced/unvoiced matches the truth
+ *   grossErrorRate  - voiced frames more than --gross-cents away from the truth
+ *   rmsCents        - RMS error of the remaining (fine) voiced frames
+ *   nsPerSample     - CPU cost of the stage under test
+ *
+ * The "all" rows are the accuracy-vs-CPU curve: `pareto` marks the
+ * configurations no other configuration beats on both cost and accuracy.
+ * The shift 0 row shows what the shifter does at unity ratio; run the
+ * detector at 46ms/16/0.10 to see the reference detector's own floor.
+ *
+ * USAGE:
+ *   PitchAccuracy [--sample-rate=44100] [--frame-ms=23,46,92]
+ *                 [--hop-divisors=4,8,16] [--thresholds=0.15]
+ *                 [--shifts=0,-12,-5,3,7,12] [--gross-cents=50]
+ *                 [--output=FILE] [--csv]
+ */
+
+using namespace NovaTuneTools;
+
+namespace {
+
+  //==========================================================================
+  // SCORING
+  //==========================================================================
+
+  struct AccuracyStats {
+    int frames = 0;
+    int voicingCorrect = 0;
+    int bothVoiced = 0;
+    int grossErrors = 0;
+    int fineFrames = 0;
+    double sumSquaredCents = 0.0;
+    double processNs = 0.0;
+    juce::int64 samples = 0;
+
+    void add(const AccuracyStats &other) {
+      frames += other.frames;
+      voicingCorrect += other.voicingCorrect;
+      bothVoiced += other.bothVoiced;
+      grossErrors += other.grossErrors;
+      fineFrames += other.fineFrames;
+      sumSquaredCents += other.sumSquaredCents;
+      processNs += other.processNs;
+      samples += other.samples;
+    }
+
+    double voicingAccuracy() const { return frames > 0 ? static_cast<double>(voicingCorrect) / frames : 0.0; }
+    double grossErrorRate() const { return bothVoiced > 0 ? static_cast<double>(grossErrors) / bothVoiced : 0.0; }
+    double rmsCents() const { return fineFrames > 0 ? std::sqrt(sumSquaredCents / fineFrames) : 0.0; }
+    double nsPerSample() const { return samples > 0 ? processNs / static_cast<double>(samples) : 0.0; }
+  };
+
+  /** Score one analysis frame against the truth */
+  void scoreFrame(AccuracyStats &stats, float truthHz, bool detectedVoiced, float detectedHz, double grossCents) {
+    const bool truthVoiced = truthHz > 0.0f;
+
+    ++stats.frames;
+    if (truthVoiced == detectedVoiced)
+      ++stats.voicingCorrect;
+
+    if (!truthVoiced || !detectedVoiced || detectedHz <= 0.0f)
+      return;
+
+    ++stats.bothVoiced;
+    const double cents = 1200.0 * std::log2(static_cast<double>(detectedHz) / truthHz);
+
+    if (std::abs(cents) > grossCents) {
+      ++stats.grossErrors;
+    } else {
+      ++stats.fineFrames;
+      stats.sumSquaredCents += cents * cents;
+    }
+  }
+
+  /**
+   * Truth at the sample the frame that ended at `frameEnd` describes:
+   * `analysisDelay` (the detector's getAnalysisDelaySamples()) before its
+   * end, plus `latency` samples for measuring a delayed output. Returns -1
+   * when that reaches before the start of the take.
+   */
+  float truthForFrame(const VocalTake &take, int frameEnd, int analysisDelay, int latency) {
+    const int position = frameEnd - analysisDelay - latency;
+    if (position < 0 || position >= static_cast<int>(take.truthHz.size()))
+      return -1.0f;
+    return take.truthHz[static_cast<size_t>(position)];
+  }
+
+  //==========================================================================
+  // DETECTOR
+  //==========================================================================
+
+  struct DetectorConfig {
+    double frameMs = 46.0;
+    int hopDivisor = 8;
+    float threshold = DSPConfig::yinThreshold;
+  };
+
+  void configure(PitchDetector &detector, const DetectorConfig &config, double sampleRate) {
+    detector.setFrameDuration(config.frameMs / 1000.0);
+    detector.prepare(sampleRate, 8192);
+    detector.setHopDivisor(config.hopDivisor);
+    detector.setThreshold(config.threshold);
+  }
+
+  /**
+   * Run a detector over a mono signal, one hop per block, so each block
+   * triggers exactly one analysis at its first sample. The callback gets
+   * the index of the sample the analysed frame ended on.
+   */
+  template <typename OnFrame>
+  double runDetector(PitchDetector &detector, const float *signal, int numSamples, OnFrame &&onFrame) {
+    const int hop = detector.getHopSize();
+    double ns = 0.0;
+
+    for (int start = 0; start < numSamples; start += hop) {
+      const int length = std::min(hop, numSamples - start);
+      float *channels[] = {const_cast<float *>(signal + start)};
+      const juce::AudioBuffer<float> block(channels, 1, length);
+
+      Stopwatch stopwatch;
+      stopwatch.start();
+      detector.process(block);
+      ns += stopwatch.elapsedNs();
+
+      onFrame(start);
+    }
+
+    return ns;
+  }
+
+  AccuracyStats evaluateDetector(const DetectorConfig &config, const VocalTake &take, double sampleRate, double grossCents) {
+    PitchDetector detector;
+    detector.setInputType(take.inputType);
+    configure(detector, config, sampleRate);
+
+    AccuracyStats stats;
+    const int analysisDelay = detector.getAnalysisDelaySamples();
+
+    stats.processNs = runDetector(detector, take.audio.getReadPointer(0), take.audio.getNumSamples(), [&](int frameEnd) {
+      const float truth = truthForFrame(take, frameEnd, analysisDelay, 0);
+      if (truth >= 0.0f)
+        scoreFrame(stats, truth, detector.isVoiced(), detector.getFrequencyHz(), grossCents);
+    });
+
+    stats.samples = take.audio.getNumSamples();
+    return stats;
+  }
+
+  //==========================================================================
+  // SHIFTER
+  //==========================================================================
+
+  /** Default frame, dense hops, strict threshold - slow but steady */
+  const DetectorConfig referenceConfig{46.0, 16, 0.10f};
+
+  AccuracyStats evaluateShifter(float semitones, const VocalTake &take, double sampleRate, double grossCents) {
+    constexpr int blockSize = 256;
+    const int numSamples = take.audio.getNumSamples();
+
+    PitchShifter shifter;
+    shifter.prepare(sampleRate, blockSize);
+    shifter.setPitchSemitones(semitones);
+    shifter.reset(); // Start at the target ratio rather than gliding to it
+
+    std::vector<float> shifted(static_cast<size_t>(numSamples));
+    AccuracyStats stats;
+
+    for (int start = 0; start < numSamples; start += blockSize) {
+      const int length = std::min(blockSize, numSamples - start);
+      Stopwatch stopwatch;
+      stopwatch.start();
+      shifter.process(take.audio.getReadPointer(0, start), shifted.data() + start, length);
+      stats.processNs += stopwatch.elapsedNs();
+    }
+
+    stats.samples = numSamples;
+
+    // Measure what actually came out. The shifted range can leave the
+    // take's voice type, so the reference searches the widest range.
+    PitchDetector reference;
+    reference.setInputType(NovaTuneEnums::InputType::Instrument);
+    configure(reference, referenceConfig, sampleRate);
+
+    const int analysisDelay = reference.getAnalysisDelaySamples();
+    const int latency = shifter.getLatencySamples();
+    const float ratio = NovaTuneUtils::semitonesToRatio(semitones);
+
+    runDetector(reference, shifted.data(), numSamples, [&](int frameEnd) {
+      const float truth = truthForFrame(take, frameEnd, analysisDelay, latency);
+      if (truth >= 0.0f)
+        scoreFrame(stats, truth * ratio, reference.isVoiced(), reference.getFrequencyHz(), grossCents);
+    });
+
+    return stats;
+  }
+
+  //==========================================================================
+  // OUTPUT
+  //==========================================================================
+
+  struct Row {
+    juce::String stage;
+    juce::String config;
+    juce::String take;
+    int frameSize = 0;
+    int hopSize = 0;
+    float threshold = 0.0f;
+    float shiftSemitones = 0.0f;
+    AccuracyStats stats;
+    bool pareto = false;
+  };
+
+  /**
+   * Mark aggregate rows that are not dominated: no other row of the same
+   * stage is at least as cheap, at least as accurate on GER and RMS, and
+   * strictly better on one of them.
+   */
+  void markParetoFront(std::vector<Row> &rows) {
+    for (auto &row : rows) {
+      if (row.take != "all")
+        continue;
+
+      row.pareto = std::none_of(rows.begin(), rows.end(), [&](const Row &other) {
+        if (&other == &row || other.take != "all" || other.stage != row.stage)
+          return false;
+
+        const auto &a = other.stats;
+        const auto &b = row.stats;
+        const bool noWorse = a.nsPerSample() <= b.nsPerSample() && a.grossErrorRate() <= b.grossErrorRate() && a.rmsCents() <= b.rmsCents();
+        const bool better = a.nsPerSample() < b.nsPerSample() || a.grossErrorRate() < b.grossErrorRate() || a.rmsCents() < b.rmsCents();
+        return noWorse && better;
+      });
+    }
+  }
+
+  void printUsage() {
+    std::cout << "PitchAccuracy - pitch detection / shifting quality vs CPU\n\n"
+              << "  --sample-rate=HZ        Sample rate (default 44100)\n"
+              << "  --frame-ms=LIST         Detector frame lengths in ms (default 23,46,92)\n"
+              << "  --hop-divisors=LIST     Hop = frame / divisor (default 4,8,16)\n"
+              << "  --thresholds=LIST       YIN thresholds (default 0.15)\n"
+              << "  --shifts=LIST           Shifter amounts in semitones (default 0,-12,-5,3,7,12)\n"
+              << "  --gross-cents=N         Gross error threshold in cents (default 50)\n"
+              << "  --output=FILE           Write results to FILE (default stdout)\n"
+              << "  --csv                   Write CSV instead of JSON\n";
+  }
+
+} // namespace
+
+//==============================================================================
+// MAIN
+//==============================================================================
+
+int main(int argc, char *argv[]) {
+  juce::ScopedNoDenormals noDenormals;
+  juce::ArgumentList args(argc, argv);
+
+  if (args.containsOption("--help|-h")) {
+    printUsage();
+    return 0;
+  }
+
+  const double sampleRate = parseNumber(args, "--sample-rate", 44100.0);
+  const double grossCents = parseNumber(args, "--gross-cents", 50.0);
+  const auto frameMs = parseList<double>(args, "--frame-ms", {23.0, 46.0, 92.0});
+  const auto hopDivisors = parseList<int>(args, "--hop-divisors", {4, 8, 16});
+  const auto thresholds = parseList<float>(args, "--thresholds", {DSPConfig::yinThreshold});
+  const auto shifts = parseList<float>(args, "--shifts", {0.0f, -12.0f, -5.0f, 3.0f, 7.0f, 12.0f});
+
+  const auto corpus = buildVocalCorpus(sampleRate);
+  std::vector<Row> rows;
+
+  //==========================================================================
+  // DETECTOR CONFIGURATIONS
+  //==========================================================================
+
+  for (double ms : frameMs) {
+    for (int divisor : hopDivisors) {
+      for (float threshold : thresholds) {
+        const DetectorConfig config{ms, juce::jmax(1, divisor), threshold};
+
+        PitchDetector probe;
+        configure(probe, config, sampleRate);
+
+        const auto label = juce::String(ms, 0) + "ms/" + juce::String(config.hopDivisor) + "/" + juce::String(threshold, 2);
+        Row all{"detector", label, "all", probe.getFrameSize(), probe.getHopSize(), threshold, 0.0f, {}};
+
+        for (const auto &take : corpus) {
+          Row row = all;
+          row.take = take.name;
+          row.stats = evaluateDetector(config, take, sampleRate, grossCents);
+          all.stats.add(row.stats);
+          rows.push_back(row);
+        }
+
+        rows.push_back(all);
+        std::cerr << "detector " << label << ": GER " << all.stats.grossErrorRate() * 100.0
+                  << "%, " << all.stats.rmsCents() << " cents RMS, " << all.stats.nsPerSample() << " ns/sample" << std::endl;
+      }
+    }
+  }
+
+  //==========================================================================
+  // SHIFTER OUTPUT
+  //==========================================================================
+
+  {
+    PitchDetector probe;
+    configure(probe, referenceConfig, sampleRate);
+
+    for (float shift : shifts) {
+      const auto label = juce::String(shift >= 0.0f ? "+" : "") + juce::String(shift, 1) + "st";
+      Row all{"shifter", label, "all", probe.getFrameSize(), probe.getHopSize(), referenceConfig.threshold, shift, {}};
+
+      for (const auto &take : corpus) {
+        Row row = all;
+        row.take = take.name;
+        row.stats = evaluateShifter(shift, take, sampleRate, grossCents);
+        all.stats.add(row.stats);
+        rows.push_back(row);
+      }
+
+      rows.push_back(all);
+      std::cerr << "shifter " << label << ": GER " << all.stats.grossErrorRate() * 100.0
+                << "%, " << all.stats.rmsCents() << " cents RMS" << std::endl;
+    }
+  }
+
+  markParetoFront(rows);
+
+  ResultTable results;
+  for (const auto &row : rows) {
+    results.addRow({{"stage", row.stage},
+                    {"config", row.config},
+                    {"take", row.take},
+                    {"frameSize", row.frameSize},
+                    {"hopSize", row.hopSize},
+                    {"threshold", row.threshold},
+                    {"shiftSemitones", row.shiftSemitones},
+                    {"frames", row.stats.frames},
+                    {"voicingAccuracy", row.stats.voicingAccuracy()},
+                    {"grossErrorRate", row.stats.grossErrorRate()},
+                    {"rmsCents", row.stats.rmsCents()},
+                    {"nsPerSample", row.stats.nsPerSample()},
+                    {"pareto", row.pareto}});
+  }
+
+  if (!results.write(args.getValueForOption("--output"), args.containsOption("--csv"))) {
+    std::cerr << "Failed to write results" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
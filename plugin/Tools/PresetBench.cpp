@@ -0,0 +1,199 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+#include <cstring>
+#include <iterator>
+#include "PluginProcessor.h"
+#include "PresetLibrary.h"
+#include "ToolUtilities.h"
+
+/**
+ * PresetBench.cpp
+ *
+ * Preset library scan and browse cost.
+ *
+ * Writes N presets (random parameters, spread over categories and tags)
+ * into a scratch library, then times:
+ *
+ *   cold    - the first scan, with no index (every preset is read)
+ *   warm    - a scan with nothing changed (directory listing only)
+ *   reopen  - a new library on the same index, as when a session opens
+ *   edited  - a scan after re-saving --edits presets (only those are read)
+ *   removed - a scan after deleting --edits presets
+ *   list    - reading every preset's name and category from the index
+ *   search  - a few queries, averaged
+ *
+ * COLUMNS:
+ *   presets     - presets in the index afterwards (matches, for search)
+ *   read        - preset files the scan opened
+ *   ms          - wall time of the phase
+ *   indexBytes  - size of the index file
+ *
+ * USAGE:
+ *   PresetBench [--presets=5000] [--edits=10] [--output=FILE] [--csv]
+ */
+
+using namespace NovaTuneTools;
+
+namespace {
+
+  const char *categories[] = {"Pop", "Rock", "Hip-Hop", "R&B", "Electronic", "Choir", "Robot", "Natural"};
+  const char *tagWords[] = {"bright", "dark", "wide", "tight", "airy", "hard", "soft", "stacked", "thirds", "fifths"};
+
+  juce::ValueTree randomState(NovaTuneAudioProcessor &processor, juce::Random &random) {
+    for (auto *parameter : processor.getParameters())
+      parameter->setValueNotifyingHost(random.nextFloat());
+
+    return processor.getValueTreeState().copyState();
+  }
+
+  void printUsage() {
+    std::cout << "PresetBench - preset library scan, index and search cost\n\n"
+              << "  --presets=N             Presets in the library (default 5000)\n"
+              << "  --edits=N               Presets changed / removed between scans (default 10)\n"
+              << "  --output=FILE           Write results to FILE (default stdout)\n"
+              << "  --csv                   Write CSV instead of JSON\n";
+  }
+
+} // namespace
+
+//==============================================================================
+// MAIN
+//==============================================================================
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  juce::ArgumentList args(argc, argv);
+
+  if (args.containsOption("--help|-h")) {
+    printUsage();
+    return 0;
+  }
+
+  const int numPresets = juce::jmax(1, static_cast<int>(parseNumber(args, "--presets", 5000)));
+  const int numEdits = juce::jlimit(0, numPresets, static_cast<int>(parseNumber(args, "--edits", 10)));
+
+  const auto root = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                        .getNonexistentChildFile("NovaTunePresetBench", {}, false);
+  const auto indexFile = root.getChildFile("PresetIndex.ntpi");
+  const std::vector<PresetLibrary::Directory> directories = {{root.getChildFile("Factory"), true},
+                                                             {root.getChildFile("User"), false}};
+
+  //==========================================================================
+  // LIBRARY
+  //==========================================================================
+
+  NovaTuneAudioProcessor processor;
+  juce::Random random(1234);
+  juce::Array<juce::File> files;
+
+  {
+    PresetLibrary writer(directories, indexFile);
+
+    for (int i = 0; i < numPresets; ++i) {
+      juce::StringArray tags;
+      tags.add(tagWords[random.nextInt(static_cast<int>(std::size(tagWords)))]);
+      tags.add(tagWords[random.nextInt(static_cast<int>(std::size(tagWords)))]);
+
+      files.add(writer.save("Preset " + juce::String(i), categories[i % static_cast<int>(std::size(categories))],
+                            tags.joinIntoString(","), randomState(processor, random)));
+    }
+  }
+
+  std::cerr << numPresets << " presets written to " << root.getFullPathName() << std::endl;
+
+  ResultTable table;
+  Stopwatch stopwatch;
+  bool ok = true;
+
+  auto addScan = [&](const char *phase, const PresetLibrary &library, const PresetLibrary::ScanResult &scan,
+                     int expected) {
+    const int listed = library.getIndex()->size();
+    ok = ok && listed == expected;
+
+    std::cerr << phase << ": " << scan.milliseconds << " ms, " << scan.numRead << " read, " << listed << " listed"
+              << (listed == expected ? "" : " - WRONG COUNT") << std::endl;
+
+    table.addRow({{"phase", phase},
+                  {"presets", listed},
+                  {"read", scan.numRead},
+                  {"ms", scan.milliseconds},
+                  {"indexBytes", indexFile.getSize()}});
+  };
+
+  //==========================================================================
+  // SCANS
+  //==========================================================================
+
+  {
+    PresetLibrary library(directories, indexFile);
+    addScan("cold", library, library.scan(), numPresets);
+    addScan("warm", library, library.scan(), numPresets);
+  }
+
+  PresetLibrary library(directories, indexFile);
+  addScan("reopen", library, library.scan(), numPresets);
+
+  for (int i = 0; i < numEdits; ++i) {
+    const auto file = files[i];
+    library.save(file.getFileNameWithoutExtension(), file.getParentDirectory().getFileName(), "edited",
+                 randomState(processor, random));
+
+    // Keep the modification time from landing on the one the index has
+    file.setLastModificationTime(juce::Time::getCurrentTime() + juce::RelativeTime::seconds(1));
+  }
+
+  addScan("edited", library, library.scan(), numPresets);
+
+  for (int i = 0; i < numEdits; ++i)
+    library.remove(files[files.size() - 1 - i]);
+
+  addScan("removed", library, library.scan(), numPresets - numEdits);
+
+  //==========================================================================
+  // BROWSING
+  //==========================================================================
+
+  const auto index = library.getIndex();
+  size_t characters = 0;
+
+  stopwatch.start();
+  for (int i = 0; i < index->size(); ++i) {
+    const auto preset = index->getPreset(i);
+    characters += std::strlen(preset.name) + std::strlen(preset.category);
+  }
+  const double listMs = stopwatch.elapsedNs() / 1.0e6;
+
+  table.addRow({{"phase", "list"},
+                {"presets", index->size()},
+                {"read", 0},
+                {"ms", listMs},
+                {"indexBytes", indexFile.getSize()}});
+  std::cerr << "list: " << listMs << " ms (" << characters << " characters)" << std::endl;
+
+  const char *queries[] = {"bright", "dark wide", "preset 42", "edited", "no such preset"};
+  constexpr int searchRepeats = 20;
+
+  for (const char *query : queries) {
+    size_t matches = 0;
+    stopwatch.start();
+
+    for (int r = 0; r < searchRepeats; ++r)
+      matches = index->search(query).size();
+
+    const double searchMs = stopwatch.elapsedNs() / 1.0e6 / searchRepeats;
+    std::cerr << "search \"" << query << "\": " << searchMs << " ms, " << matches << " matches" << std::endl;
+
+    table.addRow({{"phase", juce::String("search: ") + query},
+                  {"presets", static_cast<int>(matches)},
+                  {"read", 0},
+                  {"ms", searchMs},
+                  {"indexBytes", indexFile.getSize()}});
+  }
+
+  root.deleteRecursively();
+
+  if (!table.write(args.getValueForOption("--output"), args.containsOption("--csv")))
+    return 1;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,417 @@
+#include "RealtimeSafety.h"
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <new>
+#include <ostream>
+#include <poll.h>
+#include <pthread.h>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * RealtimeSafety.cpp
+ *
+ * Symbol interposition for the real-time safety checker.
+ *
+ * Because these definitions live in the executable, the dynamic linker
+ * resolves every malloc/free/pthread_mutex_lock/... in the process
+ * (including calls made from inside JUCE and libstdc++) to them first.
+ * Each hook records a violation if the calling thread is guarded, then
+ * forwards to the real implementation.
+ *
+ * RULES FOR CODE IN THIS FILE:
+ * - Nothing on the hook path may allocate or lock (it would recurse)
+ * - Violations are stored in a fixed-size table and symbolised later,
+ *   outside the guard, when printing the report
+ */
+
+// glibc's internal allocator entry points - always exported, and calling
+// them directly keeps our own hooks out of the way
+extern "C" {
+  void *__libc_malloc(size_t size) noexcept;
+  void *__libc_calloc(size_t count, size_t size) noexcept;
+  void *__libc_realloc(void *ptr, size_t size) noexcept;
+  void *__libc_memalign(size_t alignment, size_t size) noexcept;
+  void __libc_free(void *ptr) noexcept;
+}
+
+namespace NovaTuneTools {
+  namespace RealtimeSafety {
+
+    namespace {
+
+      //======================================================================
+      // STATE
+      //======================================================================
+
+      /** Unique sites kept; hits beyond that only show up in totalHits */
+      constexpr int maxViolations = 256;
+
+      /** Hook + recordViolation frames, not interesting in the report */
+      constexpr int framesToSkip = 2;
+
+      std::array<Violation, maxViolations> violations;
+      std::atomic<int> numViolations{0};
+      std::atomic<long long> totalHits{0};
+
+      /** Non-null while a ScopedGuard is alive on this thread */
+      thread_local const char *activeContext = nullptr;
+
+      /** Set while we are capturing, so the unwinder itself is never reported */
+      thread_local bool capturing = false;
+
+      bool sameStack(const Violation &v, const char *kind, void *const *frames, int numFrames) {
+        if (v.kind != kind || v.numFrames != numFrames)
+          return false;
+        return std::memcmp(v.frames, frames, sizeof(void *) * static_cast<size_t>(numFrames)) == 0;
+      }
+
+      /**
+       * Called from every hook. Cheap when the thread is not guarded.
+       */
+      __attribute__((noinline)) void recordViolation(const char *kind) {
+        if (activeContext == nullptr || capturing)
+          return;
+
+        capturing = true;
+        totalHits.fetch_add(1, std::memory_order_relaxed);
+
+        void *frames[maxStackFrames];
+        const int numFrames = backtrace(frames, maxStackFrames);
+        const int count = numViolations.load(std::memory_order_acquire);
+
+        bool found = false;
+        for (int i = 0; i < count && !found; ++i) {
+          auto &v = violations[static_cast<size_t>(i)];
+          if (sameStack(v, kind, frames, numFrames)) {
+            ++v.count;
+            found = true;
+          }
+        }
+
+        if (!found && count < maxViolations) {
+          auto &v = violations[static_cast<size_t>(count)];
+          v.kind = kind;
+          v.context = activeContext;
+          v.count = 1;
+          v.numFrames = numFrames;
+          std::memcpy(v.frames, frames, sizeof(void *) * static_cast<size_t>(numFrames));
+          numViolations.store(count + 1, std::memory_order_release);
+        }
+
+        capturing = false;
+      }
+
+      /**
+       * Look up the next definition of a symbol once and cache it.
+       * dlsym is only called the first time (or from warmUp()).
+       */
+      template <typename Fn>
+      Fn nextSymbol(std::atomic<void *> &cache, const char *name) {
+        void *fn = cache.load(std::memory_order_relaxed);
+        if (fn == nullptr) {
+          fn = dlsym(RTLD_NEXT, name);
+          cache.store(fn, std::memory_order_relaxed);
+        }
+        return reinterpret_cast<Fn>(fn);
+      }
+
+      std::atomic<void *> realMutexLock{nullptr};
+      std::atomic<void *> realCondWait{nullptr};
+      std::atomic<void *> realCondTimedWait{nullptr};
+      std::atomic<void *> realOpen{nullptr};
+      std::atomic<void *> realRead{nullptr};
+      std::atomic<void *> realWrite{nullptr};
+      std::atomic<void *> realClose{nullptr};
+      std::atomic<void *> realFsync{nullptr};
+      std::atomic<void *> realPoll{nullptr};
+      std::atomic<void *> realNanosleep{nullptr};
+      std::atomic<void *> realUsleep{nullptr};
+
+      /** Demangle the symbol part of a backtrace_symbols() line */
+      std::string demangleFrame(const char *line) {
+        std::string text(line);
+        const auto open = text.find('(');
+        const auto plus = text.find('+', open);
+
+        if (open == std::string::npos || plus == std::string::npos || plus == open + 1)
+          return text;
+
+        const auto mangled = text.substr(open + 1, plus - open - 1);
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+
+        if (status != 0 || demangled == nullptr)
+          return text;
+
+        std::string result = text.substr(0, open + 1) + demangled + text.substr(plus);
+        std::free(demangled);
+        return result;
+      }
+
+    } // namespace
+
+    //==========================================================================
+    // PUBLIC API
+    //==========================================================================
+
+    ScopedGuard::ScopedGuard(const char *context) noexcept
+        : previousContext(activeContext) {
+      activeContext = context != nullptr ? context : "guarded";
+    }
+
+    ScopedGuard::~ScopedGuard() noexcept {
+      activeContext = previousContext;
+    }
+
+    void warmUp() {
+      nextSymbol<void *>(realMutexLock, "pthread_mutex_lock");
+      nextSymbol<void *>(realCondWait, "pthread_cond_wait");
+      nextSymbol<void *>(realCondTimedWait, "pthread_cond_timedwait");
+      nextSymbol<void *>(realOpen, "open");
+      nextSymbol<void *>(realRead, "read");
+      nextSymbol<void *>(realWrite, "write");
+      nextSymbol<void *>(realClose, "close");
+      nextSymbol<void *>(realFsync, "fsync");
+      nextSymbol<void *>(realPoll, "poll");
+      nextSymbol<void *>(realNanosleep, "nanosleep");
+      nextSymbol<void *>(realUsleep, "usleep");
+
+      // The first backtrace() loads the unwinder, which allocates
+      void *frames[4];
+      backtrace(frames, 4);
+    }
+
+    int getNumViolations() noexcept {
+      return numViolations.load(std::memory_order_acquire);
+    }
+
+    long long getTotalHits() noexcept {
+      return totalHits.load(std::memory_order_relaxed);
+    }
+
+    const Violation &getViolation(int index) noexcept {
+      return violations[static_cast<size_t>(index)];
+    }
+
+    void clearViolations() noexcept {
+      numViolations.store(0, std::memory_order_release);
+      totalHits.store(0, std::memory_order_relaxed);
+    }
+
+    void printReport(std::ostream &out) {
+      const int count = getNumViolations();
+
+      for (int i = 0; i < count; ++i) {
+        const auto &v = getViolation(i);
+        out << "[" << (i + 1) << "] " << v.kind << " x" << v.count
+            << " during '" << v.context << "'\n";
+
+        char **symbols = backtrace_symbols(v.frames, v.numFrames);
+        for (int f = framesToSkip; f < v.numFrames; ++f)
+          out << "    #" << (f - framesToSkip) << "  "
+              << (symbols != nullptr ? demangleFrame(symbols[f]) : std::string("?")) << "\n";
+        std::free(symbols);
+
+        out << "\n";
+      }
+    }
+
+  } // namespace RealtimeSafety
+} // namespace NovaTuneTools
+
+//==============================================================================
+// INTERPOSED SYMBOLS
+//==============================================================================
+
+namespace rt = NovaTuneTools::RealtimeSafety;
+
+using rt::nextSymbol;
+using rt::recordViolation;
+
+extern "C" {
+
+  //==========================================================================
+  // C ALLOCATOR
+  //==========================================================================
+
+  void *malloc(size_t size) noexcept {
+    recordViolation("malloc");
+    return __libc_malloc(size);
+  }
+
+  void *calloc(size_t count, size_t size) noexcept {
+    recordViolation("calloc");
+    return __libc_calloc(count, size);
+  }
+
+  void *realloc(void *ptr, size_t size) noexcept {
+    recordViolation("realloc");
+    return __libc_realloc(ptr, size);
+  }
+
+  void free(void *ptr) noexcept {
+    if (ptr != nullptr)
+      recordViolation("free");
+    __libc_free(ptr);
+  }
+
+  void *memalign(size_t alignment, size_t size) noexcept {
+    recordViolation("memalign");
+    return __libc_memalign(alignment, size);
+  }
+
+  void *aligned_alloc(size_t alignment, size_t size) noexcept {
+    recordViolation("aligned_alloc");
+    return __libc_memalign(alignment, size);
+  }
+
+  int posix_memalign(void **result, size_t alignment, size_t size) noexcept {
+    recordViolation("posix_memalign");
+
+    if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+      return EINVAL;
+
+    *result = __libc_memalign(alignment, size);
+    return *result != nullptr ? 0 : ENOMEM;
+  }
+
+  //==========================================================================
+  // LOCKS
+  //==========================================================================
+
+  int pthread_mutex_lock(pthread_mutex_t *mutex) noexcept {
+    recordViolation("pthread_mutex_lock");
+    return nextSymbol<int (*)(pthread_mutex_t *)>(rt::realMutexLock,
+                                                  "pthread_mutex_lock")(mutex);
+  }
+
+  int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex) {
+    recordViolation("pthread_cond_wait");
+    return nextSymbol<int (*)(pthread_cond_t *, pthread_mutex_t *)>(rt::realCondWait,
+                                                                    "pthread_cond_wait")(cond, mutex);
+  }
+
+  int pthread_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *abstime) {
+    recordViolation("pthread_cond_timedwait");
+    return nextSymbol<int (*)(pthread_cond_t *, pthread_mutex_t *, const struct timespec *)>(
+        rt::realCondTimedWait, "pthread_cond_timedwait")(cond, mutex, abstime);
+  }
+
+  //==========================================================================
+  // BLOCKING SYSCALLS
+  //==========================================================================
+
+  int open(const char *path, int flags, ...) {
+    recordViolation("open");
+
+    mode_t mode = 0;
+    if ((flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE) {
+      va_list args;
+      va_start(args, flags);
+      mode = static_cast<mode_t>(va_arg(args, int));
+      va_end(args);
+    }
+
+    return nextSymbol<int (*)(const char *, int, ...)>(rt::realOpen, "open")(path, flags, mode);
+  }
+
+  ssize_t read(int fd, void *buf, size_t count) {
+    recordViolation("read");
+    return nextSymbol<ssize_t (*)(int, void *, size_t)>(rt::realRead, "read")(fd, buf, count);
+  }
+
+  ssize_t write(int fd, const void *buf, size_t count) {
+    recordViolation("write");
+    return nextSymbol<ssize_t (*)(int, const void *, size_t)>(rt::realWrite, "write")(fd, buf, count);
+  }
+
+  int close(int fd) {
+    recordViolation("close");
+    return nextSymbol<int (*)(int)>(rt::realClose, "close")(fd);
+  }
+
+  int fsync(int fd) {
+    recordViolation("fsync");
+    return nextSymbol<int (*)(int)>(rt::realFsync, "fsync")(fd);
+  }
+
+  int poll(struct pollfd *fds, nfds_t nfds, int timeout) {
+    recordViolation("poll");
+    return nextSymbol<int (*)(struct pollfd *, nfds_t, int)>(rt::realPoll, "poll")(fds, nfds, timeout);
+  }
+
+  int nanosleep(const struct timespec *duration, struct timespec *remaining) {
+    recordViolation("nanosleep");
+    return nextSymbol<int (*)(const struct timespec *, struct timespec *)>(
+        rt::realNanosleep, "nanosleep")(duration, remaining);
+  }
+
+  int usleep(useconds_t microseconds) {
+    recordViolation("usleep");
+    return nextSymbol<int (*)(useconds_t)>(rt::realUsleep, "usleep")(microseconds);
+  }
+
+} // extern "C"
+
+//==============================================================================
+// OPERATOR NEW / DELETE
+//==============================================================================
+
+namespace {
+  void *allocateOrThrow(const char *kind, std::size_t size) {
+    recordViolation(kind);
+    if (void *ptr = __libc_malloc(size > 0 ? size : 1))
+      return ptr;
+    throw std::bad_alloc();
+  }
+
+  void *allocateAlignedOrThrow(const char *kind, std::size_t size, std::align_val_t alignment) {
+    recordViolation(kind);
+    if (void *ptr = __libc_memalign(static_cast<std::size_t>(alignment), size > 0 ? size : 1))
+      return ptr;
+    throw std::bad_alloc();
+  }
+
+  void deallocate(const char *kind, void *ptr) noexcept {
+    if (ptr != nullptr)
+      recordViolation(kind);
+    __libc_free(ptr);
+  }
+} // namespace
+
+void *operator new(std::size_t size) { return allocateOrThrow("operator new", size); }
+void *operator new[](std::size_t size) { return allocateOrThrow("operator new[]", size); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow("operator new", size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow("operator new[]", size, alignment); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  recordViolation("operator new");
+  return __libc_malloc(size > 0 ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  recordViolation("operator new[]");
+  return __libc_malloc(size > 0 ? size : 1);
+}
+
+void operator delete(void *ptr) noexcept { deallocate("operator delete", ptr); }
+void operator delete[](void *ptr) noexcept { deallocate("operator delete[]", ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { deallocate("operator delete", ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { deallocate("operator delete[]", ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { deallocate("operator delete", ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { deallocate("operator delete[]", ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { deallocate("operator delete", ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { deallocate("operator delete[]", ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { deallocate("operator delete", ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { deallocate("operator delete[]", ptr); }
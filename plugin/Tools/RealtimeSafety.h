@@ -0,0 +1,80 @@
+#pragma once
+
+#include <iosfwd>
+
+/**
+ * RealtimeSafety.h
+ *
+ * Detects real-time safety violations on a guarded thread.
+ *
+ * RealtimeSafety.cpp interposes the C allocator, operator new/delete,
+ * pthread mutex/condition waits and a handful of blocking syscalls for the
+ * whole process. The hooks are free when no guard is active; while a
+ * ScopedGuard is alive on the calling thread, every hit is recorded with
+ * a stack trace so it can be reported after the block has finished.
+ *
+ * ANALOGY: Like a sanitizer that only switches on inside processBlock -
+ * the rest of the program (the message thread, parameter setup, file
+ * output) is allowed to allocate and lock as much as it likes.
+ *
+ * Linux/glibc only: the allocator hooks forward to glibc's __libc_* entry
+ * points and the other hooks use dlsym(RTLD_NEXT).
+ */
+
+namespace NovaTuneTools {
+  namespace RealtimeSafety {
+
+    /** Maximum stack depth captured per violation */
+    static constexpr int maxStackFrames = 32;
+
+    /**
+     * A unique violation site. Repeated hits from the same call stack
+     * only bump the count.
+     */
+    struct Violation {
+      const char *kind = nullptr;    // "malloc", "pthread_mutex_lock", "write", ...
+      const char *context = nullptr; // Label of the guard that was active
+      int count = 0;
+      int numFrames = 0;
+      void *frames[maxStackFrames] = {};
+    };
+
+    /**
+     * Marks the calling thread as real-time for its lifetime.
+     * Guards nest; the context label should be a string with static storage.
+     */
+    class ScopedGuard {
+    public:
+      explicit ScopedGuard(const char *context) noexcept;
+      ~ScopedGuard() noexcept;
+
+      ScopedGuard(const ScopedGuard &) = delete;
+      ScopedGuard &operator=(const ScopedGuard &) = delete;
+
+    private:
+      const char *previousContext;
+    };
+
+    /**
+     * Resolve the forwarded symbols and initialise the unwinder up front,
+     * so neither allocates the first time a violation is captured.
+     */
+    void warmUp();
+
+    /** Number of unique violation sites recorded so far */
+    int getNumViolations() noexcept;
+
+    /** Total number of hits across all sites (including dropped ones) */
+    long long getTotalHits() noexcept;
+
+    /** Access a recorded violation (0 <= index < getNumViolations()) */
+    const Violation &getViolation(int index) noexcept;
+
+    /** Forget everything recorded so far */
+    void clearViolations() noexcept;
+
+    /** Print every recorded violation with a symbolised stack trace */
+    void printReport(std::ostream &out);
+
+  } // namespace RealtimeSafety
+} // namespace NovaTuneTools
@@ -0,0 +1,233 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+#include <functional>
+#include "PluginProcessor.h"
+#include "RealtimeSafety.h"
+#include "SyntheticVocal.h"
+#include "ToolUtilities.h"
+
+/**
+ * RealtimeSafetyCheck.cpp
+ *
+ * Test-mode harness that checks the audio path is real-time safe.
+ *
+ * The TunerEngine promises "no locks, no memory allocation" on the audio
+ * thread. This tool holds it to that: every processBlock() call runs under
+ * a RealtimeSafety::ScopedGuard, and any allocation, mutex wait or blocking
+ * syscall made inside it is recorded with its call stack.
+ *
+ * A scripted session drives the processor the way a host would - parameter
+ * automation between blocks, harmony voices switching on and off, bypass
+ * toggles and changing host block sizes - so code paths that only run on a
+ * parameter change are exercised too.
+ *
+ * USAGE:
+ *   RealtimeSafetyCheck [--sample-rate=48000] [--block-size=512]
+ *
+ * EXIT CODE:
+ *   0 = no violations, 1 = violations found (report on stdout)
+ *
+ * Build with symbols (RelWithDebInfo) for readable stack traces.
+ */
+
+using namespace NovaTuneTools;
+
+namespace {
+
+  //==========================================================================
+  // SCRIPT
+  //==========================================================================
+
+  /**
+   * One section of the scripted session. automate() runs before every
+   * block (outside the guard, like host automation does) and gets the
+   * block index within the step.
+   */
+  struct ScriptStep {
+    const char *name;
+    int numBlocks;
+    int blockSize; // 0 = random host block sizes up to the prepared maximum
+    std::function<void(juce::AudioProcessorValueTreeState &, int)> automate;
+  };
+
+  /** Set a parameter from a normalised 0..1 value */
+  void automate(juce::AudioProcessorValueTreeState &apvts, const char *parameterId, float normalised) {
+    if (auto *param = apvts.getParameter(parameterId))
+      param->setValueNotifyingHost(juce::jlimit(0.0f, 1.0f, normalised));
+  }
+
+  /** Triangle ramp 0 -> 1 -> 0 over period blocks */
+  float ramp(int block, int period) {
+    const float phase = static_cast<float>(block % period) / static_cast<float>(period);
+    return phase < 0.5f ? phase * 2.0f : 2.0f - phase * 2.0f;
+  }
+
+  std::vector<ScriptStep> buildScript(int maxBlockSize) {
+    using namespace ParamIDs;
+
+    const char *levelIds[] = {A_level, B_level, C_level};
+    const char *panIds[] = {A_pan, B_pan, C_pan};
+    const char *formantIds[] = {A_formantShift, B_formantShift, C_formantShift};
+    const char *modeIds[] = {A_mode, B_mode, C_mode};
+    const char *diaIds[] = {A_intervalDiatonic, B_intervalDiatonic, C_intervalDiatonic};
+    const char *semiIds[] = {A_intervalSemi, B_intervalSemi, C_intervalSemi};
+    const char *humTimingIds[] = {A_humTiming, B_humTiming, C_humTiming};
+    const char *humPitchIds[] = {A_humPitch, B_humPitch, C_humPitch};
+
+    std::vector<ScriptStep> script;
+
+    script.push_back({"steady state", 48, maxBlockSize, [](auto &, int) {}});
+
+    script.push_back({"key and scale automation", 48, maxBlockSize, [](auto &apvts, int block) {
+      if (block % 8 == 0) {
+        automate(apvts, key, static_cast<float>((block / 8) % 12) / 11.0f);
+        automate(apvts, scale, static_cast<float>((block / 8) % 5) / 4.0f);
+      }
+    }});
+
+    script.push_back({"retune/humanize/vibrato sweeps", 64, maxBlockSize, [](auto &apvts, int block) {
+      automate(apvts, retuneSpeed, ramp(block, 32));
+      automate(apvts, humanize, ramp(block + 8, 32));
+      automate(apvts, vibratoAmount, ramp(block + 16, 32));
+    }});
+
+    script.push_back({"harmony voices on", 48, maxBlockSize, [=](auto &apvts, int block) {
+      if (block == 0)
+        setActiveHarmonyVoices(apvts, DSPConfig::maxHarmonyVoices);
+
+      for (int v = 0; v < DSPConfig::maxHarmonyVoices; ++v) {
+        automate(apvts, levelIds[v], ramp(block + v * 4, 24));
+        automate(apvts, panIds[v], ramp(block + v * 8, 16));
+        automate(apvts, humTimingIds[v], ramp(block, 20));
+        automate(apvts, humPitchIds[v], ramp(block + 4, 20));
+      }
+    }});
+
+    script.push_back({"harmony interval and mode changes", 64, maxBlockSize, [=](auto &apvts, int block) {
+      if (block % 4 != 0)
+        return;
+
+      for (int v = 0; v < DSPConfig::maxHarmonyVoices; ++v) {
+        automate(apvts, modeIds[v], (block / 16) % 2 == 0 ? 0.0f : 1.0f);
+        automate(apvts, diaIds[v], static_cast<float>((block / 4 + v * 3) % 15) / 14.0f);
+        automate(apvts, semiIds[v], ramp(block + v * 8, 32));
+      }
+    }});
+
+    script.push_back({"formant shift sweep", 48, maxBlockSize, [=](auto &apvts, int block) {
+      for (int v = 0; v < DSPConfig::maxHarmonyVoices; ++v)
+        automate(apvts, formantIds[v], ramp(block + v * 4, 16));
+    }});
+
+    script.push_back({"input type and quality mode", 32, maxBlockSize, [](auto &apvts, int block) {
+      if (block % 8 == 0) {
+        automate(apvts, inputType, static_cast<float>((block / 8) % 4) / 3.0f);
+        automate(apvts, qualityMode, (block / 8) % 2 == 0 ? 0.0f : 1.0f);
+      }
+    }});
+
+    script.push_back({"mix and bypass toggles", 48, maxBlockSize, [](auto &apvts, int block) {
+      automate(apvts, mix, ramp(block, 16));
+      automate(apvts, bypass, (block / 6) % 2 == 0 ? 0.0f : 1.0f);
+    }});
+
+    script.push_back({"smaller host block", 48, juce::jmax(1, maxBlockSize / 4), [](auto &apvts, int block) {
+      if (block == 0)
+        automate(apvts, bypass, 0.0f);
+    }});
+
+    script.push_back({"variable host block sizes", 96, 0, [](auto &, int) {}});
+
+    script.push_back({"harmony voices off", 32, maxBlockSize, [](auto &apvts, int block) {
+      if (block == 0)
+        setActiveHarmonyVoices(apvts, 0);
+    }});
+
+    return script;
+  }
+
+  void printUsage() {
+    std::cout << "RealtimeSafetyCheck - audio thread allocation/lock/syscall checker\n\n"
+              << "  --sample-rate=HZ   Sample rate (default 48000)\n"
+              << "  --block-size=N     Maximum host block size (default 512)\n";
+  }
+
+} // namespace
+
+//==============================================================================
+// MAIN
+//==============================================================================
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  juce::ArgumentList args(argc, argv);
+
+  if (args.containsOption("--help|-h")) {
+    printUsage();
+    return 0;
+  }
+
+  const double sampleRate = parseNumber(args, "--sample-rate", 48000.0);
+  const int maxBlockSize = juce::jmax(1, static_cast<int>(parseNumber(args, "--block-size", 512.0)));
+  const int numChannels = 2;
+
+  RealtimeSafety::warmUp();
+
+  NovaTuneAudioProcessor processor;
+  auto &apvts = processor.getValueTreeState();
+  processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, maxBlockSize);
+  processor.prepareToPlay(sampleRate, maxBlockSize);
+
+  SyntheticVocal vocal;
+  vocal.prepare(sampleRate);
+
+  juce::AudioBuffer<float> ioBuffer(numChannels, maxBlockSize);
+  juce::MidiBuffer midi;
+  juce::Random random(0x4e6f7661); // Fixed seed - the script is repeatable
+
+  double time = 0.0;
+  int totalBlocks = 0;
+
+  for (const auto &step : buildScript(maxBlockSize)) {
+    for (int block = 0; block < step.numBlocks; ++block) {
+      // Everything outside the guard is "host" work and may allocate freely
+      step.automate(apvts, block);
+
+      const int numSamples = step.blockSize > 0 ? step.blockSize : 1 + random.nextInt(maxBlockSize);
+
+      auto *left = ioBuffer.getWritePointer(0);
+      for (int i = 0; i < numSamples; ++i) {
+        const double midiNote = 57.3 + 3.0 * std::sin(0.7 * juce::MathConstants<double>::twoPi * time);
+        vocal.setFundamental(NovaTuneUtils::midiNoteToFrequency(static_cast<float>(midiNote)));
+        left[i] = vocal.nextSample();
+        time += 1.0 / sampleRate;
+      }
+      ioBuffer.copyFrom(1, 0, ioBuffer, 0, 0, numSamples);
+
+      // Refers to ioBuffer's memory - no allocation
+      juce::AudioBuffer<float> hostBlock(ioBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+      {
+        RealtimeSafety::ScopedGuard guard(step.name);
+        processor.processBlock(hostBlock, midi);
+      }
+
+      ++totalBlocks;
+    }
+  }
+
+  processor.releaseResources();
+
+  const int numSites = RealtimeSafety::getNumViolations();
+
+  if (numSites == 0) {
+    std::cout << "OK: " << totalBlocks << " blocks processed with no real-time violations" << std::endl;
+    return 0;
+  }
+
+  std::cout << "FAIL: " << RealtimeSafety::getTotalHits() << " real-time violations from "
+            << numSites << " call sites over " << totalBlocks << " blocks\n\n";
+  RealtimeSafety::printReport(std::cout);
+  std::cout.flush();
+  return 1;
+}
@@ -0,0 +1,344 @@
+#include "SegmentRender.h"
+#include "OfflineRender.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * SegmentRender.cpp
+ *
+ * Split planning, the worker/writer pipeline, splicing and verification.
+ */
+
+namespace NovaTuneTools {
+  namespace SegmentRender {
+
+    namespace {
+
+      juce::int64 toSamples(double seconds, double sampleRate) {
+        return static_cast<juce::int64>(std::llround(std::max(0.0, seconds) * sampleRate));
+      }
+
+      int getFadeLength(const Options &options, double sampleRate) {
+        return static_cast<int>(std::max<juce::int64>(1, toSamples(options.fadeMs / 1000.0, sampleRate)));
+      }
+
+      /** Start of the quietest `window`-sample stretch of [from, to) */
+      juce::int64 findQuietest(juce::AudioFormatReader &reader, juce::int64 from, juce::int64 to, int window) {
+        const int numSamples = static_cast<int>(to - from) + window;
+        juce::AudioBuffer<float> audio(static_cast<int>(reader.numChannels), numSamples);
+        reader.read(&audio, 0, numSamples, from, true, true);
+
+        // Running energy (all channels) over the window, one step at a time
+        auto energyAt = [&](int i) {
+          double sum = 0.0;
+          for (int ch = 0; ch < audio.getNumChannels(); ++ch)
+            sum += static_cast<double>(audio.getSample(ch, i)) * audio.getSample(ch, i);
+          return sum;
+        };
+
+        double energy = 0.0;
+        for (int i = 0; i < window; ++i)
+          energy += energyAt(i);
+
+        double quietestEnergy = energy;
+        int quietest = 0;
+
+        for (int start = 1; start + window <= numSamples; ++start) {
+          energy += energyAt(start + window - 1) - energyAt(start - 1);
+
+          if (energy < quietestEnergy) {
+            quietestEnergy = energy;
+            quietest = start;
+          }
+        }
+
+        return from + quietest;
+      }
+
+    } // namespace
+
+    //==========================================================================
+    // PLANNING
+    //==========================================================================
+
+    std::vector<juce::int64> planSegments(juce::AudioFormatReader &reader, const Options &options) {
+      const juce::int64 length = reader.lengthInSamples;
+      const juce::int64 segmentLength = std::max<juce::int64>(1, toSamples(options.segmentSeconds, reader.sampleRate));
+      const juce::int64 search = toSamples(options.searchSeconds, reader.sampleRate);
+      const int window = getFadeLength(options, reader.sampleRate);
+
+      std::vector<juce::int64> bounds{0};
+
+      // Leave at least half a segment after the last split
+      for (juce::int64 target = segmentLength; target + segmentLength / 2 < length;) {
+        const juce::int64 from = std::max(bounds.back() + window, target - search);
+        const juce::int64 to = std::min(length - window, target + search + 1);
+
+        if (from >= to)
+          break;
+
+        bounds.push_back(findQuietest(reader, from, to, window));
+        target = bounds.back() + segmentLength;
+      }
+
+      if (length > 0)
+        bounds.push_back(length);
+
+      return bounds;
+    }
+
+    //==========================================================================
+    // RENDERING
+    //==========================================================================
+
+    Result render(const std::vector<NovaTuneAudioProcessor *> &processors, const ReaderFactory &openReader,
+                  juce::AudioFormatWriter &writer, const Options &options) {
+      Result result;
+      auto planReader = openReader();
+
+      if (planReader == nullptr || processors.empty()) {
+        result.error = "could not open the input";
+        return result;
+      }
+
+      const double sampleRate = planReader->sampleRate;
+      const int numChannels = static_cast<int>(planReader->numChannels);
+      const juce::int64 length = planReader->lengthInSamples;
+      const juce::int64 warmUp = toSamples(options.warmUpSeconds, sampleRate);
+      const int fadeLength = getFadeLength(options, sampleRate);
+
+      const auto bounds = planSegments(*planReader, options);
+      planReader.reset();
+
+      const int numSegments = std::max(0, static_cast<int>(bounds.size()) - 1);
+      result.numSegments = numSegments;
+
+      //========================================================================
+      // SHARED STATE (guarded by `lock`)
+      //========================================================================
+
+      // Each finished segment holds [start, end + fade): its core plus the tail
+      // that is crossfaded into the next one
+      std::vector<std::unique_ptr<juce::AudioBuffer<float>>> finished(static_cast<size_t>(numSegments));
+      std::mutex lock;
+      std::condition_variable changed;
+      int nextSegment = 0;
+      int numWritten = 0;
+      bool failed = false;
+
+      // Backpressure: workers stay this many segments ahead of the writer at most
+      const int maxAhead = 2 * static_cast<int>(processors.size());
+
+      auto fail = [&](const juce::String &message) {
+        {
+          const std::lock_guard<std::mutex> guard(lock);
+          if (!failed)
+            result.error = message;
+          failed = true;
+        }
+        changed.notify_all();
+      };
+
+      //========================================================================
+      // WORKERS
+      //========================================================================
+
+      auto worker = [&](NovaTuneAudioProcessor &processor) {
+        auto reader = openReader();
+
+        if (reader == nullptr) {
+          fail("could not open the input");
+          return;
+        }
+
+        for (;;) {
+          int k = 0;
+
+          {
+            std::unique_lock<std::mutex> guard(lock);
+            changed.wait(guard, [&] { return failed || nextSegment >= numSegments || nextSegment < numWritten + maxAhead; });
+
+            if (failed || nextSegment >= numSegments)
+              return;
+
+            k = nextSegment++;
+          }
+
+          const juce::int64 start = bounds[static_cast<size_t>(k)];
+          const juce::int64 end = bounds[static_cast<size_t>(k) + 1];
+          const juce::int64 renderStart = std::max<juce::int64>(0, start - warmUp);
+          const juce::int64 renderEnd = k + 1 < numSegments ? std::min(length, end + fadeLength) : end;
+
+          auto audio = std::make_unique<juce::AudioBuffer<float>>(numChannels, static_cast<int>(renderEnd - start));
+
+          // Same seed everywhere; the timeline start keys humanization to file position
+          processor.setRandomSeed(options.seed);
+          processor.setTimelineStart(renderStart);
+          OfflineRender::prepareProcessor(processor, numChannels, sampleRate, options.blockSize);
+
+          juce::int64 position = renderStart;
+
+          // The range rarely ends on a block boundary; renderRange pads the
+          // last block rather than shortening it, which would re-prepare the
+          // shifters and send the splice tail out of reset ones
+          OfflineRender::renderRange(processor, *reader, renderStart, renderEnd - renderStart, options.blockSize, true,
+                                     [&](const juce::AudioBuffer<float> &buffer, int offset, int numSamples) {
+                                       // Warm-up output is dropped
+                                       const int skip = static_cast<int>(std::clamp<juce::int64>(start - position, 0, numSamples));
+
+                                       for (int ch = 0; ch < numChannels && skip < numSamples; ++ch)
+                                         audio->copyFrom(ch, static_cast<int>(position + skip - start), buffer, ch,
+                                                         offset + skip, numSamples - skip);
+
+                                       position += numSamples;
+                                       return true;
+                                     });
+
+          {
+            const std::lock_guard<std::mutex> guard(lock);
+            result.latencySamples = processor.getLatencySamples();
+            finished[static_cast<size_t>(k)] = std::move(audio);
+          }
+
+          processor.releaseResources();
+          changed.notify_all();
+        }
+      };
+
+      std::vector<std::thread> threads;
+      for (auto *processor : processors)
+        threads.emplace_back(worker, std::ref(*processor));
+
+      //========================================================================
+      // WRITER (this thread): splice and write segments in order
+      //========================================================================
+
+      for (int k = 0; k < numSegments; ++k) {
+        juce::AudioBuffer<float> *current = nullptr;
+        juce::AudioBuffer<float> *next = nullptr;
+
+        {
+          std::unique_lock<std::mutex> guard(lock);
+          changed.wait(guard, [&] {
+            return failed || (finished[static_cast<size_t>(k)] != nullptr &&
+                              (k + 1 == numSegments || finished[static_cast<size_t>(k) + 1] != nullptr));
+          });
+
+          if (failed)
+            break;
+
+          current = finished[static_cast<size_t>(k)].get();
+          next = k + 1 < numSegments ? finished[static_cast<size_t>(k) + 1].get() : nullptr;
+        }
+
+        const int coreLength = static_cast<int>(bounds[static_cast<size_t>(k) + 1] - bounds[static_cast<size_t>(k)]);
+
+        if (next != nullptr) {
+          // Both renders of the fade: measure how far apart they are, then
+          // crossfade this segment's tail into the next one's head
+          const int fade = std::min({fadeLength, current->getNumSamples() - coreLength, next->getNumSamples()});
+          double levelSum = 0.0;
+          double errorSum = 0.0;
+
+          for (int ch = 0; ch < numChannels; ++ch) {
+            const float *tail = current->getReadPointer(ch, coreLength);
+            float *head = next->getWritePointer(ch);
+
+            for (int i = 0; i < fade; ++i) {
+              const float difference = tail[i] - head[i];
+              levelSum += static_cast<double>(tail[i]) * tail[i];
+              errorSum += static_cast<double>(difference) * difference;
+
+              const float w = (static_cast<float>(i) + 0.5f) / static_cast<float>(fade);
+              head[i] = tail[i] + w * (head[i] - tail[i]);
+            }
+          }
+
+          const double count = std::max(1, fade * numChannels);
+          const float level = static_cast<float>(std::sqrt(levelSum / count));
+          const float error = static_cast<float>(std::sqrt(errorSum / count));
+
+          // Relative to the signal, floored at -60 dBFS so splices in silence aren't judged on noise
+          Boundary boundary;
+          boundary.position = bounds[static_cast<size_t>(k) + 1];
+          boundary.levelDb = juce::Decibels::gainToDecibels(level);
+          boundary.errorDb = juce::Decibels::gainToDecibels(error / std::max(level, 0.001f));
+          boundary.withinTolerance = boundary.errorDb <= options.toleranceDb;
+          result.boundaries.push_back(boundary);
+        }
+
+        if (!writer.writeFromAudioSampleBuffer(*current, 0, coreLength)) {
+          fail("write failed (disk full?)");
+          break;
+        }
+
+        {
+          const std::lock_guard<std::mutex> guard(lock);
+          finished[static_cast<size_t>(k)].reset();
+          numWritten = k + 1;
+        }
+
+        changed.notify_all();
+      }
+
+      for (auto &thread : threads)
+        thread.join();
+
+      result.ok = !failed;
+      return result;
+    }
+
+    //==========================================================================
+    // VERIFICATION
+    //==========================================================================
+
+    Comparison compareWithSequential(NovaTuneAudioProcessor &processor, juce::AudioFormatReader &input,
+                                     juce::AudioFormatReader &segmented, const Options &options) {
+      Comparison comparison;
+      const int numChannels = static_cast<int>(input.numChannels);
+
+      processor.setRandomSeed(options.seed);
+      processor.setTimelineStart(0);
+      OfflineRender::prepareProcessor(processor, numChannels, input.sampleRate, options.blockSize);
+
+      juce::AudioBuffer<float> rendered(numChannels, options.blockSize);
+      double errorSum = 0.0;
+      float maxError = 0.0f;
+      juce::int64 position = 0;
+      const juce::int64 length = std::min(input.lengthInSamples, segmented.lengthInSamples);
+
+      comparison.ok = OfflineRender::renderRange(
+          processor, input, 0, length, options.blockSize, true,
+          [&](const juce::AudioBuffer<float> &buffer, int offset, int numSamples) {
+            if (!segmented.read(&rendered, 0, numSamples, position, true, true))
+              return false;
+
+            for (int ch = 0; ch < numChannels; ++ch) {
+              const float *sequential = buffer.getReadPointer(ch, offset);
+              const float *split = rendered.getReadPointer(ch);
+
+              for (int i = 0; i < numSamples; ++i) {
+                const float difference = std::abs(sequential[i] - split[i]);
+                maxError = std::max(maxError, difference);
+                errorSum += static_cast<double>(difference) * difference;
+              }
+            }
+
+            position += numSamples;
+            return true;
+          });
+
+      processor.releaseResources();
+
+      comparison.numSamples = position;
+      comparison.maxDifferenceDb = juce::Decibels::gainToDecibels(maxError);
+      comparison.rmsDifferenceDb = juce::Decibels::gainToDecibels(
+          static_cast<float>(std::sqrt(errorSum / static_cast<double>(std::max<juce::int64>(1, position * numChannels)))));
+      return comparison;
+    }
+
+  } // namespace SegmentRender
+} // namespace NovaTuneTools
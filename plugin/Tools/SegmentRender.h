@@ -0,0 +1,106 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "PluginProcessor.h"
+
+/**
+ * SegmentRender.h
+ *
+ * Renders ONE long file on several cores.
+ *
+ * The engine is sequential (detector history, smoothing, shifter grains),
+ * so a file can't simply be cut up. Instead it is split into segments and
+ * each segment is rendered by its own processor, starting a warm-up
+ * region early so the engine's state has settled by the time it reaches
+ * the segment:
+ *
+ *   input    |----------------|----------------|----------------|
+ *   seg 0    [=======core=====]ff
+ *   seg 1            [warm-up][=======core=====]ff
+ *   seg 2                             [warm-up][=======core=====]
+ *
+ * Warm-up output is discarded. Each segment also renders a few ms past its
+ * end (ff); that tail is crossfaded into the next segment's head, and the
+ * difference between the two over the fade is measured - the splice
+ * error. Splits are moved to the quietest point near each fixed split, so
+ * most splices fall in breaths or gaps.
+ *
+ * Every processor is seeded with the same seed and told where its range
+ * starts on the file's timeline, so harmony humanization draws the same
+ * offsets as a single sequential pass (see HarmonyVoice::setRandomSeed).
+ *
+ * Segments are written in order as they complete, and workers stay at
+ * most a few segments ahead of the writer, so memory is bounded by the
+ * segment length, not the file length.
+ */
+
+namespace NovaTuneTools {
+  namespace SegmentRender {
+
+    struct Options {
+      double segmentSeconds = 60.0; // Target core length
+      double warmUpSeconds = 2.0;   // Rendered and discarded before each core
+      double searchSeconds = 1.0;   // Look this far either side of a fixed split for silence
+      double fadeMs = 10.0;         // Crossfade at each splice
+      int blockSize = 1024;
+      juce::int64 seed = 1;
+      float toleranceDb = -40.0f;   // Splice error above this is reported
+    };
+
+    /** One splice between consecutive segments */
+    struct Boundary {
+      juce::int64 position = 0;
+      float levelDb = -100.0f; // Output level over the fade
+      float errorDb = -100.0f; // RMS difference of the two renders over the fade, relative to the level
+      bool withinTolerance = true;
+    };
+
+    struct Result {
+      bool ok = false;
+      juce::String error;
+      int numSegments = 0;
+      int latencySamples = 0;
+      std::vector<Boundary> boundaries;
+    };
+
+    /** Opens a fresh reader on the input - each worker needs its own */
+    using ReaderFactory = std::function<std::unique_ptr<juce::AudioFormatReader>()>;
+
+    /**
+     * Segment boundaries for `reader`: 0, the split points, and the length.
+     * Each split is the quietest fade-length window within searchSeconds
+     * of a multiple of segmentSeconds.
+     */
+    std::vector<juce::int64> planSegments(juce::AudioFormatReader &reader, const Options &options);
+
+    /**
+     * Render the whole input through `processors` (one worker thread each)
+     * and write it to `writer`, latency-trimmed. The processors must have
+     * their state applied; they are prepared here for every segment.
+     */
+    Result render(const std::vector<NovaTuneAudioProcessor *> &processors, const ReaderFactory &openReader,
+                  juce::AudioFormatWriter &writer, const Options &options);
+
+    //==========================================================================
+    // VERIFICATION
+    //==========================================================================
+
+    struct Comparison {
+      bool ok = false;
+      juce::int64 numSamples = 0;
+      float maxDifferenceDb = -100.0f; // Peak |segmented - sequential|, dBFS
+      float rmsDifferenceDb = -100.0f; // RMS of the difference, dBFS
+    };
+
+    /**
+     * Render `input` sequentially (same seed, one processor) and compare it
+     * with a finished segmented render, streaming both.
+     */
+    Comparison compareWithSequential(NovaTuneAudioProcessor &processor, juce::AudioFormatReader &input,
+                                     juce::AudioFormatReader &segmented, const Options &options);
+
+  } // namespace SegmentRender
+} // namespace NovaTuneTools
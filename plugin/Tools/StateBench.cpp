@@ -0,0 +1,166 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+#include <memory>
+#include "PluginProcessor.h"
+#include "ToolUtilities.h"
+
+/**
+ * StateBench.cpp
+ *
+ * Session save / load cost: the binary state format against the legacy
+ * XML one.
+ *
+ * Creates N processors with randomised parameters (a session's worth of
+ * instances), then for each format times saving every instance's state
+ * and loading it into a second set of processors, and checks that every
+ * parameter came back exactly. The legacy format is produced the way
+ * getStateInformation used to (XML through copyXmlToBinary), and loads
+ * through the same setStateInformation, which still reads it.
+ *
+ * COLUMNS:
+ *   bytes           - state size of one instance
+ *   saveUs / loadUs - per instance, mean over the iterations
+ *   sessionSaveMs   - all N instances saved (an autosave)
+ *   sessionLoadMs   - all N instances loaded (opening the session)
+ *   roundTrip       - every parameter of every instance restored exactly
+ *
+ * USAGE:
+ *   StateBench [--instances=80] [--iterations=20] [--output=FILE] [--csv]
+ */
+
+using namespace NovaTuneTools;
+
+namespace {
+
+  using Processors = std::vector<std::unique_ptr<NovaTuneAudioProcessor>>;
+
+  Processors createProcessors(int count) {
+    Processors processors;
+
+    for (int i = 0; i < count; ++i)
+      processors.push_back(std::make_unique<NovaTuneAudioProcessor>());
+
+    return processors;
+  }
+
+  /** Every parameter somewhere in its range (automation-like, not just defaults) */
+  void randomise(NovaTuneAudioProcessor &processor, juce::Random &random) {
+    // Snapped to each range, as a host's automation lands: a bool or choice
+    // holds the unsnapped value it was given, but its state stores the snapped one
+    for (auto *parameter : processor.getParameters())
+      if (auto *ranged = dynamic_cast<juce::RangedAudioParameter *>(parameter))
+        ranged->setValueNotifyingHost(ranged->convertTo0to1(ranged->convertFrom0to1(random.nextFloat())));
+  }
+
+  bool sameParameters(NovaTuneAudioProcessor &a, NovaTuneAudioProcessor &b) {
+    const auto &x = a.getParameters();
+    const auto &y = b.getParameters();
+
+    for (int i = 0; i < x.size(); ++i)
+      if (!juce::exactlyEqual(x[i]->getValue(), y[i]->getValue()))
+        return false;
+
+    return true;
+  }
+
+  enum class Format { binary, legacyXml };
+
+  void save(NovaTuneAudioProcessor &processor, Format format, juce::MemoryBlock &dest) {
+    if (format == Format::binary) {
+      processor.getStateInformation(dest);
+      return;
+    }
+
+    if (auto xml = processor.getValueTreeState().copyState().createXml())
+      juce::AudioProcessor::copyXmlToBinary(*xml, dest);
+  }
+
+  void printUsage() {
+    std::cout << "StateBench - session save/load time, binary vs legacy XML state\n\n"
+              << "  --instances=N           Processors in the session (default 80)\n"
+              << "  --iterations=N          Save/load passes to average (default 20)\n"
+              << "  --output=FILE           Write results to FILE (default stdout)\n"
+              << "  --csv                   Write CSV instead of JSON\n";
+  }
+
+} // namespace
+
+//==============================================================================
+// MAIN
+//==============================================================================
+
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  juce::ArgumentList args(argc, argv);
+
+  if (args.containsOption("--help|-h")) {
+    printUsage();
+    return 0;
+  }
+
+  const int numInstances = juce::jmax(1, static_cast<int>(parseNumber(args, "--instances", 80)));
+  const int iterations = juce::jmax(1, static_cast<int>(parseNumber(args, "--iterations", 20)));
+
+  auto sources = createProcessors(numInstances);
+  auto targets = createProcessors(numInstances);
+
+  juce::Random random(1234);
+  for (auto &processor : sources)
+    randomise(*processor, random);
+
+  std::vector<juce::MemoryBlock> states(static_cast<size_t>(numInstances));
+  ResultTable table;
+  bool allRestored = true;
+
+  for (auto format : {Format::binary, Format::legacyXml}) {
+    const char *name = format == Format::binary ? "binary" : "legacyXml";
+    double saveNs = 0.0, loadNs = 0.0;
+    bool roundTrip = true;
+
+    for (int pass = 0; pass < iterations; ++pass) {
+      Stopwatch stopwatch;
+
+      for (int i = 0; i < numInstances; ++i)
+        save(*sources[static_cast<size_t>(i)], format, states[static_cast<size_t>(i)]);
+
+      saveNs += stopwatch.elapsedNs();
+      stopwatch.start();
+
+      for (int i = 0; i < numInstances; ++i) {
+        const auto &state = states[static_cast<size_t>(i)];
+        targets[static_cast<size_t>(i)]->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+      }
+
+      loadNs += stopwatch.elapsedNs();
+
+      // Scramble the targets so the next pass really loads something
+      for (size_t i = 0; i < targets.size(); ++i) {
+        roundTrip = roundTrip && sameParameters(*sources[i], *targets[i]);
+        randomise(*targets[i], random);
+      }
+    }
+
+    const double passes = static_cast<double>(iterations);
+    const double sessionSaveMs = saveNs / passes / 1.0e6;
+    const double sessionLoadMs = loadNs / passes / 1.0e6;
+
+    std::cerr << name << ": " << states.front().getSize() << " bytes, session save " << sessionSaveMs
+              << " ms, load " << sessionLoadMs << " ms" << (roundTrip ? "" : " - ROUND TRIP FAILED") << std::endl;
+
+    table.addRow({{"format", name},
+                  {"instances", numInstances},
+                  {"bytes", static_cast<int>(states.front().getSize())},
+                  {"saveUs", sessionSaveMs * 1000.0 / numInstances},
+                  {"loadUs", sessionLoadMs * 1000.0 / numInstances},
+                  {"sessionSaveMs", sessionSaveMs},
+                  {"sessionLoadMs", sessionLoadMs},
+                  {"roundTrip", roundTrip}});
+
+    allRestored = allRestored && roundTrip;
+  }
+
+  if (!table.write(args.getValueForOption("--output"), args.containsOption("--csv")))
+    return 1;
+
+  return allRestored ? 0 : 1;
+}
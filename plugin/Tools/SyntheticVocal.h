@@ -0,0 +1,163 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+#include <array>
+#include <cmath>
+#include "DSPConfig.h"
+
+/**
+ * SyntheticVocal.h
+ *
+ * A tiny source-filter voice model used by the headless tools.
+ *
+ * We need repeatable "vocal-like" material for benchmarks and stress runs:
+ * pure sines are too easy for the pitch detector and white noise never
+ * becomes voiced, so neither exercises the real code paths.
+ *
+ * MODEL:
+ * - Source: a Rosenberg-style glottal pulse train at the fundamental,
+ *   plus optional aspiration ("breath") noise
+ * - Filter: three two-pole resonators at typical "AH" formant positions
+ *
+ * The pulse train can be switched off (setVoiced(false)) with a short fade,
+ * leaving only breath noise - an unvoiced gap between phrases.
+ *
+ * The generator is deterministic - the same settings always render the
+ * same samples (the noise is seeded in reset()), so results are comparable
+ * between runs.
+ */
+
+namespace NovaTuneTools {
+
+  class SyntheticVocal {
+  public:
+    SyntheticVocal() = default;
+
+    /**
+     * Prepare for rendering at the given sample rate.
+     * Resets the oscillator and the resonator state.
+     */
+    void prepare(double newSampleRate) {
+      sampleRate = newSampleRate;
+      voicingStep = static_cast<float>(1.0 / (voicingFadeSeconds * sampleRate));
+      updateResonators();
+      reset();
+    }
+
+    /** Reset oscillator phase and filter memory */
+    void reset() {
+      phase = 0.0;
+      voicingGain = voiced ? 1.0f : 0.0f;
+      noise.setSeed(noiseSeed);
+      for (auto &r : resonators) {
+        r.z1 = 0.0f;
+        r.z2 = 0.0f;
+      }
+    }
+
+    /** Set the fundamental frequency in Hz */
+    void setFundamental(float frequencyHz) { fundamentalHz = frequencyHz; }
+
+    /** Set the output level (linear gain) */
+    void setLevel(float newLevel) { level = newLevel; }
+
+    /** Aspiration noise level relative to the glottal pulse (0 = none) */
+    void setBreathNoise(float newLevel) { breathLevel = newLevel; }
+
+    /** Switch the glottal pulses on/off (fades over ~10ms, breath noise continues) */
+    void setVoiced(bool shouldBeVoiced) { voiced = shouldBeVoiced; }
+
+    /**
+     * Render the next sample.
+     */
+    float nextSample() {
+      // Glottal source: rising half-cosine over the open phase, fast closure
+      const double openQuotient = 0.6;
+      float source = 0.0f;
+
+      if (phase < openQuotient) {
+        const double t = phase / openQuotient;
+        source = static_cast<float>(0.5 * (1.0 - std::cos(juce::MathConstants<double>::pi * t)));
+      } else if (phase < openQuotient + 0.1) {
+        const double t = (phase - openQuotient) / 0.1;
+        source = static_cast<float>(std::cos(juce::MathConstants<double>::halfPi * t));
+      }
+
+      phase += static_cast<double>(fundamentalHz) / sampleRate;
+      if (phase >= 1.0)
+        phase -= std::floor(phase);
+
+      // Fade the pulses in/out so voicing changes don't click
+      if (voiced)
+        voicingGain = std::min(1.0f, voicingGain + voicingStep);
+      else
+        voicingGain = std::max(0.0f, voicingGain - voicingStep);
+
+      source *= voicingGain;
+
+      if (breathLevel > 0.0f)
+        source += breathLevel * (noise.nextFloat() * 2.0f - 1.0f);
+
+      // Vocal tract: sum of parallel formant resonators
+      float out = 0.0f;
+      for (auto &r : resonators) {
+        const float y = r.b0 * source - r.a1 * r.z1 - r.a2 * r.z2;
+        r.z2 = r.z1;
+        r.z1 = y;
+        out += y * r.gain;
+      }
+
+      return out * level;
+    }
+
+    /**
+     * Render a block of samples.
+     */
+    void render(float *dest, int numSamples) {
+      for (int i = 0; i < numSamples; ++i)
+        dest[i] = nextSample();
+    }
+
+  private:
+    struct Resonator {
+      float frequencyHz = 0.0f;
+      float bandwidthHz = 0.0f;
+      float gain = 1.0f;
+      float b0 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+      float z1 = 0.0f, z2 = 0.0f;
+    };
+
+    double sampleRate = 44100.0;
+    double phase = 0.0;
+    float fundamentalHz = DSPConfig::concertPitchHz / 2.0f;
+    float level = 0.25f;
+    float breathLevel = 0.0f;
+
+    bool voiced = true;
+    float voicingGain = 1.0f;
+    float voicingStep = 0.002f;
+    static constexpr double voicingFadeSeconds = 0.01;
+
+    static constexpr juce::int64 noiseSeed = 0x62726561; // Any fixed value
+    juce::Random noise{noiseSeed};
+
+    // F1-F3 for an open "AH" vowel
+    std::array<Resonator, 3> resonators{{{730.0f, 90.0f, 1.0f},
+                                         {1090.0f, 110.0f, 0.5f},
+                                         {2440.0f, 170.0f, 0.25f}}};
+
+    void updateResonators() {
+      for (auto &r : resonators) {
+        const double freq = std::min(static_cast<double>(r.frequencyHz), sampleRate * 0.45);
+        const double radius = std::exp(-juce::MathConstants<double>::pi * r.bandwidthHz / sampleRate);
+        const double theta = juce::MathConstants<double>::twoPi * freq / sampleRate;
+
+        r.a1 = static_cast<float>(-2.0 * radius * std::cos(theta));
+        r.a2 = static_cast<float>(radius * radius);
+        r.b0 = static_cast<float>(1.0 - radius); // Roughly normalises the peak gain
+      }
+    }
+  };
+
+} // namespace NovaTuneTools
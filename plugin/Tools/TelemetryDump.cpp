@@ -0,0 +1,113 @@
+#include <juce_core/juce_core.h>
+#include "TelemetryRecorder.h"
+#include "ToolUtilities.h"
+
+/**
+ * TelemetryDump.cpp
+ *
+ * Reader/converter for the .nttl files written by TelemetryRecorder (the
+ * editor's "Log" button).
+ *
+ * Writes one row per recorded block as CSV or JSON - ready for a
+ * spreadsheet or a plotting script - and prints a summary to stderr:
+ * duration, dropped frames, block-size changes and the slowest block.
+ *
+ * USAGE:
+ *   TelemetryDump FILE.nttl [--output=FILE] [--csv]
+ *
+ * EXIT CODE:
+ *   0 = converted, 1 = unreadable file
+ */
+
+using namespace NovaTuneTools;
+
+namespace {
+
+  void printUsage() {
+    std::cout << "TelemetryDump - convert NovaTune telemetry (.nttl) to CSV/JSON\n\n"
+              << "  TelemetryDump FILE.nttl [--output=FILE] [--csv]\n";
+  }
+
+} // namespace
+
+//==============================================================================
+// MAIN
+//==============================================================================
+
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+
+  if (args.containsOption("--help|-h") || args.size() == 0 || args[0].isOption()) {
+    printUsage();
+    return args.containsOption("--help|-h") ? 0 : 1;
+  }
+
+  const auto file = args[0].resolveAsFile();
+
+  std::vector<TelemetryFrame> frames;
+  juce::String error;
+
+  if (!TelemetryRecorder::readFile(file, frames, error)) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+
+  ResultTable table;
+
+  uint64_t dropped = 0;
+  int blockSizeChanges = 0;
+  int degradedBlocks = 0;
+  float slowestBlockMicros = 0.0f;
+  double slowestBlockSeconds = 0.0;
+  double durationSeconds = 0.0;
+
+  for (const auto &frame : frames) {
+    const double seconds = frame.sampleRate > 0.0f ? static_cast<double>(frame.samplePosition) / frame.sampleRate : 0.0;
+    const double budgetMicros = frame.sampleRate > 0.0f ? 1.0e6 * frame.blockSize / frame.sampleRate : 0.0;
+
+    ResultTable::Row row{{"seconds", seconds},
+                         {"blockSize", static_cast<int>(frame.blockSize)},
+                         {"voiced", (frame.flags & TelemetryFrame::voiced) != 0},
+                         {"blockSizeChanged", (frame.flags & TelemetryFrame::blockSizeChanged) != 0},
+                         {"guardLevel", frame.getGuardLevel()},
+                         {"droppedBefore", static_cast<int>(frame.droppedBefore)},
+                         {"detectedHz", frame.detectedHz},
+                         {"confidence", frame.confidence},
+                         {"targetMidiNote", frame.targetMidiNote},
+                         {"leadRatio", frame.leadRatio}};
+
+    for (int v = 0; v < DSPConfig::maxHarmonyVoices; ++v)
+      row.emplace_back("voice" + juce::String::charToString(static_cast<juce::juce_wchar>('A' + v)) + "Ratio",
+                       frame.voiceRatios[v]);
+
+    for (int s = 0; s < StageProfiler::numStages; ++s)
+      row.emplace_back(juce::String(StageProfiler::getStageName(static_cast<StageProfiler::Stage>(s))).removeCharacters(" ") + "Us",
+                       frame.stageMicros[s]);
+
+    row.emplace_back("blockUs", frame.blockMicros);
+    row.emplace_back("budgetPercent", budgetMicros > 0.0 ? 100.0 * frame.blockMicros / budgetMicros : 0.0);
+    table.addRow(row);
+
+    dropped += frame.droppedBefore;
+    blockSizeChanges += (frame.flags & TelemetryFrame::blockSizeChanged) != 0 ? 1 : 0;
+    degradedBlocks += frame.getGuardLevel() > 0 ? 1 : 0;
+    durationSeconds = seconds + (frame.sampleRate > 0.0f ? frame.blockSize / frame.sampleRate : 0.0);
+
+    if (frame.blockMicros > slowestBlockMicros) {
+      slowestBlockMicros = frame.blockMicros;
+      slowestBlockSeconds = seconds;
+    }
+  }
+
+  std::cerr << frames.size() << " blocks, " << durationSeconds << " s, "
+            << dropped << " dropped, " << blockSizeChanges << " block-size changes, " << degradedBlocks
+            << " degraded by the CPU guard, slowest block "
+            << slowestBlockMicros << " us at " << slowestBlockSeconds << " s" << std::endl;
+
+  if (!table.write(args.getValueForOption("--output"), args.containsOption("--csv"))) {
+    std::cerr << "Failed to write output" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "ParameterIDs.h"
+#include "DSPConfig.h"
+
+#if JUCE_MODULE_AVAILABLE_juce_audio_processors
+  #include <juce_audio_processors/juce_audio_processors.h>
+#endif
+
+/**
+ * ToolUtilities.h
+ *
+ * Shared helpers for the headless NovaTune tools (benchmarks, harnesses).
+ *
+ * None of this is compiled into the plugin - it only exists so each tool
+ * doesn't have to re-implement argument parsing, parameter setting and
+ * result output.
+ *
+ * The parameter helpers need the processor module, so the tools built on
+ * NovaTuneDSP alone (no processor) don't get them.
+ */
+
+namespace NovaTuneTools {
+
+  //==========================================================================
+  // COMMAND LINE
+  //==========================================================================
+
+  /**
+   * Parse a comma-separated list of numbers ("44100,48000,96000").
+   * Returns the fallback list if the option was not given.
+   */
+  template <typename T>
+  inline std::vector<T> parseList(const juce::ArgumentList &args,
+                                  const juce::String &option,
+                                  std::vector<T> fallback) {
+    if (!args.containsOption(option))
+      return fallback;
+
+    std::vector<T> values;
+    auto tokens = juce::StringArray::fromTokens(args.getValueForOption(option), ",", "");
+    tokens.removeEmptyStrings();
+
+    for (const auto &token : tokens)
+      values.push_back(static_cast<T>(token.trim().getDoubleValue()));
+
+    return values.empty() ? fallback : values;
+  }
+
+  /** Parse a single numeric option with a default */
+  inline double parseNumber(const juce::ArgumentList &args,
+                            const juce::String &option,
+                            double fallback) {
+    if (!args.containsOption(option))
+      return fallback;
+    return args.getValueForOption(option).getDoubleValue();
+  }
+
+#if JUCE_MODULE_AVAILABLE_juce_audio_processors
+  //==========================================================================
+  // PARAMETERS
+  //==========================================================================
+
+  /**
+   * Set a parameter by ID using its real (denormalised) value.
+   * Goes through the same path as host automation.
+   */
+  inline void setParameter(juce::AudioProcessorValueTreeState &apvts,
+                           const char *parameterId,
+                           float value) {
+    if (auto *param = apvts.getParameter(parameterId))
+      param->setValueNotifyingHost(param->convertTo0to1(value));
+  }
+
+  /**
+   * Enable the first numVoices harmony voices (A, B, C) with distinct
+   * intervals, and disable the rest.
+   */
+  inline void setActiveHarmonyVoices(juce::AudioProcessorValueTreeState &apvts, int numVoices) {
+    const char *enabledIds[] = {ParamIDs::A_enabled, ParamIDs::B_enabled, ParamIDs::C_enabled};
+    const char *diaIds[] = {ParamIDs::A_intervalDiatonic, ParamIDs::B_intervalDiatonic, ParamIDs::C_intervalDiatonic};
+    const float intervals[] = {9.0f, 5.0f, 11.0f}; // +3rd, -3rd, +5th
+
+    for (int i = 0; i < DSPConfig::maxHarmonyVoices; ++i) {
+      setParameter(apvts, enabledIds[i], i < numVoices ? 1.0f : 0.0f);
+      setParameter(apvts, diaIds[i], intervals[i]);
+    }
+  }
+#endif
+
+  //==========================================================================
+  // TIMING
+  //==========================================================================
+
+  /**
+   * Minimal steady-clock stopwatch.
+   */
+  class Stopwatch {
+  public:
+    void start() noexcept { begin = std::chrono::steady_clock::now(); }
+
+    /** Nanoseconds since start() */
+    double elapsedNs() const noexcept {
+      return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+  private:
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+  };
+
+  //==========================================================================
+  // RESULT OUTPUT
+  //==========================================================================
+
+  /**
+   * Collects result rows and writes them as JSON or CSV.
+   *
+   * Every row is a flat set of named values. The column order for CSV is
+   * taken from the first row added.
+   */
+  class ResultTable {
+  public:
+    using Row = std::vector<std::pair<juce::String, juce::var>>;
+
+    /** Add a row - a list of (column, value) pairs */
+    void addRow(std::initializer_list<std::pair<juce::String, juce::var>> values) {
+      addRow(Row(values));
+    }
+
+    /** Add a row built up at runtime (e.g. with optional columns) */
+    void addRow(const Row &values) {
+      auto *row = new juce::DynamicObject();
+
+      for (const auto &[name, value] : values) {
+        if (rows.isEmpty())
+          columns.addIfNotAlreadyThere(name);
+        row->setProperty(name, value);
+      }
+
+      rows.add(juce::var(row));
+    }
+
+    int getNumRows() const noexcept { return rows.size(); }
+
+    juce::String toJson() const {
+      return juce::JSON::toString(juce::var(rows));
+    }
+
+    juce::String toCsv() const {
+      juce::String csv = columns.joinIntoString(",") + "\n";
+
+      for (const auto &row : rows) {
+        juce::StringArray cells;
+        for (const auto &column : columns)
+          cells.add(row.getProperty(column, {}).toString());
+        csv << cells.joinIntoString(",") << "\n";
+      }
+
+      return csv;
+    }
+
+    /**
+     * Write to a file, or to stdout when the path is empty.
+     * The format is CSV when the file ends in ".csv" or csv is requested.
+     */
+    bool write(const juce::String &path, bool asCsv) const {
+      const bool csv = asCsv || path.endsWithIgnoreCase(".csv");
+      const auto text = csv ? toCsv() : toJson();
+
+      if (path.isEmpty()) {
+        std::cout << text << std::endl;
+        return true;
+      }
+
+      return juce::File::getCurrentWorkingDirectory().getChildFile(path).replaceWithText(text);
+    }
+
+  private:
+    juce::StringArray columns;
+    juce::Array<juce::var> rows;
+  };
+
+} // namespace NovaTuneTools
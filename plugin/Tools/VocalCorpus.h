@@ -0,0 +1,185 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <vector>
+#include "ParameterIDs.h"
+#include "Utilities.h"
+#include "SyntheticVocal.h"
+
+/**
+ * VocalCorpus.h
+ *
+ * A fixed set of synthetic vocal takes with ground-truth pitch, used as the
+ * regression corpus for pitch detection and pitch shifting quality.
+ *
+ * Each take is written as a short score (notes, rests, glides, vibrato)
+ * and rendered through SyntheticVocal, so the exact F0 of every sample is
+ * known. The takes target the things that break real detectors:
+ * - Held notes across the low/mid/high voice ranges
+ * - Vibrato (periodic F0 modulation)
+ * - Glides between notes (portamento)
+ * - Breath noise and unvoiced gaps
+ * - Octave leaps (the classic octave-error trap)
+ *
+ * Everything is deterministic, so a change in the numbers is a change in
+ * the algorithm, not in the test material.
+ */
+
+namespace NovaTuneTools {
+
+  /** A note (or rest) in a take's score */
+  struct ScoreNote {
+    float midiNote = 57.0f;    // Ignored for rests
+    double seconds = 0.5;      // Duration, including the glide
+    double glideSeconds = 0.0; // Portamento from the previous note
+    float vibratoCents = 0.0f; // Peak deviation
+    float vibratoHz = 5.5f;
+    bool rest = false;
+  };
+
+  /** One rendered take plus its ground truth */
+  struct VocalTake {
+    juce::String name;
+    NovaTuneEnums::InputType inputType = NovaTuneEnums::InputType::AltoTenor;
+    juce::AudioBuffer<float> audio; // Mono
+    std::vector<float> truthHz;     // Per sample, 0 = unvoiced
+  };
+
+  /** A rest of the given length */
+  inline ScoreNote rest(double seconds) {
+    ScoreNote note;
+    note.seconds = seconds;
+    note.rest = true;
+    return note;
+  }
+
+  /**
+   * Render a score to audio and a per-sample F0 track.
+   *
+   * Vibrato fades in over the first 300ms of a note, as it does with
+   * real singers. Glides use a raised-cosine curve.
+   */
+  inline VocalTake renderTake(const juce::String &name,
+                              NovaTuneEnums::InputType inputType,
+                              const std::vector<ScoreNote> &score,
+                              double sampleRate,
+                              float breathNoise = 0.05f) {
+    constexpr double vibratoOnsetSeconds = 0.3;
+
+    VocalTake take;
+    take.name = name;
+    take.inputType = inputType;
+
+    double totalSeconds = 0.0;
+    for (const auto &note : score)
+      totalSeconds += note.seconds;
+
+    const int totalSamples = static_cast<int>(totalSeconds * sampleRate);
+    take.audio.setSize(1, totalSamples);
+    take.truthHz.assign(static_cast<size_t>(totalSamples), 0.0f);
+
+    SyntheticVocal vocal;
+    vocal.setBreathNoise(breathNoise);
+    vocal.prepare(sampleRate);
+
+    auto *out = take.audio.getWritePointer(0);
+    float previousMidi = score.empty() ? 57.0f : score.front().midiNote;
+    int position = 0;
+
+    for (const auto &note : score) {
+      const int noteSamples = std::min(static_cast<int>(note.seconds * sampleRate), totalSamples - position);
+      vocal.setVoiced(!note.rest);
+
+      for (int i = 0; i < noteSamples; ++i, ++position) {
+        if (note.rest) {
+          out[position] = vocal.nextSample();
+          continue;
+        }
+
+        const double t = static_cast<double>(i) / sampleRate;
+        double midi = note.midiNote;
+
+        if (note.glideSeconds > 0.0 && t < note.glideSeconds) {
+          const double progress = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::pi * t / note.glideSeconds);
+          midi = previousMidi + (note.midiNote - previousMidi) * progress;
+        }
+
+        if (note.vibratoCents > 0.0f) {
+          const double depth = note.vibratoCents * std::min(1.0, t / vibratoOnsetSeconds);
+          midi += depth / 100.0 * std::sin(juce::MathConstants<double>::twoPi * note.vibratoHz * t);
+        }
+
+        const float hz = NovaTuneUtils::midiNoteToFrequency(static_cast<float>(midi));
+        vocal.setFundamental(hz);
+        out[position] = vocal.nextSample();
+        take.truthHz[static_cast<size_t>(position)] = hz;
+      }
+
+      if (!note.rest)
+        previousMidi = note.midiNote;
+    }
+
+    return take;
+  }
+
+  /**
+   * Build the standard corpus at the given sample rate.
+   */
+  inline std::vector<VocalTake> buildVocalCorpus(double sampleRate) {
+    using NovaTuneEnums::InputType;
+
+    auto held = [](std::initializer_list<float> notes, double seconds) {
+      std::vector<ScoreNote> score;
+      for (float n : notes)
+        score.push_back({n, seconds});
+      return score;
+    };
+
+    std::vector<VocalTake> corpus;
+
+    // E2..E3, A2 region is where frame length matters most
+    corpus.push_back(renderTake("steady-low", InputType::LowMale, held({40, 43, 45, 47, 52}, 0.6), sampleRate));
+
+    // D3..G4, the bread-and-butter range
+    corpus.push_back(renderTake("steady-mid", InputType::AltoTenor, held({50, 55, 57, 60, 64, 67}, 0.5), sampleRate));
+
+    // E4..G5
+    corpus.push_back(renderTake("steady-high", InputType::Soprano, held({64, 69, 72, 76, 79}, 0.5), sampleRate));
+
+    corpus.push_back(renderTake("vibrato", InputType::AltoTenor,
+                                {{57, 1.5, 0.0, 50.0f, 5.5f},
+                                 {62, 1.5, 0.0, 80.0f, 6.2f},
+                                 {55, 1.5, 0.0, 30.0f, 4.8f}},
+                                sampleRate));
+
+    corpus.push_back(renderTake("glides", InputType::AltoTenor,
+                                {{55, 0.5},
+                                 {62, 0.6, 0.25},
+                                 {57, 0.5, 0.15},
+                                 {64, 0.7, 0.4},
+                                 {52, 0.7, 0.3}},
+                                sampleRate));
+
+    corpus.push_back(renderTake("breathy", InputType::AltoTenor,
+                                {{57, 0.7}, rest(0.25),
+                                 {60, 0.7}, rest(0.25),
+                                 {64, 1.0, 0.0, 40.0f, 5.5f}},
+                                sampleRate, 0.5f));
+
+    corpus.push_back(renderTake("octave-leaps", InputType::AltoTenor,
+                                held({52, 64, 52, 64, 57, 69, 57}, 0.4), sampleRate));
+
+    corpus.push_back(renderTake("phrase", InputType::AltoTenor,
+                                {rest(0.2),
+                                 {57, 0.4}, {59, 0.3, 0.08}, {60, 0.6, 0.1, 35.0f, 5.8f},
+                                 rest(0.15),
+                                 {64, 0.35}, {62, 0.3, 0.1}, {60, 0.9, 0.12, 60.0f, 5.5f},
+                                 rest(0.2),
+                                 {55, 0.3}, {67, 0.5}, {64, 0.8, 0.2, 45.0f, 6.0f},
+                                 rest(0.2)},
+                                sampleRate, 0.1f));
+
+    return corpus;
+  }
+
+} // namespace NovaTuneTools